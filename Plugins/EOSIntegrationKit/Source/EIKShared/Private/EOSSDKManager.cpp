@@ -15,6 +15,7 @@
 #include "Misc/ConfigCacheIni.h"
 #include "ProfilingDebugging/CsvProfiler.h"
 #include "ProfilingDebugging/CallstackTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 #include "Stats/Stats.h"
 
 #include "CoreGlobals.h"
@@ -36,6 +37,8 @@
 #define EOS_TRACE_MALLOC 1
 #endif
 
+CSV_DEFINE_CATEGORY(EIKSDK, true);
+
 namespace
 {
 	static void* EOS_MEMORY_CALL EosMalloc(size_t Bytes, size_t Alignment)
@@ -431,6 +434,7 @@ IEOSPlatformHandlePtr FEIKSDKManager::CreatePlatform(const FString& PlatformConf
 	{
 		UE_LOG(LogEOSSDK, Verbose, TEXT("Created platform handle: PlatformConfigName=%s InstanceName=%s"), *PlatformConfigName, *InstanceName.ToString());
 		PlatformMap->Emplace(InstanceName, PlatformHandle);
+		SetPlatformTickName(*PlatformHandle, InstanceName.IsNone() ? PlatformConfigName : FString::Printf(TEXT("%s_%s"), *PlatformConfigName, *InstanceName.ToString()));
 	}
 
 	return PlatformHandle;
@@ -454,6 +458,7 @@ IEOSPlatformHandlePtr FEIKSDKManager::CreatePlatform(EOS_Platform_Options& Platf
 		if (PlatformHandle)
 		{
 			ActivePlatforms.Emplace(PlatformHandle);
+			SetPlatformTickName(PlatformHandle, FString::Printf(TEXT("Platform%d"), NumCreatedPlatforms++));
 			SharedPlatform = MakeShared<FEOSPlatformHandle, ESPMode::ThreadSafe>(*this, PlatformHandle);
 			SetupTicker();
 
@@ -489,6 +494,13 @@ void FEIKSDKManager::LoadConfig()
 	ConfigTickIntervalSeconds = 0.f;
 	GConfig->GetDouble(TEXT("EOSSDK"), TEXT("TickIntervalSeconds"), ConfigTickIntervalSeconds, GEngineIni);
 
+	ConfigActiveTickIntervalSeconds = 0.f;
+	GConfig->GetDouble(TEXT("EOSSDK"), TEXT("ActiveTickIntervalSeconds"), ConfigActiveTickIntervalSeconds, GEngineIni);
+
+	double FrameTickBudgetMilliseconds = 0.f;
+	GConfig->GetDouble(TEXT("EOSSDK"), TEXT("FrameTickBudgetMilliseconds"), FrameTickBudgetMilliseconds, GEngineIni);
+	ConfigFrameTickBudgetSeconds = FrameTickBudgetMilliseconds / 1000.0;
+
 	SetupTicker();
 }
 
@@ -500,10 +512,10 @@ void FEIKSDKManager::SetupTicker()
 		TickerHandle.Reset();
 	}
 
+	// The ticker runs every frame, Tick decides which platforms are due
 	if (ActivePlatforms.Num() > 0)
 	{
-		const double TickIntervalSeconds = ConfigTickIntervalSeconds > SMALL_NUMBER ? ConfigTickIntervalSeconds / ActivePlatforms.Num() : 0.f;
-		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FEIKSDKManager::Tick), TickIntervalSeconds);
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FEIKSDKManager::Tick));
 	}
 }
 
@@ -511,31 +523,92 @@ bool FEIKSDKManager::Tick(float)
 {
 	ReleaseReleasedPlatforms();
 
-	if (ActivePlatforms.Num())
+	const int32 NumPlatforms = ActivePlatforms.Num();
+	if (NumPlatforms > 0)
 	{
-		TArray<EOS_HPlatform> PlatformsToTick;
-		if (ConfigTickIntervalSeconds > SMALL_NUMBER)
-		{
-			PlatformTickIdx = (PlatformTickIdx + 1) % ActivePlatforms.Num();
-			PlatformsToTick.Emplace(ActivePlatforms[PlatformTickIdx]);
-		}
-		else
-		{
-			PlatformsToTick = ActivePlatforms;
-		}
+		QUICK_SCOPE_CYCLE_COUNTER(FEIKSDKManager_Tick);
 
-		for (EOS_HPlatform PlatformHandle : PlatformsToTick)
+		// The completion callbacks are delivered by the platform ticks, tick faster while operations are waiting for them
+		const double TickIntervalSeconds = FCallbackBase::GetNumPendingOperations() > 0 ? ConfigActiveTickIntervalSeconds : ConfigTickIntervalSeconds;
+		const double FrameStartTime = FPlatformTime::Seconds();
+		bool bTickedPlatform = false;
+
+		// Platforms created by the callbacks are appended, they are ticked from the next frame
+		for (int32 Count = 1; Count <= NumPlatforms; ++Count)
 		{
-			LLM_SCOPE(ELLMTag::RealTimeCommunications); // TODO should really be ELLMTag::EOSSDK
-			QUICK_SCOPE_CYCLE_COUNTER(FEIKSDKManager_Tick);
-			CSV_SCOPED_TIMING_STAT_EXCLUSIVE(EOSSDK);
-			EOS_Platform_Tick(PlatformHandle);
+			const int32 PlatformIdx = (PlatformTickIdx + Count) % NumPlatforms;
+			const EOS_HPlatform PlatformHandle = ActivePlatforms[PlatformIdx];
+			FPlatformTickStats& Stats = PlatformTickStats.FindOrAdd(PlatformHandle);
+			if (FrameStartTime - Stats.LastTickTime < TickIntervalSeconds)
+			{
+				continue;
+			}
+
+			if (bTickedPlatform && ConfigFrameTickBudgetSeconds > 0.0
+				&& FPlatformTime::Seconds() - FrameStartTime + Stats.AverageTickSeconds > ConfigFrameTickBudgetSeconds)
+			{
+				// This platform goes first next frame
+				++Stats.NumDeferredTicks;
+				break;
+			}
+
+			TickPlatform(PlatformHandle);
+			PlatformTickIdx = PlatformIdx;
+			bTickedPlatform = true;
 		}
 	}
 
 	return true;
 }
 
+void FEIKSDKManager::TickPlatform(EOS_HPlatform PlatformHandle)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	{
+		LLM_SCOPE(ELLMTag::RealTimeCommunications); // TODO should really be ELLMTag::EOSSDK
+		const FPlatformTickStats* Stats = PlatformTickStats.Find(PlatformHandle);
+		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(Stats ? *Stats->Name : TEXT("EOS_Platform_Tick"));
+		CSV_SCOPED_TIMING_STAT_EXCLUSIVE(EOSSDK);
+		EOS_Platform_Tick(PlatformHandle);
+	}
+	const double TickSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// The callbacks can create platforms, the stats are looked up again once they ran
+	if (FPlatformTickStats* Stats = PlatformTickStats.Find(PlatformHandle))
+	{
+		Stats->LastTickTime = StartTime;
+		Stats->LastTickSeconds = TickSeconds;
+		Stats->AverageTickSeconds = Stats->NumTicks > 0 ? FMath::Lerp(Stats->AverageTickSeconds, TickSeconds, 0.1) : TickSeconds;
+		Stats->MaxTickSeconds = FMath::Max(Stats->MaxTickSeconds, TickSeconds);
+		++Stats->NumTicks;
+#if CSV_PROFILER
+		FCsvProfiler::RecordCustomStat(Stats->CsvStatName, CSV_CATEGORY_INDEX(EIKSDK), static_cast<float>(TickSeconds * 1000.0), ECsvCustomStatOp::Accumulate);
+#endif
+	}
+}
+
+void FEIKSDKManager::SetPlatformTickName(EOS_HPlatform PlatformHandle, const FString& Name)
+{
+	FPlatformTickStats& Stats = PlatformTickStats.FindOrAdd(PlatformHandle);
+	Stats.Name = Name;
+	Stats.CsvStatName = FName(*FString::Printf(TEXT("TickMs_%s"), *Name));
+}
+
+void FEIKSDKManager::LogTickStats() const
+{
+	UE_LOG(LogEOSSDK, Log, TEXT("TickStats: Platforms=%d PendingOperations=%d TickIntervalSeconds=%.3f ActiveTickIntervalSeconds=%.3f FrameTickBudgetSeconds=%.4f"),
+		ActivePlatforms.Num(), FCallbackBase::GetNumPendingOperations(), ConfigTickIntervalSeconds, ConfigActiveTickIntervalSeconds, ConfigFrameTickBudgetSeconds);
+
+	for (EOS_HPlatform PlatformHandle : ActivePlatforms)
+	{
+		if (const FPlatformTickStats* Stats = PlatformTickStats.Find(PlatformHandle))
+		{
+			UE_LOG(LogEOSSDK, Log, TEXT("TickStats: %s Ticks=%llu Deferred=%llu LastMs=%.3f AverageMs=%.3f MaxMs=%.3f"),
+				*Stats->Name, Stats->NumTicks, Stats->NumDeferredTicks, Stats->LastTickSeconds * 1000.0, Stats->AverageTickSeconds * 1000.0, Stats->MaxTickSeconds * 1000.0);
+		}
+	}
+}
+
 void FEIKSDKManager::OnApplicationStatusChanged(EOS_EApplicationStatus ApplicationStatus)
 {
 	UE_LOG(LogEOSSDK, Log, TEXT("OnApplicationStatusChanged [%s] -> [%s]"), LexToString(CachedApplicationStatus), LexToString(ApplicationStatus));
@@ -638,6 +711,7 @@ void FEIKSDKManager::ReleaseReleasedPlatforms()
 			{
 				EOS_Platform_Release(PlatformHandle);
 				ActivePlatforms.Remove(PlatformHandle);
+				PlatformTickStats.Remove(PlatformHandle);
 			}
 		}
 		ReleasedPlatforms.Empty();
@@ -697,6 +771,10 @@ bool FEIKSDKManager::Exec(class UWorld* InWorld, const TCHAR* Cmd, FOutputDevice
 	{
 		LogInfo();
 	}
+	else if (FParse::Command(&Cmd, TEXT("TICKSTATS")))
+	{
+		LogTickStats();
+	}
 	else
 	{
 		UE_LOG(LogEOSSDK, Warning, TEXT("Unknown exec command: %s]"), Cmd);
@@ -1037,10 +1115,8 @@ FEOSPlatformHandle::~FEOSPlatformHandle()
 
 void FEOSPlatformHandle::Tick()
 {
-	LLM_SCOPE(ELLMTag::RealTimeCommunications);
 	QUICK_SCOPE_CYCLE_COUNTER(FEOSPlatformHandle_Tick);
-	CSV_SCOPED_TIMING_STAT_EXCLUSIVE(EOSSDK);
-	EOS_Platform_Tick(PlatformHandle);
+	Manager.TickPlatform(PlatformHandle);
 }
 
 FString FEOSPlatformHandle::GetOverrideCountryCode() const
@@ -68,6 +68,25 @@ protected:
 	virtual IEOSPlatformHandlePtr CreatePlatform(const FEOSSDKPlatformConfig& PlatformConfig, EOS_Platform_Options& PlatformOptions);
 	virtual bool Tick(float);
 
+	/** Measured cost of the ticks of one platform, reported by EOSSDK TICKSTATS and to the CSV profiler */
+	struct FPlatformTickStats
+	{
+		FString Name;
+		FName CsvStatName;
+		double LastTickTime = 0.0;
+		double LastTickSeconds = 0.0;
+		/** Moving average, used to predict whether the next tick fits in the frame budget */
+		double AverageTickSeconds = 0.0;
+		double MaxTickSeconds = 0.0;
+		uint64 NumTicks = 0;
+		/** Number of frames the platform was due but not ticked because the frame budget was spent */
+		uint64 NumDeferredTicks = 0;
+	};
+
+	void TickPlatform(EOS_HPlatform PlatformHandle);
+	void SetPlatformTickName(EOS_HPlatform PlatformHandle, const FString& Name);
+	void LogTickStats() const;
+
 	void OnApplicationStatusChanged(EOS_EApplicationStatus ApplicationStatus);
 	void OnNetworkStatusChanged(EOS_ENetworkStatus NetworkStatus);
 	EOS_EApplicationStatus CachedApplicationStatus = EOS_EApplicationStatus::EOS_AS_Foreground;
@@ -88,10 +107,14 @@ protected:
 
 	/** Are we currently initialized */
 	bool bInitialized = false;
-	/** Index of the last ticked platform, used for round-robin ticking when ConfigTickIntervalSeconds > 0 */
-	uint8 PlatformTickIdx = 0;
+	/** Index of the last ticked platform, the next tick starts after it so the frame budget does not always defer the same platforms */
+	int32 PlatformTickIdx = 0;
 	/** Created platforms actively ticking */
 	TArray<EOS_HPlatform> ActivePlatforms;
+	/** Tick stats of the active platforms */
+	TMap<EOS_HPlatform, FPlatformTickStats> PlatformTickStats;
+	/** Number of platforms created so far, used to name the unnamed ones */
+	int32 NumCreatedPlatforms = 0;
 	/** Contains platforms released with ReleasePlatform, which we will release on the next Tick. */
 	TArray<EOS_HPlatform> ReleasedPlatforms;
 	/** Handle to ticker delegate for Tick(), valid whenever there are ActivePlatforms to tick, or ReleasedPlatforms to release. */
@@ -108,6 +131,10 @@ protected:
 	// Config
 	/** Interval between platform ticks. 0 means we tick every frame. */
 	double ConfigTickIntervalSeconds = 0.f;
+	/** Interval between platform ticks while SDK operations are waiting for their completion. 0 means we tick every frame. */
+	double ConfigActiveTickIntervalSeconds = 0.f;
+	/** Time the platform ticks may take in one frame, at least one platform is ticked per frame. 0 means no budget. */
+	double ConfigFrameTickBudgetSeconds = 0.f;
 };
 
 struct FEOSPlatformHandle : public IEOSPlatformHandle
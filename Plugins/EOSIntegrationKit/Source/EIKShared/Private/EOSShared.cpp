@@ -2,6 +2,7 @@
 
 #include "EOSShared.h"
 #include "EOSSharedTypes.h"
+#include "HAL/ThreadSafeCounter.h"
 
 #include "eos_auth_types.h"
 #include "eos_friends_types.h"
@@ -10,6 +11,26 @@
 
 DEFINE_LOG_CATEGORY(LogEOSSDK);
 
+namespace
+{
+	FThreadSafeCounter NumPendingOperations;
+}
+
+int32 FCallbackBase::GetNumPendingOperations()
+{
+	return NumPendingOperations.GetValue();
+}
+
+void FCallbackBase::AddPendingOperation()
+{
+	NumPendingOperations.Increment();
+}
+
+void FCallbackBase::RemovePendingOperation()
+{
+	NumPendingOperations.Decrement();
+}
+
 FString LexToString(const EOS_EResult EosResult)
 {
 	return UTF8_TO_TCHAR(EOS_EResult_ToString(EosResult));
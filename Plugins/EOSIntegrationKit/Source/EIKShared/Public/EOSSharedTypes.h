@@ -22,6 +22,14 @@ class EIKSHARED_API FCallbackBase
 {
 public:
 	virtual ~FCallbackBase() {}
+
+	/** Number of SDK operations still waiting for their completion callback, the platforms are ticked faster while there are some */
+	static int32 GetNumPendingOperations();
+
+protected:
+	/** Called by the callbacks of one-shot operations, which are created with the operation and deleted once it completed */
+	static void AddPendingOperation();
+	static void RemovePendingOperation();
 };
 
 #if WITH_EOS_SDK
@@ -152,6 +152,8 @@ const FEOSSettings& UEIKSettings::ManualGetSettings()
 		GConfig->GetString(INI_SECTION, TEXT("DefaultArtifactName"), CachedSettings->DefaultArtifactName, GEngineIni);
 		GConfig->GetInt(INI_SECTION, TEXT("TickBudgetInMilliseconds"), CachedSettings->TickBudgetInMilliseconds, GEngineIni);
 		GConfig->GetInt(INI_SECTION, TEXT("TitleStorageReadChunkLength"), CachedSettings->TitleStorageReadChunkLength, GEngineIni);
+		GConfig->GetBool(INI_SECTION, TEXT("bCacheUserCloudFiles"), CachedSettings->bCacheUserCloudFiles, GEngineIni);
+		GConfig->GetBool(INI_SECTION, TEXT("bTrustEnumeratedUserCloudFiles"), CachedSettings->bTrustEnumeratedUserCloudFiles, GEngineIni);
 		GConfig->GetBool(INI_SECTION, TEXT("bEnableOverlay"), CachedSettings->bEnableOverlay, GEngineIni);
 		GConfig->GetBool(INI_SECTION, TEXT("bEnableSocialOverlay"), CachedSettings->bEnableSocialOverlay, GEngineIni);
 		GConfig->GetBool(INI_SECTION, TEXT("bEnableEditorOverlay"), CachedSettings->bEnableEditorOverlay, GEngineIni);
@@ -177,6 +179,8 @@ FEOSSettings UEIKSettings::ToNative() const
 	Native.DefaultArtifactName = DefaultArtifactName;
 	Native.TickBudgetInMilliseconds = TickBudgetInMilliseconds;
 	Native.TitleStorageReadChunkLength = TitleStorageReadChunkLength;
+	Native.bCacheUserCloudFiles = bCacheUserCloudFiles;
+	Native.bTrustEnumeratedUserCloudFiles = bTrustEnumeratedUserCloudFiles;
 	Native.bEnableOverlay = bEnableOverlay;
 	Native.bEnableSocialOverlay = bEnableSocialOverlay;
 	Native.bEnableEditorOverlay = bEnableEditorOverlay;
@@ -26,6 +26,16 @@
 /** This is the game name plus version in ansi done once for optimization */
 char BucketIdAnsi[EOS_OSS_STRING_BUFFER_LENGTH];
 
+/** Version of the LAN beacon responses, the responses of other versions are ignored */
+constexpr uint8 LAN_SESSION_BEACON_VERSION = 1;
+/** A full record carries the whole session, an unchanged one only the open connections */
+constexpr uint8 LAN_SESSION_RECORD_FULL = 0;
+constexpr uint8 LAN_SESSION_RECORD_UNCHANGED = 1;
+/** Seconds after which a host sends the whole session again to a client that already received it */
+constexpr double LAN_SESSION_BEACON_CLIENT_TIMEOUT = 60.0;
+/** Seconds a LAN search result is kept without a response from its host, longer than the above */
+constexpr double LAN_SEARCH_RESULT_MAX_AGE = 120.0;
+
 FString MakeStringFromAttributeValue(const EOS_Sessions_AttributeData* Attribute)
 {
 	switch (Attribute->ValueType)
@@ -67,6 +77,109 @@ bool IsSessionSettingTypeSupported(EOnlineKeyValuePairDataType::Type InType)
 	return false;
 }
 
+bool GetLANSearchNumericValue(const FVariantData& Data, double& OutValue)
+{
+	switch (Data.GetType())
+	{
+		case EOnlineKeyValuePairDataType::Int32:
+		{
+			int32 Value = 0;
+			Data.GetValue(Value);
+			OutValue = Value;
+			return true;
+		}
+		case EOnlineKeyValuePairDataType::UInt32:
+		{
+			uint32 Value = 0;
+			Data.GetValue(Value);
+			OutValue = Value;
+			return true;
+		}
+		case EOnlineKeyValuePairDataType::Int64:
+		{
+			int64 Value = 0;
+			Data.GetValue(Value);
+			OutValue = Value;
+			return true;
+		}
+		case EOnlineKeyValuePairDataType::UInt64:
+		{
+			uint64 Value = 0;
+			Data.GetValue(Value);
+			OutValue = Value;
+			return true;
+		}
+		case EOnlineKeyValuePairDataType::Float:
+		{
+			float Value = 0.f;
+			Data.GetValue(Value);
+			OutValue = Value;
+			return true;
+		}
+		case EOnlineKeyValuePairDataType::Double:
+		{
+			Data.GetValue(OutValue);
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Compares an advertised LAN setting with a search param, params that can't be compared with it are ignored */
+bool MatchesLANSearchParam(const FVariantData& Setting, const FOnlineSessionSearchParam& SearchParam)
+{
+	double SettingValue = 0.0;
+	double ParamValue = 0.0;
+	const bool bIsNumeric = GetLANSearchNumericValue(Setting, SettingValue) && GetLANSearchNumericValue(SearchParam.Data, ParamValue);
+	if (!bIsNumeric && Setting.GetType() != SearchParam.Data.GetType())
+	{
+		return true;
+	}
+
+	switch (SearchParam.ComparisonOp)
+	{
+		case EOnlineComparisonOp::Equals:
+		{
+			return bIsNumeric ? SettingValue == ParamValue : Setting == SearchParam.Data;
+		}
+		case EOnlineComparisonOp::NotEquals:
+		{
+			return bIsNumeric ? SettingValue != ParamValue : Setting != SearchParam.Data;
+		}
+		case EOnlineComparisonOp::GreaterThan:
+		{
+			return !bIsNumeric || SettingValue > ParamValue;
+		}
+		case EOnlineComparisonOp::GreaterThanEquals:
+		{
+			return !bIsNumeric || SettingValue >= ParamValue;
+		}
+		case EOnlineComparisonOp::LessThan:
+		{
+			return !bIsNumeric || SettingValue < ParamValue;
+		}
+		case EOnlineComparisonOp::LessThanEquals:
+		{
+			return !bIsNumeric || SettingValue <= ParamValue;
+		}
+	}
+	return true;
+}
+
+bool MatchesLANSearch(const FOnlineSessionSettings& SessionSettings, const FOnlineSearchSettings& QuerySettings)
+{
+	for (FSearchParams::TConstIterator It(QuerySettings.SearchParams); It; ++It)
+	{
+		// Keys the host doesn't advertise are search options like SEARCH_PRESENCE rather than filters
+		const FOnlineSessionSetting* Setting = SessionSettings.Settings.Find(It.Key());
+		if (Setting != nullptr && !MatchesLANSearchParam(Setting->Data, It.Value()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 EOS_EOnlineComparisonOp ToEOSSearchOp(EOnlineComparisonOp::Type Op)
 {
 	switch (Op)
@@ -1010,6 +1123,9 @@ uint32 FOnlineSessionEOS::CreateLANSession(int32 HostingPlayerNum, FNamedOnlineS
 	NewSessionInfo->InitLAN(EOSSubsystem);
 	Session->SessionInfo = MakeShareable(NewSessionInfo);
 
+	// A new session gets a new beacon id so the clients don't mistake it for the previous one
+	LANSessionBeacons.Remove(Session->SessionName);
+
 	// Don't create a the beacon if advertising is off
 	if (Session->SessionSettings.bShouldAdvertise)
 	{
@@ -1516,6 +1632,11 @@ bool FOnlineSessionEOS::UpdateSession(FName SessionName, FOnlineSessionSettings&
 		}
 		else
 		{
+			// Encode the LAN beacon again on the next query
+			if (FLANSessionBeaconEOS* Beacon = LANSessionBeacons.Find(SessionName))
+			{
+				Beacon->bIsDirty = true;
+			}
 			Result = ONLINE_SUCCESS;
 		}
 	}
@@ -1744,6 +1865,7 @@ bool FOnlineSessionEOS::DestroySession(FName SessionName, const FOnDestroySessio
 					LANSession->StopLANSession();
 					LANSession = nullptr;
 				}
+				LANSessionBeacons.Remove(SessionName);
 
 				Result = ONLINE_SUCCESS;
 			}
@@ -2321,8 +2443,13 @@ uint32 FOnlineSessionEOS::FindLANSession()
 		LANSession = MakeShareable(new FLANSession());
 	}
 
-	// Recreate the unique identifier for this client
-	GenerateNonce((uint8*)&LANSession->LanNonce, 8);
+	// The hosts remember the sessions they sent to our nonce, so it is only recreated when our results don't match theirs
+	if (bLANSearchNeedsNewNonce || LANSearchResults.Num() == 0)
+	{
+		GenerateNonce((uint8*)&LANSearchNonce, 8);
+		bLANSearchNeedsNewNonce = false;
+	}
+	LANSession->LanNonce = LANSearchNonce;
 
 	FOnValidResponsePacketDelegate ResponseDelegate = FOnValidResponsePacketDelegate::CreateRaw(this, &FOnlineSessionEOS::OnValidResponsePacketReceived);
 	FOnSearchingTimeoutDelegate TimeoutDelegate = FOnSearchingTimeoutDelegate::CreateRaw(this, &FOnlineSessionEOS::OnLANSearchTimeout);
@@ -3159,12 +3286,7 @@ void FOnlineSessionEOS::AppendSessionToPacket(FNboSerializeToBufferEOS& Packet,
 {
 	/** Owner of the session */
 	((FNboSerializeToBuffer&)Packet) << Session->OwningUserId->ToString()
-		<< Session->OwningUserName
-		<< Session->NumOpenPrivateConnections
-		<< Session->NumOpenPublicConnections;
-
-	// Try to get the actual port the netdriver is using
-	SetPortFromNetDriver(*EOSSubsystem, Session->SessionInfo);
+		<< Session->OwningUserName;
 
 	// Write host info (host addr, session id, and key)
 	Packet << *StaticCastSharedPtr<FOnlineSessionInfoEOS>(Session->SessionInfo);
@@ -3221,6 +3343,46 @@ void FOnlineSessionEOS::AppendSessionSettingsToPacket(FNboSerializeToBufferEOS&
 	}
 }
 
+FLANSessionBeaconEOS& FOnlineSessionEOS::GetLANSessionBeacon(FNamedOnlineSession* Session)
+{
+	FLANSessionBeaconEOS& Beacon = LANSessionBeacons.FindOrAdd(Session->SessionName);
+	if (Beacon.BeaconId == 0)
+	{
+		GenerateNonce((uint8*)&Beacon.BeaconId, 8);
+	}
+
+	const int32 NetDriverPort = GetPortFromNetDriver(EOSSubsystem->GetInstanceName());
+	if (Beacon.bIsDirty || Beacon.EncodedPort != NetDriverPort)
+	{
+		// Try to get the actual port the netdriver is using
+		SetPortFromNetDriver(*EOSSubsystem, Session->SessionInfo);
+
+		FNboSerializeToBufferEOS Packet(LAN_BEACON_MAX_PACKET_SIZE);
+		AppendSessionToPacket(Packet, Session);
+		Beacon.EncodedSession.Reset();
+		Beacon.EncodedSession.Append((uint8*)Packet, Packet.GetByteCount());
+		Beacon.EncodedPort = NetDriverPort;
+		Beacon.bIsDirty = false;
+		Beacon.Revision++;
+
+		// Every client needs the new revision
+		Beacon.UpToDateClients.Reset();
+	}
+	else
+	{
+		const double Now = FPlatformTime::Seconds();
+		for (TMap<uint64, double>::TIterator It(Beacon.UpToDateClients); It; ++It)
+		{
+			if (Now - It.Value() > LAN_SESSION_BEACON_CLIENT_TIMEOUT)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	return Beacon;
+}
+
 void FOnlineSessionEOS::OnValidQueryPacketReceived(uint8* PacketData, int32 PacketLength, uint64 ClientNonce)
 {
 	// Iterate through all registered sessions and respond for each LAN match
@@ -3242,12 +3404,28 @@ void FOnlineSessionEOS::OnValidQueryPacketReceived(uint8* PacketData, int32 Pack
 
 			if (bIsMatchJoinable)
 			{
+				FLANSessionBeaconEOS& Beacon = GetLANSessionBeacon(Session);
+
+				// Clients that already received this revision only need the open connections
+				const bool bIsClientUpToDate = Beacon.UpToDateClients.Contains(ClientNonce);
+
 				FNboSerializeToBufferEOS Packet(LAN_BEACON_MAX_PACKET_SIZE);
 				// Create the basic header before appending additional information
 				LANSession->CreateHostResponsePacket(Packet, ClientNonce);
 
-				// Add all the session details
-				AppendSessionToPacket(Packet, Session);
+				((FNboSerializeToBuffer&)Packet) << LAN_SESSION_BEACON_VERSION
+					<< (bIsClientUpToDate ? LAN_SESSION_RECORD_UNCHANGED : LAN_SESSION_RECORD_FULL)
+					<< Beacon.BeaconId
+					<< Beacon.Revision
+					<< Session->NumOpenPrivateConnections
+					<< Session->NumOpenPublicConnections;
+
+				if (!bIsClientUpToDate)
+				{
+					// Add all the session details
+					Packet.WriteBinary(Beacon.EncodedSession.GetData(), Beacon.EncodedSession.Num());
+					Beacon.UpToDateClients.Add(ClientNonce, FPlatformTime::Seconds());
+				}
 
 				// Broadcast this response so the client can see us
 				LANSession->BroadcastPacket(Packet, Packet.GetByteCount());
@@ -3265,9 +3443,7 @@ void FOnlineSessionEOS::ReadSessionFromPacket(FNboSerializeFromBufferEOS& Packet
 	/** Owner of the session */
 	FString OwningUserIdStr;
 	Packet >> OwningUserIdStr
-		>> Session->OwningUserName
-		>> Session->NumOpenPrivateConnections
-		>> Session->NumOpenPublicConnections;
+		>> Session->OwningUserName;
 
 	Session->OwningUserId = FUniqueNetIdEOSRegistry::FindOrAdd(OwningUserIdStr);
 
@@ -3352,28 +3528,66 @@ void FOnlineSessionEOS::ReadSettingsFromPacket(FNboSerializeFromBufferEOS& Packe
 
 void FOnlineSessionEOS::OnValidResponsePacketReceived(uint8* PacketData, int32 PacketLength)
 {
-	// Create an object that we'll copy the data to
-	FOnlineSessionSettings NewServer;
-	if (CurrentSessionSearch.IsValid())
+	if (!CurrentSessionSearch.IsValid())
 	{
-		// Add space in the search results array
-		FOnlineSessionSearchResult* NewResult = new (CurrentSessionSearch->SearchResults) FOnlineSessionSearchResult();
-		// this is not a correct ping, but better than nothing
-		NewResult->PingInMs = static_cast<int32>((FPlatformTime::Seconds() - SessionSearchStartInSeconds) * 1000);
+		UE_LOG_ONLINE_SESSION(Warning, TEXT("Received a LAN session without a search in progress"));
+		return;
+	}
 
-		FOnlineSession* NewSession = &NewResult->Session;
+	// Prepare to read data from the packet
+	FNboSerializeFromBufferEOS Packet(PacketData, PacketLength);
 
-		// Prepare to read data from the packet
-		FNboSerializeFromBufferEOS Packet(PacketData, PacketLength);
-		
-		ReadSessionFromPacket(Packet, NewSession);
+	uint8 Version = 0;
+	Packet >> Version;
+	if (Version != LAN_SESSION_BEACON_VERSION)
+	{
+		UE_LOG_ONLINE_SESSION(Verbose, TEXT("Ignoring LAN session of beacon version (%d)"), Version);
+		return;
+	}
 
-		// NOTE: we don't notify until the timeout happens
+	uint8 RecordType = 0;
+	uint64 BeaconId = 0;
+	uint32 Revision = 0;
+	int32 NumOpenPrivateConnections = 0;
+	int32 NumOpenPublicConnections = 0;
+	Packet >> RecordType
+		>> BeaconId
+		>> Revision
+		>> NumOpenPrivateConnections
+		>> NumOpenPublicConnections;
+	if (Packet.HasOverflow())
+	{
+		UE_LOG_ONLINE_SESSION(Verbose, TEXT("Packet overflow detected in OnValidResponsePacketReceived()"));
+		return;
 	}
-	else
+
+	FLANSearchResultEOS* Result = LANSearchResults.Find(BeaconId);
+	if (Result == nullptr || Result->Revision != Revision)
 	{
-		UE_LOG_ONLINE_SESSION(Warning, TEXT("Failed to create new online game settings object"));
+		if (RecordType != LAN_SESSION_RECORD_FULL)
+		{
+			// The host thinks we already have this revision, the next search asks every host for everything again
+			bLANSearchNeedsNewNonce = true;
+			return;
+		}
+
+		FLANSearchResultEOS NewResult;
+		NewResult.Revision = Revision;
+		ReadSessionFromPacket(Packet, &NewResult.SearchResult.Session);
+		if (Packet.HasOverflow())
+		{
+			return;
+		}
+		Result = &LANSearchResults.Add(BeaconId, MoveTemp(NewResult));
 	}
+
+	Result->SearchResult.Session.NumOpenPrivateConnections = NumOpenPrivateConnections;
+	Result->SearchResult.Session.NumOpenPublicConnections = NumOpenPublicConnections;
+	// this is not a correct ping, but better than nothing
+	Result->SearchResult.PingInMs = static_cast<int32>((FPlatformTime::Seconds() - SessionSearchStartInSeconds) * 1000);
+	Result->LastSeenTime = FPlatformTime::Seconds();
+
+	// NOTE: we don't notify until the timeout happens
 }
 
 void FOnlineSessionEOS::OnLANSearchTimeout()
@@ -3413,6 +3627,24 @@ void FOnlineSessionEOS::OnLANSearchTimeout()
 
 	if (CurrentSessionSearch.IsValid())
 	{
+		// Report the sessions whose host answered this search, the others are kept a while in case a response was lost
+		const double Now = FPlatformTime::Seconds();
+		for (TMap<uint64, FLANSearchResultEOS>::TIterator It(LANSearchResults); It; ++It)
+		{
+			const FLANSearchResultEOS& Result = It.Value();
+			if (Result.LastSeenTime < SessionSearchStartInSeconds)
+			{
+				if (Now - Result.LastSeenTime > LAN_SEARCH_RESULT_MAX_AGE)
+				{
+					It.RemoveCurrent();
+				}
+			}
+			else if (MatchesLANSearch(Result.SearchResult.Session.SessionSettings, CurrentSessionSearch->QuerySettings))
+			{
+				CurrentSessionSearch->SearchResults.Add(Result.SearchResult);
+			}
+		}
+
 		if (CurrentSessionSearch->SearchResults.Num() > 0)
 		{
 			// Allow game code to sort the servers
@@ -49,6 +49,32 @@ struct FLobbyDetailsEOS : FNoncopyable
 	}
 };
 
+/** LAN beacon data of a hosted session, encoded again only when the session changes */
+struct FLANSessionBeaconEOS
+{
+	/** Identifies the session in the search results of the clients, a recreated session gets a new one */
+	uint64 BeaconId = 0;
+	/** Incremented every time the session is encoded again */
+	uint32 Revision = 0;
+	/** Owner, host address and advertised settings of the session */
+	TArray<uint8> EncodedSession;
+	/** Port of the host address when the session was encoded */
+	int32 EncodedPort = 0;
+	/** Set when the session settings were updated */
+	bool bIsDirty = true;
+	/** Search nonces of the clients that received this revision, and when */
+	TMap<uint64, double> UpToDateClients;
+};
+
+/** Session found over LAN, kept between the searches so the hosts only send what changed */
+struct FLANSearchResultEOS
+{
+	FOnlineSessionSearchResult SearchResult;
+	uint32 Revision = 0;
+	/** Time of the last response of the host */
+	double LastSeenTime = 0.0;
+};
+
 /**
  * Interface for interacting with EOS sessions
  */
@@ -171,6 +197,8 @@ public:
 		: CurrentSessionSearch(nullptr)
 		, SessionSearchStartInSeconds(0)
 		, EOSSubsystem(InSubsystem)
+		, LANSearchNonce(0)
+		, bLANSearchNeedsNewNonce(true)
 	{
 	}
 
@@ -310,6 +338,7 @@ private:
 	uint32 JoinLANSession(int32 PlayerNum, class FNamedOnlineSession* Session, const class FOnlineSession* SearchSession);
 	uint32 FindLANSession();
 
+	FLANSessionBeaconEOS& GetLANSessionBeacon(FNamedOnlineSession* Session);
 	void AppendSessionToPacket(class FNboSerializeToBufferEOS& Packet, class FOnlineSession* Session);
 	void AppendSessionSettingsToPacket(class FNboSerializeToBufferEOS& Packet, FOnlineSessionSettings* SessionSettings);
 	void ReadSessionFromPacket(class FNboSerializeFromBufferEOS& Packet, class FOnlineSession* Session);
@@ -325,6 +354,14 @@ private:
 
 	/** Handles advertising sessions over LAN and client searches */
 	TSharedPtr<FLANSession> LANSession;
+	/** LAN beacon data of the hosted sessions, by session name */
+	TMap<FName, FLANSessionBeaconEOS> LANSessionBeacons;
+	/** Sessions found by the LAN searches, by beacon id */
+	TMap<uint64, FLANSearchResultEOS> LANSearchResults;
+	/** Kept between the LAN searches so the hosts know which sessions we already received */
+	uint64 LANSearchNonce;
+	/** Set when a host assumed we had a session we don't have, so every host sends everything again */
+	bool bLANSearchNeedsNewNonce;
 	/** EOS handle wrapper to hold onto it for scope of the search */
 	TSharedPtr<FSessionSearchEOS> CurrentSearchHandle;
 	/** The last accepted invite search. It searches by session id */
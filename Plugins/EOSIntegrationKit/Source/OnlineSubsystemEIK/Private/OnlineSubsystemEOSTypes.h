@@ -351,13 +351,18 @@ public:
 		: FCallbackBase()
 		, Owner(InOwner)
 	{
+		AddPendingOperation();
 	}
 	TEOSCallback(TWeakPtr<const OwningType> InOwner)
 		: FCallbackBase()
 		, Owner(InOwner)
 	{
+		AddPendingOperation();
+	}
+	virtual ~TEOSCallback()
+	{
+		RemovePendingOperation();
 	}
-	virtual ~TEOSCallback() = default;
 
 
 	CallbackFuncType GetCallbackPtr()
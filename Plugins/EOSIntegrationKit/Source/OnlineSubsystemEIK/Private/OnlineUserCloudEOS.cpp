@@ -5,25 +5,173 @@
 #include "OnlineSubsystemEOS.h"
 #include "OnlineSubsystemEOSPrivate.h"
 #include "OnlineSubsystemEOSTypes.h"
+#include "UserCloudStorageEOS.h"
 #include "UserManagerEOS.h"
 #include "EIKSettings.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 #if WITH_EOS_SDK
-#include "eos_playerdatastorage.h"
 
-typedef TEOSCallback<EOS_PlayerDataStorage_OnQueryFileListCompleteCallback, EOS_PlayerDataStorage_QueryFileListCallbackInfo, FOnlineUserCloudEOS> FOnQueryFileListCallback;
+namespace
+{
+	/** Files are split in about this many chunks, so large files do not go through thousands of small chunks */
+	const int64 USER_CLOUD_TARGET_CHUNK_COUNT = 16;
+	/** Largest chunk used by the transfers, the chunks are copied on the game thread */
+	const int32 USER_CLOUD_MAX_CHUNK_LENGTH = 1024 * 1024;
+
+	/** Marks the files compressed by WriteUserFile, the other files are stored as they were given */
+	const uint32 USER_CLOUD_PAYLOAD_MAGIC = 0x434B4945; // "EIKC"
+	const uint8 USER_CLOUD_PAYLOAD_VERSION = 1;
+
+	enum class EUserCloudPayloadFormat : uint8
+	{
+		Zlib = 1,
+		Oodle = 2
+	};
+
+	struct FUserCloudPayloadHeader
+	{
+		static const int32 Size = 32;
+
+		uint32 Magic = USER_CLOUD_PAYLOAD_MAGIC;
+		uint8 Version = USER_CLOUD_PAYLOAD_VERSION;
+		uint8 Format = 0;
+		uint16 Reserved = 0;
+		int32 UncompressedSize = 0;
+		/** Hash of the uncompressed contents */
+		FSHAHash Hash;
+
+		friend FArchive& operator<<(FArchive& Ar, FUserCloudPayloadHeader& Header)
+		{
+			return Ar << Header.Magic << Header.Version << Header.Format << Header.Reserved << Header.UncompressedSize << Header.Hash;
+		}
+	};
+
+	/** Compresses the contents of a file, returns false if they do not get smaller */
+	bool EncodeUserCloudPayload(const TArray<uint8>& Contents, TArray<uint8>& OutPayload)
+	{
+		const FName FormatName = FCompression::IsFormatValid(NAME_Oodle) ? NAME_Oodle : NAME_Zlib;
+
+		FUserCloudPayloadHeader Header;
+		Header.Format = (uint8)(FormatName == NAME_Oodle ? EUserCloudPayloadFormat::Oodle : EUserCloudPayloadFormat::Zlib);
+		Header.UncompressedSize = Contents.Num();
+		FSHA1::HashBuffer(Contents.GetData(), Contents.Num(), Header.Hash.Hash);
+
+		int32 CompressedSize = FCompression::CompressMemoryBound(FormatName, Contents.Num());
+		OutPayload.SetNumUninitialized(FUserCloudPayloadHeader::Size + CompressedSize);
+		if (!FCompression::CompressMemory(FormatName, OutPayload.GetData() + FUserCloudPayloadHeader::Size, CompressedSize, Contents.GetData(), Contents.Num())
+			|| FUserCloudPayloadHeader::Size + CompressedSize >= Contents.Num())
+		{
+			OutPayload.Empty();
+			return false;
+		}
+		OutPayload.SetNum(FUserCloudPayloadHeader::Size + CompressedSize, false);
+
+		FMemoryWriter Writer(OutPayload);
+		Writer << Header;
+		return true;
+	}
+
+	/** Decompresses the files written with compression and checks their hash, the other files are left as they are */
+	bool DecodeUserCloudPayload(TArray<uint8>& InOutData)
+	{
+		if (InOutData.Num() < FUserCloudPayloadHeader::Size)
+		{
+			return true;
+		}
+
+		FUserCloudPayloadHeader Header;
+		FMemoryReader Reader(InOutData);
+		Reader << Header;
+		if (Header.Magic != USER_CLOUD_PAYLOAD_MAGIC)
+		{
+			return true;
+		}
+
+		FName FormatName = NAME_None;
+		if (Header.Format == (uint8)EUserCloudPayloadFormat::Zlib)
+		{
+			FormatName = NAME_Zlib;
+		}
+		else if (Header.Format == (uint8)EUserCloudPayloadFormat::Oodle)
+		{
+			FormatName = NAME_Oodle;
+		}
+
+		if (Header.Version != USER_CLOUD_PAYLOAD_VERSION || FormatName.IsNone() || Header.UncompressedSize < 0)
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::DecodeUserCloudPayload] Unsupported payload version %d with format %d"), Header.Version, Header.Format);
+			return false;
+		}
+
+		TArray<uint8> Contents;
+		Contents.SetNumUninitialized(Header.UncompressedSize);
+		if (!FCompression::UncompressMemory(FormatName, Contents.GetData(), Contents.Num(), InOutData.GetData() + FUserCloudPayloadHeader::Size, InOutData.Num() - FUserCloudPayloadHeader::Size))
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::DecodeUserCloudPayload] Unable to decompress payload of %d bytes"), InOutData.Num());
+			return false;
+		}
+
+		FSHAHash Hash;
+		FSHA1::HashBuffer(Contents.GetData(), Contents.Num(), Hash.Hash);
+		if (Hash != Header.Hash)
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::DecodeUserCloudPayload] Hash mismatch after decompressing %d bytes"), Contents.Num());
+			return false;
+		}
+
+		InOutData = MoveTemp(Contents);
+		return true;
+	}
+
+	/** The cached files are named after the hash the storage gives to the stored version of the file */
+	FString GetUserCloudCachePath(const FUniqueNetId& UserId, const FString& MD5Hash)
+	{
+		return FPaths::ProjectSavedDir() / TEXT("EIK") / TEXT("UserCloudCache") / UserId.ToString() / MD5Hash;
+	}
 
-typedef TEOSCallbackWithNested2ForNested1Param3<EOS_PlayerDataStorage_OnWriteFileCompleteCallback, EOS_PlayerDataStorage_WriteFileCallbackInfo, FOnlineUserCloudEOS,
-	EOS_PlayerDataStorage_OnWriteFileDataCallback, EOS_PlayerDataStorage_WriteFileDataCallbackInfo, EOS_PlayerDataStorage_EWriteResult,
-	EOS_PlayerDataStorage_OnFileTransferProgressCallback, EOS_PlayerDataStorage_FileTransferProgressCallbackInfo
-> FWriteUserFileCompleteCallback;
+	/** The cached files start with the hash of the payload, so a partially written file is never used */
+	void SaveCachedUserCloudPayload(const FString& Path, const TArray<uint8>& Payload)
+	{
+		FSHAHash Hash;
+		FSHA1::HashBuffer(Payload.GetData(), Payload.Num(), Hash.Hash);
+
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Path));
+		if (Writer.IsValid())
+		{
+			Writer->Serialize(Hash.Hash, sizeof(Hash.Hash));
+			Writer->Serialize(const_cast<uint8*>(Payload.GetData()), Payload.Num());
+		}
+	}
 
-typedef TEOSCallbackWithNested2<EOS_PlayerDataStorage_OnReadFileCompleteCallback, EOS_PlayerDataStorage_ReadFileCallbackInfo, FOnlineUserCloudEOS,
-	EOS_PlayerDataStorage_OnReadFileDataCallback, EOS_PlayerDataStorage_ReadFileDataCallbackInfo, EOS_PlayerDataStorage_EReadResult,
-	EOS_PlayerDataStorage_OnFileTransferProgressCallback, EOS_PlayerDataStorage_FileTransferProgressCallbackInfo
-> FReadUserFileCompleteCallback;
+	bool LoadCachedUserCloudPayload(const FString& Path, TArray<uint8>& OutPayload)
+	{
+		constexpr int32 HashSize = sizeof(FSHAHash::Hash);
+		if (!FFileHelper::LoadFileToArray(OutPayload, *Path, FILEREAD_Silent) || OutPayload.Num() < HashSize)
+		{
+			return false;
+		}
+
+		FSHAHash Hash;
+		FSHA1::HashBuffer(OutPayload.GetData() + HashSize, OutPayload.Num() - HashSize, Hash.Hash);
+		if (FMemory::Memcmp(Hash.Hash, OutPayload.GetData(), HashSize) != 0)
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::LoadCachedUserCloudPayload] Discarding corrupted cached file %s"), *Path);
+			IFileManager::Get().Delete(*Path, false, false, true);
+			return false;
+		}
 
-typedef TEOSCallback<EOS_PlayerDataStorage_OnDeleteFileCompleteCallback, EOS_PlayerDataStorage_DeleteFileCallbackInfo, FOnlineUserCloudEOS> FOnDeleteFileCallback;
+		OutPayload.RemoveAt(0, HashSize, false);
+		return true;
+	}
+}
 
 void FEOSUserCloudFile::Unload()
 {
@@ -38,6 +186,61 @@ void FEOSUserCloudFile::Unload()
 	}
 }
 
+FOnlineUserCloudEOS::FOnlineUserCloudEOS(FOnlineSubsystemEOS* InSubsystem)
+	: EOSSubsystem(InSubsystem)
+{
+	// -EOSLocalUserCloud stores the files on disk instead, to test the user cloud without the EOS service
+	if (FParse::Param(FCommandLine::Get(), TEXT("EOSLocalUserCloud")))
+	{
+		Storage = MakeShared<FUserCloudStorageEOSLocal, ESPMode::ThreadSafe>();
+	}
+	else
+	{
+		Storage = MakeShared<FUserCloudStorageEOSSDK, ESPMode::ThreadSafe>(EOSSubsystem->PlayerDataStorageHandle);
+	}
+}
+
+void FOnlineUserCloudEOS::SetStorage(const FUserCloudStorageEOSPtr& InStorage)
+{
+	check(InStorage.IsValid());
+	Storage = InStorage;
+}
+
+uint32 FOnlineUserCloudEOS::GetChunkLength(int64 FileSizeBytes) const
+{
+	int32 ChunkLength = UEIKSettings::GetSettings().TitleStorageReadChunkLength;
+	if (ChunkLength <= 0)
+	{
+		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::GetChunkLength] invalid size TitleStorageReadChunkLength %d. ReadChunkSize set to 16KB by default"), ChunkLength);
+		ChunkLength = 16 * 1024;
+	}
+
+	// The setting is the smallest chunk, larger files use larger chunks
+	const int64 AdaptiveChunkLength = FMath::DivideAndRoundUp(FMath::Max<int64>(FileSizeBytes, 0), USER_CLOUD_TARGET_CHUNK_COUNT);
+	return (uint32)FMath::Clamp<int64>(AdaptiveChunkLength, ChunkLength, FMath::Max(ChunkLength, USER_CLOUD_MAX_CHUNK_LENGTH));
+}
+
+int64 FOnlineUserCloudEOS::GetKnownFileSize(const FUniqueNetIdRef& UserId, const FString& FileName) const
+{
+	// Only picks the chunk length, a size that is out of date is fine
+	FUserCloudFileInfoEOS FileInfo;
+	Storage->GetFileInfo(FUniqueNetIdEOS::Cast(*UserId), FileName, FileInfo);
+	if (FileInfo.SizeBytes > 0)
+	{
+		return FileInfo.SizeBytes;
+	}
+
+	if (const TArray<FCloudFileHeader>* const UserFileSets = QueryFileSetsPerUser.Find(UserId))
+	{
+		if (const FCloudFileHeader* const FileHeader = UserFileSets->FindByPredicate([&FileName](const FCloudFileHeader& Header) { return Header.FileName == FileName; }))
+		{
+			return FileHeader->FileSize;
+		}
+	}
+
+	return 0;
+}
+
 bool FOnlineUserCloudEOS::GetFileContents(const FUniqueNetId& UserId, const FString& FileName, TArray<uint8>& FileContents)
 {
 	FUniqueNetIdPtr UniqueNetId = EOSSubsystem->UserManager->GetUniquePlayerId(EOSSubsystem->UserManager->GetLocalUserNumFromUniqueNetId(UserId));
@@ -190,66 +393,22 @@ void FOnlineUserCloudEOS::EnumerateUserFiles(const FUniqueNetId& UserId)
 		return;
 	}
 
-	EOS_PlayerDataStorage_QueryFileListOptions Options = {};
-	Options.ApiVersion = EOS_PLAYERDATASTORAGE_QUERYFILELISTOPTIONS_API_LATEST;
-	Options.LocalUserId = LocalUserId;
-
-	FOnQueryFileListCallback* CallbackObj = new FOnQueryFileListCallback(FOnlineUserCloudEOSWeakPtr(AsShared()));
-	CallbackObj->CallbackLambda = [this](const EOS_PlayerDataStorage_QueryFileListCallbackInfo* Data)
+	Storage->QueryFiles(UserEOSId, [this, WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), UserIdRef = UserId.AsShared()](bool bWasSuccessful, TArray<FCloudFileHeader>&& Files)
 	{
-		bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success || Data->ResultCode == EOS_EResult::EOS_NotFound; // If the user doesn't have any files yet, we will get a NotFound error, but the query was valid
-
-		FUniqueNetIdEOSPtr UniqueNetIdPtr = EOSSubsystem->UserManager->GetLocalUniqueNetIdEOS(Data->LocalUserId);
-		if (UniqueNetIdPtr.IsValid())
+		if (!WeakThis.IsValid())
 		{
-			if (bWasSuccessful)
-			{
-				uint32 FileCount = Data->FileCount;
-				UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::EnumerateUserFiles] Found %d files for user %s"), FileCount, *UniqueNetIdPtr->ToString());
-
-				TArray<FCloudFileHeader>& QueryFileSet = QueryFileSetsPerUser.FindOrAdd(UniqueNetIdPtr.ToSharedRef());
-				QueryFileSet.Empty();
-
-				for (uint32 Index = 0; Index < FileCount; ++Index)
-				{
-					EOS_PlayerDataStorage_CopyFileMetadataAtIndexOptions CopyFileMetadataAtIndexOptions = { };
-					CopyFileMetadataAtIndexOptions.ApiVersion = EOS_PLAYERDATASTORAGE_COPYFILEMETADATAATINDEXOPTIONS_API_LATEST;
-					CopyFileMetadataAtIndexOptions.LocalUserId = Data->LocalUserId;
-					CopyFileMetadataAtIndexOptions.Index = Index;
-
-					EOS_PlayerDataStorage_FileMetadata* FileMetadata = nullptr;
-					EOS_EResult Result = EOS_PlayerDataStorage_CopyFileMetadataAtIndex(EOSSubsystem->PlayerDataStorageHandle, &CopyFileMetadataAtIndexOptions, &FileMetadata);
-					if (Result == EOS_EResult::EOS_Success)
-					{
-						if (FileMetadata && FileMetadata->Filename)
-						{
-							QueryFileSet.Emplace(FCloudFileHeader(ANSI_TO_TCHAR(FileMetadata->Filename), ANSI_TO_TCHAR(FileMetadata->Filename), FileMetadata->FileSizeBytes));
-
-							UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FOnlineUserCloudEOS::EnumerateUserFiles] Cached metadata for file %s with size %d"), ANSI_TO_TCHAR(FileMetadata->Filename), FileMetadata->FileSizeBytes);
-						}
-
-						EOS_PlayerDataStorage_FileMetadata_Release(FileMetadata);
-					}
-					else
-					{
-						UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::EnumerateUserFiles] EOS_PlayerDataStorage_CopyFileMetadataAtIndex was not successful. Finished with error %s on file with index %d"), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)), Index);
-					}
-				}
-			}
-			else
-			{
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::EnumerateUserFiles] EOS_PlayerDataStorage_QueryFileList was not successful. Finished with error %s"), ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
-			}
+			return;
 		}
-		else
+
+		if (bWasSuccessful)
 		{
-			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::EnumerateUserFiles] UniqueNetId not found for EOS_ProductUserId %s"), Data->LocalUserId);
-		}
+			UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::EnumerateUserFiles] Found %d files for user %s"), Files.Num(), *UserIdRef->ToString());
 
-		TriggerOnEnumerateUserFilesCompleteDelegates(bWasSuccessful, *UniqueNetIdPtr);
-	};
+			QueryFileSetsPerUser.FindOrAdd(UserIdRef) = MoveTemp(Files);
+		}
 
-	EOS_PlayerDataStorage_QueryFileList(EOSSubsystem->PlayerDataStorageHandle, &Options, CallbackObj, CallbackObj->GetCallbackPtr());
+		TriggerOnEnumerateUserFilesCompleteDelegates(bWasSuccessful, *UserIdRef);
+	});
 }
 
 void FOnlineUserCloudEOS::GetUserFileList(const FUniqueNetId& UserId, TArray<FCloudFileHeader>& UserFiles)
@@ -303,153 +462,185 @@ bool FOnlineUserCloudEOS::ReadUserFile(const FUniqueNetId& UserId, const FString
 		}
 	}
 
-	// We prepare all the components for the Options object
-
-	FTCHARToUTF8 FileNameUtf8(*FileName);
+	FEOSUserCloudFile UserCloudFile;
+	UserCloudFile.Filename = FileName;
+	UserCloudFile.bInProgress = true;
+	FileSetsPerUser.FindOrAdd(SharedUserId).FindOrAdd(FileName) = MoveTemp(UserCloudFile); // Replace the last file, or create a new entry, same with the user
 
-	int32 ReadChunkSize = UEIKSettings::GetSettings().TitleStorageReadChunkLength;
-	if (ReadChunkSize <= 0)
+	if (!UEIKSettings::GetSettings().bCacheUserCloudFiles)
 	{
-		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] invalid size TitleStorageReadChunkLength %d. ReadChunkSize set to 16KB by default"), ReadChunkSize);
-		ReadChunkSize = 16 * 1024;
+		DownloadUserFile(SharedUserId, FileName, 0);
+		return true;
 	}
 
-	FReadUserFileCompleteCallback* CallbackObj = new FReadUserFileCompleteCallback(FOnlineUserCloudEOSWeakPtr(AsShared()));
+	// The metadata of the last enumeration or transfer is only current if no other device wrote the file since
+	if (UEIKSettings::GetSettings().bTrustEnumeratedUserCloudFiles)
+	{
+		FUserCloudFileInfoEOS FileInfo;
+		if (Storage->GetFileInfo(FUniqueNetIdEOS::Cast(UserId), FileName, FileInfo))
+		{
+			ReadCachedUserFile(SharedUserId, FileName, FileInfo);
+		}
+		else
+		{
+			DownloadUserFile(SharedUserId, FileName, FileInfo.SizeBytes);
+		}
+		return true;
+	}
 
-	CallbackObj->SetNested1CallbackLambda([this, SharedUserId, FileName](const EOS_PlayerDataStorage_ReadFileDataCallbackInfo* Data)
+	Storage->QueryFileInfo(FUniqueNetIdEOS::Cast(UserId), FileName, [WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), SharedUserId, FileName](bool bWasSuccessful, const FUserCloudFileInfoEOS& FileInfo)
 		{
-			UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Reading %d bytes of file %s's data"), Data->DataChunkLengthBytes, *FileName);
+			FOnlineUserCloudEOSPtr StrongThis = WeakThis.Pin();
+			if (!StrongThis.IsValid())
+			{
+				return;
+			}
 
-			FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(SharedUserId);
-			if (UserCloudFileCollection != nullptr)
+			if (bWasSuccessful)
 			{
-				FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection->Find(FileName);
-				if (UserCloudFile != nullptr)
-				{
-					check(UserCloudFile->bInProgress);
+				StrongThis->ReadCachedUserFile(SharedUserId, FileName, FileInfo);
+			}
+			else
+			{
+				StrongThis->DownloadUserFile(SharedUserId, FileName, FileInfo.SizeBytes);
+			}
+		});
 
-					// Is this is the first chunk of data we have received for this file?
-					if (UserCloudFile->ContentSize == 0 && UserCloudFile->ContentIndex == 0)
-					{
-						// Store the actual size of the file being read
-						UserCloudFile->ContentSize = Data->TotalFileSizeBytes;
+	return true;
+}
 
-						// Is the file being read empty?
-						if (UserCloudFile->ContentSize == 0)
-						{
-							// If the file is empty, we return this value as we would do in the case when we have read the last bytes of a file. The OnReadComplete delegate will trigger immediately after.
-							return EOS_PlayerDataStorage_EReadResult::EOS_RR_ContinueReading;
-						}
+void FOnlineUserCloudEOS::ReadCachedUserFile(const FUniqueNetIdRef& SharedUserId, const FString& FileName, const FUserCloudFileInfoEOS& FileInfo)
+{
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), SharedUserId, FileName, FileInfo]()
+		{
+			TArray<uint8> Contents;
+			const bool bWasCached = LoadCachedUserCloudPayload(GetUserCloudCachePath(*SharedUserId, FileInfo.MD5Hash), Contents) && DecodeUserCloudPayload(Contents);
 
-						UserCloudFile->Contents.AddUninitialized(Data->TotalFileSizeBytes);
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, SharedUserId, FileName, FileInfo, bWasCached, Contents = MoveTemp(Contents)]() mutable
+				{
+					FOnlineUserCloudEOSPtr StrongThis = WeakThis.Pin();
+					if (!StrongThis.IsValid())
+					{
+						return;
 					}
 
-					if (UserCloudFile->ContentIndex + Data->DataChunkLengthBytes <= UserCloudFile->ContentSize)
+					if (bWasCached)
 					{
-						check(Data->DataChunkLengthBytes > 0);
-						FMemory::Memcpy(UserCloudFile->Contents.GetData() + UserCloudFile->ContentIndex, Data->DataChunk, Data->DataChunkLengthBytes);
-						UserCloudFile->ContentIndex += Data->DataChunkLengthBytes;
-						return EOS_PlayerDataStorage_EReadResult::EOS_RR_ContinueReading;
+						UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::ReadUserFile] File %s is unchanged, loaded it from the cache"), *FileName);
+						StrongThis->FinishReadUserFile(SharedUserId, FileName, true, MoveTemp(Contents));
 					}
 					else
 					{
-						UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Read size exceeded specified file size for file %s"), *FileName);
-						return EOS_PlayerDataStorage_EReadResult::EOS_RR_FailRequest;
+						StrongThis->DownloadUserFile(SharedUserId, FileName, FileInfo.SizeBytes);
 					}
-				}
-				else
-				{
-					UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Unknown file %s. Cancelling transfer request"), *FileName);
-				}
-			}
-			else
-			{
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Unknown user %s. Cancelling transfer request for file %s"), *SharedUserId->ToString(), *FileName);
-			}
-
-			return EOS_PlayerDataStorage_EReadResult::EOS_RR_CancelRequest;
+				});
 		});
+}
 
-	CallbackObj->SetNested2CallbackLambda([this, SharedUserId, FileName](const _tagEOS_PlayerDataStorage_FileTransferProgressCallbackInfo* Data)
-		{
-			UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FOnlineUserCloudEOS::ReadUserFile] File transfer progress for file %s is %d bytes"), *FileName, Data->BytesTransferred);
-			//TriggerOnReadUserFileProgressDelegates(Data->BytesTransferred, *SharedUserId, FileName); It doesn't exist, maybe we should add it
-		});
+void FOnlineUserCloudEOS::DownloadUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, int64 FileSizeBytes)
+{
+	const FUniqueNetIdEOS& UserEOSId = FUniqueNetIdEOS::Cast(*UserId);
 
-	CallbackObj->CallbackLambda = [this, SharedUserId, FileName](const EOS_PlayerDataStorage_ReadFileCallbackInfo* Data)
+	if (FileSizeBytes <= 0)
 	{
-		bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success;
+		FileSizeBytes = GetKnownFileSize(UserId, FileName);
+	}
 
-		FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(SharedUserId);
-		if (UserCloudFileCollection != nullptr)
+	const bool bWasStarted = Storage->ReadFile(UserEOSId, FileName, GetChunkLength(FileSizeBytes), [this, WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), UserId, FileName](bool bWasSuccessful, TArray<uint8>&& Payload)
 		{
-			FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection->Find(FileName);
-			if (UserCloudFile != nullptr)
+			if (!WeakThis.IsValid())
 			{
-				if (UserCloudFile->FileTransferRequest != nullptr)
-				{
-					EOS_PlayerDataStorageFileTransferRequest_Release(UserCloudFile->FileTransferRequest);
-					UserCloudFile->FileTransferRequest = nullptr;
-				}
-
-				if (bWasSuccessful)
-				{
-					UserCloudFile->bIsLoaded = true;
-					UserCloudFile->bInProgress = false;
-					UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Read file %s with size %d"), *UserCloudFile->Filename, UserCloudFile->ContentSize);
-				}
-				else
-				{
-					// If we fail to complete reading the file, discard it from the known files
-					FileSetsPerUser.Find(SharedUserId)->Remove(FileName);
-
-					UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] EOS_PlayerDataStorage_ReadFile was not successful for file %s. Finished with error %s"), *FileName, ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
-				}
+				return;
 			}
-			else
+
+			if (!bWasSuccessful)
 			{
-				bWasSuccessful = false;
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Unknown transfer request for file %s"), *FileName);
+				FinishReadUserFile(UserId, FileName, false, TArray<uint8>());
+				return;
 			}
-		}
-		else
-		{
-			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Unknown user %s for file %s's transfer request"), *SharedUserId->ToString(), *FileName);
-		}
 
-		TriggerOnReadUserFileCompleteDelegates(bWasSuccessful, *SharedUserId, FileName);
-	};
+			// The download updated the storage's metadata of the file, so it is cached as its current version
+			FString CachePath;
+			FUserCloudFileInfoEOS FileInfo;
+			if (UEIKSettings::GetSettings().bCacheUserCloudFiles && Storage->GetFileInfo(FUniqueNetIdEOS::Cast(*UserId), FileName, FileInfo))
+			{
+				CachePath = GetUserCloudCachePath(*UserId, FileInfo.MD5Hash);
+			}
 
-	const FUniqueNetIdEOS& UserEOSId = FUniqueNetIdEOS::Cast(UserId);
+			// Decompressing and hashing files of several MB would hitch the game thread
+			Async(EAsyncExecution::ThreadPool, [WeakThis, UserId, FileName, CachePath, Payload = MoveTemp(Payload)]() mutable
+				{
+					if (!CachePath.IsEmpty())
+					{
+						SaveCachedUserCloudPayload(CachePath, Payload);
+					}
 
-	EOS_PlayerDataStorage_ReadFileOptions ReadFileOptions = {};
-	ReadFileOptions.ApiVersion = EOS_PLAYERDATASTORAGE_READFILEOPTIONS_API_LATEST;
-	ReadFileOptions.LocalUserId = UserEOSId.GetProductUserId();
-	ReadFileOptions.Filename = FileNameUtf8.Get();
-	ReadFileOptions.ReadChunkLengthBytes = (uint32_t)ReadChunkSize;
-	ReadFileOptions.ReadFileDataCallback = CallbackObj->GetNested1CallbackPtr();
-	ReadFileOptions.FileTransferProgressCallback = CallbackObj->GetNested2CallbackPtr();
+					const bool bWasDecoded = DecodeUserCloudPayload(Payload);
+					if (!bWasDecoded && !CachePath.IsEmpty())
+					{
+						IFileManager::Get().Delete(*CachePath, false, false, true);
+					}
 
-	EOS_HPlayerDataStorageFileTransferRequest FileTransferRequest = EOS_PlayerDataStorage_ReadFile(EOSSubsystem->PlayerDataStorageHandle, &ReadFileOptions, CallbackObj, CallbackObj->GetCallbackPtr());
+					AsyncTask(ENamedThreads::GameThread, [WeakThis, UserId, FileName, bWasDecoded, Contents = MoveTemp(Payload)]() mutable
+						{
+							FOnlineUserCloudEOSPtr StrongThis = WeakThis.Pin();
+							if (StrongThis.IsValid())
+							{
+								StrongThis->FinishReadUserFile(UserId, FileName, bWasDecoded, MoveTemp(Contents));
+							}
+						});
+				});
+		});
 
-	if (FileTransferRequest != nullptr)
+	if (bWasStarted)
 	{
-		FEOSUserCloudFile UserCloudFile;
-		UserCloudFile.Filename = FileName;
-		UserCloudFile.FileTransferRequest = FileTransferRequest;
-		UserCloudFile.bInProgress = true;
-		FileSetsPerUser.FindOrAdd(SharedUserId).FindOrAdd(FileName) = MoveTemp(UserCloudFile); // Replace the last file, or create a new entry, same with the user
+		FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(UserId);
+		FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection != nullptr ? UserCloudFileCollection->Find(FileName) : nullptr;
+		if (UserCloudFile != nullptr)
+		{
+			UserCloudFile->bIsTransferring = true;
+		}
 	}
 	else
 	{
-		EOSSubsystem->ExecuteNextTick([this, UserIdRef = UserId.AsShared(), FileName]()
+		EOSSubsystem->ExecuteNextTick([this, UserId, FileName]()
 			{
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Failed to create a transfer request for user's %s file with name %s"), *UserIdRef->ToString(), *FileName);
-				TriggerOnReadUserFileCompleteDelegates(false, *UserIdRef, FileName);
+				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Failed to create a transfer request for user's %s file with name %s"), *UserId->ToString(), *FileName);
+				FinishReadUserFile(UserId, FileName, false, TArray<uint8>());
 			});
 	}
+}
 
-	return true;
+void FOnlineUserCloudEOS::FinishReadUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, bool bWasSuccessful, TArray<uint8>&& Contents)
+{
+	FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(UserId);
+	FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection != nullptr ? UserCloudFileCollection->Find(FileName) : nullptr;
+	if (UserCloudFile != nullptr)
+	{
+		if (bWasSuccessful)
+		{
+			UserCloudFile->Contents = MoveTemp(Contents);
+			UserCloudFile->ContentSize = UserCloudFile->Contents.Num();
+			UserCloudFile->bIsLoaded = true;
+			UserCloudFile->bInProgress = false;
+			UserCloudFile->bIsTransferring = false;
+			UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Read file %s with size %d"), *UserCloudFile->Filename, UserCloudFile->ContentSize);
+		}
+		else
+		{
+			// If we fail to complete reading the file, discard it from the known files
+			UserCloudFileCollection->Remove(FileName);
+
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Reading file %s was not successful"), *FileName);
+		}
+	}
+	else
+	{
+		bWasSuccessful = false;
+		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::ReadUserFile] Unknown transfer request for file %s"), *FileName);
+	}
+
+	TriggerOnReadUserFileCompleteDelegates(bWasSuccessful, *UserId, FileName);
 }
 
 bool FOnlineUserCloudEOS::WriteUserFile(const FUniqueNetId& UserId, const FString& FileName, TArray<uint8>& FileContents, bool bCompressBeforeUpload)
@@ -485,151 +676,144 @@ bool FOnlineUserCloudEOS::WriteUserFile(const FUniqueNetId& UserId, const FStrin
 		}
 	}
 
-	// We prepare all the components for the Options object
+	FEOSUserCloudFile UserCloudFile;
+	UserCloudFile.Filename = FileName;
+	UserCloudFile.bInProgress = true;
+	UserCloudFile.ContentSize = FileContents.Num();
+	UserCloudFile.Contents = FileContents;
+	FileSetsPerUser.FindOrAdd(SharedUserId).FindOrAdd(FileName) = MoveTemp(UserCloudFile); // Replace the last title file, or create a new entry, same with the user
 
-	FTCHARToUTF8 FileNameUtf8(*FileName);
-
-	// We'll use the same buffer size to write as we use to read
-	int32 ReadChunkSize = UEIKSettings::GetSettings().TitleStorageReadChunkLength;
-	if (ReadChunkSize <= 0)
+	if (!bCompressBeforeUpload)
 	{
-		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] invalid size TitleStorageReadChunkLength %d"), ReadChunkSize);
-		ReadChunkSize = 16 * 1024;
+		UploadUserFile(SharedUserId, FileName, TArray<uint8>(FileContents));
+		return true;
 	}
 
-	FWriteUserFileCompleteCallback* CallbackObj = new FWriteUserFileCompleteCallback(FOnlineUserCloudEOSWeakPtr(AsShared()));
-
-	CallbackObj->SetNested1CallbackLambda([this, SharedUserId, FileName](const EOS_PlayerDataStorage_WriteFileDataCallbackInfo* Data, void* OutDataBuffer, uint32_t* OutDataWritten)
-	{
-		UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Writing file data for %s"), *FileName);
-
-		FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(SharedUserId);
-		if (UserCloudFileCollection != nullptr)
+	// The upload starts once the contents are compressed on the thread pool
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), SharedUserId, FileName, Contents = FileContents]() mutable
 		{
-			FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection->Find(FileName);
-			if (UserCloudFile != nullptr)
+			TArray<uint8> Payload;
+			if (EncodeUserCloudPayload(Contents, Payload))
 			{
-				check(UserCloudFile->bInProgress);
-
-				size_t BytesToWrite = FMath::Min(Data->DataBufferLengthBytes, (uint32_t)(UserCloudFile->ContentSize - UserCloudFile->ContentIndex));
-
-				if (BytesToWrite == 0)
-				{
-					return EOS_PlayerDataStorage_EWriteResult::EOS_WR_CompleteRequest;
-				}
-				if (UserCloudFile->ContentIndex + BytesToWrite <= UserCloudFile->ContentSize)
-				{
-					check(BytesToWrite > 0);
-					FMemory::Memcpy(OutDataBuffer, static_cast<const void*>(&UserCloudFile->Contents[UserCloudFile->ContentIndex]), BytesToWrite);
-					*OutDataWritten = static_cast<uint32_t>(BytesToWrite);
-
-					UserCloudFile->ContentIndex += (size_t)*OutDataWritten;
-
-					UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Wrote %d bytes for file %s"), BytesToWrite, *FileName);
-
-					return EOS_PlayerDataStorage_EWriteResult::EOS_WR_ContinueWriting;
-				}
-				else
-				{
-					UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Read size exceeded specified file size for file %s"), *FileName);
-					return EOS_PlayerDataStorage_EWriteResult::EOS_WR_FailRequest;
-				}
+				UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Compressed file %s from %d to %d bytes"), *FileName, Contents.Num(), Payload.Num());
 			}
 			else
 			{
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Unknown file %s. Cancelling transfer request"), *FileName);
+				Payload = MoveTemp(Contents);
 			}
-		}
-		else
-		{
-			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Unknown user %s. Cancelling transfer request for file %s"), *SharedUserId->ToString(), *FileName);
-		}
 
-		return EOS_PlayerDataStorage_EWriteResult::EOS_WR_CancelRequest;
-	});
-
-	CallbackObj->SetNested2CallbackLambda([this, SharedUserId, FileName](const EOS_PlayerDataStorage_FileTransferProgressCallbackInfo* Data)
-		{
-			UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FOnlineUserCloudEOS::WriteUserFile] File transfer progress for file %s is %d bytes"), *FileName, Data->BytesTransferred);
-			TriggerOnWriteUserFileProgressDelegates(Data->BytesTransferred, *SharedUserId, FileName);
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, SharedUserId, FileName, Payload = MoveTemp(Payload)]() mutable
+				{
+					FOnlineUserCloudEOSPtr StrongThis = WeakThis.Pin();
+					if (StrongThis.IsValid())
+					{
+						StrongThis->UploadUserFile(SharedUserId, FileName, MoveTemp(Payload));
+					}
+				});
 		});
 
-	CallbackObj->CallbackLambda = [this, SharedUserId, FileName](const EOS_PlayerDataStorage_WriteFileCallbackInfo* Data)
+	return true;
+}
+
+void FOnlineUserCloudEOS::UploadUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, TArray<uint8>&& Payload)
+{
+	FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(UserId);
+	FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection != nullptr ? UserCloudFileCollection->Find(FileName) : nullptr;
+	if (UserCloudFile == nullptr || UserCloudFile->bCancelRequested)
 	{
-		bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success;
+		UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Write of file %s was canceled before its upload started"), *FileName);
+		FinishWriteUserFile(UserId, FileName, false);
+		return;
+	}
 
-		FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(SharedUserId);
-		if (UserCloudFileCollection != nullptr)
-		{
-			FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection->Find(FileName);
-			if (UserCloudFile != nullptr)
-			{
-				if (UserCloudFile->FileTransferRequest != nullptr)
-				{
-					EOS_PlayerDataStorageFileTransferRequest_Release(UserCloudFile->FileTransferRequest);
-					UserCloudFile->FileTransferRequest = nullptr;
-				}
+	const FUniqueNetIdEOS& UserEOSId = FUniqueNetIdEOS::Cast(*UserId);
 
-				if (bWasSuccessful)
-				{
-					UserCloudFile->bIsLoaded = true;
-					UserCloudFile->bInProgress = false;
-					UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Wrote file %s with size %d"), *UserCloudFile->Filename, UserCloudFile->ContentSize);
-				}
-				else
-				{
-					// If we fail to complete writing the file, discard it from the known files
-					FileSetsPerUser.Find(SharedUserId)->Remove(FileName);
+	// The uploaded payload is kept to cache it, it replaces the cached copy of the previous version of the file
+	const bool bCacheUserCloudFiles = UEIKSettings::GetSettings().bCacheUserCloudFiles;
+	FUserCloudFileInfoEOS PreviousFileInfo;
+	Storage->GetFileInfo(UserEOSId, FileName, PreviousFileInfo);
+	TArray<uint8> CachedPayload;
+	if (bCacheUserCloudFiles)
+	{
+		CachedPayload = Payload;
+	}
 
-					UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] EOS_PlayerDataStorage_WriteFile was not successful. Finished with error %s"), ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
-				}
-			}
-			else
+	const uint32 ChunkLength = GetChunkLength(Payload.Num());
+	const bool bWasStarted = Storage->WriteFile(UserEOSId, FileName, ChunkLength, MoveTemp(Payload),
+		[this, WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), UserId, FileName](int32 BytesTransferred)
+		{
+			if (WeakThis.IsValid())
 			{
-				bWasSuccessful = false;
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Unknown transfer request for file %s"), *FileName);
+				TriggerOnWriteUserFileProgressDelegates(BytesTransferred, *UserId, FileName);
 			}
-		}
-		else
+		},
+		[this, WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), UserId, FileName, PreviousMD5Hash = PreviousFileInfo.MD5Hash, CachedPayload = MoveTemp(CachedPayload)](bool bWasSuccessful) mutable
 		{
-			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Unknown user %s for file %s's transfer request"), *SharedUserId->ToString(), *FileName);
-		}
-
-		TriggerOnWriteUserFileCompleteDelegates(bWasSuccessful, *SharedUserId, FileName);
-	};
-
-	const FUniqueNetIdEOS& UserEOSId = FUniqueNetIdEOS::Cast(UserId);
+			if (!WeakThis.IsValid())
+			{
+				return;
+			}
 
-	EOS_PlayerDataStorage_WriteFileOptions WriteFileOptions = {};
-	WriteFileOptions.ApiVersion = EOS_PLAYERDATASTORAGE_WRITEFILEOPTIONS_API_LATEST;
-	WriteFileOptions.LocalUserId = UserEOSId.GetProductUserId();
-	WriteFileOptions.Filename = FileNameUtf8.Get();
-	WriteFileOptions.ChunkLengthBytes = (uint32_t)ReadChunkSize;
-	WriteFileOptions.WriteFileDataCallback = CallbackObj->GetNested1CallbackPtr();
-	WriteFileOptions.FileTransferProgressCallback = CallbackObj->GetNested2CallbackPtr();
+			FUserCloudFileInfoEOS FileInfo;
+			if (bWasSuccessful && CachedPayload.Num() > 0 && Storage->GetFileInfo(FUniqueNetIdEOS::Cast(*UserId), FileName, FileInfo) && FileInfo.MD5Hash != PreviousMD5Hash)
+			{
+				FString CachePath = GetUserCloudCachePath(*UserId, FileInfo.MD5Hash);
+				FString PreviousCachePath = PreviousMD5Hash.IsEmpty() ? FString() : GetUserCloudCachePath(*UserId, PreviousMD5Hash);
+				Async(EAsyncExecution::ThreadPool, [CachePath = MoveTemp(CachePath), PreviousCachePath = MoveTemp(PreviousCachePath), Payload = MoveTemp(CachedPayload)]()
+					{
+						SaveCachedUserCloudPayload(CachePath, Payload);
+						if (!PreviousCachePath.IsEmpty())
+						{
+							IFileManager::Get().Delete(*PreviousCachePath, false, false, true);
+						}
+					});
+			}
 
-	EOS_HPlayerDataStorageFileTransferRequest FileTransferRequest = EOS_PlayerDataStorage_WriteFile(EOSSubsystem->PlayerDataStorageHandle, &WriteFileOptions, CallbackObj, CallbackObj->GetCallbackPtr());
+			FinishWriteUserFile(UserId, FileName, bWasSuccessful);
+		});
 
-	if (FileTransferRequest != nullptr)
+	if (bWasStarted)
 	{
-		FEOSUserCloudFile UserCloudFile;
-		UserCloudFile.Filename = FileName;
-		UserCloudFile.FileTransferRequest = FileTransferRequest;
-		UserCloudFile.bInProgress = true;
-		UserCloudFile.ContentSize = FileContents.Num();
-		UserCloudFile.Contents = FileContents;
-		FileSetsPerUser.FindOrAdd(SharedUserId).FindOrAdd(FileName) = MoveTemp(UserCloudFile); // Replace the last title file, or create a new entry, same with the user
+		UserCloudFile->bIsTransferring = true;
 	}
 	else
 	{
-		EOSSubsystem->ExecuteNextTick([this, UserIdRef = UserId.AsShared(), FileName]()
+		EOSSubsystem->ExecuteNextTick([this, UserId, FileName]()
 			{
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Failed to create a transfer request for user's %s file with name %s"), *UserIdRef->ToString(), *FileName);
-				TriggerOnWriteUserFileCompleteDelegates(false, *UserIdRef, FileName);
-			});		
+				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Failed to create a transfer request for user's %s file with name %s"), *UserId->ToString(), *FileName);
+				FinishWriteUserFile(UserId, FileName, false);
+			});
 	}
+}
 
-	return true;
+void FOnlineUserCloudEOS::FinishWriteUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, bool bWasSuccessful)
+{
+	FUserCloudFileCollection* UserCloudFileCollection = FileSetsPerUser.Find(UserId);
+	FEOSUserCloudFile* UserCloudFile = UserCloudFileCollection != nullptr ? UserCloudFileCollection->Find(FileName) : nullptr;
+	if (UserCloudFile != nullptr)
+	{
+		if (bWasSuccessful)
+		{
+			UserCloudFile->bIsLoaded = true;
+			UserCloudFile->bInProgress = false;
+			UserCloudFile->bIsTransferring = false;
+			UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Wrote file %s with size %d"), *UserCloudFile->Filename, UserCloudFile->ContentSize);
+		}
+		else
+		{
+			// If we fail to complete writing the file, discard it from the known files
+			UserCloudFileCollection->Remove(FileName);
+
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Writing file %s was not successful"), *FileName);
+		}
+	}
+	else
+	{
+		bWasSuccessful = false;
+		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::WriteUserFile] Unknown transfer request for file %s"), *FileName);
+	}
+
+	TriggerOnWriteUserFileCompleteDelegates(bWasSuccessful, *UserId, FileName);
 }
 
 void FOnlineUserCloudEOS::CancelWriteUserFile(const FUniqueNetId& UserId, const FString& FileName)
@@ -656,16 +840,24 @@ void FOnlineUserCloudEOS::CancelWriteUserFile(const FUniqueNetId& UserId, const
 		{
 			if (UserCloudFile->bInProgress)
 			{
-				EOS_EResult Result = EOS_PlayerDataStorageFileTransferRequest_CancelRequest(UserCloudFile->FileTransferRequest);
-				bWasSuccessful = Result == EOS_EResult::EOS_Success;
+				if (UserCloudFile->bIsTransferring)
+				{
+					bWasSuccessful = Storage->CancelTransfer(FUniqueNetIdEOS::Cast(UserId), FileName);
+				}
+				else
+				{
+					// The contents are still being compressed, the upload won't be started
+					UserCloudFile->bCancelRequested = true;
+					bWasSuccessful = true;
+				}
+
 				if (bWasSuccessful)
 				{
-					UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::CancelWriteUserFile] EOS_PlayerDataStorageFileTransferRequest_CancelRequest was successful. Cancelled write operation of file %s for user %s."), *FileName, *UserId.ToString());
+					UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::CancelWriteUserFile] Cancelled write operation of file %s for user %s."), *FileName, *UserId.ToString());
 				}
 				else
 				{
-					// Result code will be EOS_NoChange if request had already completed (can't be canceled), and EOS_AlreadyPending if it's already been canceled before (this is a final state for a canceled request and won't change over time)
-					UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::CancelWriteUserFile] EOS_PlayerDataStorageFileTransferRequest_CancelRequest was not successful. Finished with error %s"), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+					UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::CancelWriteUserFile] Unable to cancel write operation of file %s for user %s."), *FileName, *UserId.ToString());
 				}
 			}
 			else
@@ -750,33 +942,35 @@ bool FOnlineUserCloudEOS::DeleteUserFile(const FUniqueNetId& UserId, const FStri
 	// Cloud deletion
 	if (bShouldCloudDelete)
 	{
-		FTCHARToUTF8 FileNameUtf8(*FileName);
-
 		const FUniqueNetIdEOS& UserEOSId = FUniqueNetIdEOS::Cast(UserId);
 
-		EOS_PlayerDataStorage_DeleteFileOptions Options = {};
-		Options.ApiVersion = EOS_PLAYERDATASTORAGE_DELETEFILEOPTIONS_API_LATEST;
-		Options.LocalUserId = UserEOSId.GetProductUserId();
-		Options.Filename = FileNameUtf8.Get();
+		// The cached copy of the deleted version is removed with it
+		FString CachePath;
+		FUserCloudFileInfoEOS FileInfo;
+		if (Storage->GetFileInfo(UserEOSId, FileName, FileInfo))
+		{
+			CachePath = GetUserCloudCachePath(UserId, FileInfo.MD5Hash);
+		}
 
-		FOnDeleteFileCallback* CallbackObj = new FOnDeleteFileCallback(FOnlineUserCloudEOSWeakPtr(AsShared()));
-		CallbackObj->CallbackLambda = [this, UserIdRef = UserId.AsShared(), FileName](const EOS_PlayerDataStorage_DeleteFileCallbackInfo* Data)
+		Storage->DeleteFile(UserEOSId, FileName, [this, WeakThis = FOnlineUserCloudEOSWeakPtr(AsShared()), UserIdRef = UserId.AsShared(), FileName, CachePath](bool bWasSuccessful)
 		{
-			bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success;
-			if (bWasSuccessful)
+			if (!WeakThis.IsValid())
 			{
-				UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::DeleteUserFile] EOS_PlayerDataStorage_DeleteFile was successful."));
+				return;
 			}
-			else
+
+			if (bWasSuccessful)
 			{
-				// File deletion operations can fail if the user does not own the file
-				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FOnlineUserCloudEOS::DeleteUserFile] EOS_PlayerDataStorage_DeleteFile was not successful for file %s. Finished with error %s"), *FileName, ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
+				UE_LOG_ONLINE_CLOUD(Verbose, TEXT("[FOnlineUserCloudEOS::DeleteUserFile] Deleting file %s was successful."), *FileName);
+
+				if (!CachePath.IsEmpty())
+				{
+					IFileManager::Get().Delete(*CachePath, false, false, true);
+				}
 			}
 
 			TriggerOnDeleteUserFileCompleteDelegates(bWasSuccessful, *UserIdRef, FileName);
-		};
-
-		EOS_PlayerDataStorage_DeleteFile(EOSSubsystem->PlayerDataStorageHandle, &Options, CallbackObj, CallbackObj->GetCallbackPtr());
+		});
 	}
 
 	return true;
@@ -873,10 +1067,11 @@ bool FOnlineUserCloudEOS::HandleUserCloudExec(UWorld* InWorld, const TCHAR* Cmd,
 		int UserIndex = FCString::Atoi(*FParse::Token(Cmd, false));
 		FString FileName = FParse::Token(Cmd, false);
 		int32 FileSize = FCString::Atoi(*FParse::Token(Cmd, false));
+		bool bCompressBeforeUpload = (bool)FCString::Atoi(*FParse::Token(Cmd, false));
 		TArray<uint8> FileContents;
 		WriteRandomFile(FileContents, FileSize);
 
-		WriteUserFile(*EOSSubsystem->UserManager->GetLocalUniqueNetIdEOS(UserIndex), FileName, FileContents);
+		WriteUserFile(*EOSSubsystem->UserManager->GetLocalUniqueNetIdEOS(UserIndex), FileName, FileContents, bCompressBeforeUpload);
 
 		bWasHandled = true;
 	}
@@ -6,23 +6,25 @@
 #include "Online/CoreOnline.h"
 #include "Interfaces/OnlineUserCloudInterface.h"
 #include "OnlineSubsystemEOSTypes.h"
+#include "UserCloudStorageEOS.h"
 
 class FOnlineSubsystemEOS;
 
 #if WITH_EOS_SDK
-	#include "eos_playerdatastorage_types.h"
 
 struct FEOSUserCloudFile
 {
 	TArray<uint8> Contents;
 	size_t ContentSize;
-	size_t ContentIndex;
 	bool bIsLoaded;
 	bool bInProgress;
+	/** The storage transfer was started, before that the contents are being compressed or looked up in the cache */
+	bool bIsTransferring;
+	/** The write was canceled before its upload started */
+	bool bCancelRequested;
 	FString Filename;
-	EOS_HPlayerDataStorageFileTransferRequest FileTransferRequest;
 
-	FEOSUserCloudFile() : ContentSize(0), ContentIndex(0), bIsLoaded(false), bInProgress(false)
+	FEOSUserCloudFile() : ContentSize(0), bIsLoaded(false), bInProgress(false), bIsTransferring(false), bCancelRequested(false)
 	{
 	}
 
@@ -53,17 +55,33 @@ public:
 	virtual void DumpCloudFileState(const FUniqueNetId& UserId, const FString& FileName) override;
 //~ IOnlineUserCloud
 
-	FOnlineUserCloudEOS(FOnlineSubsystemEOS* InSubsystem)
-		: EOSSubsystem(InSubsystem)
-	{
-	}
+	FOnlineUserCloudEOS(FOnlineSubsystemEOS* InSubsystem);
 
 	bool HandleUserCloudExec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar);
 
+	/** Replaces the storage the files are transferred with, e.g. by a FUserCloudStorageEOSLocal. No file should be in progress. */
+	void SetStorage(const FUserCloudStorageEOSPtr& InStorage);
+	const FUserCloudStorageEOSPtr& GetStorage() const { return Storage; }
+
 protected:
 	FOnlineSubsystemEOS* EOSSubsystem;
 
 private:
+	/** Larger files are transferred in larger chunks, starting from TitleStorageReadChunkLength */
+	uint32 GetChunkLength(int64 FileSizeBytes) const;
+	/** Size of the file seen by the last enumeration or transfer, 0 if it was never seen */
+	int64 GetKnownFileSize(const FUniqueNetIdRef& UserId, const FString& FileName) const;
+
+	/** Loads the file from the cache if its contents for the MD5 of FileInfo are there, otherwise downloads it */
+	void ReadCachedUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, const FUserCloudFileInfoEOS& FileInfo);
+	void DownloadUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, int64 FileSizeBytes);
+	void FinishReadUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, bool bWasSuccessful, TArray<uint8>&& Contents);
+	void UploadUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, TArray<uint8>&& Payload);
+	void FinishWriteUserFile(const FUniqueNetIdRef& UserId, const FString& FileName, bool bWasSuccessful);
+
+	/** The player data storage, or a stand-in for it */
+	FUserCloudStorageEOSPtr Storage;
+
 	/** Results of the last file enumeration per user */
 	TUniqueNetIdMap<TArray<FCloudFileHeader>> QueryFileSetsPerUser;
 
@@ -0,0 +1,503 @@
+//Copyright (c) 2023 Betide Studio. All Rights Reserved.
+
+#include "UserCloudStorageEOS.h"
+#include "OnlineSubsystemEOSPrivate.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+#if WITH_EOS_SDK
+#include "eos_playerdatastorage.h"
+
+typedef TEOSCallback<EOS_PlayerDataStorage_OnQueryFileListCompleteCallback, EOS_PlayerDataStorage_QueryFileListCallbackInfo, IUserCloudStorageEOS> FOnQueryFileListCallback;
+typedef TEOSCallback<EOS_PlayerDataStorage_OnQueryFileCompleteCallback, EOS_PlayerDataStorage_QueryFileCallbackInfo, IUserCloudStorageEOS> FOnQueryFileCallback;
+
+typedef TEOSCallbackWithNested2ForNested1Param3<EOS_PlayerDataStorage_OnWriteFileCompleteCallback, EOS_PlayerDataStorage_WriteFileCallbackInfo, IUserCloudStorageEOS,
+	EOS_PlayerDataStorage_OnWriteFileDataCallback, EOS_PlayerDataStorage_WriteFileDataCallbackInfo, EOS_PlayerDataStorage_EWriteResult,
+	EOS_PlayerDataStorage_OnFileTransferProgressCallback, EOS_PlayerDataStorage_FileTransferProgressCallbackInfo
+> FWriteFileCompleteCallback;
+
+typedef TEOSCallbackWithNested2<EOS_PlayerDataStorage_OnReadFileCompleteCallback, EOS_PlayerDataStorage_ReadFileCallbackInfo, IUserCloudStorageEOS,
+	EOS_PlayerDataStorage_OnReadFileDataCallback, EOS_PlayerDataStorage_ReadFileDataCallbackInfo, EOS_PlayerDataStorage_EReadResult,
+	EOS_PlayerDataStorage_OnFileTransferProgressCallback, EOS_PlayerDataStorage_FileTransferProgressCallbackInfo
+> FReadFileCompleteCallback;
+
+typedef TEOSCallback<EOS_PlayerDataStorage_OnDeleteFileCompleteCallback, EOS_PlayerDataStorage_DeleteFileCallbackInfo, IUserCloudStorageEOS> FOnDeleteFileCallback;
+
+FUserCloudStorageEOSSDK::FUserCloudStorageEOSSDK(EOS_HPlayerDataStorage InPlayerDataStorageHandle)
+	: PlayerDataStorageHandle(InPlayerDataStorageHandle)
+{
+}
+
+void FUserCloudStorageEOSSDK::QueryFiles(const FUniqueNetIdEOS& UserId, FOnUserCloudQueryFilesComplete&& OnComplete)
+{
+	EOS_PlayerDataStorage_QueryFileListOptions Options = {};
+	Options.ApiVersion = EOS_PLAYERDATASTORAGE_QUERYFILELISTOPTIONS_API_LATEST;
+	Options.LocalUserId = UserId.GetProductUserId();
+
+	FOnQueryFileListCallback* CallbackObj = new FOnQueryFileListCallback(FUserCloudStorageEOSWeakPtr(AsShared()));
+	CallbackObj->CallbackLambda = [this, OnComplete = MoveTemp(OnComplete)](const EOS_PlayerDataStorage_QueryFileListCallbackInfo* Data)
+	{
+		bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success || Data->ResultCode == EOS_EResult::EOS_NotFound; // If the user doesn't have any files yet, we will get a NotFound error, but the query was valid
+
+		TArray<FCloudFileHeader> Files;
+		if (bWasSuccessful)
+		{
+			for (uint32 Index = 0; Index < Data->FileCount; ++Index)
+			{
+				EOS_PlayerDataStorage_CopyFileMetadataAtIndexOptions CopyFileMetadataAtIndexOptions = { };
+				CopyFileMetadataAtIndexOptions.ApiVersion = EOS_PLAYERDATASTORAGE_COPYFILEMETADATAATINDEXOPTIONS_API_LATEST;
+				CopyFileMetadataAtIndexOptions.LocalUserId = Data->LocalUserId;
+				CopyFileMetadataAtIndexOptions.Index = Index;
+
+				EOS_PlayerDataStorage_FileMetadata* FileMetadata = nullptr;
+				EOS_EResult Result = EOS_PlayerDataStorage_CopyFileMetadataAtIndex(PlayerDataStorageHandle, &CopyFileMetadataAtIndexOptions, &FileMetadata);
+				if (Result == EOS_EResult::EOS_Success)
+				{
+					if (FileMetadata && FileMetadata->Filename)
+					{
+						Files.Emplace(FCloudFileHeader(ANSI_TO_TCHAR(FileMetadata->Filename), ANSI_TO_TCHAR(FileMetadata->Filename), FileMetadata->FileSizeBytes));
+
+						UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FUserCloudStorageEOSSDK::QueryFiles] Cached metadata for file %s with size %d"), ANSI_TO_TCHAR(FileMetadata->Filename), FileMetadata->FileSizeBytes);
+					}
+
+					EOS_PlayerDataStorage_FileMetadata_Release(FileMetadata);
+				}
+				else
+				{
+					UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::QueryFiles] EOS_PlayerDataStorage_CopyFileMetadataAtIndex was not successful. Finished with error %s on file with index %d"), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)), Index);
+				}
+			}
+		}
+		else
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::QueryFiles] EOS_PlayerDataStorage_QueryFileList was not successful. Finished with error %s"), ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
+		}
+
+		OnComplete(bWasSuccessful, MoveTemp(Files));
+	};
+
+	EOS_PlayerDataStorage_QueryFileList(PlayerDataStorageHandle, &Options, CallbackObj, CallbackObj->GetCallbackPtr());
+}
+
+bool FUserCloudStorageEOSSDK::GetFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FUserCloudFileInfoEOS& OutInfo)
+{
+	FTCHARToUTF8 FileNameUtf8(*FileName);
+
+	EOS_PlayerDataStorage_CopyFileMetadataByFilenameOptions Options = {};
+	Options.ApiVersion = EOS_PLAYERDATASTORAGE_COPYFILEMETADATABYFILENAMEOPTIONS_API_LATEST;
+	Options.LocalUserId = UserId.GetProductUserId();
+	Options.Filename = FileNameUtf8.Get();
+
+	// The SDK only has the metadata of the files seen by a query or a transfer
+	EOS_PlayerDataStorage_FileMetadata* FileMetadata = nullptr;
+	EOS_EResult Result = EOS_PlayerDataStorage_CopyFileMetadataByFilename(PlayerDataStorageHandle, &Options, &FileMetadata);
+	if (Result != EOS_EResult::EOS_Success || FileMetadata == nullptr)
+	{
+		return false;
+	}
+
+	OutInfo.SizeBytes = FileMetadata->UnencryptedDataSizeBytes > 0 ? FileMetadata->UnencryptedDataSizeBytes : FileMetadata->FileSizeBytes;
+	OutInfo.MD5Hash = FileMetadata->MD5Hash != nullptr ? FString(ANSI_TO_TCHAR(FileMetadata->MD5Hash)) : FString();
+	EOS_PlayerDataStorage_FileMetadata_Release(FileMetadata);
+
+	return !OutInfo.MD5Hash.IsEmpty();
+}
+
+void FUserCloudStorageEOSSDK::QueryFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudQueryFileInfoComplete&& OnComplete)
+{
+	FTCHARToUTF8 FileNameUtf8(*FileName);
+
+	EOS_PlayerDataStorage_QueryFileOptions Options = {};
+	Options.ApiVersion = EOS_PLAYERDATASTORAGE_QUERYFILEOPTIONS_API_LATEST;
+	Options.LocalUserId = UserId.GetProductUserId();
+	Options.Filename = FileNameUtf8.Get();
+
+	FOnQueryFileCallback* CallbackObj = new FOnQueryFileCallback(FUserCloudStorageEOSWeakPtr(AsShared()));
+	CallbackObj->CallbackLambda = [this, UserIdRef = UserId.AsShared(), FileName, OnComplete = MoveTemp(OnComplete)](const EOS_PlayerDataStorage_QueryFileCallbackInfo* Data)
+	{
+		// The query refreshed the SDK's copy of the metadata
+		FUserCloudFileInfoEOS Info;
+		bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success && GetFileInfo(FUniqueNetIdEOS::Cast(*UserIdRef), FileName, Info);
+		if (Data->ResultCode != EOS_EResult::EOS_Success && Data->ResultCode != EOS_EResult::EOS_NotFound)
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::QueryFileInfo] EOS_PlayerDataStorage_QueryFile was not successful for file %s. Finished with error %s"), *FileName, ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
+		}
+
+		OnComplete(bWasSuccessful, Info);
+	};
+
+	EOS_PlayerDataStorage_QueryFile(PlayerDataStorageHandle, &Options, CallbackObj, CallbackObj->GetCallbackPtr());
+}
+
+bool FUserCloudStorageEOSSDK::ReadFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, FOnUserCloudReadFileComplete&& OnComplete)
+{
+	const FTransferKey Key(UserId.GetProductUserId(), FileName);
+	if (Transfers.Contains(Key))
+	{
+		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::ReadFile] File %s is already being transferred"), *FileName);
+		return false;
+	}
+
+	FTCHARToUTF8 FileNameUtf8(*FileName);
+
+	FReadFileCompleteCallback* CallbackObj = new FReadFileCompleteCallback(FUserCloudStorageEOSWeakPtr(AsShared()));
+
+	CallbackObj->SetNested1CallbackLambda([this, Key](const EOS_PlayerDataStorage_ReadFileDataCallbackInfo* Data)
+		{
+			UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FUserCloudStorageEOSSDK::ReadFile] Reading %d bytes of file %s's data"), Data->DataChunkLengthBytes, *Key.Get<1>());
+
+			FTransfer* Transfer = Transfers.Find(Key);
+			if (Transfer == nullptr)
+			{
+				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::ReadFile] Unknown file %s. Cancelling transfer request"), *Key.Get<1>());
+				return EOS_PlayerDataStorage_EReadResult::EOS_RR_CancelRequest;
+			}
+
+			// Is this is the first chunk of data we have received for this file?
+			if (Transfer->Offset == 0 && Transfer->Data.Num() == 0)
+			{
+				// An empty file still gets a data callback, the OnReadComplete delegate will trigger immediately after.
+				Transfer->Data.SetNumUninitialized(Data->TotalFileSizeBytes);
+			}
+
+			if (Transfer->Offset + Data->DataChunkLengthBytes <= (uint32)Transfer->Data.Num())
+			{
+				FMemory::Memcpy(Transfer->Data.GetData() + Transfer->Offset, Data->DataChunk, Data->DataChunkLengthBytes);
+				Transfer->Offset += Data->DataChunkLengthBytes;
+				return EOS_PlayerDataStorage_EReadResult::EOS_RR_ContinueReading;
+			}
+
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::ReadFile] Read size exceeded specified file size for file %s"), *Key.Get<1>());
+			return EOS_PlayerDataStorage_EReadResult::EOS_RR_FailRequest;
+		});
+
+	CallbackObj->SetNested2CallbackLambda([FileName](const EOS_PlayerDataStorage_FileTransferProgressCallbackInfo* Data)
+		{
+			UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FUserCloudStorageEOSSDK::ReadFile] File transfer progress for file %s is %d bytes"), *FileName, Data->BytesTransferred);
+		});
+
+	CallbackObj->CallbackLambda = [this, Key, OnComplete = MoveTemp(OnComplete)](const EOS_PlayerDataStorage_ReadFileCallbackInfo* Data)
+	{
+		const bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success;
+		if (!bWasSuccessful)
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::ReadFile] EOS_PlayerDataStorage_ReadFile was not successful for file %s. Finished with error %s"), *Key.Get<1>(), ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
+		}
+
+		TArray<uint8> FileData = FinishTransfer(Key);
+		OnComplete(bWasSuccessful, bWasSuccessful ? MoveTemp(FileData) : TArray<uint8>());
+	};
+
+	EOS_PlayerDataStorage_ReadFileOptions ReadFileOptions = {};
+	ReadFileOptions.ApiVersion = EOS_PLAYERDATASTORAGE_READFILEOPTIONS_API_LATEST;
+	ReadFileOptions.LocalUserId = UserId.GetProductUserId();
+	ReadFileOptions.Filename = FileNameUtf8.Get();
+	ReadFileOptions.ReadChunkLengthBytes = ChunkLength;
+	ReadFileOptions.ReadFileDataCallback = CallbackObj->GetNested1CallbackPtr();
+	ReadFileOptions.FileTransferProgressCallback = CallbackObj->GetNested2CallbackPtr();
+
+	EOS_HPlayerDataStorageFileTransferRequest Request = EOS_PlayerDataStorage_ReadFile(PlayerDataStorageHandle, &ReadFileOptions, CallbackObj, CallbackObj->GetCallbackPtr());
+	if (Request == nullptr)
+	{
+		return false;
+	}
+
+	Transfers.Add(Key).Request = Request;
+	return true;
+}
+
+bool FUserCloudStorageEOSSDK::WriteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, TArray<uint8>&& Data, FOnUserCloudTransferProgress&& OnProgress, FOnUserCloudOperationComplete&& OnComplete)
+{
+	const FTransferKey Key(UserId.GetProductUserId(), FileName);
+	if (Transfers.Contains(Key))
+	{
+		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::WriteFile] File %s is already being transferred"), *FileName);
+		return false;
+	}
+
+	FTCHARToUTF8 FileNameUtf8(*FileName);
+
+	FWriteFileCompleteCallback* CallbackObj = new FWriteFileCompleteCallback(FUserCloudStorageEOSWeakPtr(AsShared()));
+
+	CallbackObj->SetNested1CallbackLambda([this, Key](const EOS_PlayerDataStorage_WriteFileDataCallbackInfo* Data, void* OutDataBuffer, uint32_t* OutDataWritten)
+		{
+			FTransfer* Transfer = Transfers.Find(Key);
+			if (Transfer == nullptr)
+			{
+				UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::WriteFile] Unknown file %s. Cancelling transfer request"), *Key.Get<1>());
+				return EOS_PlayerDataStorage_EWriteResult::EOS_WR_CancelRequest;
+			}
+
+			const uint32 BytesToWrite = FMath::Min(Data->DataBufferLengthBytes, (uint32)Transfer->Data.Num() - Transfer->Offset);
+			if (BytesToWrite > 0)
+			{
+				FMemory::Memcpy(OutDataBuffer, Transfer->Data.GetData() + Transfer->Offset, BytesToWrite);
+				Transfer->Offset += BytesToWrite;
+			}
+			*OutDataWritten = BytesToWrite;
+
+			UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FUserCloudStorageEOSSDK::WriteFile] Wrote %d bytes for file %s"), BytesToWrite, *Key.Get<1>());
+
+			// The last chunk completes the request, instead of waiting for one more empty callback
+			return Transfer->Offset == (uint32)Transfer->Data.Num() ? EOS_PlayerDataStorage_EWriteResult::EOS_WR_CompleteRequest : EOS_PlayerDataStorage_EWriteResult::EOS_WR_ContinueWriting;
+		});
+
+	CallbackObj->SetNested2CallbackLambda([FileName, OnProgress = MoveTemp(OnProgress)](const EOS_PlayerDataStorage_FileTransferProgressCallbackInfo* Data)
+		{
+			UE_LOG_ONLINE_CLOUD(VeryVerbose, TEXT("[FUserCloudStorageEOSSDK::WriteFile] File transfer progress for file %s is %d bytes"), *FileName, Data->BytesTransferred);
+			OnProgress(Data->BytesTransferred);
+		});
+
+	CallbackObj->CallbackLambda = [this, Key, OnComplete = MoveTemp(OnComplete)](const EOS_PlayerDataStorage_WriteFileCallbackInfo* Data)
+	{
+		const bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success;
+		if (!bWasSuccessful)
+		{
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::WriteFile] EOS_PlayerDataStorage_WriteFile was not successful for file %s. Finished with error %s"), *Key.Get<1>(), ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
+		}
+
+		FinishTransfer(Key);
+		OnComplete(bWasSuccessful);
+	};
+
+	EOS_PlayerDataStorage_WriteFileOptions WriteFileOptions = {};
+	WriteFileOptions.ApiVersion = EOS_PLAYERDATASTORAGE_WRITEFILEOPTIONS_API_LATEST;
+	WriteFileOptions.LocalUserId = UserId.GetProductUserId();
+	WriteFileOptions.Filename = FileNameUtf8.Get();
+	WriteFileOptions.ChunkLengthBytes = ChunkLength;
+	WriteFileOptions.WriteFileDataCallback = CallbackObj->GetNested1CallbackPtr();
+	WriteFileOptions.FileTransferProgressCallback = CallbackObj->GetNested2CallbackPtr();
+
+	// The data callbacks can only happen once the SDK ticks, so the transfer is added after the request is created
+	EOS_HPlayerDataStorageFileTransferRequest Request = EOS_PlayerDataStorage_WriteFile(PlayerDataStorageHandle, &WriteFileOptions, CallbackObj, CallbackObj->GetCallbackPtr());
+	if (Request == nullptr)
+	{
+		return false;
+	}
+
+	FTransfer& Transfer = Transfers.Add(Key);
+	Transfer.Request = Request;
+	Transfer.Data = MoveTemp(Data);
+	return true;
+}
+
+bool FUserCloudStorageEOSSDK::CancelTransfer(const FUniqueNetIdEOS& UserId, const FString& FileName)
+{
+	const FTransfer* Transfer = Transfers.Find(FTransferKey(UserId.GetProductUserId(), FileName));
+	if (Transfer == nullptr)
+	{
+		return false;
+	}
+
+	EOS_EResult Result = EOS_PlayerDataStorageFileTransferRequest_CancelRequest(Transfer->Request);
+	if (Result != EOS_EResult::EOS_Success)
+	{
+		// Result code will be EOS_NoChange if request had already completed (can't be canceled), and EOS_AlreadyPending if it's already been canceled before (this is a final state for a canceled request and won't change over time)
+		UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::CancelTransfer] EOS_PlayerDataStorageFileTransferRequest_CancelRequest was not successful. Finished with error %s"), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+		return false;
+	}
+
+	return true;
+}
+
+void FUserCloudStorageEOSSDK::DeleteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudOperationComplete&& OnComplete)
+{
+	FTCHARToUTF8 FileNameUtf8(*FileName);
+
+	EOS_PlayerDataStorage_DeleteFileOptions Options = {};
+	Options.ApiVersion = EOS_PLAYERDATASTORAGE_DELETEFILEOPTIONS_API_LATEST;
+	Options.LocalUserId = UserId.GetProductUserId();
+	Options.Filename = FileNameUtf8.Get();
+
+	FOnDeleteFileCallback* CallbackObj = new FOnDeleteFileCallback(FUserCloudStorageEOSWeakPtr(AsShared()));
+	CallbackObj->CallbackLambda = [FileName, OnComplete = MoveTemp(OnComplete)](const EOS_PlayerDataStorage_DeleteFileCallbackInfo* Data)
+	{
+		bool bWasSuccessful = Data->ResultCode == EOS_EResult::EOS_Success;
+		if (!bWasSuccessful)
+		{
+			// File deletion operations can fail if the user does not own the file
+			UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSSDK::DeleteFile] EOS_PlayerDataStorage_DeleteFile was not successful for file %s. Finished with error %s"), *FileName, ANSI_TO_TCHAR(EOS_EResult_ToString(Data->ResultCode)));
+		}
+
+		OnComplete(bWasSuccessful);
+	};
+
+	EOS_PlayerDataStorage_DeleteFile(PlayerDataStorageHandle, &Options, CallbackObj, CallbackObj->GetCallbackPtr());
+}
+
+TArray<uint8> FUserCloudStorageEOSSDK::FinishTransfer(const FTransferKey& Key)
+{
+	FTransfer Transfer;
+	if (Transfers.RemoveAndCopyValue(Key, Transfer) && Transfer.Request != nullptr)
+	{
+		EOS_PlayerDataStorageFileTransferRequest_Release(Transfer.Request);
+	}
+	return MoveTemp(Transfer.Data);
+}
+
+FString FUserCloudStorageEOSLocal::GetUserDir(const FUniqueNetIdEOS& UserId)
+{
+	return FPaths::ProjectSavedDir() / TEXT("EIK") / TEXT("LocalUserCloud") / UserId.ToString();
+}
+
+void FUserCloudStorageEOSLocal::QueryFiles(const FUniqueNetIdEOS& UserId, FOnUserCloudQueryFilesComplete&& OnComplete)
+{
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FUserCloudStorageEOSWeakPtr(AsShared()), UserDir = GetUserDir(UserId), OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			TArray<FString> FileNames;
+			IFileManager::Get().FindFiles(FileNames, *(UserDir / TEXT("*")), true, false);
+
+			TArray<FCloudFileHeader> Files;
+			TMap<FString, FUserCloudFileInfoEOS> Infos;
+			for (const FString& FileName : FileNames)
+			{
+				TArray<uint8> Data;
+				if (FFileHelper::LoadFileToArray(Data, *(UserDir / FileName)))
+				{
+					Files.Emplace(FCloudFileHeader(FileName, FileName, Data.Num()));
+					Infos.Add(UserDir / FileName, { Data.Num(), FMD5::HashBytes(Data.GetData(), Data.Num()) });
+				}
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Files = MoveTemp(Files), Infos = MoveTemp(Infos), OnComplete = MoveTemp(OnComplete)]() mutable
+				{
+					FUserCloudStorageEOSPtr StrongThis = WeakThis.Pin();
+					if (StrongThis.IsValid())
+					{
+						static_cast<FUserCloudStorageEOSLocal*>(StrongThis.Get())->FileInfos.Append(Infos);
+						OnComplete(true, MoveTemp(Files));
+					}
+				});
+		});
+}
+
+bool FUserCloudStorageEOSLocal::GetFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FUserCloudFileInfoEOS& OutInfo)
+{
+	const FUserCloudFileInfoEOS* Info = FileInfos.Find(GetUserDir(UserId) / FileName);
+	if (Info == nullptr)
+	{
+		return false;
+	}
+	OutInfo = *Info;
+	return true;
+}
+
+void FUserCloudStorageEOSLocal::QueryFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudQueryFileInfoComplete&& OnComplete)
+{
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FUserCloudStorageEOSWeakPtr(AsShared()), Path = GetUserDir(UserId) / FileName, OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			TArray<uint8> Data;
+			const bool bWasSuccessful = FFileHelper::LoadFileToArray(Data, *Path, FILEREAD_Silent);
+			FUserCloudFileInfoEOS Info;
+			if (bWasSuccessful)
+			{
+				Info = { Data.Num(), FMD5::HashBytes(Data.GetData(), Data.Num()) };
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Path, bWasSuccessful, Info = MoveTemp(Info), OnComplete = MoveTemp(OnComplete)]() mutable
+				{
+					FUserCloudStorageEOSPtr StrongThis = WeakThis.Pin();
+					if (StrongThis.IsValid())
+					{
+						TMap<FString, FUserCloudFileInfoEOS>& FileInfos = static_cast<FUserCloudStorageEOSLocal*>(StrongThis.Get())->FileInfos;
+						if (bWasSuccessful)
+						{
+							FileInfos.Add(Path, Info);
+						}
+						else
+						{
+							FileInfos.Remove(Path);
+						}
+						OnComplete(bWasSuccessful, Info);
+					}
+				});
+		});
+}
+
+bool FUserCloudStorageEOSLocal::ReadFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, FOnUserCloudReadFileComplete&& OnComplete)
+{
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FUserCloudStorageEOSWeakPtr(AsShared()), Path = GetUserDir(UserId) / FileName, OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			TArray<uint8> Data;
+			const bool bWasSuccessful = FFileHelper::LoadFileToArray(Data, *Path);
+			FString MD5Hash = bWasSuccessful ? FMD5::HashBytes(Data.GetData(), Data.Num()) : FString();
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Path, bWasSuccessful, MD5Hash = MoveTemp(MD5Hash), Data = MoveTemp(Data), OnComplete = MoveTemp(OnComplete)]() mutable
+				{
+					FUserCloudStorageEOSPtr StrongThis = WeakThis.Pin();
+					if (StrongThis.IsValid())
+					{
+						if (bWasSuccessful)
+						{
+							static_cast<FUserCloudStorageEOSLocal*>(StrongThis.Get())->FileInfos.Add(Path, { Data.Num(), MoveTemp(MD5Hash) });
+						}
+						else
+						{
+							UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSLocal::ReadFile] Unable to read file %s"), *Path);
+						}
+						OnComplete(bWasSuccessful, MoveTemp(Data));
+					}
+				});
+		});
+
+	return true;
+}
+
+bool FUserCloudStorageEOSLocal::WriteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, TArray<uint8>&& Data, FOnUserCloudTransferProgress&& OnProgress, FOnUserCloudOperationComplete&& OnComplete)
+{
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FUserCloudStorageEOSWeakPtr(AsShared()), Path = GetUserDir(UserId) / FileName, Data = MoveTemp(Data), OnProgress = MoveTemp(OnProgress), OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			const bool bWasSuccessful = FFileHelper::SaveArrayToFile(Data, *Path);
+			FString MD5Hash = FMD5::HashBytes(Data.GetData(), Data.Num());
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Path, bWasSuccessful, MD5Hash = MoveTemp(MD5Hash), SizeBytes = Data.Num(), OnProgress = MoveTemp(OnProgress), OnComplete = MoveTemp(OnComplete)]() mutable
+				{
+					FUserCloudStorageEOSPtr StrongThis = WeakThis.Pin();
+					if (StrongThis.IsValid())
+					{
+						if (bWasSuccessful)
+						{
+							static_cast<FUserCloudStorageEOSLocal*>(StrongThis.Get())->FileInfos.Add(Path, { SizeBytes, MoveTemp(MD5Hash) });
+							OnProgress(SizeBytes);
+						}
+						else
+						{
+							UE_LOG_ONLINE_CLOUD(Warning, TEXT("[FUserCloudStorageEOSLocal::WriteFile] Unable to write file %s"), *Path);
+						}
+						OnComplete(bWasSuccessful);
+					}
+				});
+		});
+
+	return true;
+}
+
+bool FUserCloudStorageEOSLocal::CancelTransfer(const FUniqueNetIdEOS& UserId, const FString& FileName)
+{
+	// The disk accesses are short, they are not cancelable
+	return false;
+}
+
+void FUserCloudStorageEOSLocal::DeleteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudOperationComplete&& OnComplete)
+{
+	const FString Path = GetUserDir(UserId) / FileName;
+	FileInfos.Remove(Path);
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis = FUserCloudStorageEOSWeakPtr(AsShared()), Path, OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			const bool bWasSuccessful = IFileManager::Get().Delete(*Path);
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, bWasSuccessful, OnComplete = MoveTemp(OnComplete)]()
+				{
+					if (WeakThis.IsValid())
+					{
+						OnComplete(bWasSuccessful);
+					}
+				});
+		});
+}
+
+#endif
@@ -0,0 +1,133 @@
+//Copyright (c) 2023 Betide Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineUserCloudInterface.h"
+#include "OnlineSubsystemEOSTypes.h"
+
+#if WITH_EOS_SDK
+	#include "eos_playerdatastorage_types.h"
+
+/** Metadata of a stored file, as last seen by the storage */
+struct FUserCloudFileInfoEOS
+{
+	int64 SizeBytes = 0;
+	/** Identifies the stored version of the file, it changes every time the file is written */
+	FString MD5Hash;
+};
+
+typedef TFunction<void(bool bWasSuccessful, TArray<FCloudFileHeader>&& Files)> FOnUserCloudQueryFilesComplete;
+typedef TFunction<void(bool bWasSuccessful, const FUserCloudFileInfoEOS& Info)> FOnUserCloudQueryFileInfoComplete;
+typedef TFunction<void(bool bWasSuccessful, TArray<uint8>&& Data)> FOnUserCloudReadFileComplete;
+typedef TFunction<void(int32 BytesTransferred)> FOnUserCloudTransferProgress;
+typedef TFunction<void(bool bWasSuccessful)> FOnUserCloudOperationComplete;
+
+/**
+ * The player data storage calls made by FOnlineUserCloudEOS.
+ * The SDK implementation is used by default, the local one stores the files on disk so the user cloud can run without the EOS service.
+ * All the calls and callbacks happen on the game thread.
+ */
+class IUserCloudStorageEOS
+	: public TSharedFromThis<IUserCloudStorageEOS, ESPMode::ThreadSafe>
+{
+public:
+	virtual ~IUserCloudStorageEOS() = default;
+
+	virtual void QueryFiles(const FUniqueNetIdEOS& UserId, FOnUserCloudQueryFilesComplete&& OnComplete) = 0;
+
+	/**
+	 * Gets the metadata of a file the storage already knows about, from a query or a transfer
+	 *
+	 * @return false if the file is unknown
+	 */
+	virtual bool GetFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FUserCloudFileInfoEOS& OutInfo) = 0;
+
+	/** Gets the current metadata of a file from the storage, the file may have been written from another device since it was last seen */
+	virtual void QueryFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudQueryFileInfoComplete&& OnComplete) = 0;
+
+	/**
+	 * Downloads a file in chunks of ChunkLength bytes
+	 *
+	 * @return false if the transfer could not be started, OnComplete is not called then
+	 */
+	virtual bool ReadFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, FOnUserCloudReadFileComplete&& OnComplete) = 0;
+
+	/**
+	 * Uploads a file in chunks of ChunkLength bytes
+	 *
+	 * @return false if the transfer could not be started, OnComplete is not called then
+	 */
+	virtual bool WriteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, TArray<uint8>&& Data, FOnUserCloudTransferProgress&& OnProgress, FOnUserCloudOperationComplete&& OnComplete) = 0;
+
+	/** @return true if a running transfer of the file was canceled, its completion callback still gets called */
+	virtual bool CancelTransfer(const FUniqueNetIdEOS& UserId, const FString& FileName) = 0;
+
+	virtual void DeleteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudOperationComplete&& OnComplete) = 0;
+};
+
+typedef TSharedPtr<IUserCloudStorageEOS, ESPMode::ThreadSafe> FUserCloudStorageEOSPtr;
+typedef TWeakPtr<IUserCloudStorageEOS, ESPMode::ThreadSafe> FUserCloudStorageEOSWeakPtr;
+
+/** Transfers the files through the EOS player data storage interface */
+class FUserCloudStorageEOSSDK
+	: public IUserCloudStorageEOS
+{
+public:
+	explicit FUserCloudStorageEOSSDK(EOS_HPlayerDataStorage InPlayerDataStorageHandle);
+
+	//~ Begin IUserCloudStorageEOS Interface
+	virtual void QueryFiles(const FUniqueNetIdEOS& UserId, FOnUserCloudQueryFilesComplete&& OnComplete) override;
+	virtual bool GetFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FUserCloudFileInfoEOS& OutInfo) override;
+	virtual void QueryFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudQueryFileInfoComplete&& OnComplete) override;
+	virtual bool ReadFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, FOnUserCloudReadFileComplete&& OnComplete) override;
+	virtual bool WriteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, TArray<uint8>&& Data, FOnUserCloudTransferProgress&& OnProgress, FOnUserCloudOperationComplete&& OnComplete) override;
+	virtual bool CancelTransfer(const FUniqueNetIdEOS& UserId, const FString& FileName) override;
+	virtual void DeleteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudOperationComplete&& OnComplete) override;
+	//~ End IUserCloudStorageEOS Interface
+
+private:
+	struct FTransfer
+	{
+		TArray<uint8> Data;
+		uint32 Offset = 0;
+		EOS_HPlayerDataStorageFileTransferRequest Request = nullptr;
+	};
+
+	typedef TTuple<EOS_ProductUserId, FString> FTransferKey;
+
+	/** Releases the request of a completed transfer and takes its data */
+	TArray<uint8> FinishTransfer(const FTransferKey& Key);
+
+	EOS_HPlayerDataStorage PlayerDataStorageHandle;
+
+	/** Transfers in progress, there is at most one per user and file */
+	TMap<FTransferKey, FTransfer> Transfers;
+};
+
+/**
+ * Stores the files under Saved/EIK/LocalUserCloud/<UserId>, the disk accesses are done on the thread pool.
+ * Use it to test the user cloud without the EOS service.
+ */
+class FUserCloudStorageEOSLocal
+	: public IUserCloudStorageEOS
+{
+public:
+	//~ Begin IUserCloudStorageEOS Interface
+	virtual void QueryFiles(const FUniqueNetIdEOS& UserId, FOnUserCloudQueryFilesComplete&& OnComplete) override;
+	virtual bool GetFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FUserCloudFileInfoEOS& OutInfo) override;
+	virtual void QueryFileInfo(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudQueryFileInfoComplete&& OnComplete) override;
+	virtual bool ReadFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, FOnUserCloudReadFileComplete&& OnComplete) override;
+	virtual bool WriteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, uint32 ChunkLength, TArray<uint8>&& Data, FOnUserCloudTransferProgress&& OnProgress, FOnUserCloudOperationComplete&& OnComplete) override;
+	virtual bool CancelTransfer(const FUniqueNetIdEOS& UserId, const FString& FileName) override;
+	virtual void DeleteFile(const FUniqueNetIdEOS& UserId, const FString& FileName, FOnUserCloudOperationComplete&& OnComplete) override;
+	//~ End IUserCloudStorageEOS Interface
+
+private:
+	static FString GetUserDir(const FUniqueNetIdEOS& UserId);
+
+	/** Metadata of the files seen by the last query or transfer, keyed by path */
+	TMap<FString, FUserCloudFileInfoEOS> FileInfos;
+};
+
+#endif
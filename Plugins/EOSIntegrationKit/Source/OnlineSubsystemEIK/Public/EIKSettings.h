@@ -73,6 +73,8 @@ struct FEOSSettings
 	FString DefaultArtifactName;
 	int32 TickBudgetInMilliseconds;
 	int32 TitleStorageReadChunkLength;
+	bool bCacheUserCloudFiles = true;
+	bool bTrustEnumeratedUserCloudFiles = false;
 	bool bEnableOverlay;
 	bool bEnableSocialOverlay;
 	bool bEnableEditorOverlay;
@@ -180,6 +182,14 @@ public:
 	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category="EOS Settings")
 	int32 TitleStorageReadChunkLength = 0;
 
+	/** Keeps a copy of the downloaded and uploaded player data storage files on disk, so files that did not change are not downloaded again */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category="EOS Settings")
+	bool bCacheUserCloudFiles = true;
+
+	/** Serves cached player data storage files by the metadata of the last enumeration instead of querying it before each read. Saves a request per read, but a file written from another device since is read stale */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category="EOS Settings")
+	bool bTrustEnumeratedUserCloudFiles = false;
+
 	/** Per artifact SDK settings. A game might have a FooStaging, FooQA, and public Foo artifact */
 	UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category="EOS Settings")
 	TArray<FEArtifactSettings> Artifacts;
@@ -212,6 +212,20 @@ void UNetDriverEIKBase::Shutdown()
 	}
 }
 
+void UNetDriverEIKBase::TickFlush(float DeltaSeconds)
+{
+	Super::TickFlush(DeltaSeconds);
+
+	// Send the packets our connections coalesced this frame
+	if (!bIsPassthrough)
+	{
+		if (FSocketEOS* const EOSSocket = static_cast<FSocketEOS*>(GetSocket()))
+		{
+			EOSSocket->FlushSendQueue();
+		}
+	}
+}
+
 int UNetDriverEIKBase::GetClientPort()
 {
 	if (bIsPassthrough)
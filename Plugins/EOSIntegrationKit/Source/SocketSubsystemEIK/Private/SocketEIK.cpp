@@ -3,6 +3,7 @@
 #include "SocketEIK.h"
 #include "SocketTypes.h"
 #include "SocketSubsystemEIK.h"
+#include "HAL/IConsoleManager.h"
 
 #if WITH_EOS_SDK
 	#include "eos_p2p.h"
@@ -54,10 +55,25 @@ void NpLog(const TCHAR* Msg)
 #include "Windows/HideWindowsPlatformTypes.h"
 #endif
 
+static TAutoConsoleVariable<bool> CVarCoalesceSends(
+	TEXT("EIK.P2P.CoalesceSends"),
+	false,
+	TEXT("Whether the packets sent to a peer during a frame are packed into as few p2p packets as possible. Every peer must use the same value (default false)."));
+
+static TAutoConsoleVariable<int32> CVarMaxReceiveBatch(
+	TEXT("EIK.P2P.MaxReceiveBatch"),
+	256,
+	TEXT("Maximum number of p2p packets a socket reads from the transport at once (default 256)."));
+
+/** Size of the length prefixed to every packet of a coalesced send */
+constexpr int32 COALESCED_PACKET_HEADER_SIZE = 2;
+
 FSocketEOS::FSocketEOS(FSocketSubsystemEIK& InSocketSubsystem, const FString& InSocketDescription)
 	: FSocket(ESocketType::SOCKTYPE_Datagram, InSocketDescription, NAME_None)
 	, SocketSubsystem(InSocketSubsystem)
 	, bIsListening(false)
+	, NextReceivedPacket(0)
+	, PeakReceivedPackets(0)
 #if WITH_EOS_SDK
 	, ConnectNotifyCallback(nullptr)
 	, ConnectNotifyId(EOS_INVALID_NOTIFICATIONID)
@@ -90,16 +106,22 @@ bool FSocketEOS::Close()
 {
 	check(IsInGameThread() && "p2p does not support multithreading");
 
+	FlushSendQueue();
+	ReceivedPackets.Reset();
+	NextReceivedPacket = 0;
+
 #if WITH_EOS_SDK
 	if (ConnectNotifyId != EOS_INVALID_NOTIFICATIONID)
 	{
 		EOS_P2P_RemoveNotifyPeerConnectionRequest(SocketSubsystem.GetP2PHandle(), ConnectNotifyId);
+		ConnectNotifyId = EOS_INVALID_NOTIFICATIONID;
 	}
 	delete ConnectNotifyCallback;
 	ConnectNotifyCallback = nullptr;
 	if (ClosedNotifyId != EOS_INVALID_NOTIFICATIONID)
 	{
 		EOS_P2P_RemoveNotifyPeerConnectionClosed(SocketSubsystem.GetP2PHandle(), ClosedNotifyId);
+		ClosedNotifyId = EOS_INVALID_NOTIFICATIONID;
 	}
 	delete ClosedNotifyCallback;
 	ClosedNotifyCallback = nullptr;
@@ -169,6 +191,9 @@ bool FSocketEOS::Bind(const FInternetAddr& Addr)
 	LocalAddress = EOSAddr;
 	LocalAddress.SetLocalUserId(LocalUserId);
 
+	// Need to handle closures if we are a client and the server closes down on us
+	RegisterClosedNotification();
+
 	UE_LOG(LogSocketSubsystemEOS, Verbose, TEXT("Successfully bound socket to address (%s)"), *LocalAddress.ToString(true));
 	NP_LOG(TEXT("[%s] - Successfully bound socket to address (%s)\r\n"), GetLogPrefix(), *LocalAddress.ToString(true));
 	return true;
@@ -271,31 +296,30 @@ bool FSocketEOS::HasPendingData(uint32& PendingDataSize)
 
 	PendingDataSize = 0;
 
-#if WITH_EOS_SDK
-	EOS_P2P_GetNextReceivedPacketSizeOptions Options = { };
-	Options.ApiVersion = EOS_P2P_GETNEXTRECEIVEDPACKETSIZE_API_LATEST;
-	Options.LocalUserId = LocalAddress.GetLocalUserId();
-	uint8 Channel = LocalAddress.GetChannel();
-	Options.RequestedChannel = &Channel;
+	if (NextReceivedPacket < ReceivedPackets.Num())
+	{
+		PendingDataSize = ReceivedPackets[NextReceivedPacket].Size;
+		return true;
+	}
 
-	EOS_EResult Result = EOS_P2P_GetNextReceivedPacketSize(SocketSubsystem.GetP2PHandle(), &Options, &PendingDataSize);
-	if (Result == EOS_EResult::EOS_NotFound)
+	ISocketEOSTransport* Transport = SocketSubsystem.GetTransport();
+	if (Transport == nullptr)
 	{
 		return false;
 	}
-	if (Result != EOS_EResult::EOS_Success)
-	{
-		UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Unable to check for data on address (%s) result code = (%s)"), *LocalAddress.ToString(true), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
 
-		// @todo joeg - map EOS codes to UE4's
-		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_EINVAL);
+	const ESocketErrors Error = Transport->GetNextPacketSize(LocalAddress, PendingDataSize);
+	if (Error == ESocketErrors::SE_EWOULDBLOCK)
+	{
+		return false;
+	}
+	if (Error != ESocketErrors::SE_NO_ERROR)
+	{
+		SocketSubsystem.SetLastSocketError(Error);
 		return false;
 	}
 
 	return true;
-#else
-	return false;
-#endif
 }
 
 FSocket* FSocketEOS::Accept(const FString& InSocketDescription)
@@ -326,10 +350,12 @@ bool FSocketEOS::SendTo(const uint8* Data, int32 Count, int32& OutBytesSent, con
 		return false;
 	}
 
-#if WITH_EOS_SDK
-	if (Count > EOS_P2P_MAX_PACKET_SIZE)
+	// Coalesced packets are prefixed with their size
+	const bool bCoalesceSends = CVarCoalesceSends.GetValueOnGameThread();
+	const int32 MaxPacketSize = bCoalesceSends ? EIK_P2P_MAX_PACKET_SIZE - COALESCED_PACKET_HEADER_SIZE : EIK_P2P_MAX_PACKET_SIZE;
+	if (Count > MaxPacketSize)
 	{
-		UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Unable to send data, data over maximum size. Amount=[%d/%d] DestinationAddress = (%s)"), Count, EOS_P2P_MAX_PACKET_SIZE, *Destination.ToString(true));
+		UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Unable to send data, data over maximum size. Amount=[%d/%d] DestinationAddress = (%s)"), Count, MaxPacketSize, *Destination.ToString(true));
 
 		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_EMSGSIZE);
 		return false;
@@ -337,12 +363,11 @@ bool FSocketEOS::SendTo(const uint8* Data, int32 Count, int32& OutBytesSent, con
 
 	if (Count < 0)
 	{
-		UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Unable to send data, data invalid. Amount=[%d/%d] DestinationAddress = (%s)"), Count, EOS_P2P_MAX_PACKET_SIZE, *Destination.ToString(true));
+		UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Unable to send data, data invalid. Amount=[%d/%d] DestinationAddress = (%s)"), Count, MaxPacketSize, *Destination.ToString(true));
 
 		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_EINVAL);
 		return false;
 	}
-#endif 
 
 	if (Data == nullptr && Count != 0)
 	{
@@ -378,39 +403,45 @@ bool FSocketEOS::SendTo(const uint8* Data, int32 Count, int32& OutBytesSent, con
 		return false;
 	}
 
-#if WITH_EOS_SDK
-	// Need to handle closures if we are a client and the server closes down on us
-	RegisterClosedNotification();
+	ISocketEOSTransport* Transport = SocketSubsystem.GetTransport();
+	if (Transport == nullptr)
+	{
+		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_NOTINITIALISED);
+		return false;
+	}
 
-	EOS_P2P_SocketId SocketId = { };
-	SocketId.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
-	FCStringAnsi::Strcpy(SocketId.SocketName, DestinationAddress.GetSocketName());
+	const FInternetAddrEOS PeerAddress = MakePeerAddress(DestinationAddress);
+	FPeer& Peer = Peers.FindOrAdd(PeerAddress);
+	Peer.Stats.PacketsSent++;
+	Peer.Stats.BytesSent += Count;
 
-	EOS_P2P_SendPacketOptions Options = { };
-	Options.ApiVersion = EOS_P2P_SENDPACKET_API_LATEST;
-	Options.LocalUserId = LocalAddress.GetLocalUserId();
-	Options.RemoteUserId = DestinationAddress.GetRemoteUserId();
-	Options.SocketId = &SocketId;
-	Options.bAllowDelayedDelivery = EOS_TRUE;
-	Options.Reliability = EOS_EPacketReliability::EOS_PR_UnreliableUnordered;
-	Options.Channel = DestinationAddress.GetChannel();
-	Options.DataLengthBytes = Count;
-	Options.Data = Data;
-	EOS_EResult Result = EOS_P2P_SendPacket(SocketSubsystem.GetP2PHandle(), &Options);
-	NP_LOG(TEXT("[%s] - EOS_P2P_SendPacket() to (%s) result code = (%s)\r\n"), GetLogPrefix(), *Destination.ToString(true), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
-	if (Result != EOS_EResult::EOS_Success)
+	if (!bCoalesceSends && Peer.SendQueue.Num() == 0)
 	{
-		UE_LOG(LogSocketSubsystemEOS, Error, TEXT("Unable to send data to (%s) result code = (%s)"), *Destination.ToString(true), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+		Peer.Stats.TransportPacketsSent++;
+		const ESocketErrors Error = Transport->SendPacket(LocalAddress, DestinationAddress, Data, Count);
+		if (Error != ESocketErrors::SE_NO_ERROR)
+		{
+			SocketSubsystem.SetLastSocketError(Error);
+			return false;
+		}
+		OutBytesSent = Count;
+		return true;
+	}
 
-		// @todo joeg - map EOS codes to UE4's
-		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_EINVAL);
-		return false;
+	// Send what is already queued for the peer first if this packet does not fit with it
+	if (Peer.SendQueue.Num() + COALESCED_PACKET_HEADER_SIZE + Count > EIK_P2P_MAX_PACKET_SIZE)
+	{
+		FlushPeer(*Transport, PeerAddress, Peer);
 	}
+
+	Peer.SendQueue.Add(uint8(Count & 0xFF));
+	Peer.SendQueue.Add(uint8(Count >> 8));
+	Peer.SendQueue.Append(Data, Count);
+	Peer.Stats.QueuedPackets++;
+	Peer.Stats.PeakQueuedPackets = FMath::Max(Peer.Stats.PeakQueuedPackets, Peer.Stats.QueuedPackets);
+
 	OutBytesSent = Count;
 	return true;
-#else
-	return false;
-#endif
 }
 
 bool FSocketEOS::Send(const uint8* Data, int32 Count, int32& BytesSent)
@@ -443,45 +474,93 @@ bool FSocketEOS::RecvFrom(uint8* Data, int32 BufferSize, int32& BytesRead, FInte
 		return false;
 	}
 
-#if WITH_EOS_SDK
-	EOS_P2P_ReceivePacketOptions Options = { };
-	Options.ApiVersion = EOS_P2P_RECEIVEPACKET_API_LATEST;
-	Options.LocalUserId = LocalAddress.GetLocalUserId();
-	Options.MaxDataSizeBytes = BufferSize;
-	uint8 Channel = LocalAddress.GetChannel();
-	Options.RequestedChannel = &Channel;
-
-	EOS_ProductUserId RemoteUserId = nullptr;
-	EOS_P2P_SocketId SocketId;
-	
-	EOS_EResult Result = EOS_P2P_ReceivePacket(SocketSubsystem.GetP2PHandle(), &Options, &RemoteUserId, &SocketId, &Channel, Data, (uint32*)&BytesRead);
-	NP_LOG(TEXT("[%s] - EOS_P2P_ReceivePacket() for user (%s) and channel (%d) with result code = (%s)\r\n"), GetLogPrefix(), *MakeStringFromProductUserId(LocalAddress.GetLocalUserId()), Channel, ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
-	if (Result == EOS_EResult::EOS_NotFound)
+	if (NextReceivedPacket == ReceivedPackets.Num())
 	{
-		// No data to read
-		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_EWOULDBLOCK);
-		return false;
+		ISocketEOSTransport* Transport = SocketSubsystem.GetTransport();
+		const ESocketErrors Error = Transport != nullptr ? ReceivePackets(*Transport) : ESocketErrors::SE_EWOULDBLOCK;
+		if (Error != ESocketErrors::SE_NO_ERROR)
+		{
+			SocketSubsystem.SetLastSocketError(Error);
+			return false;
+		}
 	}
-	else if (Result != EOS_EResult::EOS_Success)
+
+	const FReceivedPacket& Packet = ReceivedPackets[NextReceivedPacket++];
+	if (Packet.Size > BufferSize)
 	{
-		UE_LOG(LogSocketSubsystemEOS, Error, TEXT("Unable to receive data result code = (%s)"), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+		UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Dropping packet of size (%d) from (%s), receiving buffer is too small. BufferSize = (%d)"), Packet.Size, *Packet.Source.ToString(true), BufferSize);
 
-		// @todo joeg - map EOS codes to UE4's
-		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_EINVAL);
+		SocketSubsystem.SetLastSocketError(ESocketErrors::SE_EMSGSIZE);
 		return false;
 	}
 
-	FInternetAddrEOS& SourceAddress = static_cast<FInternetAddrEOS&>(Source);
-	SourceAddress.SetLocalUserId(LocalAddress.GetLocalUserId());
-	SourceAddress.SetRemoteUserId(RemoteUserId);
-	SourceAddress.SetSocketName(SocketId.SocketName);
-	SourceAddress.SetChannel(Channel);
+	FMemory::Memcpy(Data, ReceiveBuffer.GetData() + Packet.Offset, Packet.Size);
+	BytesRead = Packet.Size;
+	static_cast<FInternetAddrEOS&>(Source) = Packet.Source;
 
-	NP_LOG(TEXT("[%s] - EOS_P2P_ReceivePacket() of size (%d) from (%s)\r\n"), GetLogPrefix(), BytesRead, *SourceAddress.ToString(true));
+	NP_LOG(TEXT("[%s] - EOS_P2P_ReceivePacket() of size (%d) from (%s)\r\n"), GetLogPrefix(), BytesRead, *Packet.Source.ToString(true));
 	return true;
-#else
-	return false;
-#endif
+}
+
+ESocketErrors FSocketEOS::ReceivePackets(ISocketEOSTransport& Transport)
+{
+	// All the packets of the previous batch were returned, so its storage can be reused
+	ReceivedPackets.Reset();
+	ReceiveBuffer.Reset();
+	NextReceivedPacket = 0;
+
+	const bool bCoalescedSends = CVarCoalesceSends.GetValueOnGameThread();
+	const int32 MaxPackets = FMath::Max(CVarMaxReceiveBatch.GetValueOnGameThread(), 1);
+	ESocketErrors Error = ESocketErrors::SE_NO_ERROR;
+	for (int32 PacketIndex = 0; PacketIndex < MaxPackets; ++PacketIndex)
+	{
+		const int32 Offset = ReceiveBuffer.Num();
+		ReceiveBuffer.AddUninitialized(EIK_P2P_MAX_PACKET_SIZE);
+
+		FInternetAddrEOS Source;
+		int32 BytesRead = 0;
+		Error = Transport.ReceivePacket(LocalAddress, ReceiveBuffer.GetData() + Offset, EIK_P2P_MAX_PACKET_SIZE, BytesRead, Source);
+		if (Error != ESocketErrors::SE_NO_ERROR)
+		{
+			ReceiveBuffer.SetNum(Offset, false);
+			break;
+		}
+		ReceiveBuffer.SetNum(Offset + BytesRead, false);
+
+		FSocketEOSPeerStats& Stats = Peers.FindOrAdd(Source).Stats;
+		Stats.TransportPacketsReceived++;
+		if (!bCoalescedSends)
+		{
+			ReceivedPackets.Add({ Source, Offset, BytesRead });
+			Stats.PacketsReceived++;
+			Stats.BytesReceived += BytesRead;
+			continue;
+		}
+
+		const int32 End = Offset + BytesRead;
+		int32 PacketOffset = Offset;
+		while (PacketOffset < End)
+		{
+			const int32 Size = PacketOffset + COALESCED_PACKET_HEADER_SIZE <= End ? ReceiveBuffer[PacketOffset] | (ReceiveBuffer[PacketOffset + 1] << 8) : -1;
+			PacketOffset += COALESCED_PACKET_HEADER_SIZE;
+			if (Size < 0 || PacketOffset + Size > End)
+			{
+				UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Dropping the rest of a malformed coalesced packet from (%s), check that EIK.P2P.CoalesceSends matches on every peer"), *Source.ToString(true));
+				break;
+			}
+			ReceivedPackets.Add({ Source, PacketOffset, Size });
+			Stats.PacketsReceived++;
+			Stats.BytesReceived += Size;
+			PacketOffset += Size;
+		}
+	}
+
+	PeakReceivedPackets = FMath::Max(PeakReceivedPackets, ReceivedPackets.Num());
+	if (ReceivedPackets.Num() > 0)
+	{
+		return ESocketErrors::SE_NO_ERROR;
+	}
+	return Error == ESocketErrors::SE_NO_ERROR ? ESocketErrors::SE_EWOULDBLOCK : Error;
 }
 
 bool FSocketEOS::Recv(uint8* Data, int32 BufferSize, int32& BytesRead, ESocketReceiveFlags::Type Flags)
@@ -616,6 +695,15 @@ bool FSocketEOS::Close(const FInternetAddrEOS& RemoteAddress)
 		return false;
 	}
 
+	// Deliver what was sent before closing
+	const FInternetAddrEOS PeerAddress = MakePeerAddress(RemoteAddress);
+	FPeer* Peer = Peers.Find(PeerAddress);
+	ISocketEOSTransport* Transport = SocketSubsystem.GetTransport();
+	if (Peer != nullptr && Transport != nullptr)
+	{
+		FlushPeer(*Transport, PeerAddress, *Peer);
+	}
+
 #if WITH_EOS_SDK
 	// So we don't reopen a connection by sending to it
 	ClosedRemotes.Add(RemoteAddress);
@@ -671,8 +759,80 @@ void FSocketEOS::RegisterClosedNotification()
 		FInternetAddrEOS RemoteAddress(Info->RemoteUserId, Info->SocketId->SocketName, LocalAddress.GetChannel());
 		RemoteAddress.SetLocalUserId(LocalAddress.GetLocalUserId());
 		ClosedRemotes.Add(RemoteAddress);
+		if (FPeer* Peer = Peers.Find(MakePeerAddress(RemoteAddress)))
+		{
+			// Nothing queued can be delivered anymore
+			Peer->SendQueue.Reset();
+			Peer->Stats.QueuedPackets = 0;
+		}
 		NP_LOG(TEXT("[%s] - Close connection received for remote address (%s)\r\n"), GetLogPrefix(), *RemoteAddress.ToString(true));
 	};
 	ClosedNotifyId = EOS_P2P_AddNotifyPeerConnectionClosed(SocketSubsystem.GetP2PHandle(), &Options, ClosedNotifyCallback, ClosedNotifyCallback->GetCallbackPtr());
 #endif
 }
+
+void FSocketEOS::FlushSendQueue()
+{
+	check(IsInGameThread() && "p2p does not support multithreading");
+
+	ISocketEOSTransport* Transport = SocketSubsystem.GetTransport();
+	if (Transport == nullptr)
+	{
+		return;
+	}
+
+	for (TPair<FInternetAddrEOS, FPeer>& Peer : Peers)
+	{
+		FlushPeer(*Transport, Peer.Key, Peer.Value);
+	}
+}
+
+ESocketErrors FSocketEOS::FlushPeer(ISocketEOSTransport& Transport, const FInternetAddrEOS& RemoteAddress, FPeer& Peer)
+{
+	if (Peer.SendQueue.Num() == 0)
+	{
+		return ESocketErrors::SE_NO_ERROR;
+	}
+
+	Peer.Stats.TransportPacketsSent++;
+	const ESocketErrors Error = Transport.SendPacket(LocalAddress, RemoteAddress, Peer.SendQueue.GetData(), Peer.SendQueue.Num());
+	Peer.SendQueue.Reset();
+	Peer.Stats.QueuedPackets = 0;
+	if (Error != ESocketErrors::SE_NO_ERROR)
+	{
+		SocketSubsystem.SetLastSocketError(Error);
+	}
+	return Error;
+}
+
+FInternetAddrEOS FSocketEOS::MakePeerAddress(const FInternetAddrEOS& RemoteAddress) const
+{
+	FInternetAddrEOS PeerAddress = RemoteAddress;
+	PeerAddress.SetLocalUserId(LocalAddress.GetLocalUserId());
+	return PeerAddress;
+}
+
+TMap<FInternetAddrEOS, FSocketEOSPeerStats> FSocketEOS::GetPeerStats() const
+{
+	TMap<FInternetAddrEOS, FSocketEOSPeerStats> PeerStats;
+	PeerStats.Reserve(Peers.Num());
+	for (const TPair<FInternetAddrEOS, FPeer>& Peer : Peers)
+	{
+		PeerStats.Add(Peer.Key, Peer.Value.Stats);
+	}
+	return PeerStats;
+}
+
+void FSocketEOS::DumpStats(FOutputDevice& Out) const
+{
+	Out.Logf(TEXT("Socket (%s) peers (%d) pending received packets (%d) peak received batch (%d)"), *LocalAddress.ToString(true), Peers.Num(), ReceivedPackets.Num() - NextReceivedPacket, PeakReceivedPackets);
+	for (const TPair<FInternetAddrEOS, FPeer>& Peer : Peers)
+	{
+		const FSocketEOSPeerStats& Stats = Peer.Value.Stats;
+		Out.Logf(TEXT("  (%s) sent (%llu packets, %llu bytes, %llu p2p packets) received (%llu packets, %llu bytes, %llu p2p packets) queued (%d, peak %d)"),
+			*Peer.Key.ToString(true),
+			Stats.PacketsSent, Stats.BytesSent, Stats.TransportPacketsSent,
+			Stats.PacketsReceived, Stats.BytesReceived, Stats.TransportPacketsReceived,
+			Stats.QueuedPackets, Stats.PeakQueuedPackets);
+	}
+}
@@ -0,0 +1,172 @@
+//Copyright (c) 2023 Betide Studio. All Rights Reserved.
+
+#include "SocketEOSTransport.h"
+#include "SocketEIK.h"
+#include "EOSSharedTypes.h"
+
+#if WITH_EOS_SDK
+	#include "eos_p2p.h"
+#endif
+
+#if WITH_EOS_SDK
+FSocketEOSTransportSDK::FSocketEOSTransportSDK(EOS_HP2P InP2PHandle)
+	: P2PHandle(InP2PHandle)
+{
+}
+
+ESocketErrors FSocketEOSTransportSDK::SendPacket(const FInternetAddrEOS& LocalAddress, const FInternetAddrEOS& RemoteAddress, const uint8* Data, int32 Count)
+{
+	EOS_P2P_SocketId SocketId = { };
+	SocketId.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
+	FCStringAnsi::Strcpy(SocketId.SocketName, RemoteAddress.GetSocketName());
+
+	EOS_P2P_SendPacketOptions Options = { };
+	Options.ApiVersion = EOS_P2P_SENDPACKET_API_LATEST;
+	Options.LocalUserId = LocalAddress.GetLocalUserId();
+	Options.RemoteUserId = RemoteAddress.GetRemoteUserId();
+	Options.SocketId = &SocketId;
+	Options.bAllowDelayedDelivery = EOS_TRUE;
+	Options.Reliability = EOS_EPacketReliability::EOS_PR_UnreliableUnordered;
+	Options.Channel = RemoteAddress.GetChannel();
+	Options.DataLengthBytes = Count;
+	Options.Data = Data;
+	EOS_EResult Result = EOS_P2P_SendPacket(P2PHandle, &Options);
+	NP_LOG(TEXT("[%s] - EOS_P2P_SendPacket() to (%s) result code = (%s)\r\n"), GetLogPrefix(), *RemoteAddress.ToString(true), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+	if (Result != EOS_EResult::EOS_Success)
+	{
+		UE_LOG(LogSocketSubsystemEOS, Error, TEXT("Unable to send data to (%s) result code = (%s)"), *RemoteAddress.ToString(true), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+
+		// @todo joeg - map EOS codes to UE4's
+		return ESocketErrors::SE_EINVAL;
+	}
+	return ESocketErrors::SE_NO_ERROR;
+}
+
+ESocketErrors FSocketEOSTransportSDK::ReceivePacket(const FInternetAddrEOS& LocalAddress, uint8* Data, int32 BufferSize, int32& OutBytesRead, FInternetAddrEOS& OutSource)
+{
+	EOS_P2P_ReceivePacketOptions Options = { };
+	Options.ApiVersion = EOS_P2P_RECEIVEPACKET_API_LATEST;
+	Options.LocalUserId = LocalAddress.GetLocalUserId();
+	Options.MaxDataSizeBytes = BufferSize;
+	uint8 Channel = LocalAddress.GetChannel();
+	Options.RequestedChannel = &Channel;
+
+	EOS_ProductUserId RemoteUserId = nullptr;
+	EOS_P2P_SocketId SocketId;
+
+	EOS_EResult Result = EOS_P2P_ReceivePacket(P2PHandle, &Options, &RemoteUserId, &SocketId, &Channel, Data, (uint32*)&OutBytesRead);
+	NP_LOG(TEXT("[%s] - EOS_P2P_ReceivePacket() for user (%s) and channel (%d) with result code = (%s)\r\n"), GetLogPrefix(), *MakeStringFromProductUserId(LocalAddress.GetLocalUserId()), Channel, ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+	if (Result == EOS_EResult::EOS_NotFound)
+	{
+		// No data to read
+		return ESocketErrors::SE_EWOULDBLOCK;
+	}
+	else if (Result != EOS_EResult::EOS_Success)
+	{
+		UE_LOG(LogSocketSubsystemEOS, Error, TEXT("Unable to receive data result code = (%s)"), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+
+		// @todo joeg - map EOS codes to UE4's
+		return ESocketErrors::SE_EINVAL;
+	}
+
+	OutSource.SetLocalUserId(LocalAddress.GetLocalUserId());
+	OutSource.SetRemoteUserId(RemoteUserId);
+	OutSource.SetSocketName(SocketId.SocketName);
+	OutSource.SetChannel(Channel);
+	return ESocketErrors::SE_NO_ERROR;
+}
+
+ESocketErrors FSocketEOSTransportSDK::GetNextPacketSize(const FInternetAddrEOS& LocalAddress, uint32& OutPacketSize)
+{
+	EOS_P2P_GetNextReceivedPacketSizeOptions Options = { };
+	Options.ApiVersion = EOS_P2P_GETNEXTRECEIVEDPACKETSIZE_API_LATEST;
+	Options.LocalUserId = LocalAddress.GetLocalUserId();
+	uint8 Channel = LocalAddress.GetChannel();
+	Options.RequestedChannel = &Channel;
+
+	EOS_EResult Result = EOS_P2P_GetNextReceivedPacketSize(P2PHandle, &Options, &OutPacketSize);
+	if (Result == EOS_EResult::EOS_NotFound)
+	{
+		return ESocketErrors::SE_EWOULDBLOCK;
+	}
+	if (Result != EOS_EResult::EOS_Success)
+	{
+		UE_LOG(LogSocketSubsystemEOS, Warning, TEXT("Unable to check for data on address (%s) result code = (%s)"), *LocalAddress.ToString(true), ANSI_TO_TCHAR(EOS_EResult_ToString(Result)));
+
+		// @todo joeg - map EOS codes to UE4's
+		return ESocketErrors::SE_EINVAL;
+	}
+	return ESocketErrors::SE_NO_ERROR;
+}
+#endif
+
+namespace
+{
+	/** Receivers are matched on their user id and channel only, like the EOS p2p interface does */
+	FInternetAddrEOS MakeLoopbackKey(const FInternetAddrEOS& Address, bool bUseRemoteUser)
+	{
+		FInternetAddrEOS Key;
+		Key.SetLocalUserId(bUseRemoteUser ? Address.GetRemoteUserId() : Address.GetLocalUserId());
+		Key.SetChannel(Address.GetChannel());
+		return Key;
+	}
+}
+
+ESocketErrors FSocketEOSTransportLoopback::SendPacket(const FInternetAddrEOS& LocalAddress, const FInternetAddrEOS& RemoteAddress, const uint8* Data, int32 Count)
+{
+	FPacketQueue& Queue = Queues.FindOrAdd(MakeLoopbackKey(RemoteAddress, true));
+	FPacket& Packet = Queue.Packets.AddDefaulted_GetRef();
+	Packet.Source.SetRemoteUserId(LocalAddress.GetLocalUserId());
+	Packet.Source.SetSocketName(RemoteAddress.GetSocketName());
+	Packet.Source.SetChannel(RemoteAddress.GetChannel());
+	Packet.Data.Append(Data, Count);
+	return ESocketErrors::SE_NO_ERROR;
+}
+
+ESocketErrors FSocketEOSTransportLoopback::ReceivePacket(const FInternetAddrEOS& LocalAddress, uint8* Data, int32 BufferSize, int32& OutBytesRead, FInternetAddrEOS& OutSource)
+{
+	FPacketQueue* Queue = FindQueue(LocalAddress);
+	if (Queue == nullptr)
+	{
+		return ESocketErrors::SE_EWOULDBLOCK;
+	}
+
+	const FPacket& Packet = Queue->Packets[Queue->Head];
+	if (Packet.Data.Num() > BufferSize)
+	{
+		return ESocketErrors::SE_EMSGSIZE;
+	}
+	FMemory::Memcpy(Data, Packet.Data.GetData(), Packet.Data.Num());
+	OutBytesRead = Packet.Data.Num();
+	OutSource = Packet.Source;
+	OutSource.SetLocalUserId(LocalAddress.GetLocalUserId());
+
+	// The queue is compacted once drained, so receiving stays cheap with many packets pending
+	if (++Queue->Head == Queue->Packets.Num())
+	{
+		Queue->Packets.Reset();
+		Queue->Head = 0;
+	}
+	return ESocketErrors::SE_NO_ERROR;
+}
+
+ESocketErrors FSocketEOSTransportLoopback::GetNextPacketSize(const FInternetAddrEOS& LocalAddress, uint32& OutPacketSize)
+{
+	FPacketQueue* Queue = FindQueue(LocalAddress);
+	if (Queue == nullptr)
+	{
+		return ESocketErrors::SE_EWOULDBLOCK;
+	}
+	OutPacketSize = Queue->Packets[Queue->Head].Data.Num();
+	return ESocketErrors::SE_NO_ERROR;
+}
+
+FSocketEOSTransportLoopback::FPacketQueue* FSocketEOSTransportLoopback::FindQueue(const FInternetAddrEOS& LocalAddress)
+{
+	FPacketQueue* Queue = Queues.Find(MakeLoopbackKey(LocalAddress, false));
+	if (Queue == nullptr || Queue->Head == Queue->Packets.Num())
+	{
+		return nullptr;
+	}
+	return Queue;
+}
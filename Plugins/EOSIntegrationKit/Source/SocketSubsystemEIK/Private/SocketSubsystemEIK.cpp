@@ -3,9 +3,11 @@
 #include "SocketSubsystemEIK.h"
 #include "InternetAddrEIK.h"
 #include "SocketEIK.h"
+#include "SocketEOSTransport.h"
 #include "SocketTypes.h"
 #include "Containers/Ticker.h"
 #include "Misc/ConfigCacheIni.h"
+#include "HAL/IConsoleManager.h"
 #include "SocketSubsystemModule.h"
 #include "Modules/ModuleManager.h"
 #include "Misc/OutputDeviceRedirector.h"
@@ -18,6 +20,11 @@
 TArray<FSocketSubsystemEIK*> FSocketSubsystemEIK::SocketSubsystemEOSInstances;
 TMap<UWorld*, FSocketSubsystemEIK*> FSocketSubsystemEIK::SocketSubsystemEOSPerWorldMap;
 
+static FAutoConsoleCommandWithOutputDevice CmdDumpP2PStats(
+	TEXT("EIK.P2P.DumpStats"),
+	TEXT("Prints the packet counters and queue depths of every EOS p2p socket."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FSocketSubsystemEIK::DumpStats));
+
 FSocketSubsystemEIK::FSocketSubsystemEIK(IEOSPlatformHandlePtr InPlatformHandle, ISocketSubsystemEOSUtilsPtr InUtils)
 	: P2PHandle(nullptr)
 	, Utils(InUtils)
@@ -29,6 +36,10 @@ FSocketSubsystemEIK::FSocketSubsystemEIK(IEOSPlatformHandlePtr InPlatformHandle,
 	{
 		UE_LOG(LogSocketSubsystemEOS, Error, TEXT("FOnlineSubsystemEOS: failed to init EOS platform, couldn't get p2p handle"));
 	}
+	else
+	{
+		Transport = MakeShared<FSocketEOSTransportSDK>(P2PHandle);
+	}
 #endif
 }
 
@@ -204,6 +215,27 @@ EOS_ProductUserId FSocketSubsystemEIK::GetLocalUserId()
 }
 #endif
 
+ISocketEOSTransport* FSocketSubsystemEIK::GetTransport() const
+{
+	return Transport.Get();
+}
+
+void FSocketSubsystemEIK::SetTransport(const TSharedPtr<ISocketEOSTransport>& InTransport)
+{
+	Transport = InTransport;
+}
+
+void FSocketSubsystemEIK::DumpStats(FOutputDevice& Out)
+{
+	for (const FSocketSubsystemEIK* SocketSubsystem : SocketSubsystemEOSInstances)
+	{
+		for (const TUniquePtr<FSocketEOS>& Socket : SocketSubsystem->TrackedSockets)
+		{
+			Socket->DumpStats(Out);
+		}
+	}
+}
+
 TSharedRef<FInternetAddr> FSocketSubsystemEIK::GetLocalBindAddr(const UWorld* const OwningWorld, FOutputDevice& Out)
 {
 	TSharedRef<FInternetAddrEOS> BoundAddr = MakeShared<FInternetAddrEOS>();
@@ -23,6 +23,7 @@ public:
 	virtual ISocketSubsystem* GetSocketSubsystem() override;
 	virtual void Shutdown() override;
 	virtual int GetClientPort() override;
+	virtual void TickFlush(float DeltaSeconds) override;
 //~ End UNetDriver Interface
 
 	UWorld* FindWorld() const;
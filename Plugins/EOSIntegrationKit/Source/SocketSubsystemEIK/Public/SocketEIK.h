@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Sockets.h"
 #include "InternetAddrEIK.h"
+#include "SocketEOSTransport.h"
 #include "EOSSharedTypes.h"
 
 class FOnlineSubsystemEOS;
@@ -16,6 +17,7 @@ class FSocketSubsystemEIK;
 	#define NP_LOG(Msg, ...) NpLog(*FString::Printf(Msg, __VA_ARGS__))
 
 	void NpLog(const TCHAR* Msg);
+	const TCHAR* GetLogPrefix();
 #else
 	#define NP_LOG(Msg, ...)
 #endif
@@ -24,6 +26,23 @@ class FSocketSubsystemEIK;
 	#include "eos_p2p_types.h"
 #endif
 
+/** Traffic counters of a socket for one remote peer */
+struct FSocketEOSPeerStats
+{
+	/** Packets and bytes passed to SendTo */
+	uint64 PacketsSent = 0;
+	uint64 BytesSent = 0;
+	/** Packets and bytes returned by RecvFrom */
+	uint64 PacketsReceived = 0;
+	uint64 BytesReceived = 0;
+	/** Packets that went through the transport, fewer than the above when sends are coalesced */
+	uint64 TransportPacketsSent = 0;
+	uint64 TransportPacketsReceived = 0;
+	/** Packets waiting in the send queue of the peer, and the most there has been */
+	int32 QueuedPackets = 0;
+	int32 PeakQueuedPackets = 0;
+};
+
 class SOCKETSUBSYSTEMEIK_API FSocketEOS
 	: public FSocket
 {
@@ -73,13 +92,43 @@ public:
 
 	bool WasClosed(const FInternetAddrEOS& RemoteAddress)
 	{
-		int32 Index = -1;
-		return ClosedRemotes.Find(RemoteAddress, Index);
+		return ClosedRemotes.Contains(RemoteAddress);
 	}
 
 	void RegisterClosedNotification();
 
+	/** Sends the packets coalesced since the last flush, called by the net driver once per frame */
+	void FlushSendQueue();
+
+	/** Returns the traffic counters of every peer this socket exchanged packets with */
+	TMap<FInternetAddrEOS, FSocketEOSPeerStats> GetPeerStats() const;
+
+	void DumpStats(FOutputDevice& Out) const;
+
 private:
+	struct FPeer
+	{
+		FSocketEOSPeerStats Stats;
+		/** Length prefixed packets waiting to be sent together */
+		TArray<uint8> SendQueue;
+	};
+
+	struct FReceivedPacket
+	{
+		FInternetAddrEOS Source;
+		int32 Offset;
+		int32 Size;
+	};
+
+	/** Reads all the pending packets from the transport, returns SE_EWOULDBLOCK if there were none */
+	ESocketErrors ReceivePackets(ISocketEOSTransport& Transport);
+
+	ESocketErrors FlushPeer(ISocketEOSTransport& Transport, const FInternetAddrEOS& RemoteAddress, FPeer& Peer);
+
+	/** Returns the peer address as used for the keys of Peers */
+	FInternetAddrEOS MakePeerAddress(const FInternetAddrEOS& RemoteAddress) const;
+
+
 	/** Used to track our aliveness and make it possible to use the callback interface */
 	TSharedPtr<FCallbackBase> CallbackAliveTracker;
 
@@ -92,7 +141,20 @@ private:
 	/** Are we currently listening? */
 	bool bIsListening;
 
-	TArray<FInternetAddrEOS> ClosedRemotes;
+	TSet<FInternetAddrEOS> ClosedRemotes;
+
+	/** Send queues and counters of the remote peers */
+	TMap<FInternetAddrEOS, FPeer> Peers;
+
+	/** Packets read from the transport and not returned by RecvFrom yet, their data lives in ReceiveBuffer */
+	TArray<FReceivedPacket> ReceivedPackets;
+	int32 NextReceivedPacket;
+
+	/** Storage of the received packets, kept between the batches so receiving does not allocate */
+	TArray<uint8> ReceiveBuffer;
+
+	/** The most packets received in one batch */
+	int32 PeakReceivedPackets;
 
 #if WITH_EOS_SDK
 	typedef TEIKGlobalCallback<EOS_P2P_OnIncomingConnectionRequestCallback, EOS_P2P_OnIncomingConnectionRequestInfo, FCallbackBase> FConnectNotifyCallback;
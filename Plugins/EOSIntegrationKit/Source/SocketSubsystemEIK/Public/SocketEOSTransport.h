@@ -0,0 +1,98 @@
+//Copyright (c) 2023 Betide Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SocketTypes.h"
+#include "InternetAddrEIK.h"
+
+#if WITH_EOS_SDK
+	#include "eos_p2p_types.h"
+
+	#define EIK_P2P_MAX_PACKET_SIZE EOS_P2P_MAX_PACKET_SIZE
+#else
+	#define EIK_P2P_MAX_PACKET_SIZE 1170
+#endif
+
+/**
+ * The p2p packet calls made by FSocketEOS.
+ * The SDK implementation is used by default, the loopback one lets the sockets run without the EOS service.
+ */
+class SOCKETSUBSYSTEMEIK_API ISocketEOSTransport
+{
+public:
+	virtual ~ISocketEOSTransport() = default;
+
+	/**
+	 * Sends one packet from the local user of LocalAddress to the remote user of RemoteAddress
+	 *
+	 * @return SE_NO_ERROR if the packet was queued for sending
+	 */
+	virtual ESocketErrors SendPacket(const FInternetAddrEOS& LocalAddress, const FInternetAddrEOS& RemoteAddress, const uint8* Data, int32 Count) = 0;
+
+	/**
+	 * Receives the next packet for the local user and channel of LocalAddress
+	 *
+	 * @return SE_EWOULDBLOCK if there is no packet to receive
+	 */
+	virtual ESocketErrors ReceivePacket(const FInternetAddrEOS& LocalAddress, uint8* Data, int32 BufferSize, int32& OutBytesRead, FInternetAddrEOS& OutSource) = 0;
+
+	/**
+	 * Gets the size of the next packet for the local user and channel of LocalAddress
+	 *
+	 * @return SE_EWOULDBLOCK if there is no packet to receive
+	 */
+	virtual ESocketErrors GetNextPacketSize(const FInternetAddrEOS& LocalAddress, uint32& OutPacketSize) = 0;
+};
+
+#if WITH_EOS_SDK
+/** Sends and receives the packets through the EOS p2p interface */
+class SOCKETSUBSYSTEMEIK_API FSocketEOSTransportSDK
+	: public ISocketEOSTransport
+{
+public:
+	explicit FSocketEOSTransportSDK(EOS_HP2P InP2PHandle);
+
+	//~ Begin ISocketEOSTransport Interface
+	virtual ESocketErrors SendPacket(const FInternetAddrEOS& LocalAddress, const FInternetAddrEOS& RemoteAddress, const uint8* Data, int32 Count) override;
+	virtual ESocketErrors ReceivePacket(const FInternetAddrEOS& LocalAddress, uint8* Data, int32 BufferSize, int32& OutBytesRead, FInternetAddrEOS& OutSource) override;
+	virtual ESocketErrors GetNextPacketSize(const FInternetAddrEOS& LocalAddress, uint32& OutPacketSize) override;
+	//~ End ISocketEOSTransport Interface
+
+private:
+	EOS_HP2P P2PHandle;
+};
+#endif
+
+/**
+ * Delivers the packets in process, to the socket bound to the remote user id and channel of the destination.
+ * Set it on the socket subsystems of both ends to benchmark the sockets and net drivers without the EOS service.
+ */
+class SOCKETSUBSYSTEMEIK_API FSocketEOSTransportLoopback
+	: public ISocketEOSTransport
+{
+public:
+	//~ Begin ISocketEOSTransport Interface
+	virtual ESocketErrors SendPacket(const FInternetAddrEOS& LocalAddress, const FInternetAddrEOS& RemoteAddress, const uint8* Data, int32 Count) override;
+	virtual ESocketErrors ReceivePacket(const FInternetAddrEOS& LocalAddress, uint8* Data, int32 BufferSize, int32& OutBytesRead, FInternetAddrEOS& OutSource) override;
+	virtual ESocketErrors GetNextPacketSize(const FInternetAddrEOS& LocalAddress, uint32& OutPacketSize) override;
+	//~ End ISocketEOSTransport Interface
+
+private:
+	struct FPacket
+	{
+		FInternetAddrEOS Source;
+		TArray<uint8> Data;
+	};
+
+	struct FPacketQueue
+	{
+		TArray<FPacket> Packets;
+		int32 Head = 0;
+	};
+
+	FPacketQueue* FindQueue(const FInternetAddrEOS& LocalAddress);
+
+	/** Pending packets keyed by the receiving user id and channel */
+	TMap<FInternetAddrEOS, FPacketQueue> Queues;
+};
@@ -26,6 +26,7 @@ class FResolveInfo;
 class FInternetAddr;
 class FInternetAddrEOS;
 class FSocketEOS;
+class ISocketEOSTransport;
 
 typedef TSet<uint8> FChannelSet;
 
@@ -66,6 +67,20 @@ public:
 	EOS_ProductUserId GetLocalUserId();
 #endif
 
+	/** Returns the transport the sockets send and receive their packets with, null if there is none */
+	ISocketEOSTransport* GetTransport() const;
+
+	/**
+	 * Replaces the transport of the sockets, e.g. with a FSocketEOSTransportLoopback shared by several subsystems for benchmarks.
+	 * Should be set before any socket is bound.
+	 *
+	 * @param InTransport The new transport
+	 */
+	void SetTransport(const TSharedPtr<ISocketEOSTransport>& InTransport);
+
+	/** Prints the traffic counters of every socket of every instance */
+	static void DumpStats(FOutputDevice& Out);
+
 	/**
 	 * Bind our socket name & channel and ensure no other connections are using this combination
 	 *
@@ -101,6 +116,9 @@ private:
 #endif
 	ISocketSubsystemEOSUtilsPtr Utils;
 
+	/** The p2p packet calls of our sockets, the EOS SDK unless replaced */
+	TSharedPtr<ISocketEOSTransport> Transport;
+
 	/** All sockets allocated by this subsystem */
 	TArray<TUniquePtr<FSocketEOS>> TrackedSockets;
 
@@ -3,6 +3,7 @@
 */
 
 #include "DynamoDBClientObject.h"
+#include "DynamoDBGetItemBatcher.h"
 #include "DynamoDBGlobals.h"
 #include "DynamoDBPrivatePCH.h"
 
@@ -206,11 +207,18 @@ UDynamoDBClientObject *UDynamoDBClientObject::CreateDynamoDBObject(
     DynamoDBClient->awsDynamoDBClient = new Aws::DynamoDB::DynamoDBClient(credentials.toAWS(),
     Aws::MakeShared<Aws::DynamoDB::DynamoDBEndpointProvider>("unreal"),
     clientConfiguration.toAWS());
+    DynamoDBClient->getItemBatcher = MakeShared<FDynamoDBGetItemBatcher>(DynamoDBClient->awsDynamoDBClient);
     return DynamoDBClient;
 #endif
     return nullptr;
 }
 
+void UDynamoDBClientObject::ClearItemCache() {
+#if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+    this->getItemBatcher->ClearCache();
+#endif
+}
+
 #if WITH_DYNAMODBCLIENTSDK && WITH_CORE
 
 class FBatchExecuteStatementAction : public FPendingLatentAction {
@@ -405,9 +413,12 @@ private:
 
     Aws::DynamoDB::Model::BatchWriteItemOutcomeCallable callable;
 
+    TWeakPtr<FDynamoDBGetItemBatcher> getItemBatcher;
+
 public:
     FBatchWriteItemAction(
         Aws::DynamoDB::DynamoDBClient *DynamoDBClient,
+        TWeakPtr<FDynamoDBGetItemBatcher> GetItemBatcher,
         bool &success,
         FBatchWriteItemRequest batchWriteItemRequest,
         FBatchWriteItemResult &batchWriteItemResult,
@@ -417,7 +428,7 @@ public:
     )
     : success(success), batchWriteItemResult(batchWriteItemResult), errorType(errorType), errorMessage(errorMessage),
     ExecutionFunction(LatentInfo.ExecutionFunction),
-    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget) {
+    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget), getItemBatcher(GetItemBatcher) {
 
         callable = DynamoDBClient->BatchWriteItemCallable(batchWriteItemRequest.toAWS());
     }
@@ -426,6 +437,11 @@ public:
         if (callable.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             auto awsBatchWriteItemOutcome = callable.get();
 
+            // Reads that completed while the batch was being written may have cached old items
+            if (TSharedPtr<FDynamoDBGetItemBatcher> batcher = getItemBatcher.Pin()) {
+                batcher->ClearCache();
+            }
+
             success = awsBatchWriteItemOutcome.IsSuccess();
                 if (success) {
                     batchWriteItemResult.fromAWS(awsBatchWriteItemOutcome.GetResult());
@@ -463,12 +479,16 @@ UDynamoDBClientObject::BatchWriteItem(
         struct FLatentActionInfo LatentInfo
 ) {
 #if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+    // The written keys are not tracked here, the whole GetItem cache is dropped
+    this->getItemBatcher->ClearCache();
+
     // Prepare latent action
     if (UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::Assert)) {
         FLatentActionManager &LatentActionManager = World->GetLatentActionManager();
         if (LatentActionManager.FindExistingAction<FBatchWriteItemAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == NULL) {
             LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID,
                 new FBatchWriteItemAction(this->awsDynamoDBClient,
+                this->getItemBatcher,
                 success,
                 batchWriteItemRequest,
                 batchWriteItemResult,
@@ -855,9 +875,14 @@ private:
 
     Aws::DynamoDB::Model::DeleteItemOutcomeCallable callable;
 
+    TWeakPtr<FDynamoDBGetItemBatcher> getItemBatcher;
+    FString tableName;
+    TMap<FString, FDynamoDBAttributeValue> key;
+
 public:
     FDeleteItemAction(
         Aws::DynamoDB::DynamoDBClient *DynamoDBClient,
+        TWeakPtr<FDynamoDBGetItemBatcher> GetItemBatcher,
         bool &success,
         FDeleteItemRequest deleteItemRequest,
         FDeleteItemResult &deleteItemResult,
@@ -867,7 +892,8 @@ public:
     )
     : success(success), deleteItemResult(deleteItemResult), errorType(errorType), errorMessage(errorMessage),
     ExecutionFunction(LatentInfo.ExecutionFunction),
-    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget) {
+    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget), getItemBatcher(GetItemBatcher),
+    tableName(deleteItemRequest.tableName), key(deleteItemRequest.key) {
 
         callable = DynamoDBClient->DeleteItemCallable(deleteItemRequest.toAWS());
     }
@@ -876,6 +902,11 @@ public:
         if (callable.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             auto awsDeleteItemOutcome = callable.get();
 
+            // Drop what a GetItem racing the delete may have cached
+            if (TSharedPtr<FDynamoDBGetItemBatcher> batcher = getItemBatcher.Pin()) {
+                batcher->InvalidateItem(tableName, key);
+            }
+
             success = awsDeleteItemOutcome.IsSuccess();
                 if (success) {
                     deleteItemResult.fromAWS(awsDeleteItemOutcome.GetResult());
@@ -913,12 +944,15 @@ UDynamoDBClientObject::DeleteItem(
         struct FLatentActionInfo LatentInfo
 ) {
 #if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+    this->getItemBatcher->InvalidateItem(deleteItemRequest.tableName, deleteItemRequest.key);
+
     // Prepare latent action
     if (UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::Assert)) {
         FLatentActionManager &LatentActionManager = World->GetLatentActionManager();
         if (LatentActionManager.FindExistingAction<FDeleteItemAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == NULL) {
             LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID,
                 new FDeleteItemAction(this->awsDynamoDBClient,
+                this->getItemBatcher,
                 success,
                 deleteItemRequest,
                 deleteItemResult,
@@ -2653,11 +2687,11 @@ private:
     int32 OutputLink;
     FWeakObjectPtr CallbackTarget;
 
-    Aws::DynamoDB::Model::GetItemOutcomeCallable callable;
+    TSharedRef<FDynamoDBGetItemTicket> ticket;
 
 public:
     FGetItemAction(
-        Aws::DynamoDB::DynamoDBClient *DynamoDBClient,
+        FDynamoDBGetItemBatcher &GetItemBatcher,
         bool &success,
         FGetItemRequest getItemRequest,
         FGetItemResult &getItemResult,
@@ -2667,14 +2701,13 @@ public:
     )
     : success(success), getItemResult(getItemResult), errorType(errorType), errorMessage(errorMessage),
     ExecutionFunction(LatentInfo.ExecutionFunction),
-    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget) {
-
-        callable = DynamoDBClient->GetItemCallable(getItemRequest.toAWS());
+    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget),
+    ticket(GetItemBatcher.GetItem(getItemRequest)) {
     }
 
     void UpdateOperation(FLatentResponse &Response) override {
-        if (callable.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-            auto awsGetItemOutcome = callable.get();
+        if (ticket->done) {
+            const auto &awsGetItemOutcome = ticket->outcome;
 
             success = awsGetItemOutcome.IsSuccess();
                 if (success) {
@@ -2717,8 +2750,10 @@ UDynamoDBClientObject::GetItem(
     if (UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::Assert)) {
         FLatentActionManager &LatentActionManager = World->GetLatentActionManager();
         if (LatentActionManager.FindExistingAction<FGetItemAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == NULL) {
+            this->getItemBatcher->batchGetItems = this->batchGetItems;
+            this->getItemBatcher->cacheTimeToLive = this->itemCacheTimeToLive;
             LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID,
-                new FGetItemAction(this->awsDynamoDBClient,
+                new FGetItemAction(*this->getItemBatcher,
                 success,
                 getItemRequest,
                 getItemResult,
@@ -3465,9 +3500,14 @@ private:
 
     Aws::DynamoDB::Model::PutItemOutcomeCallable callable;
 
+    TWeakPtr<FDynamoDBGetItemBatcher> getItemBatcher;
+    FString tableName;
+    TMap<FString, FDynamoDBAttributeValue> item;
+
 public:
     FPutItemAction(
         Aws::DynamoDB::DynamoDBClient *DynamoDBClient,
+        TWeakPtr<FDynamoDBGetItemBatcher> GetItemBatcher,
         bool &success,
         FPutItemRequest putItemRequest,
         FPutItemResult &putItemResult,
@@ -3477,7 +3517,8 @@ public:
     )
     : success(success), putItemResult(putItemResult), errorType(errorType), errorMessage(errorMessage),
     ExecutionFunction(LatentInfo.ExecutionFunction),
-    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget) {
+    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget), getItemBatcher(GetItemBatcher),
+    tableName(putItemRequest.tableName), item(putItemRequest.item) {
 
         callable = DynamoDBClient->PutItemCallable(putItemRequest.toAWS());
     }
@@ -3486,6 +3527,11 @@ public:
         if (callable.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             auto awsPutItemOutcome = callable.get();
 
+            // A GetItem sent while the put was in flight may have cached the previous item
+            if (TSharedPtr<FDynamoDBGetItemBatcher> batcher = getItemBatcher.Pin()) {
+                batcher->InvalidateItem(tableName, item);
+            }
+
             success = awsPutItemOutcome.IsSuccess();
                 if (success) {
                     putItemResult.fromAWS(awsPutItemOutcome.GetResult());
@@ -3523,12 +3569,16 @@ UDynamoDBClientObject::PutItem(
         struct FLatentActionInfo LatentInfo
 ) {
 #if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+    // The next GetItem of the item reads it from DynamoDB again
+    this->getItemBatcher->InvalidateItem(putItemRequest.tableName, putItemRequest.item);
+
     // Prepare latent action
     if (UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::Assert)) {
         FLatentActionManager &LatentActionManager = World->GetLatentActionManager();
         if (LatentActionManager.FindExistingAction<FPutItemAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == NULL) {
             LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID,
                 new FPutItemAction(this->awsDynamoDBClient,
+                this->getItemBatcher,
                 success,
                 putItemRequest,
                 putItemResult,
@@ -4088,9 +4138,12 @@ private:
 
     Aws::DynamoDB::Model::TransactWriteItemsOutcomeCallable callable;
 
+    TWeakPtr<FDynamoDBGetItemBatcher> getItemBatcher;
+
 public:
     FTransactWriteItemsAction(
         Aws::DynamoDB::DynamoDBClient *DynamoDBClient,
+        TWeakPtr<FDynamoDBGetItemBatcher> GetItemBatcher,
         bool &success,
         FTransactWriteItemsRequest transactWriteItemsRequest,
         FTransactWriteItemsResult &transactWriteItemsResult,
@@ -4100,7 +4153,7 @@ public:
     )
     : success(success), transactWriteItemsResult(transactWriteItemsResult), errorType(errorType), errorMessage(errorMessage),
     ExecutionFunction(LatentInfo.ExecutionFunction),
-    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget) {
+    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget), getItemBatcher(GetItemBatcher) {
 
         callable = DynamoDBClient->TransactWriteItemsCallable(transactWriteItemsRequest.toAWS());
     }
@@ -4109,6 +4162,11 @@ public:
         if (callable.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             auto awsTransactWriteItemsOutcome = callable.get();
 
+            // Reads that completed during the transaction may have cached old items
+            if (TSharedPtr<FDynamoDBGetItemBatcher> batcher = getItemBatcher.Pin()) {
+                batcher->ClearCache();
+            }
+
             success = awsTransactWriteItemsOutcome.IsSuccess();
                 if (success) {
                     transactWriteItemsResult.fromAWS(awsTransactWriteItemsOutcome.GetResult());
@@ -4146,12 +4204,16 @@ UDynamoDBClientObject::TransactWriteItems(
         struct FLatentActionInfo LatentInfo
 ) {
 #if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+    // The written keys are not tracked here, the whole GetItem cache is dropped
+    this->getItemBatcher->ClearCache();
+
     // Prepare latent action
     if (UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::Assert)) {
         FLatentActionManager &LatentActionManager = World->GetLatentActionManager();
         if (LatentActionManager.FindExistingAction<FTransactWriteItemsAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == NULL) {
             LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID,
                 new FTransactWriteItemsAction(this->awsDynamoDBClient,
+                this->getItemBatcher,
                 success,
                 transactWriteItemsRequest,
                 transactWriteItemsResult,
@@ -4621,9 +4683,14 @@ private:
 
     Aws::DynamoDB::Model::UpdateItemOutcomeCallable callable;
 
+    TWeakPtr<FDynamoDBGetItemBatcher> getItemBatcher;
+    FString tableName;
+    TMap<FString, FDynamoDBAttributeValue> key;
+
 public:
     FUpdateItemAction(
         Aws::DynamoDB::DynamoDBClient *DynamoDBClient,
+        TWeakPtr<FDynamoDBGetItemBatcher> GetItemBatcher,
         bool &success,
         FUpdateItemRequest updateItemRequest,
         FUpdateItemResult &updateItemResult,
@@ -4633,7 +4700,8 @@ public:
     )
     : success(success), updateItemResult(updateItemResult), errorType(errorType), errorMessage(errorMessage),
     ExecutionFunction(LatentInfo.ExecutionFunction),
-    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget) {
+    OutputLink(LatentInfo.Linkage), CallbackTarget(LatentInfo.CallbackTarget), getItemBatcher(GetItemBatcher),
+    tableName(updateItemRequest.tableName), key(updateItemRequest.key) {
 
         callable = DynamoDBClient->UpdateItemCallable(updateItemRequest.toAWS());
     }
@@ -4642,6 +4710,11 @@ public:
         if (callable.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             auto awsUpdateItemOutcome = callable.get();
 
+            // The item may have been read and cached again while the update was in flight
+            if (TSharedPtr<FDynamoDBGetItemBatcher> batcher = getItemBatcher.Pin()) {
+                batcher->InvalidateItem(tableName, key);
+            }
+
             success = awsUpdateItemOutcome.IsSuccess();
                 if (success) {
                     updateItemResult.fromAWS(awsUpdateItemOutcome.GetResult());
@@ -4679,12 +4752,15 @@ UDynamoDBClientObject::UpdateItem(
         struct FLatentActionInfo LatentInfo
 ) {
 #if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+    this->getItemBatcher->InvalidateItem(updateItemRequest.tableName, updateItemRequest.key);
+
     // Prepare latent action
     if (UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::Assert)) {
         FLatentActionManager &LatentActionManager = World->GetLatentActionManager();
         if (LatentActionManager.FindExistingAction<FUpdateItemAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == NULL) {
             LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID,
                 new FUpdateItemAction(this->awsDynamoDBClient,
+                this->getItemBatcher,
                 success,
                 updateItemRequest,
                 updateItemResult,
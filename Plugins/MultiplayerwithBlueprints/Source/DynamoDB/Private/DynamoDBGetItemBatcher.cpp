@@ -0,0 +1,412 @@
+/* Copyright (C) Siqi.Wu - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ */
+
+#include "DynamoDBGetItemBatcher.h"
+
+#include "DynamoDBGlobals.h"
+
+#if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+
+#include "Misc/CoreDelegates.h"
+
+// The most keys BatchGetItem accepts in one request
+constexpr int32 MAX_BATCH_GET_ITEM_KEYS = 100;
+// Number of times a key left unprocessed is sent again before its GetItems fail
+constexpr int32 MAX_UNPROCESSED_KEY_ATTEMPTS = 5;
+constexpr double UNPROCESSED_KEY_RETRY_DELAY = 0.05;
+
+static FString MakeRequestedKeyString(const FString &keyString, bool consistentRead) {
+    return consistentRead ? keyString + TEXT("\nconsistentRead") : keyString;
+}
+
+// Writes a number as 0.<significant digits>e<exponent>, "1", "1.0", "01" and "10e-1" all become "0.1e1"
+static FString CanonicalizeNumber(const Aws::String &number) {
+    FString text = UTF8_TO_TCHAR(number.c_str());
+    text.TrimStartAndEndInline();
+
+    int32 index = 0;
+    bool negative = false;
+    if (index < text.Len() && (text[index] == TEXT('-') || text[index] == TEXT('+'))) {
+        negative = text[index] == TEXT('-');
+        ++index;
+    }
+
+    FString digits;
+    int32 integerDigits = INDEX_NONE;
+    for (; index < text.Len() && (FChar::IsDigit(text[index]) || text[index] == TEXT('.')); ++index) {
+        if (text[index] == TEXT('.')) {
+            integerDigits = digits.Len();
+        } else {
+            digits.AppendChar(text[index]);
+        }
+    }
+    if (integerDigits == INDEX_NONE) {
+        integerDigits = digits.Len();
+    }
+
+    int64 exponent = 0;
+    if (index < text.Len() && (text[index] == TEXT('e') || text[index] == TEXT('E'))) {
+        exponent = FCString::Atoi64(*text + index + 1);
+        index = text.Len();
+    }
+
+    // Not a number DynamoDB accepts, the request fails anyway
+    if (index != text.Len() || digits.IsEmpty()) {
+        return text;
+    }
+
+    int32 first = 0;
+    while (first < digits.Len() && digits[first] == TEXT('0')) {
+        ++first;
+    }
+    if (first == digits.Len()) {
+        return TEXT("0");
+    }
+    int32 last = digits.Len();
+    while (digits[last - 1] == TEXT('0')) {
+        --last;
+    }
+
+    return FString::Printf(TEXT("%s0.%se%lld"), negative ? TEXT("-") : TEXT(""), *digits.Mid(first, last - first), integerDigits - first + exponent);
+}
+
+FDynamoDBGetItemBatcher::FDynamoDBGetItemBatcher(Aws::DynamoDB::DynamoDBClient *DynamoDBClient)
+: awsDynamoDBClient(DynamoDBClient) {
+    endFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FDynamoDBGetItemBatcher::OnEndFrame);
+}
+
+FDynamoDBGetItemBatcher::~FDynamoDBGetItemBatcher() {
+    FCoreDelegates::OnEndFrame.Remove(endFrameHandle);
+
+    // The latent actions would wait forever otherwise
+    const Aws::DynamoDB::Model::GetItemOutcome awsGetItemOutcome(Aws::DynamoDB::DynamoDBError(Aws::Client::AWSError<Aws::DynamoDB::DynamoDBErrors>(
+        Aws::DynamoDB::DynamoDBErrors::INTERNAL_FAILURE, "ClientDestroyed", "The DynamoDB client object was destroyed", false)));
+    TArray<TSharedPtr<FRequestedKey>> remainingKeys;
+    requestedKeys.GenerateValueArray(remainingKeys);
+    // Keys replaced in requestedKeys after a write are only referenced by their batch
+    for (const FBatch &batch : batches) {
+        remainingKeys.Append(batch.keys);
+    }
+    for (const TSharedPtr<FRequestedKey> &requestedKey : remainingKeys) {
+        CompleteKey(*requestedKey, awsGetItemOutcome);
+    }
+    for (FDirectRequest &directRequest : directRequests) {
+        for (const TSharedRef<FDynamoDBGetItemTicket> &ticket : directRequest.tickets) {
+            ticket->outcome = awsGetItemOutcome;
+            ticket->done = true;
+        }
+    }
+}
+
+TSharedRef<FDynamoDBGetItemTicket> FDynamoDBGetItemBatcher::GetItem(const FGetItemRequest &getItemRequest) {
+    TSharedRef<FDynamoDBGetItemTicket> ticket = MakeShared<FDynamoDBGetItemTicket>();
+    const Aws::DynamoDB::Model::GetItemRequest awsGetItemRequest = getItemRequest.toAWS();
+
+    TArray<FString> keyNames;
+    for (const auto &elem : awsGetItemRequest.GetKey()) {
+        keyNames.Add(UTF8_TO_TCHAR(elem.first.c_str()));
+    }
+    keyNames.Sort();
+
+    // A key that does not have the attributes of the table key fails on its own, it is never merged with other GetItems.
+    // Only whole items can be cached or matched back to their key in a BatchGetItem result.
+    const TArray<FString> *tableKey = tableKeyNames.Find(getItemRequest.tableName);
+    FString keyString;
+    if (tableKey != nullptr && *tableKey == keyNames && getItemRequest.projectionExpression.IsEmpty() && getItemRequest.expressionAttributeNames.Num() == 0) {
+        keyString = MakeKeyString(getItemRequest.tableName, awsGetItemRequest.GetKey());
+    }
+
+    if (cacheTimeToLive > 0.f && !getItemRequest.consistentRead && !keyString.IsEmpty()) {
+        const FCachedItem *cachedItem = cachedItems.Find(keyString);
+        if (cachedItem != nullptr && cachedItem->expireTime > FPlatformTime::Seconds()) {
+            ticket->outcome = Aws::DynamoDB::Model::GetItemOutcome(Aws::DynamoDB::Model::GetItemResult().WithItem(cachedItem->item));
+            ticket->done = true;
+            return ticket;
+        }
+    }
+
+    // BatchGetItem only returns the consumed capacity of the whole batch
+    const bool consumedCapacityRequested = getItemRequest.returnConsumedCapacity == EAWSReturnConsumedCapacity::INDEXES || getItemRequest.returnConsumedCapacity == EAWSReturnConsumedCapacity::TOTAL;
+    if (batchGetItems && !consumedCapacityRequested && !keyString.IsEmpty()) {
+        TSharedPtr<FRequestedKey> &requestedKey = requestedKeys.FindOrAdd(MakeRequestedKeyString(keyString, getItemRequest.consistentRead));
+        // A read sent before the last write can return the old item, the GetItems made after the write do not share it
+        if (!requestedKey.IsValid() || (requestedKey->sent && requestedKey->generation != writeGeneration)) {
+            requestedKey = MakeShared<FRequestedKey>();
+            requestedKey->tableName = getItemRequest.tableName;
+            requestedKey->keyString = keyString;
+            requestedKey->key = awsGetItemRequest.GetKey();
+            requestedKey->consistentRead = getItemRequest.consistentRead;
+            pendingKeys.Add(requestedKey);
+        }
+        requestedKey->tickets.Add(ticket);
+        return ticket;
+    }
+
+    if (tableKey != nullptr) {
+        keyNames.Empty();
+    }
+    directRequests.Add(FDirectRequest{{ticket}, keyString, writeGeneration, awsDynamoDBClient->GetItemCallable(awsGetItemRequest), getItemRequest.tableName, MoveTemp(keyNames)});
+    return ticket;
+}
+
+void FDynamoDBGetItemBatcher::InvalidateItem(const FString &tableName, const TMap<FString, FDynamoDBAttributeValue> &keyOrItem) {
+    ++writeGeneration;
+    if (cachedItems.Num() == 0) {
+        return;
+    }
+
+    // Nothing was cached for a table whose key is unknown
+    const TArray<FString> *keyNames = tableKeyNames.Find(tableName);
+    if (keyNames == nullptr) {
+        return;
+    }
+
+    FAWSItem awsKey;
+    for (const FString &keyName : *keyNames) {
+        if (const FDynamoDBAttributeValue *value = keyOrItem.Find(keyName)) {
+            awsKey[TCHAR_TO_UTF8(*keyName)] = value->toAWS();
+        }
+    }
+
+    const FString keyString = MakeKeyString(tableName, awsKey);
+    if (!keyString.IsEmpty()) {
+        cachedItems.Remove(keyString);
+    } else {
+        const FString tablePrefix = tableName + TEXT("\n");
+        for (auto It = cachedItems.CreateIterator(); It; ++It) {
+            if (It.Key().StartsWith(tablePrefix, ESearchCase::CaseSensitive)) {
+                It.RemoveCurrent();
+            }
+        }
+    }
+}
+
+void FDynamoDBGetItemBatcher::ClearCache() {
+    ++writeGeneration;
+    cachedItems.Empty();
+}
+
+void FDynamoDBGetItemBatcher::OnEndFrame() {
+    PollBatches();
+    PollDirectRequests();
+    SendBatches();
+
+    const double now = FPlatformTime::Seconds();
+    if (cachedItems.Num() > 0 && now >= nextCachePruneTime) {
+        for (auto It = cachedItems.CreateIterator(); It; ++It) {
+            if (It.Value().expireTime <= now) {
+                It.RemoveCurrent();
+            }
+        }
+        nextCachePruneTime = now + FMath::Max(cacheTimeToLive, 1.f);
+    }
+}
+
+void FDynamoDBGetItemBatcher::PollBatches() {
+    for (int32 index = batches.Num() - 1; index >= 0; --index) {
+        if (batches[index].callable.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            continue;
+        }
+
+        const Aws::DynamoDB::Model::BatchGetItemOutcome awsBatchGetItemOutcome = batches[index].callable.get();
+        const TArray<TSharedPtr<FRequestedKey>> keys = MoveTemp(batches[index].keys);
+        const uint64 batchGeneration = batches[index].generation;
+        batches.RemoveAtSwap(index);
+        for (const TSharedPtr<FRequestedKey> &requestedKey : keys) {
+            requestedKey->sent = false;
+        }
+
+        if (!awsBatchGetItemOutcome.IsSuccess()) {
+            LOG_DYNAMODB_WARNING(FString::Printf(TEXT("BatchGetItem of %d keys failed: %s"), keys.Num(), UTF8_TO_TCHAR(awsBatchGetItemOutcome.GetError().GetMessage().c_str())));
+            const Aws::DynamoDB::Model::GetItemOutcome awsGetItemOutcome(awsBatchGetItemOutcome.GetError());
+            for (const TSharedPtr<FRequestedKey> &requestedKey : keys) {
+                CompleteKey(*requestedKey, awsGetItemOutcome);
+            }
+            continue;
+        }
+
+        const Aws::DynamoDB::Model::BatchGetItemResult &awsBatchGetItemResult = awsBatchGetItemOutcome.GetResult();
+
+        TMap<FString, const FAWSItem *> returnedItems;
+        int32 returnedItemCount = 0;
+        for (const auto &response : awsBatchGetItemResult.GetResponses()) {
+            const FString tableName = UTF8_TO_TCHAR(response.first.c_str());
+            for (const FAWSItem &item : response.second) {
+                returnedItems.Add(MakeKeyString(tableName, item), &item);
+                ++returnedItemCount;
+            }
+        }
+
+        TSet<FString> unprocessedKeys;
+        for (const auto &unprocessed : awsBatchGetItemResult.GetUnprocessedKeys()) {
+            const FString tableName = UTF8_TO_TCHAR(unprocessed.first.c_str());
+            for (const FAWSItem &key : unprocessed.second.GetKeys()) {
+                unprocessedKeys.Add(MakeKeyString(tableName, key));
+            }
+        }
+
+        // The keys left out of the result are items that do not exist, unless a returned item could not be matched to its key
+        int32 matchedItemCount = 0;
+        for (const TSharedPtr<FRequestedKey> &requestedKey : keys) {
+            if (returnedItems.Contains(requestedKey->keyString)) {
+                ++matchedItemCount;
+            }
+        }
+        const bool missingKeysKnown = matchedItemCount == returnedItemCount;
+
+        const double now = FPlatformTime::Seconds();
+        for (const TSharedPtr<FRequestedKey> &requestedKey : keys) {
+            if (const FAWSItem *const *item = returnedItems.Find(requestedKey->keyString)) {
+                CacheItem(requestedKey->keyString, **item, batchGeneration);
+                CompleteKey(*requestedKey, Aws::DynamoDB::Model::GetItemOutcome(Aws::DynamoDB::Model::GetItemResult().WithItem(**item)));
+            } else if (unprocessedKeys.Contains(requestedKey->keyString)) {
+                if (++requestedKey->attempts < MAX_UNPROCESSED_KEY_ATTEMPTS) {
+                    requestedKey->retryTime = now + UNPROCESSED_KEY_RETRY_DELAY * (1 << (requestedKey->attempts - 1));
+                    pendingKeys.Add(requestedKey);
+                } else {
+                    CompleteKey(*requestedKey, Aws::DynamoDB::Model::GetItemOutcome(Aws::DynamoDB::DynamoDBError(Aws::Client::AWSError<Aws::DynamoDB::DynamoDBErrors>(
+                        Aws::DynamoDB::DynamoDBErrors::PROVISIONED_THROUGHPUT_EXCEEDED, "ProvisionedThroughputExceededException", "BatchGetItem left the key unprocessed", true))));
+                }
+            } else if (missingKeysKnown) {
+                // BatchGetItem leaves out the items that do not exist, GetItem returns an empty item for them
+                CacheItem(requestedKey->keyString, FAWSItem(), batchGeneration);
+                CompleteKey(*requestedKey, Aws::DynamoDB::Model::GetItemOutcome(Aws::DynamoDB::Model::GetItemResult()));
+            } else {
+                LOG_DYNAMODB_VERBOSE(FString::Printf(TEXT("BatchGetItem returned an item of %s that matches no key, reading the key with GetItem"), *requestedKey->tableName));
+                Aws::DynamoDB::Model::GetItemRequest awsGetItemRequest;
+                awsGetItemRequest.SetTableName(TCHAR_TO_UTF8(*requestedKey->tableName));
+                awsGetItemRequest.SetKey(requestedKey->key);
+                awsGetItemRequest.SetConsistentRead(requestedKey->consistentRead);
+                directRequests.Add(FDirectRequest{MoveTemp(requestedKey->tickets), requestedKey->keyString, batchGeneration, awsDynamoDBClient->GetItemCallable(awsGetItemRequest)});
+                // Only removes the key from requestedKeys, its tickets now belong to the direct request
+                CompleteKey(*requestedKey, Aws::DynamoDB::Model::GetItemOutcome(Aws::DynamoDB::Model::GetItemResult()));
+            }
+        }
+    }
+}
+
+void FDynamoDBGetItemBatcher::PollDirectRequests() {
+    for (int32 index = directRequests.Num() - 1; index >= 0; --index) {
+        FDirectRequest &directRequest = directRequests[index];
+        if (directRequest.callable.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            continue;
+        }
+
+        const Aws::DynamoDB::Model::GetItemOutcome awsGetItemOutcome = directRequest.callable.get();
+        for (const TSharedRef<FDynamoDBGetItemTicket> &ticket : directRequest.tickets) {
+            ticket->outcome = awsGetItemOutcome;
+            ticket->done = true;
+        }
+        // DynamoDB rejects a GetItem whose key is not the table key
+        if (awsGetItemOutcome.IsSuccess() && directRequest.keyNames.Num() > 0 && !tableKeyNames.Contains(directRequest.tableName)) {
+            tableKeyNames.Add(directRequest.tableName, directRequest.keyNames);
+        }
+        if (awsGetItemOutcome.IsSuccess() && !directRequest.keyString.IsEmpty()) {
+            CacheItem(directRequest.keyString, awsGetItemOutcome.GetResult().GetItem(), directRequest.generation);
+        }
+        directRequests.RemoveAtSwap(index);
+    }
+}
+
+void FDynamoDBGetItemBatcher::SendBatches() {
+    if (pendingKeys.Num() == 0) {
+        return;
+    }
+
+    const double now = FPlatformTime::Seconds();
+    TArray<TSharedPtr<FRequestedKey>> readyKeys;
+    pendingKeys.RemoveAll([&readyKeys, now](const TSharedPtr<FRequestedKey> &requestedKey) {
+        if (requestedKey->retryTime <= now) {
+            readyKeys.Add(requestedKey);
+            return true;
+        }
+        return false;
+    });
+    // Every pending key can be waiting for its retry
+    if (readyKeys.Num() == 0) {
+        return;
+    }
+
+    // A table is read with one consistency per request, grouping the strongly consistent reads keeps the batches full
+    readyKeys.StableSort([](const TSharedPtr<FRequestedKey> &A, const TSharedPtr<FRequestedKey> &B) {
+        return !A->consistentRead && B->consistentRead;
+    });
+
+    TArray<TSharedPtr<FRequestedKey>> batchKeys;
+    Aws::Map<Aws::String, Aws::DynamoDB::Model::KeysAndAttributes> awsRequestItems;
+    auto sendBatch = [this, &batchKeys, &awsRequestItems]() {
+        if (batchKeys.Num() == 0) {
+            return;
+        }
+        LOG_DYNAMODB_VERBOSE(FString::Printf(TEXT("Sending BatchGetItem of %d keys"), batchKeys.Num()));
+        Aws::DynamoDB::Model::BatchGetItemRequest awsBatchGetItemRequest;
+        awsBatchGetItemRequest.SetRequestItems(std::move(awsRequestItems));
+        for (const TSharedPtr<FRequestedKey> &requestedKey : batchKeys) {
+            requestedKey->sent = true;
+            requestedKey->generation = writeGeneration;
+        }
+        batches.Add(FBatch{MoveTemp(batchKeys), writeGeneration, awsDynamoDBClient->BatchGetItemCallable(awsBatchGetItemRequest)});
+        awsRequestItems.clear();
+        batchKeys.Reset();
+    };
+
+    for (const TSharedPtr<FRequestedKey> &requestedKey : readyKeys) {
+        const Aws::String awsTableName = TCHAR_TO_UTF8(*requestedKey->tableName);
+        auto found = awsRequestItems.find(awsTableName);
+        if (batchKeys.Num() == MAX_BATCH_GET_ITEM_KEYS || (found != awsRequestItems.end() && found->second.GetConsistentRead() != requestedKey->consistentRead)) {
+            sendBatch();
+            found = awsRequestItems.end();
+        }
+        if (found == awsRequestItems.end()) {
+            Aws::DynamoDB::Model::KeysAndAttributes awsKeysAndAttributes;
+            awsKeysAndAttributes.SetConsistentRead(requestedKey->consistentRead);
+            found = awsRequestItems.emplace(awsTableName, awsKeysAndAttributes).first;
+        }
+        found->second.AddKeys(requestedKey->key);
+        batchKeys.Add(requestedKey);
+    }
+    sendBatch();
+}
+
+void FDynamoDBGetItemBatcher::CompleteKey(FRequestedKey &requestedKey, const Aws::DynamoDB::Model::GetItemOutcome &outcome) {
+    for (const TSharedRef<FDynamoDBGetItemTicket> &ticket : requestedKey.tickets) {
+        ticket->outcome = outcome;
+        ticket->done = true;
+    }
+    requestedKey.tickets.Empty();
+
+    // The key may have been replaced by a read sent after a write
+    const FString requestedKeyString = MakeRequestedKeyString(requestedKey.keyString, requestedKey.consistentRead);
+    const TSharedPtr<FRequestedKey> *found = requestedKeys.Find(requestedKeyString);
+    if (found != nullptr && found->Get() == &requestedKey) {
+        requestedKeys.Remove(requestedKeyString);
+    }
+}
+
+void FDynamoDBGetItemBatcher::CacheItem(const FString &keyString, const FAWSItem &item, uint64 readGeneration) {
+    if (cacheTimeToLive > 0.f && readGeneration == writeGeneration) {
+        cachedItems.Add(keyString, FCachedItem{item, FPlatformTime::Seconds() + cacheTimeToLive});
+    }
+}
+
+FString FDynamoDBGetItemBatcher::MakeKeyString(const FString &tableName, const FAWSItem &keyOrItem) const {
+    const TArray<FString> *keyNames = tableKeyNames.Find(tableName);
+    if (keyNames == nullptr || keyNames->Num() == 0) {
+        return FString();
+    }
+
+    FString keyString = tableName;
+    for (const FString &keyName : *keyNames) {
+        const auto found = keyOrItem.find(TCHAR_TO_UTF8(*keyName));
+        if (found == keyOrItem.end()) {
+            return FString();
+        }
+        const Aws::DynamoDB::Model::AttributeValue &value = found->second;
+        keyString += TEXT("\n") + keyName + TEXT("=");
+        keyString += value.GetType() == Aws::DynamoDB::Model::ValueType::NUMBER ? TEXT("N:") + CanonicalizeNumber(value.GetN()) : FString(UTF8_TO_TCHAR(value.SerializeAttribute().c_str()));
+    }
+    return keyString;
+}
+
+#endif
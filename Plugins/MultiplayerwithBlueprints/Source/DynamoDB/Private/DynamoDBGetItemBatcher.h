@@ -0,0 +1,129 @@
+/* Copyright (C) Siqi.Wu - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DYNAMODBCLIENTSDK && WITH_CORE
+
+#include "Model/GetItemRequest.h"
+
+#include "aws/dynamodb/DynamoDBClient.h"
+
+/**
+* Result of a GetItem sent through FDynamoDBGetItemBatcher, the GetItem latent action polls it.
+**/
+struct FDynamoDBGetItemTicket {
+    bool done = false;
+    Aws::DynamoDB::Model::GetItemOutcome outcome;
+};
+
+/**
+* Sends the GetItem calls of a UDynamoDBClientObject.
+* The GetItems made in the same frame are merged into BatchGetItem requests of up to 100 keys, and the results are fanned back out to each call.
+* A table is batched once a GetItem of it succeeded, that read gives the attributes of its key.
+* The items read can be kept in a local cache for a time to live, the writes made through the same client remove them from it when they are sent and again when they complete.
+* Everything happens on the game thread, the requests are polled at the end of each frame.
+**/
+class FDynamoDBGetItemBatcher {
+public:
+    explicit FDynamoDBGetItemBatcher(Aws::DynamoDB::DynamoDBClient *DynamoDBClient);
+    ~FDynamoDBGetItemBatcher();
+
+    TSharedRef<FDynamoDBGetItemTicket> GetItem(const FGetItemRequest &getItemRequest);
+
+    /**
+    * Removes an item from the cache, the reads in flight are not cached anymore
+    * @param keyOrItem      The primary key of the item, or the whole item
+    **/
+    void InvalidateItem(const FString &tableName, const TMap<FString, FDynamoDBAttributeValue> &keyOrItem);
+
+    void ClearCache();
+
+    /** Merge the GetItems into BatchGetItem requests */
+    bool batchGetItems = true;
+
+    /** Seconds the items read are served from the cache, 0 disables the cache */
+    float cacheTimeToLive = 0.f;
+
+private:
+    typedef Aws::Map<Aws::String, Aws::DynamoDB::Model::AttributeValue> FAWSItem;
+
+    /** One key requested by one or more GetItems */
+    struct FRequestedKey {
+        FString tableName;
+        FString keyString;
+        FAWSItem key;
+        bool consistentRead = false;
+        TArray<TSharedRef<FDynamoDBGetItemTicket>> tickets;
+        /** Number of times BatchGetItem left the key unprocessed */
+        int32 attempts = 0;
+        /** Unprocessed keys are retried with an exponential backoff */
+        double retryTime = 0.0;
+        /** Set while the key is part of a BatchGetItem in flight */
+        bool sent = false;
+        /** writeGeneration when the key was sent */
+        uint64 generation = 0;
+    };
+
+    struct FBatch {
+        TArray<TSharedPtr<FRequestedKey>> keys;
+        uint64 generation;
+        Aws::DynamoDB::Model::BatchGetItemOutcomeCallable callable;
+    };
+
+    struct FDirectRequest {
+        TArray<TSharedRef<FDynamoDBGetItemTicket>> tickets;
+        /** Set when the result is a whole item that can be cached */
+        FString keyString;
+        uint64 generation;
+        Aws::DynamoDB::Model::GetItemOutcomeCallable callable;
+        /** Set when the key schema of the table is not known yet, it is recorded when the read succeeds */
+        FString tableName;
+        TArray<FString> keyNames;
+    };
+
+    struct FCachedItem {
+        FAWSItem item;
+        double expireTime = 0.0;
+    };
+
+    void OnEndFrame();
+    void PollBatches();
+    void PollDirectRequests();
+    void SendBatches();
+
+    void CompleteKey(FRequestedKey &requestedKey, const Aws::DynamoDB::Model::GetItemOutcome &outcome);
+    /** Skipped when a write was sent or completed after the read was sent, the item could be older than the write */
+    void CacheItem(const FString &keyString, const FAWSItem &item, uint64 readGeneration);
+
+    /**
+    * Builds the string identifying an item from the key attributes of its table, the attributes are taken from the key or the whole item.
+    * Numbers are written in a canonical form, DynamoDB does not return them as they were sent.
+    **/
+    FString MakeKeyString(const FString &tableName, const FAWSItem &keyOrItem) const;
+
+    Aws::DynamoDB::DynamoDBClient *awsDynamoDBClient;
+
+    FDelegateHandle endFrameHandle;
+
+    /** Keys waiting to be sent or in flight, keyed by key string and consistency so that concurrent GetItems of the same item share one read */
+    TMap<FString, TSharedPtr<FRequestedKey>> requestedKeys;
+    /** Keys waiting for the next BatchGetItem */
+    TArray<TSharedPtr<FRequestedKey>> pendingKeys;
+    TArray<FBatch> batches;
+    TArray<FDirectRequest> directRequests;
+
+    /** Sorted names of the key attributes of the tables, recorded by the first GetItem of each table that succeeds */
+    TMap<FString, TArray<FString>> tableKeyNames;
+
+    TMap<FString, FCachedItem> cachedItems;
+    double nextCachePruneTime = 0.0;
+
+    /** Incremented by every InvalidateItem and ClearCache */
+    uint64 writeGeneration = 0;
+};
+
+#endif
@@ -137,8 +137,31 @@ class DYNAMODB_API UDynamoDBClientObject : public UObject {
 public:
 #if WITH_DYNAMODBCLIENTSDK && WITH_CORE
     Aws::DynamoDB::DynamoDBClient *awsDynamoDBClient;
+
+    /** Sends the GetItems, see batchGetItems and itemCacheTimeToLive */
+    TSharedPtr<class FDynamoDBGetItemBatcher> getItemBatcher;
 #endif
 
+    /**
+    * Merge the GetItems made in the same frame into BatchGetItem requests of up to 100 keys.
+    * Only the GetItems reading whole items without returning the consumed capacity are merged, the others are sent on their own.
+    **/
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DynamoDB Client")
+    bool batchGetItems = true;
+
+    /**
+    * Seconds the items read by GetItem are served from a local cache, 0 disables the cache.
+    * Strongly consistent reads always go to DynamoDB. PutItem, UpdateItem and DeleteItem remove their item from the cache, BatchWriteItem and TransactWriteItems clear it.
+    **/
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DynamoDB Client")
+    float itemCacheTimeToLive = 0.f;
+
+    /**
+    * Removes all the items from the GetItem cache.
+    **/
+    UFUNCTION(BlueprintCallable, Category = "DynamoDB Client")
+    void ClearItemCache();
+
     /**
     * public static UDynamoDBClientObject::CreateDynamoDBObject
     * Creates a DynamoDBClientObject. This function must be called first before accessing any Dynamo DB client functions.
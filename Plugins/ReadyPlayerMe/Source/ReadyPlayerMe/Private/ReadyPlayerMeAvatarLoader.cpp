@@ -8,9 +8,13 @@
 #include "Storage/AvatarCacheHandler.h"
 #include "ReadyPlayerMeGlbLoader.h"
 #include "Request/AvatarRequest.h"
+#include "Request/AvatarLoadScheduler.h"
 #include "Utils/MetadataExtractor.h"
 #include "Engine/GameInstance.h"
 #include "Engine/World.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
 
 //TODO: Move the timout to the RPMSettings to make it configurable
 constexpr float AVATAR_REQUEST_TIMEOUT = 60.f;
@@ -19,7 +23,7 @@ constexpr float METADATA_REQUEST_TIMEOUT = 20.f;
 UReadyPlayerMeAvatarLoader::UReadyPlayerMeAvatarLoader()
 	: SkeletalMesh(nullptr)
 	, GlbLoader(nullptr)
-	, bIsTryingToUpdate(false)
+	, AvatarTargetSkeleton(nullptr)
 {
 }
 
@@ -37,25 +41,89 @@ void UReadyPlayerMeAvatarLoader::LoadAvatar(const FString& UrlShortcode, UReadyP
 	OnAvatarDownloadCompleted = OnDownloadCompleted;
 	OnAvatarLoadFailed = OnLoadFailed;
 	AvatarUri = FAvatarUrlConvertor::CreateAvatarUri(Url, AvatarConfig);
+	AvatarTargetSkeleton = TargetSkeleton;
+	AvatarSkeletalMeshConfig = SkeletalMeshConfig;
+	const UReadyPlayerMeGameSubsystem* GameSubsystem = UGameInstance::GetSubsystem<UReadyPlayerMeGameSubsystem>(GetWorld()->GetGameInstance());
+	LoadScheduler = GameSubsystem ? GameSubsystem->LoadScheduler : nullptr;
+	if (GameSubsystem && GameSubsystem->MemoryCache)
+	{
+		MemoryCache = GameSubsystem->MemoryCache;
+		JoinedLoadKey = FAvatarMemoryCacheKey(AvatarUri->Guid, AvatarUri->ConfigHash, FAvatarMemoryCacheKey::MakeSkeletalMeshConfigHash(TargetSkeleton, SkeletalMeshConfig));
+		// If the same avatar is already being loaded, the loader downloading it will call us back.
+		if (!MemoryCache->JoinLoad(*JoinedLoadKey, AvatarTargetSkeleton, this))
+		{
+			return;
+		}
+	}
+	ScheduleLoad();
+}
+
+void UReadyPlayerMeAvatarLoader::ScheduleLoad()
+{
+	const TSharedPtr<FAvatarLoadScheduler> Scheduler = LoadScheduler.Pin();
+	if (Scheduler.IsValid())
+	{
+		Scheduler->Schedule(this);
+	}
+	else
+	{
+		StartLoad();
+	}
+}
+
+void UReadyPlayerMeAvatarLoader::StartLoad()
+{
 	const UReadyPlayerMeGameSubsystem* GameSubsystem = UGameInstance::GetSubsystem<UReadyPlayerMeGameSubsystem>(GetWorld()->GetGameInstance());
 	auto AvatarManifest = GameSubsystem ? GameSubsystem->AvatarManifest : nullptr;
 	CacheHandler = MakeShared<FAvatarCacheHandler>(*AvatarUri, AvatarManifest);
 
 	GlbLoader = NewObject<UReadyPlayerMeGlbLoader>(this,TEXT("GlbLoader"));
-	GlbLoader->SkeletalMeshConfig = SkeletalMeshConfig;
-	GlbLoader->TargetSkeleton = TargetSkeleton;
+	GlbLoader->SkeletalMeshConfig = AvatarSkeletalMeshConfig;
+	GlbLoader->TargetSkeleton = AvatarTargetSkeleton;
+
+	if (CacheHandler->ShouldLoadFromCache())
+	{
+		AvatarMetadata = CacheHandler->GetLocalMetadata();
+		if (AvatarMetadata.IsSet())
+		{
+			// The local avatar is used right away and its metadata is revalidated in the background.
+			const TSharedPtr<FAvatarLoadScheduler> Scheduler = LoadScheduler.Pin();
+			if (Scheduler.IsValid())
+			{
+				Scheduler->Revalidate(*AvatarUri, AvatarMetadata->UpdatedAtDate);
+			}
+			OnGlbLoadCompleted.BindDynamic(this, &UReadyPlayerMeAvatarLoader::OnGlbLoaded);
+			GlbLoader->SkeletalMeshConfig.AsyncLoadingPriority = GetLoadPriority();
+			GlbLoader->LoadFromFile(AvatarUri->LocalModelPath, AvatarMetadata->BodyType, OnGlbLoadCompleted);
+			return;
+		}
+	}
 
 	MetadataRequest = MakeShared<FAvatarRequest>();
 	MetadataRequest->GetCompleteCallback().BindUObject(this, &UReadyPlayerMeAvatarLoader::OnMetadataDownloaded);
 	MetadataRequest->Download(AvatarUri->MetadataUrl, METADATA_REQUEST_TIMEOUT);
-	if (CacheHandler->ShouldLoadFromCache())
+	DownloadAvatarModel();
+}
+
+float UReadyPlayerMeAvatarLoader::GetLoadPriority() const
+{
+	const AActor* Actor = GetTypedOuter<AActor>();
+	const UWorld* World = GetWorld();
+	const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	if (!Actor || !PlayerController || !PlayerController->PlayerCameraManager)
 	{
-		bIsTryingToUpdate = true;
+		// Preloads and avatars without an actor wait for the avatars placed in the world.
+		return TNumericLimits<float>::Lowest();
 	}
-	else
+
+	const FVector CameraToAvatar = Actor->GetActorLocation() - PlayerController->PlayerCameraManager->GetCameraLocation();
+	float Distance = CameraToAvatar.Size();
+	if ((CameraToAvatar | PlayerController->PlayerCameraManager->GetCameraRotation().Vector()) < 0)
 	{
-		DownloadAvatarModel();
+		// Avatars behind the camera wait for the visible ones a few times farther away.
+		Distance *= 4;
 	}
+	return -Distance;
 }
 
 void UReadyPlayerMeAvatarLoader::CancelAvatarLoad()
@@ -75,21 +143,7 @@ void UReadyPlayerMeAvatarLoader::ProcessReceivedMetadata()
 {
 	AvatarMetadata = FMetadataExtractor::ExtractAvatarMetadata(MetadataRequest->GetContentAsString());
 	CacheHandler->SetUpdatedMetadataStr(MetadataRequest->GetContentAsString(), AvatarMetadata->UpdatedAtDate);
-	// If we are not trying to update the avatar, the metadata and the model should be downloaded as the standard flow.
-	if (!bIsTryingToUpdate)
-	{
-		ExecuteSuccessCallback();
-		return;
-	}
-	// If we are trying to update the avatar and the metadata is changed, we check if the metadata is changed, we update the model.
-	if (CacheHandler->ShouldSaveMetadata())
-	{
-		DownloadAvatarModel();
-		return;
-	}
-	// If we are trying to update the avatar, but the metadata is not changed, we loaded the cached avatar.
-	OnGlbLoadCompleted.BindDynamic(this, &UReadyPlayerMeAvatarLoader::OnGlbLoaded);
-	GlbLoader->LoadFromFile(AvatarUri->LocalModelPath, AvatarMetadata->BodyType, OnGlbLoadCompleted);
+	ExecuteSuccessCallback();
 }
 
 void UReadyPlayerMeAvatarLoader::ExecuteSuccessCallback()
@@ -97,34 +151,25 @@ void UReadyPlayerMeAvatarLoader::ExecuteSuccessCallback()
 	if (SkeletalMesh != nullptr && AvatarMetadata.IsSet())
 	{
 		CacheHandler->SaveAvatarInCache();
+		if (JoinedLoadKey.IsSet() && MemoryCache.IsValid())
+		{
+			const FAvatarMemoryCacheKey Key = *JoinedLoadKey;
+			JoinedLoadKey.Reset();
+			MemoryCache->CompleteLoad(Key, AvatarTargetSkeleton, SkeletalMesh, *AvatarMetadata);
+		}
 		(void)OnAvatarDownloadCompleted.ExecuteIfBound(SkeletalMesh, *AvatarMetadata);
 		Reset();
 	}
 }
 
-void UReadyPlayerMeAvatarLoader::TryLoadFromCache()
+void UReadyPlayerMeAvatarLoader::ExecuteFailureCallback(const FString& ErrorMessage)
 {
-	MetadataRequest->GetCompleteCallback().Unbind();
-	if (ModelRequest)
-	{
-		ModelRequest->GetCompleteCallback().Unbind();
-	}
-	// We reset the cache handler state to prevent saving of incomplete data
-	CacheHandler->ResetState();
-	AvatarMetadata = CacheHandler->GetLocalMetadata();
-	if (AvatarMetadata.IsSet())
+	if (JoinedLoadKey.IsSet() && MemoryCache.IsValid())
 	{
-		OnGlbLoadCompleted.BindDynamic(this, &UReadyPlayerMeAvatarLoader::OnGlbLoaded);
-		GlbLoader->LoadFromFile(AvatarUri->LocalModelPath, AvatarMetadata->BodyType, OnGlbLoadCompleted);
+		const FAvatarMemoryCacheKey Key = *JoinedLoadKey;
+		JoinedLoadKey.Reset();
+		MemoryCache->FailLoad(Key, AvatarTargetSkeleton, ErrorMessage);
 	}
-	else
-	{
-		ExecuteFailureCallback("Failed to load local metadata");
-	}
-}
-
-void UReadyPlayerMeAvatarLoader::ExecuteFailureCallback(const FString& ErrorMessage)
-{
 	(void)OnAvatarLoadFailed.ExecuteIfBound(ErrorMessage);
 	Reset();
 }
@@ -139,10 +184,6 @@ void UReadyPlayerMeAvatarLoader::OnMetadataDownloaded(bool bSuccess)
 	{
 		ProcessReceivedMetadata();
 	}
-	else if (bIsTryingToUpdate)
-	{
-		TryLoadFromCache();
-	}
 	else
 	{
 		ExecuteFailureCallback("Failed to retrieve avatar metadata");
@@ -178,12 +219,9 @@ void UReadyPlayerMeAvatarLoader::OnModelDownloaded(bool bSuccess)
 		CacheHandler->SetModelData(&ModelRequest->GetContent());
 		const EAvatarBodyType BodyType = AvatarMetadata ? AvatarMetadata->BodyType : EAvatarBodyType::Undefined;
 		OnGlbLoadCompleted.BindDynamic(this, &UReadyPlayerMeAvatarLoader::OnGlbLoaded);
+		GlbLoader->SkeletalMeshConfig.AsyncLoadingPriority = GetLoadPriority();
 		GlbLoader->LoadFromData(ModelRequest->GetContent(), BodyType, OnGlbLoadCompleted);
 	}
-	else if (bIsTryingToUpdate)
-	{
-		TryLoadFromCache();
-	}
 	else
 	{
 		ExecuteFailureCallback("Failed to retrieve Avatar Meta Data");
@@ -197,11 +235,54 @@ void UReadyPlayerMeAvatarLoader::DownloadAvatarModel()
 	ModelRequest->Download(AvatarUri->ModelUrl, AVATAR_REQUEST_TIMEOUT);
 }
 
+void UReadyPlayerMeAvatarLoader::LeaveJoinedLoad()
+{
+	if (JoinedLoadKey.IsSet() && MemoryCache.IsValid())
+	{
+		MemoryCache->LeaveLoad(*JoinedLoadKey, AvatarTargetSkeleton, this);
+	}
+	JoinedLoadKey.Reset();
+}
+
+void UReadyPlayerMeAvatarLoader::RestartJoinedLoad(const FAvatarMemoryCacheKey& Key)
+{
+	// The loader was cancelled, reused, or is already downloading the avatar itself.
+	if (!JoinedLoadKey.IsSet() || !(*JoinedLoadKey == Key) || CacheHandler.IsValid())
+	{
+		return;
+	}
+	if (!MemoryCache.IsValid() || MemoryCache->JoinLoad(Key, AvatarTargetSkeleton, this))
+	{
+		ScheduleLoad();
+	}
+}
+
+void UReadyPlayerMeAvatarLoader::CompleteJoinedLoad(USkeletalMesh* Mesh, const FAvatarMetadata& Metadata)
+{
+	JoinedLoadKey.Reset();
+	SkeletalMesh = Mesh;
+	(void)OnAvatarDownloadCompleted.ExecuteIfBound(Mesh, Metadata);
+	Reset();
+}
+
+void UReadyPlayerMeAvatarLoader::FailJoinedLoad(const FString& ErrorMessage)
+{
+	JoinedLoadKey.Reset();
+	ExecuteFailureCallback(ErrorMessage);
+}
+
 void UReadyPlayerMeAvatarLoader::Reset()
 {
-	bIsTryingToUpdate = false;
+	LeaveJoinedLoad();
+	const TSharedPtr<FAvatarLoadScheduler> Scheduler = LoadScheduler.Pin();
+	if (Scheduler.IsValid())
+	{
+		Scheduler->Release(this);
+	}
 	SkeletalMesh = nullptr;
 	GlbLoader = nullptr;
+	AvatarTargetSkeleton = nullptr;
+	AvatarSkeletalMeshConfig = FglTFRuntimeSkeletalMeshConfig();
 	OnGlbLoadCompleted.Unbind();
 	CacheHandler.Reset();
 	AvatarMetadata.Reset();
@@ -34,14 +34,15 @@ void UReadyPlayerMeComponent::LoadAvatar(const FAvatarLoadCompleted& OnLoadCompl
 	}
 
 	OnAvatarLoadCompleted = OnLoadCompleted;
+	MemoryCacheKey = FAvatarMemoryCacheKey(FAvatarUrlConvertor::GetAvatarId(UrlShortcode), AvatarConfig, TargetSkeleton, SkeletalMeshConfig);
 
 	const UReadyPlayerMeGameSubsystem* GameSubsystem = UGameInstance::GetSubsystem<UReadyPlayerMeGameSubsystem>(GetWorld()->GetGameInstance());
 	if (IsValid(GameSubsystem))
 	{
-		const FAvatarMemoryCacheData CacheData = GameSubsystem->MemoryCache->GetAvatarCacheData(FAvatarUrlConvertor::GetAvatarId(UrlShortcode), AvatarConfig);
-		if (IsValid(CacheData.SkeletalMesh))
+		const FAvatarMemoryCacheData* CacheData = GameSubsystem->MemoryCache->FindAvatar(MemoryCacheKey);
+		if (CacheData != nullptr && IsValid(CacheData->SkeletalMesh))
 		{
-			SetAvatarData(CacheData.SkeletalMesh, CacheData.Metadata);
+			SetAvatarData(CacheData->SkeletalMesh, CacheData->Metadata);
 			return;
 		}
 	}
@@ -72,7 +73,7 @@ void UReadyPlayerMeComponent::OnAvatarDownloaded(USkeletalMesh* SkeletalMesh, co
 		const UReadyPlayerMeGameSubsystem* GameSubsystem = UGameInstance::GetSubsystem<UReadyPlayerMeGameSubsystem>(GetWorld()->GetGameInstance());
 		if (IsValid(GameSubsystem))
 		{
-			GameSubsystem->MemoryCache->AddAvatar(FAvatarUrlConvertor::GetAvatarId(UrlShortcode), AvatarConfig, SkeletalMesh, Metadata);
+			GameSubsystem->MemoryCache->StoreAvatar(MemoryCacheKey, SkeletalMesh, Metadata);
 		}
 	}
 	SetAvatarData(SkeletalMesh, Metadata);
@@ -4,16 +4,19 @@
 #include "ReadyPlayerMeMemoryCache.h"
 
 #include "Storage/AvatarManifest.h"
+#include "Request/AvatarLoadScheduler.h"
 
 UReadyPlayerMeGameSubsystem::UReadyPlayerMeGameSubsystem()
 	: MemoryCache(nullptr)
 	, AvatarManifest(nullptr)
+	, LoadScheduler(nullptr)
 {}
 
 void UReadyPlayerMeGameSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	MemoryCache = NewObject<UReadyPlayerMeMemoryCache>(this, TEXT("MemoryCache"));
 	AvatarManifest = MakeShared<FAvatarManifest>();
+	LoadScheduler = MakeShared<FAvatarLoadScheduler>();
 }
 
 void UReadyPlayerMeGameSubsystem::Deinitialize()
@@ -21,4 +24,5 @@ void UReadyPlayerMeGameSubsystem::Deinitialize()
     MemoryCache->ClearAvatars();
 	MemoryCache = nullptr;
 	AvatarManifest.Reset();
+	LoadScheduler.Reset();
 }
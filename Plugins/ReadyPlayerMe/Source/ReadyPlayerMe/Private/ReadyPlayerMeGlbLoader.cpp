@@ -6,6 +6,7 @@
 #include "glTFRuntimeFunctionLibrary.h"
 
 UReadyPlayerMeGlbLoader::UReadyPlayerMeGlbLoader()
+	: LoadingAsset(nullptr)
 {
 	OnSkeletalMeshCallback.BindDynamic(this, &UReadyPlayerMeGlbLoader::OnSkeletalMeshLoaded);
 }
@@ -30,6 +31,7 @@ void UReadyPlayerMeGlbLoader::LoadSkeletalMesh(UglTFRuntimeAsset* Asset, EAvatar
 	{
 		(void)OnLoadCompleted.ExecuteIfBound(nullptr);
 		UE_LOG(LogReadyPlayerMe, Warning, TEXT("Failed to load the avatar model"));
+		return;
 	}
 	if (BodyType == EAvatarBodyType::Undefined)
 	{
@@ -37,10 +39,18 @@ void UReadyPlayerMeGlbLoader::LoadSkeletalMesh(UglTFRuntimeAsset* Asset, EAvatar
 	}
 	const FString RootBoneName = FMetadataExtractor::GetRootBoneName(BodyType);
 	FAvatarGltfConfigCreator::OverrideConfig(SkeletalMeshConfig, RootBoneName, TargetSkeleton);
+	LoadingAsset = Asset;
 	Asset->LoadSkeletalMeshRecursiveAsync(RootBoneName, {}, OnSkeletalMeshCallback, SkeletalMeshConfig);
 }
 
 void UReadyPlayerMeGlbLoader::OnSkeletalMeshLoaded(USkeletalMesh* SkeletalMesh)
 {
+	// The asset lives until it is garbage collected, on Windows a mapped file cannot be deleted until then.
+	// The mesh is built, the buffers are not needed anymore.
+	if (LoadingAsset != nullptr && LoadingAsset->GetParser().IsValid())
+	{
+		LoadingAsset->GetParser()->ReleaseMappedFiles();
+	}
+	LoadingAsset = nullptr;
 	(void)OnLoadCompleted.ExecuteIfBound(SkeletalMesh);
 }
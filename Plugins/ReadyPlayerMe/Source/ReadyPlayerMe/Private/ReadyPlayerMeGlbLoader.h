@@ -33,6 +33,10 @@ private:
 
 	void LoadSkeletalMesh(class UglTFRuntimeAsset* Asset, EAvatarBodyType BodyType);
 
+	/** Kept until the mesh is loaded, then its mapping of the cached file is released so the cache can replace it */
+	UPROPERTY()
+	class UglTFRuntimeAsset* LoadingAsset;
+
 	FglTFRuntimeSkeletalMeshAsync OnSkeletalMeshCallback;
 	FGlbLoadCompleted OnLoadCompleted;
 };
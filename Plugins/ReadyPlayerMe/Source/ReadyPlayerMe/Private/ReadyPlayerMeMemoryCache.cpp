@@ -2,23 +2,90 @@
 
 
 #include "ReadyPlayerMeMemoryCache.h"
+#include "ReadyPlayerMeAvatarLoader.h"
+#include "ReadyPlayerMeSettings.h"
 #include "Utils/AvatarConfigProcessor.h"
+#include "glTFRuntimeParser.h"
+#include "Async/Async.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/SecureHash.h"
 
 namespace
 {
-	FString MakeAvatarConfigHash(UReadyPlayerMeAvatarConfig* AvatarConfig)
+	int64 EstimateAvatarSize(USkeletalMesh* SkeletalMesh)
 	{
-		const FString UrlQueryString = FAvatarConfigProcessor::Process(AvatarConfig);
-		return UrlQueryString.IsEmpty() ? "" : FMD5::HashAnsiString(*UrlQueryString).Left(8);
+		if (!IsValid(SkeletalMesh))
+		{
+			return 0;
+		}
+		int64 Size = SkeletalMesh->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		// Only the textures created at runtime belong to the avatar, the ones of the base materials are shared assets.
+		// glTFRuntime outers the runtime textures to the material instances, which live in the package of their base material.
+		TSet<UTexture*> AvatarTextures;
+		for (const FSkeletalMaterial& Material : SkeletalMesh->GetMaterials())
+		{
+			if (Material.MaterialInterface == nullptr)
+			{
+				continue;
+			}
+			TArray<UTexture*> UsedTextures;
+			Material.MaterialInterface->GetUsedTextures(UsedTextures, EMaterialQualityLevel::Num, true, ERHIFeatureLevel::Num, true);
+			for (UTexture* Texture : UsedTextures)
+			{
+				if (Texture != nullptr && !Texture->IsAsset())
+				{
+					AvatarTextures.Add(Texture);
+				}
+			}
+		}
+		for (UTexture* Texture : AvatarTextures)
+		{
+			Size += Texture->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+		return Size;
 	}
 }
 
+FAvatarMemoryCacheKey::FAvatarMemoryCacheKey(const FString& InAvatarId, UReadyPlayerMeAvatarConfig* AvatarConfig)
+	: AvatarId(InAvatarId)
+	, AvatarConfigHash(FAvatarConfigProcessor::MakeHash(FAvatarConfigProcessor::Process(AvatarConfig)))
+{
+}
+
+FAvatarMemoryCacheKey::FAvatarMemoryCacheKey(const FString& InAvatarId, UReadyPlayerMeAvatarConfig* AvatarConfig, USkeleton* TargetSkeleton, const FglTFRuntimeSkeletalMeshConfig& SkeletalMeshConfig)
+	: AvatarId(InAvatarId)
+	, AvatarConfigHash(FAvatarConfigProcessor::MakeHash(FAvatarConfigProcessor::Process(AvatarConfig)))
+	, SkeletalMeshConfigHash(MakeSkeletalMeshConfigHash(TargetSkeleton, SkeletalMeshConfig))
+{
+}
+
+FString FAvatarMemoryCacheKey::MakeSkeletalMeshConfigHash(USkeleton* TargetSkeleton, const FglTFRuntimeSkeletalMeshConfig& SkeletalMeshConfig)
+{
+	// The loading priority only decides when the mesh is built, the loaders change it on their own copy.
+	FglTFRuntimeSkeletalMeshConfig HashedConfig = SkeletalMeshConfig;
+	HashedConfig.AsyncLoadingPriority = 0;
+	FString ConfigText;
+	FglTFRuntimeSkeletalMeshConfig::StaticStruct()->ExportText(ConfigText, &HashedConfig, nullptr, nullptr, PPF_None, nullptr);
+	ConfigText += GetPathNameSafe(TargetSkeleton);
+	return FMD5::HashAnsiString(*ConfigText).Left(8);
+}
+
 FAvatarMemoryCacheData UReadyPlayerMeMemoryCache::GetAvatarCacheData(const FString& AvatarId, UReadyPlayerMeAvatarConfig* AvatarConfig) const
 {
-	const FString ConfigHash = MakeAvatarConfigHash(AvatarConfig);
-	const auto CacheData = CachedAvatars.FindByPredicate([&AvatarId, &ConfigHash](const FAvatarMemoryCacheData& Data){return Data.AvatarId == AvatarId && Data.AvatarConfigHash == ConfigHash;});
+	const FString AvatarConfigHash = FAvatarMemoryCacheKey(AvatarId, AvatarConfig).AvatarConfigHash;
+	const FAvatarMemoryCacheData* CacheData = nullptr;
+	for (const FAvatarMemoryCacheData& Data : CachedAvatars)
+	{
+		if (Data.AvatarId == AvatarId && Data.AvatarConfigHash == AvatarConfigHash && (CacheData == nullptr || Data.LastAccess > CacheData->LastAccess))
+		{
+			CacheData = &Data;
+		}
+	}
 	if (CacheData != nullptr)
 	{
+		CacheData->LastAccess = ++AccessCounter;
 		return *CacheData;
 	}
 	return {};
@@ -26,20 +93,170 @@ FAvatarMemoryCacheData UReadyPlayerMeMemoryCache::GetAvatarCacheData(const FStri
 
 void UReadyPlayerMeMemoryCache::AddAvatar(const FString& AvatarId, UReadyPlayerMeAvatarConfig* AvatarConfig, USkeletalMesh* SkeletalMesh, const FAvatarMetadata& Metadata)
 {
-	const FString ConfigHash = MakeAvatarConfigHash(AvatarConfig);
-	const FAvatarMemoryCacheData CacheData = GetAvatarCacheData(AvatarId, AvatarConfig);
-	if (CacheData.SkeletalMesh == nullptr)
+	StoreAvatar(FAvatarMemoryCacheKey(AvatarId, AvatarConfig), SkeletalMesh, Metadata);
+}
+
+const FAvatarMemoryCacheData* UReadyPlayerMeMemoryCache::FindAvatar(const FAvatarMemoryCacheKey& Key) const
+{
+	const int32* Index = CachedAvatarIndices.Find(Key);
+	if (Index == nullptr && !Key.SkeletalMeshConfigHash.IsEmpty())
+	{
+		// The avatars added with AddAvatar are not keyed by a skeletal mesh config, they are used for any of them.
+		Index = CachedAvatarIndices.Find(FAvatarMemoryCacheKey(Key.AvatarId, Key.AvatarConfigHash));
+	}
+	if (Index == nullptr)
+	{
+		return nullptr;
+	}
+	const FAvatarMemoryCacheData& CacheData = CachedAvatars[*Index];
+	CacheData.LastAccess = ++AccessCounter;
+	return &CacheData;
+}
+
+void UReadyPlayerMeMemoryCache::StoreAvatar(const FAvatarMemoryCacheKey& Key, USkeletalMesh* SkeletalMesh, const FAvatarMetadata& Metadata)
+{
+	if (SkeletalMesh == nullptr || CachedAvatarIndices.Contains(Key))
+	{
+		return;
+	}
+	CachedAvatarIndices.Add(Key, CachedAvatars.Num());
+	FAvatarMemoryCacheData& CacheData = CachedAvatars.Add_GetRef({Key.AvatarId, Key.AvatarConfigHash, SkeletalMesh, Key.SkeletalMeshConfigHash, Metadata});
+	CacheData.SizeBytes = EstimateAvatarSize(SkeletalMesh);
+	CacheData.LastAccess = ++AccessCounter;
+	CachedAvatarsSizeBytes += CacheData.SizeBytes;
+	EvictToBudget(Key);
+}
+
+void UReadyPlayerMeMemoryCache::EvictToBudget(const FAvatarMemoryCacheKey& KeepKey)
+{
+	const UReadyPlayerMeSettings* Settings = GetDefault<UReadyPlayerMeSettings>();
+	if (!IsValid(Settings) || Settings->MemoryCacheBudgetMB <= 0)
+	{
+		return;
+	}
+	const int64 BudgetBytes = static_cast<int64>(Settings->MemoryCacheBudgetMB) * 1024 * 1024;
+	// The avatar that was just added is kept even if it alone exceeds the budget.
+	while (CachedAvatarsSizeBytes > BudgetBytes && CachedAvatars.Num() > 1)
+	{
+		const int32 KeepIndex = CachedAvatarIndices.FindChecked(KeepKey);
+		int32 LeastRecentIndex = INDEX_NONE;
+		uint64 LeastRecentAccess = MAX_uint64;
+		for (int32 Index = 0; Index < CachedAvatars.Num(); ++Index)
+		{
+			if (CachedAvatars[Index].LastAccess < LeastRecentAccess && Index != KeepIndex)
+			{
+				LeastRecentIndex = Index;
+				LeastRecentAccess = CachedAvatars[Index].LastAccess;
+			}
+		}
+		UE_LOG(LogReadyPlayerMe, Verbose, TEXT("Evicted avatar %s from the memory cache"), *CachedAvatars[LeastRecentIndex].AvatarId);
+		RemoveCachedAvatarAt(LeastRecentIndex);
+	}
+}
+
+void UReadyPlayerMeMemoryCache::RemoveCachedAvatarAt(int32 Index)
+{
+	const FAvatarMemoryCacheData& CacheData = CachedAvatars[Index];
+	CachedAvatarsSizeBytes -= CacheData.SizeBytes;
+	CachedAvatarIndices.Remove(FAvatarMemoryCacheKey(CacheData.AvatarId, CacheData.AvatarConfigHash, CacheData.SkeletalMeshConfigHash));
+	CachedAvatars.RemoveAtSwap(Index);
+	if (CachedAvatars.IsValidIndex(Index))
 	{
-		CachedAvatars.Add({AvatarId, ConfigHash, SkeletalMesh, Metadata});
+		const FAvatarMemoryCacheData& MovedData = CachedAvatars[Index];
+		CachedAvatarIndices.Add(FAvatarMemoryCacheKey(MovedData.AvatarId, MovedData.AvatarConfigHash, MovedData.SkeletalMeshConfigHash), Index);
 	}
 }
 
 void UReadyPlayerMeMemoryCache::ClearAvatar(const FString& AvatarId)
 {
-	CachedAvatars.RemoveAll([&AvatarId](const FAvatarMemoryCacheData& Data){return Data.AvatarId == AvatarId;});
+	for (int32 Index = CachedAvatars.Num() - 1; Index >= 0; --Index)
+	{
+		if (CachedAvatars[Index].AvatarId == AvatarId)
+		{
+			RemoveCachedAvatarAt(Index);
+		}
+	}
 }
 
 void UReadyPlayerMeMemoryCache::ClearAvatars()
 {
 	CachedAvatars.Empty();
+	CachedAvatarIndices.Empty();
+	CachedAvatarsSizeBytes = 0;
+}
+
+bool UReadyPlayerMeMemoryCache::JoinLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, UReadyPlayerMeAvatarLoader* Loader)
+{
+	FInFlightLoad& InFlightLoad = InFlightLoads.FindOrAdd(FInFlightKey(Key, TargetSkeleton));
+	if (!InFlightLoad.Leader.IsValid())
+	{
+		// A leader destroyed without leaving the load hands its waiters over to the new one.
+		InFlightLoad.Leader = Loader;
+		InFlightLoad.Waiters.Remove(Loader);
+		return true;
+	}
+	if (InFlightLoad.Leader != Loader)
+	{
+		InFlightLoad.Waiters.AddUnique(Loader);
+	}
+	return false;
+}
+
+void UReadyPlayerMeMemoryCache::LeaveLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, UReadyPlayerMeAvatarLoader* Loader)
+{
+	const FInFlightKey InFlightKey(Key, TargetSkeleton);
+	FInFlightLoad* InFlightLoad = InFlightLoads.Find(InFlightKey);
+	if (InFlightLoad == nullptr)
+	{
+		return;
+	}
+	if (InFlightLoad->Leader != Loader)
+	{
+		InFlightLoad->Waiters.Remove(Loader);
+		return;
+	}
+	// The leader can be cancelled during garbage collection, so the waiters are restarted on the next tick.
+	TArray<TWeakObjectPtr<UReadyPlayerMeAvatarLoader>> Waiters = TakeWaiters(InFlightKey);
+	if (Waiters.Num() > 0)
+	{
+		AsyncTask(ENamedThreads::GameThread, [Key, Waiters = MoveTemp(Waiters)]()
+		{
+			for (const TWeakObjectPtr<UReadyPlayerMeAvatarLoader>& Waiter : Waiters)
+			{
+				if (Waiter.IsValid())
+				{
+					Waiter->RestartJoinedLoad(Key);
+				}
+			}
+		});
+	}
+}
+
+void UReadyPlayerMeMemoryCache::CompleteLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, USkeletalMesh* SkeletalMesh, const FAvatarMetadata& Metadata)
+{
+	for (const TWeakObjectPtr<UReadyPlayerMeAvatarLoader>& Waiter : TakeWaiters(FInFlightKey(Key, TargetSkeleton)))
+	{
+		if (Waiter.IsValid())
+		{
+			Waiter->CompleteJoinedLoad(SkeletalMesh, Metadata);
+		}
+	}
+}
+
+void UReadyPlayerMeMemoryCache::FailLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, const FString& ErrorMessage)
+{
+	for (const TWeakObjectPtr<UReadyPlayerMeAvatarLoader>& Waiter : TakeWaiters(FInFlightKey(Key, TargetSkeleton)))
+	{
+		if (Waiter.IsValid())
+		{
+			Waiter->FailJoinedLoad(ErrorMessage);
+		}
+	}
+}
+
+TArray<TWeakObjectPtr<UReadyPlayerMeAvatarLoader>> UReadyPlayerMeMemoryCache::TakeWaiters(const FInFlightKey& InFlightKey)
+{
+	FInFlightLoad InFlightLoad;
+	InFlightLoads.RemoveAndCopyValue(InFlightKey, InFlightLoad);
+	return MoveTemp(InFlightLoad.Waiters);
 }
@@ -31,11 +31,13 @@ void UReadyPlayerMePreloadAction::Preload()
 	const UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
 	const UReadyPlayerMeGameSubsystem* GameSubsystem = UGameInstance::GetSubsystem<UReadyPlayerMeGameSubsystem>(GameInstance);
 	MemoryCache = GameSubsystem->MemoryCache;
+	AvatarConfigHash = FAvatarMemoryCacheKey(FString(), PreloadData.AvatarConfig).AvatarConfigHash;
+	SkeletalMeshConfigHash = FAvatarMemoryCacheKey::MakeSkeletalMeshConfigHash(PreloadData.TargetSkeleton, PreloadData.SkeletalMeshConfig);
 	for (const FString& Url : PreloadData.AvatarIds)
 	{
 		const FString AvatarId = FAvatarUrlConvertor::GetAvatarId(Url);
-		const FAvatarMemoryCacheData CacheData = MemoryCache->GetAvatarCacheData(AvatarId, PreloadData.AvatarConfig);
-		if (CacheData.SkeletalMesh == nullptr)
+		const FAvatarMemoryCacheData* CacheData = MemoryCache->FindAvatar(FAvatarMemoryCacheKey(AvatarId, AvatarConfigHash, SkeletalMeshConfigHash));
+		if ((CacheData == nullptr || CacheData->SkeletalMesh == nullptr) && !AvatarLoaders.Contains(AvatarId))
 		{
 			UReadyPlayerMeAvatarLoader* AvatarLoader = NewObject<UReadyPlayerMeAvatarLoader>(this);
 			FAvatarDownloadCompleted OnAvatarDownloadCompleted;
@@ -64,7 +66,7 @@ void UReadyPlayerMePreloadAction::OnAvatarDownloaded(USkeletalMesh* SkeletalMesh
 		return Pair.Value->SkeletalMesh == SkeletalMesh;
 	});
 	const FString AvatarId = FoundItemMap.begin()->Key;
-	MemoryCache->AddAvatar(AvatarId, PreloadData.AvatarConfig, SkeletalMesh, Metadata);
+	MemoryCache->StoreAvatar(FAvatarMemoryCacheKey(AvatarId, AvatarConfigHash, SkeletalMeshConfigHash), SkeletalMesh, Metadata);
 	AvatarLoaders.Remove(AvatarId);
 	CompleteLoading();
 }
@@ -4,6 +4,8 @@
 
 UReadyPlayerMeSettings::UReadyPlayerMeSettings()
 	: bKeepLoadedAvatarsInMemory(false)
+	, MemoryCacheBudgetMB(512)
+	, MaxConcurrentAvatarLoads(4)
 {
 }
 
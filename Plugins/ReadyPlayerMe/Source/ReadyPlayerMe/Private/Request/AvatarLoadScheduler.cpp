@@ -0,0 +1,117 @@
+// Copyright © 2021++ Ready Player Me
+
+
+#include "AvatarLoadScheduler.h"
+
+#include "AvatarRequest.h"
+#include "ReadyPlayerMeAvatarLoader.h"
+#include "ReadyPlayerMeSettings.h"
+#include "Storage/AvatarStorage.h"
+#include "Utils/MetadataExtractor.h"
+
+constexpr float REVALIDATION_REQUEST_TIMEOUT = 20.f;
+
+FAvatarLoadScheduler::FAvatarLoadScheduler()
+{
+#if ENGINE_MAJOR_VERSION > 4
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAvatarLoadScheduler::Tick));
+#else
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAvatarLoadScheduler::Tick));
+#endif
+}
+
+FAvatarLoadScheduler::~FAvatarLoadScheduler()
+{
+#if ENGINE_MAJOR_VERSION > 4
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+	for (const TUniquePtr<FRevalidation>& Revalidation : Revalidations)
+	{
+		Revalidation->Request->CancelRequest();
+	}
+}
+
+void FAvatarLoadScheduler::Schedule(UReadyPlayerMeAvatarLoader* Loader)
+{
+	if (PendingLoaders.Contains(Loader) || RunningLoaders.Contains(Loader))
+	{
+		return;
+	}
+	PendingLoaders.Add(Loader);
+	Dispatch();
+}
+
+void FAvatarLoadScheduler::Release(UReadyPlayerMeAvatarLoader* Loader)
+{
+	// Loaders are released during garbage collection too, so the free slots are only used on the next tick.
+	PendingLoaders.Remove(Loader);
+	RunningLoaders.Remove(Loader);
+}
+
+void FAvatarLoadScheduler::Dispatch()
+{
+	const UReadyPlayerMeSettings* Settings = GetDefault<UReadyPlayerMeSettings>();
+	const int32 MaxRunningLoaders = IsValid(Settings) ? Settings->MaxConcurrentAvatarLoads : 0;
+	RunningLoaders.RemoveAll([](const TWeakObjectPtr<UReadyPlayerMeAvatarLoader>& Loader){return !Loader.IsValid();});
+	PendingLoaders.RemoveAll([](const TWeakObjectPtr<UReadyPlayerMeAvatarLoader>& Loader){return !Loader.IsValid();});
+
+	while (PendingLoaders.Num() > 0 && (MaxRunningLoaders <= 0 || RunningLoaders.Num() < MaxRunningLoaders))
+	{
+		// The priorities change as the players move, so they are not cached.
+		int32 BestIndex = 0;
+		float BestPriority = PendingLoaders[0]->GetLoadPriority();
+		for (int32 Index = 1; Index < PendingLoaders.Num(); ++Index)
+		{
+			const float Priority = PendingLoaders[Index]->GetLoadPriority();
+			if (Priority > BestPriority)
+			{
+				BestIndex = Index;
+				BestPriority = Priority;
+			}
+		}
+
+		UReadyPlayerMeAvatarLoader* Loader = PendingLoaders[BestIndex].Get();
+		PendingLoaders.RemoveAt(BestIndex);
+		RunningLoaders.Add(Loader);
+		Loader->StartLoad();
+	}
+}
+
+void FAvatarLoadScheduler::Revalidate(const FAvatarUri& AvatarUri, const FString& LocalUpdatedAtDate)
+{
+	TUniquePtr<FRevalidation> Revalidation = MakeUnique<FRevalidation>();
+	Revalidation->Request = MakeShared<FAvatarRequest>();
+	Revalidation->LocalMetadataPath = AvatarUri.LocalMetadataPath;
+	Revalidation->LocalUpdatedAtDate = LocalUpdatedAtDate;
+	Revalidation->Request->GetCompleteCallback().BindRaw(this, &FAvatarLoadScheduler::OnRevalidated, Revalidation.Get());
+	Revalidation->Request->Download(AvatarUri.MetadataUrl, REVALIDATION_REQUEST_TIMEOUT);
+	Revalidations.Add(MoveTemp(Revalidation));
+}
+
+void FAvatarLoadScheduler::OnRevalidated(bool bSuccess, FRevalidation* Revalidation)
+{
+	// The request is still running its callback, it is released on the next tick.
+	Revalidation->bCompleted = true;
+	if (!bSuccess)
+	{
+		return;
+	}
+	const FAvatarMetadata Metadata = FMetadataExtractor::ExtractAvatarMetadata(Revalidation->Request->GetContentAsString());
+	if (Metadata.UpdatedAtDate != Revalidation->LocalUpdatedAtDate)
+	{
+		// The local model can still be in use, removing the metadata is enough for the next load to download the avatar again.
+		FAvatarStorage::DeleteFile(Revalidation->LocalMetadataPath);
+	}
+}
+
+bool FAvatarLoadScheduler::Tick(float DeltaTime)
+{
+	Revalidations.RemoveAll([](const TUniquePtr<FRevalidation>& Revalidation){return Revalidation->bCompleted;});
+	if (PendingLoaders.Num() > 0)
+	{
+		Dispatch();
+	}
+	return true;
+}
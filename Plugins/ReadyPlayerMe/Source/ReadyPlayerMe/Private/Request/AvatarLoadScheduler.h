@@ -0,0 +1,51 @@
+// Copyright © 2021++ Ready Player Me
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "ReadyPlayerMeTypes.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+/**
+ * Starts the avatar loads with a limit on the number of concurrent loads.
+ * Pending loads are started closest to the camera first, their priority is evaluated again every time a slot is free.
+ * It also owns the background metadata requests of the avatars loaded from the local storage.
+ */
+class FAvatarLoadScheduler
+{
+public:
+	FAvatarLoadScheduler();
+	~FAvatarLoadScheduler();
+
+	void Schedule(class UReadyPlayerMeAvatarLoader* Loader);
+
+	void Release(class UReadyPlayerMeAvatarLoader* Loader);
+
+	void Revalidate(const FAvatarUri& AvatarUri, const FString& LocalUpdatedAtDate);
+
+private:
+	struct FRevalidation
+	{
+		TSharedPtr<class FAvatarRequest> Request;
+		FString LocalMetadataPath;
+		FString LocalUpdatedAtDate;
+		bool bCompleted = false;
+	};
+
+	bool Tick(float DeltaTime);
+
+	void Dispatch();
+
+	void OnRevalidated(bool bSuccess, FRevalidation* Revalidation);
+
+	TArray<TWeakObjectPtr<class UReadyPlayerMeAvatarLoader>> PendingLoaders;
+	TArray<TWeakObjectPtr<class UReadyPlayerMeAvatarLoader>> RunningLoaders;
+	TArray<TUniquePtr<FRevalidation>> Revalidations;
+
+#if ENGINE_MAJOR_VERSION > 4
+	FTSTicker::FDelegateHandle TickerHandle;
+#else
+	FDelegateHandle TickerHandle;
+#endif
+};
@@ -23,6 +23,7 @@ FAvatarCacheHandler::FAvatarCacheHandler(const FAvatarUri& AvatarUri, TSharedPtr
 	: AvatarUri(AvatarUri)
 	, ModelData(nullptr)
 	, bMetadataNeedsUpdate(false)
+	, bCanSaveAvatar(true)
 	, AvatarManifest(MoveTemp(Manifest))
 	, AvatarCacheSettings(GetAvatarCacheSettings())
 {
@@ -66,11 +67,6 @@ TOptional<FAvatarMetadata> FAvatarCacheHandler::GetLocalMetadata() const
 	return {};
 }
 
-bool FAvatarCacheHandler::ShouldSaveMetadata() const
-{
-	return bMetadataNeedsUpdate;
-}
-
 void FAvatarCacheHandler::SetUpdatedMetadataStr(const FString& MetadataJson, const FString& UpdatedDate)
 {
 	if (!AvatarCacheSettings.bEnableAvatarCaching)
@@ -79,9 +75,13 @@ void FAvatarCacheHandler::SetUpdatedMetadataStr(const FString& MetadataJson, con
 	}
 	bMetadataNeedsUpdate = IsMedataUpdated(UpdatedDate);
 	UpdatedMetadataStr = MetadataJson;
-	if (FAvatarStorage::FileExists(AvatarUri.LocalMetadataPath) && bMetadataNeedsUpdate)
+	// The metadata of a stale avatar can already be deleted by the revalidation, so the directory is checked instead.
+	if (bMetadataNeedsUpdate && !FAvatarStorage::DeleteDirectory(AvatarUri.LocalAvatarDirectory))
 	{
-		FAvatarStorage::DeleteDirectory(AvatarUri.LocalAvatarDirectory);
+		// The old model is still open, e.g. by an avatar loaded from it that is not released yet.
+		// Without the metadata the next load downloads the avatar again instead of using the old model.
+		FAvatarStorage::DeleteFile(AvatarUri.LocalMetadataPath);
+		bCanSaveAvatar = false;
 	}
 }
 
@@ -97,7 +97,7 @@ void FAvatarCacheHandler::SetModelData(const TArray<uint8>* Data)
 
 void FAvatarCacheHandler::SaveAvatarInCache() const
 {
-	if (AvatarCacheSettings.bEnableAvatarCaching && ModelData != nullptr)
+	if (AvatarCacheSettings.bEnableAvatarCaching && ModelData != nullptr && bCanSaveAvatar)
 	{
 		if (bMetadataNeedsUpdate)
 		{
@@ -110,10 +110,3 @@ void FAvatarCacheHandler::SaveAvatarInCache() const
 		}
 	}
 }
-
-void FAvatarCacheHandler::ResetState()
-{
-	UpdatedMetadataStr = "";
-	ModelData = nullptr;
-	bMetadataNeedsUpdate = false;
-};
@@ -17,11 +17,7 @@ public:
 
 	void SaveAvatarInCache() const;
 
-	void ResetState();
-
 	bool ShouldLoadFromCache() const;
-
-	bool ShouldSaveMetadata() const;
 	
 	TOptional<FAvatarMetadata> GetLocalMetadata() const;
 
@@ -33,6 +29,7 @@ private:
 	FString UpdatedMetadataStr;
 	const TArray<uint8>* ModelData;
 	bool bMetadataNeedsUpdate;
+	bool bCanSaveAvatar;
 
 	TSharedPtr<class FAvatarManifest> AvatarManifest;
 	const FRpmAvatarCacheSettings AvatarCacheSettings;
@@ -52,16 +52,31 @@ bool FAvatarStorage::FileExists(const FString& Path)
 	return !Path.IsEmpty() && FPaths::FileExists(*Path);
 }
 
-void FAvatarStorage::DeleteDirectory(const FString& Path)
+bool FAvatarStorage::DeleteDirectory(const FString& Path)
 {
 	if (Path.IsEmpty())
 	{
-		return;
+		return true;
 	}
 	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 	if (PlatformFile.DirectoryExists(*Path) && !PlatformFile.DeleteDirectoryRecursively(*Path))
 	{
 		UE_LOG(LogReadyPlayerMe, Warning, TEXT("Failed to delete directory"));
+		return false;
+	}
+	return true;
+}
+
+void FAvatarStorage::DeleteFile(const FString& Path)
+{
+	if (Path.IsEmpty())
+	{
+		return;
+	}
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (PlatformFile.FileExists(*Path) && !PlatformFile.DeleteFile(*Path))
+	{
+		UE_LOG(LogReadyPlayerMe, Warning, TEXT("Failed to delete file"));
 	}
 }
 
@@ -15,7 +15,8 @@ public:
 	static bool FileExists(const FString& Path);
 	static FString LoadJson(const FString& Path);
 	static void ClearCache();
-	static void DeleteDirectory(const FString& Path);
+	static bool DeleteDirectory(const FString& Path);
+	static void DeleteFile(const FString& Path);
 	static bool IsCacheEmpty();
 	static void ClearAvatar(const FString& Guid);
 	static TArray<FString> GetSavedAvatars();
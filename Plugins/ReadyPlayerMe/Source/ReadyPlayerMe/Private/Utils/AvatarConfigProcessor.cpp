@@ -8,6 +8,7 @@
 #include "ReadyPlayerMeTypes.h"
 #include "ReadyPlayerMeAvatarConfig.h"
 #include "Kismet/KismetStringLibrary.h"
+#include "Misc/SecureHash.h"
 
 static const TMap<EAvatarPose, FString> POSE_TO_STRING =
 {
@@ -97,3 +98,8 @@ FString FAvatarConfigProcessor::Process(UReadyPlayerMeAvatarConfig* AvatarConfig
 	Parameters.Add("useDracoMeshCompression=" + UKismetStringLibrary::Conv_BoolToString(UseDraco));
 	return "?" + FString::Join(Parameters, TEXT("&"));
 }
+
+FString FAvatarConfigProcessor::MakeHash(const FString& UrlQueryString)
+{
+	return UrlQueryString.IsEmpty() ? "" : FMD5::HashAnsiString(*UrlQueryString).Left(8);
+}
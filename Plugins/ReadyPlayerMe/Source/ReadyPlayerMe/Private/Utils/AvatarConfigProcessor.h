@@ -8,4 +8,6 @@ class FAvatarConfigProcessor
 {
 public:
 	static FString Process(class UReadyPlayerMeAvatarConfig* AvatarConfig);
+
+	static FString MakeHash(const FString& UrlQueryString);
 };
@@ -74,7 +74,8 @@ FAvatarUri FAvatarUrlConvertor::CreateAvatarUri(const FString& Url, UReadyPlayer
 	AvatarUri.MetadataUrl = UrlPath + SUFFIX_JSON;
 
 	const FString AvatarsFolder = FPaths::ProjectPersistentDownloadDir() + "/" + AVATARS_FOLDER + "/" + Guid;
-	const FString ModelFolderName = UrlQueryString.IsEmpty() ? DEFAULT_FOLDER : FMD5::HashAnsiString(*UrlQueryString).Left(8);
+	AvatarUri.ConfigHash = FAvatarConfigProcessor::MakeHash(UrlQueryString);
+	const FString ModelFolderName = AvatarUri.ConfigHash.IsEmpty() ? DEFAULT_FOLDER : AvatarUri.ConfigHash;
 	AvatarUri.LocalAvatarDirectory = AvatarsFolder;
 	AvatarUri.LocalModelPath = AvatarsFolder + "/" + ModelFolderName + "/" + Guid + SUFFIX_GLB;
 	AvatarUri.LocalMetadataPath = AvatarsFolder + "/" + Guid + SUFFIX_JSON;
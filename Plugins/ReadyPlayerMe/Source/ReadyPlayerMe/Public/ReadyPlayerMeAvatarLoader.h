@@ -5,12 +5,16 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "ReadyPlayerMeTypes.h"
+#include "ReadyPlayerMeMemoryCache.h"
 #include "glTFRuntimeParser.h"
 #include "ReadyPlayerMeAvatarLoader.generated.h"
 
 /**
  * Responsible for Loading the avatar from the url and storing it in the local storage.
  * ReadyPlayerMeAvatarLoader is used by ReadyPlayerMeComponent for loading the avatar.
+ * If another loader is already loading the same avatar, it waits for that loader instead of downloading it again.
+ * Loads are started by the avatar load scheduler, the avatars closest to the camera first.
+ * Locally cached avatars are loaded right away and their metadata is revalidated in the background.
  */
 UCLASS(BlueprintType, Meta = (ShowWorldContextPin))
 class READYPLAYERME_API UReadyPlayerMeAvatarLoader : public UObject
@@ -49,6 +53,9 @@ public:
 	USkeletalMesh* SkeletalMesh;
 
 private:
+	friend class UReadyPlayerMeMemoryCache;
+	friend class FAvatarLoadScheduler;
+
 	UFUNCTION()
 	void OnMetadataDownloaded(bool bSuccess);
 
@@ -66,7 +73,19 @@ private:
 
 	void ExecuteFailureCallback(const FString& ErrorMessage);
 
-	void TryLoadFromCache();
+	void ScheduleLoad();
+
+	void StartLoad();
+
+	float GetLoadPriority() const;
+
+	void LeaveJoinedLoad();
+
+	void RestartJoinedLoad(const FAvatarMemoryCacheKey& Key);
+
+	void CompleteJoinedLoad(USkeletalMesh* Mesh, const FAvatarMetadata& Metadata);
+
+	void FailJoinedLoad(const FString& ErrorMessage);
 
 	void Reset();
 
@@ -75,6 +94,16 @@ private:
 	UPROPERTY()
 	class UReadyPlayerMeGlbLoader* GlbLoader;
 
+	UPROPERTY()
+	USkeleton* AvatarTargetSkeleton;
+
+	UPROPERTY()
+	FglTFRuntimeSkeletalMeshConfig AvatarSkeletalMeshConfig;
+
+	TWeakObjectPtr<UReadyPlayerMeMemoryCache> MemoryCache;
+	TOptional<FAvatarMemoryCacheKey> JoinedLoadKey;
+	TWeakPtr<class FAvatarLoadScheduler> LoadScheduler;
+
 	TOptional<FAvatarMetadata> AvatarMetadata;
 	TOptional<FAvatarUri> AvatarUri;
 
@@ -85,6 +114,4 @@ private:
 	FAvatarDownloadCompleted OnAvatarDownloadCompleted;
 	FAvatarLoadFailed OnAvatarLoadFailed;
 	FGlbLoadCompleted OnGlbLoadCompleted;
-
-	bool bIsTryingToUpdate;
 };
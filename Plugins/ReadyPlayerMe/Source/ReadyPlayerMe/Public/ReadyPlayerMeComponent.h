@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "ReadyPlayerMeTypes.h"
+#include "ReadyPlayerMeMemoryCache.h"
 #include "glTFRuntimeParser.h"
 #include "ReadyPlayerMeComponent.generated.h"
 
@@ -99,4 +100,5 @@ private:
 
 	FAvatarDownloadCompleted OnAvatarDownloadCompleted;
 	FAvatarLoadCompleted OnAvatarLoadCompleted;
+	FAvatarMemoryCacheKey MemoryCacheKey;
 };
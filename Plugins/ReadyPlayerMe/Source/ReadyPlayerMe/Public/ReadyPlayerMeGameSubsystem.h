@@ -21,4 +21,6 @@ public:
 	class UReadyPlayerMeMemoryCache* MemoryCache;
 
 	TSharedPtr<class FAvatarManifest> AvatarManifest;
+
+	TSharedPtr<class FAvatarLoadScheduler> LoadScheduler;
 };
\ No newline at end of file
@@ -6,6 +6,49 @@
 #include "ReadyPlayerMeTypes.h"
 #include "ReadyPlayerMeMemoryCache.generated.h"
 
+USTRUCT(BlueprintType)
+struct READYPLAYERME_API FAvatarMemoryCacheKey
+{
+	GENERATED_BODY()
+
+	FAvatarMemoryCacheKey() = default;
+
+	FAvatarMemoryCacheKey(const FString& InAvatarId, const FString& InAvatarConfigHash, const FString& InSkeletalMeshConfigHash = FString())
+		: AvatarId(InAvatarId)
+		, AvatarConfigHash(InAvatarConfigHash)
+		, SkeletalMeshConfigHash(InSkeletalMeshConfigHash)
+	{
+	}
+
+	/** Builds the key of an avatar, the config query string is processed and hashed here once. */
+	FAvatarMemoryCacheKey(const FString& InAvatarId, class UReadyPlayerMeAvatarConfig* AvatarConfig);
+
+	/** Builds the key of an avatar loaded for a skeleton with a skeletal mesh config. */
+	FAvatarMemoryCacheKey(const FString& InAvatarId, class UReadyPlayerMeAvatarConfig* AvatarConfig, USkeleton* TargetSkeleton, const struct FglTFRuntimeSkeletalMeshConfig& SkeletalMeshConfig);
+
+	/** Hashes the skeleton and the skeletal mesh config, the same avatar loaded with different ones is a different mesh. */
+	static FString MakeSkeletalMeshConfigHash(USkeleton* TargetSkeleton, const struct FglTFRuntimeSkeletalMeshConfig& SkeletalMeshConfig);
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ReadyPlayerMe")
+	FString AvatarId;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ReadyPlayerMe")
+	FString AvatarConfigHash;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ReadyPlayerMe")
+	FString SkeletalMeshConfigHash;
+
+	bool operator==(const FAvatarMemoryCacheKey& Other) const
+	{
+		return AvatarId == Other.AvatarId && AvatarConfigHash == Other.AvatarConfigHash && SkeletalMeshConfigHash == Other.SkeletalMeshConfigHash;
+	}
+
+	friend uint32 GetTypeHash(const FAvatarMemoryCacheKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.AvatarId), GetTypeHash(Key.AvatarConfigHash)), GetTypeHash(Key.SkeletalMeshConfigHash));
+	}
+};
+
 USTRUCT(BlueprintType)
 struct FAvatarMemoryCacheData
 {
@@ -20,13 +63,26 @@ struct FAvatarMemoryCacheData
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReadyPlayerMe")
 	USkeletalMesh* SkeletalMesh = nullptr;
 
+	/** Hash of the skeleton and skeletal mesh config the avatar was loaded with, empty for the avatars added with AddAvatar. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ReadyPlayerMe")
+	FString SkeletalMeshConfigHash;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReadyPlayerMe")
 	FAvatarMetadata Metadata;
+
+	/** Estimated memory used by the skeletal mesh and its runtime textures. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ReadyPlayerMe")
+	int64 SizeBytes = 0;
+
+	/** Stamp of the last lookup, the lowest stamp is evicted first. */
+	mutable uint64 LastAccess = 0;
 };
 
 /**
  * Is used to preload avatars and store the cached skeletal meshes.
- * Cached avatars will be instantiated instantly. 
+ * Cached avatars will be instantiated instantly.
+ * The least recently used avatars are evicted when the memory cache budget of the settings is exceeded.
+ * It also tracks the avatars being loaded, so concurrent loads of the same avatar share one download and one parse.
  */
 UCLASS(Blueprintable, BlueprintType)
 class READYPLAYERME_API UReadyPlayerMeMemoryCache : public UObject
@@ -36,6 +92,7 @@ class READYPLAYERME_API UReadyPlayerMeMemoryCache : public UObject
 public:
 	/**
 	 * Returns the preload avatar data for a specific avatar.
+	 * If the avatar was loaded for several skeletons or skeletal mesh configs, the most recently used one is returned.
 	 *
 	 * @param AvatarId Avatar url.
 	 * @param AvatarConfig Avatar config.
@@ -66,7 +123,58 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Ready Player Me")
 	void ClearAvatars();
 
+	/**
+	 * Returns the cached avatar data, or nullptr if the avatar is not in the memory.
+	 * An avatar added with AddAvatar is returned for any skeletal mesh config when none was loaded for the one of the key.
+	 */
+	const FAvatarMemoryCacheData* FindAvatar(const FAvatarMemoryCacheKey& Key) const;
+
+	/** Adds an already loaded avatar to the memory, evicting the least recently used avatars if over budget. */
+	void StoreAvatar(const FAvatarMemoryCacheKey& Key, USkeletalMesh* SkeletalMesh, const FAvatarMetadata& Metadata);
+
+	/**
+	 * Registers the loader for the avatar.
+	 * Returns true if the loader has to download the avatar itself, false if it will be called back
+	 * by the loader that is already downloading the same avatar for the same skeleton.
+	 */
+	bool JoinLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, class UReadyPlayerMeAvatarLoader* Loader);
+
+	/** Unregisters a cancelled loader, if it was downloading the avatar the waiting loaders restart on the next tick. */
+	void LeaveLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, class UReadyPlayerMeAvatarLoader* Loader);
+
+	/** Passes the loaded avatar to all the loaders waiting for it. */
+	void CompleteLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, USkeletalMesh* SkeletalMesh, const FAvatarMetadata& Metadata);
+
+	/** Passes the error to all the loaders waiting for the avatar. */
+	void FailLoad(const FAvatarMemoryCacheKey& Key, USkeleton* TargetSkeleton, const FString& ErrorMessage);
+
 	/** Avatar Data for all the preloaded avatars. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ReadyPlayerMe")
 	TArray<FAvatarMemoryCacheData> CachedAvatars;
+
+	/** Estimated memory used by all the preloaded avatars. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "ReadyPlayerMe")
+	int64 CachedAvatarsSizeBytes = 0;
+
+private:
+	struct FInFlightLoad
+	{
+		TWeakObjectPtr<class UReadyPlayerMeAvatarLoader> Leader;
+		TArray<TWeakObjectPtr<class UReadyPlayerMeAvatarLoader>> Waiters;
+	};
+
+	typedef TPair<FAvatarMemoryCacheKey, TWeakObjectPtr<USkeleton>> FInFlightKey;
+
+	TArray<TWeakObjectPtr<class UReadyPlayerMeAvatarLoader>> TakeWaiters(const FInFlightKey& InFlightKey);
+
+	void EvictToBudget(const FAvatarMemoryCacheKey& KeepKey);
+
+	void RemoveCachedAvatarAt(int32 Index);
+
+	/** Index in CachedAvatars of every cached avatar. */
+	TMap<FAvatarMemoryCacheKey, int32> CachedAvatarIndices;
+
+	TMap<FInFlightKey, FInFlightLoad> InFlightLoads;
+
+	mutable uint64 AccessCounter = 0;
 };
@@ -77,5 +77,7 @@ private:
 	class UReadyPlayerMeMemoryCache* MemoryCache = nullptr;
 
 	FAvatarPreloadData PreloadData;
+	FString AvatarConfigHash;
+	FString SkeletalMeshConfigHash;
 	int32 FailedRequestCount = 0;
 };
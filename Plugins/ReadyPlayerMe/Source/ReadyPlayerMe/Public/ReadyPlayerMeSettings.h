@@ -49,6 +49,14 @@ public:
 		ToolTip = "If checked, the loaded avatars will be kept in the memory and will be reused afterwards."))
 	bool bKeepLoadedAvatarsInMemory;
 
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "Settings", meta = (DisplayName = "Memory Cache Budget MB", ClampMin = "0",
+		ToolTip = "The memory limit of the avatars kept in the memory, when it is exceeded the least recently used avatars are removed. Zero means no limit."))
+	int32 MemoryCacheBudgetMB;
+
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "Settings", meta = (DisplayName = "Max Concurrent Avatar Loads", ClampMin = "0",
+		ToolTip = "The number of avatars downloaded and loaded at the same time, the avatars closest to the camera are loaded first. Zero means no limit."))
+	int32 MaxConcurrentAvatarLoads;
+
 	UPROPERTY(Config, EditAnywhere, Category = "Settings", meta = (DisplayName = "Avatar Cache Settings",
 	ToolTip = "Settings for saving the avatars in the local storage."))
 	FRpmAvatarCacheSettings AvatarCacheSettings;
@@ -204,6 +204,7 @@ DECLARE_DYNAMIC_DELEGATE_OneParam(FGlbLoadCompleted, class USkeletalMesh*, Skele
 struct FAvatarUri
 {
 	FString Guid;
+	FString ConfigHash;
 	FString ModelUrl;
 	FString LocalModelPath;
 	FString MetadataUrl;
@@ -3,72 +3,105 @@
 #include "AsyncCompressTexture.h"
 #include "Kismet/KismetRenderingLibrary.h"
 #include "Kismet/KismetMaterialLibrary.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "RenderingThread.h"
+#include "RHIGPUReadback.h"
+#include "UObject/GCObject.h"
 
 DEFINE_LOG_CATEGORY(LogReplicatedTexture);
 
-UAsyncCompressTexture::UAsyncCompressTexture(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer), WorldContextObject(nullptr), textureToCompress(nullptr)
+namespace
 {
+    /* Render targets of finished compressions, kept for the next compression of the same size */
+    class FCompressRenderTargetPool : public FGCObject
+    {
+    public:
+        static FCompressRenderTargetPool& Get()
+        {
+            static FCompressRenderTargetPool Pool;
+            return Pool;
+        }
 
-}
+        UTextureRenderTarget2D* Acquire(UObject* WorldContextObject, int32 Width, int32 Height)
+        {
+            for (int32 i = FreeRenderTargets.Num() - 1; i >= 0; i--) {
+                UTextureRenderTarget2D* renderTarget = FreeRenderTargets[i];
+                if (renderTarget && renderTarget->SizeX == Width && renderTarget->SizeY == Height) {
+                    FreeRenderTargets.RemoveAtSwap(i);
+                    return renderTarget;
+                }
+            }
 
-UAsyncCompressTexture* UAsyncCompressTexture::CompressTexture(UObject* WorldContextObject, UTexture* textureToCompress = nullptr, int32 quality = 90, UMaterialInterface* MaterialRT = nullptr, bool exportCompressedTextureToDisk = false, FString pathExportCompressedTextureToDisk = "")
-{
-    UAsyncCompressTexture* BlueprintNode = NewObject<UAsyncCompressTexture>();
-    BlueprintNode->WorldContextObject = WorldContextObject;
+            // 8 bit sRGB, so the readback holds the same bytes ReadRenderTarget used to return
+            return UKismetRenderingLibrary::CreateRenderTarget2D(WorldContextObject, Width, Height, RTF_RGBA8_SRGB);
+        }
 
-    UTexture2D* tryTexture2D = Cast<UTexture2D>(textureToCompress);
-    if (tryTexture2D)
-    {
-        BlueprintNode->textureToCompress = Cast<UTexture2D>(tryTexture2D);
-    }
-    else
-    {
-        UTextureRenderTarget2D* tryTextureRT2D = Cast<UTextureRenderTarget2D>(textureToCompress);
-        TArray<FColor> OutSamples;
-        bool resReadRT = UKismetRenderingLibrary::ReadRenderTarget(WorldContextObject, tryTextureRT2D, OutSamples, true);
+        void Release(UTextureRenderTarget2D* renderTarget)
+        {
+            if (FreeRenderTargets.Num() >= MaxFreeRenderTargets) {
+                FreeRenderTargets.RemoveAt(0);
+            }
+            FreeRenderTargets.Add(renderTarget);
+        }
 
-        int32 widthRT = tryTextureRT2D->SizeX;
-        int32 heightRT = tryTextureRT2D->SizeY;
-        UTexture2D* texture2DFromRT = UTexture2D::CreateTransient(widthRT, heightRT);
+        virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+        {
+            Collector.AddReferencedObjects(FreeRenderTargets);
+        }
 
-        if (texture2DFromRT)
+        virtual FString GetReferencerName() const override
         {
-            texture2DFromRT->CompressionSettings = tryTextureRT2D->CompressionSettings;
-            texture2DFromRT->SRGB = true;
-            texture2DFromRT->UpdateResource();
-            int32 nbBytesArrayRBGA = sizeof(uint8) * widthRT * heightRT * 4;
-            uint8* PixelsDraw = (uint8*)malloc(nbBytesArrayRBGA);
-
-            for (int32 y = 0; y < heightRT; y++)
-            {
-                for (int32 x = 0; x < widthRT; x++)
-                {
-                    //Get the current pixel
-                    int32 CurrentPixelIndex = ((y * widthRT) + x);
-                    int32 CurrentPixelIndexRGB = 3 * CurrentPixelIndex;
-                    int32 CurrentPixelIndexRGBA = 4 * CurrentPixelIndex;
-                    PixelsDraw[CurrentPixelIndexRGBA] = OutSamples[CurrentPixelIndex].B;
-                    PixelsDraw[CurrentPixelIndexRGBA + 1] = OutSamples[CurrentPixelIndex].G;
-                    PixelsDraw[CurrentPixelIndexRGBA + 2] = OutSamples[CurrentPixelIndex].R;
-                    PixelsDraw[CurrentPixelIndexRGBA + 3] = OutSamples[CurrentPixelIndex].A;
-                }
-            }
+            return TEXT("FCompressRenderTargetPool");
+        }
 
-            //Lock the mipmap data so it can be modified
-            texture2DFromRT->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-            uint8* TextureData = (uint8*)texture2DFromRT->GetPlatformData()->Mips[0].BulkData.Realloc(widthRT * heightRT * 4);
-            //Copy the pixel data into the Texture data
-            FMemory::Memcpy(TextureData, PixelsDraw, sizeof(uint8) * widthRT * heightRT * 4);
-            texture2DFromRT->GetPlatformData()->Mips[0].BulkData.Unlock();
-            texture2DFromRT->UpdateResource();
+    private:
+        static constexpr int32 MaxFreeRenderTargets = 4;
 
-            BlueprintNode->textureToCompress = texture2DFromRT;
+        TArray<UTextureRenderTarget2D*> FreeRenderTargets;
+    };
+
+    // B8G8R8A8 to R8G8B8, the layout TooJpeg expects
+    void SwizzleBGRAToRGB(const uint8* src, uint8* dst, int32 numPixels)
+    {
+        int32 i = 0;
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+        for (; i + 16 <= numPixels; i += 16) {
+            const uint8x16x4_t bgra = vld4q_u8(src + i * 4);
+            uint8x16x3_t rgb;
+            rgb.val[0] = bgra.val[2];
+            rgb.val[1] = bgra.val[1];
+            rgb.val[2] = bgra.val[0];
+            vst3q_u8(dst + i * 3, rgb);
+        }
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_ALWAYS_HAS_SSE4_1
+        // 4 pixels per step, the 16 byte store spills 4 bytes into the next pixels so stop 2 pixels early
+        const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        for (; i + 6 <= numPixels; i += 4) {
+            const __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), _mm_shuffle_epi8(bgra, shuffle));
         }
-        else {
-            BlueprintNode->textureToCompress = nullptr;
+#endif
+        for (; i < numPixels; i++) {
+            dst[i * 3] = src[i * 4 + 2];
+            dst[i * 3 + 1] = src[i * 4 + 1];
+            dst[i * 3 + 2] = src[i * 4];
         }
     }
+}
+
+UAsyncCompressTexture::UAsyncCompressTexture(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer), WorldContextObject(nullptr), textureToCompress(nullptr)
+{
+
+}
+
+UAsyncCompressTexture* UAsyncCompressTexture::CompressTexture(UObject* WorldContextObject, UTexture* textureToCompress = nullptr, int32 quality = 90, UMaterialInterface* MaterialRT = nullptr, bool exportCompressedTextureToDisk = false, FString pathExportCompressedTextureToDisk = "")
+{
+    UAsyncCompressTexture* BlueprintNode = NewObject<UAsyncCompressTexture>();
+    BlueprintNode->WorldContextObject = WorldContextObject;
 
+    // render targets are sampled by MaterialRT like any other texture, no CPU round trip needed
+    BlueprintNode->textureToCompress = textureToCompress;
     BlueprintNode->quality = quality;
     BlueprintNode->exportCompressedTextureToDisk = exportCompressedTextureToDisk;
     BlueprintNode->pathExportCompressedTextureToDisk = pathExportCompressedTextureToDisk;
@@ -90,7 +123,8 @@ void UAsyncCompressTexture::Activate()
 
     WorldContextObject->GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UAsyncCompressTexture::GetTextureToCompressRGBData);
 
-    WorldContextObject->GetWorld()->GetTimerManager().SetTimer(timerPollCompressThread, this, &UAsyncCompressTexture::PollCompressThread, 0.200f, true);
+    // polls the GPU readback first, then the compression
+    WorldContextObject->GetWorld()->GetTimerManager().SetTimer(timerPollCompressThread, this, &UAsyncCompressTexture::PollCompressThread, 0.033f, true);
 }
 
 void UAsyncCompressTexture::GetTextureToCompressRGBData()
@@ -99,61 +133,45 @@ void UAsyncCompressTexture::GetTextureToCompressRGBData()
 
     if (textureToCompress != nullptr) {
 
-        UTextureRenderTarget2D* renderTarget = UKismetRenderingLibrary::CreateRenderTarget2D(WorldContextObject,
-            textureToCompress->GetSizeX(), textureToCompress->GetSizeY());
+        int32 TextureWidth = (int32)textureToCompress->GetSurfaceWidth();
+        int32 TextureHeight = (int32)textureToCompress->GetSurfaceHeight();
+
+        UTextureRenderTarget2D* renderTarget = FCompressRenderTargetPool::Get().Acquire(WorldContextObject, TextureWidth, TextureHeight);
         UE_LOG(LogReplicatedTexture, Warning, TEXT("renderTarget null ? %d "), renderTarget == nullptr);
 
         UMaterialInstanceDynamic* dynamicMat = UKismetMaterialLibrary::CreateDynamicMaterialInstance(WorldContextObject, MaterialRT);
         dynamicMat->SetTextureParameterValue("TextureParam", textureToCompress);
         UE_LOG(LogReplicatedTexture, Warning, TEXT("dynamicMat null ? %d "), dynamicMat == nullptr);
 
-
         UKismetRenderingLibrary::DrawMaterialToRenderTarget(WorldContextObject, renderTarget, dynamicMat);
 
-        TArray<FColor> PixelData;
-        bool resReadRT = UKismetRenderingLibrary::ReadRenderTarget(WorldContextObject, renderTarget, PixelData);
-        UE_LOG(LogReplicatedTexture, Warning, TEXT("ReadRenderTarget %d "), resReadRT);
-
-        uint32 TextureWidth = textureToCompress->GetSizeX();
-        uint32 TextureHeight = textureToCompress->GetSizeY();
-        FColor PixelColor;
-
-        UE_LOG(LogReplicatedTexture, Warning, TEXT("textureToCompress TextureWidth %d TextureHeight %d size fcolor %d "), TextureWidth, TextureHeight, sizeof(FColor));
-
-        // 3 bytes per pixel RGB
-        int numRGBBytes = 3 * TextureWidth * TextureHeight;
-        uint8* rgbData = (uint8*)malloc(numRGBBytes);
-
-        for (uint32 i = 0; i < TextureHeight; i++) {
-            for (uint32 j = 0; j < TextureWidth; j++) {
-                int32 toAccess = i * TextureWidth + j;
-                PixelColor = PixelData[toAccess];
-                int32 bytesPerPixel = 3;
-                int32 offset = (i * TextureWidth + j) * bytesPerPixel;
-                rgbData[offset] = PixelColor.R;
-                rgbData[offset + 1] = PixelColor.G;
-                rgbData[offset + 2] = PixelColor.B;
-            }
-            //UE_LOG(LogReplicatedTexture, Warning, TEXT("for i * TextureWidth %d sizeof(FColor) %d"), i * TextureWidth, sizeof(FColor));
-            /*UE_LOG(LogReplicatedTexture, Warning, TEXT("for i * TextureWidth %d sizeof(FColor) %d GetBulkDataSize %d"), i * TextureWidth, sizeof(FColor), RawImageData->GetBulkDataSize());*/
-        }
+        UE_LOG(LogReplicatedTexture, Warning, TEXT("begin readback %d %d"), TextureWidth, TextureHeight);
 
-        UE_LOG(LogReplicatedTexture, Warning, TEXT("begin writeJpeg %d %d"), TextureWidth, TextureHeight);
+        CompressTask = MakeShared<FCompressTask, ESPMode::ThreadSafe>(quality, TextureWidth, TextureHeight);
+        CompressTask->EnqueueReadback(renderTarget);
 
-        CompressThread = new FCompressThread(rgbData, &RGBDataJPEG, quality, TextureWidth, TextureHeight);
+        // render commands run in order, so the next user of this render target draws after our copy
+        FCompressRenderTargetPool::Get().Release(renderTarget);
         return;
     }
 }
 
 void UAsyncCompressTexture::PollCompressThread() {
 
-    if (CompressThread && CompressThread->isFinished) {
+    if (CompressTask) {
+        CompressTask->PollReadback();
+    }
+
+    if (CompressTask && CompressTask->isFinished) {
 
         UE_LOG(LogReplicatedTexture, Warning, TEXT("PollCompressThread finished"));
 
         WorldContextObject->GetWorld()->GetTimerManager().ClearTimer(timerPollCompressThread);
         timerPollCompressThread.Invalidate();
 
+        RGBDataJPEG = MoveTemp(CompressTask->rgbDataResult);
+        CompressTask.Reset();
+
         if (exportCompressedTextureToDisk) {
             UE_LOG(LogReplicatedTexture, Warning, TEXT("PollCompressThread writing file begin"));
             FILE* filetestjpeg = fopen(TCHAR_TO_ANSI(*pathExportCompressedTextureToDisk), "wb");
@@ -169,73 +187,116 @@ void UAsyncCompressTexture::PollCompressThread() {
 }
 
 /////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////// FCompressThread ////////////////////////////////
+///////////////////////////////// FCompressTask /////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////
 
-bool FCompressThread::isTooJPEGCompressing = false;
+FCompressTask::FCompressTask(int32 _quality, int32 _TextureWidth, int32 _TextureHeight) :
+    quality(_quality), TextureWidth(_TextureWidth), TextureHeight(_TextureHeight)
+{
+}
 
-FCompressThread::FCompressThread(uint8* _rgbDataToEncode, TArray<uint8>* _rgbDataResult, int32 _quality, int32 _TextureWidth, int32 _TextureHeight) :
-    rgbDataToCompress(_rgbDataToEncode), rgbDataResult(_rgbDataResult), quality(_quality), TextureWidth(_TextureWidth), TextureHeight(_TextureHeight)
+FCompressTask::~FCompressTask()
 {
-    Thread = FRunnableThread::Create(this, TEXT("FCompressThread"), 0, TPri_BelowNormal); //windows default = 8mb for thread, could specify more
-    isFinished = false;
 }
 
-FCompressThread::~FCompressThread()
+void FCompressTask::EnqueueReadback(UTextureRenderTarget2D* _renderTarget)
 {
-    free(rgbDataToCompress);
-    delete Thread;
-    Thread = NULL;
+    FTextureRenderTargetResource* renderTargetResource = _renderTarget ? _renderTarget->GameThread_GetRenderTargetResource() : nullptr;
+
+    ENQUEUE_RENDER_COMMAND(CompressTextureReadback)([this, Task = AsShared(), renderTargetResource](FRHICommandListImmediate& RHICmdList)
+        {
+            if (!renderTargetResource || !renderTargetResource->GetRenderTargetTexture()) {
+                UE_LOG(LogReplicatedTexture, Error, TEXT("FCompressTask::EnqueueReadback no render target"));
+                isFinished = true;
+                return;
+            }
+
+            Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("CompressTextureReadback"));
+            Readback->EnqueueCopy(RHICmdList, renderTargetResource->GetRenderTargetTexture());
+        });
+}
+
+void FCompressTask::PollReadback()
+{
+    if (isPollQueued.exchange(true)) {
+        return;
+    }
+
+    // the staging texture can only be mapped on the render thread
+    ENQUEUE_RENDER_COMMAND(CompressTextureMapReadback)([this, Task = AsShared()](FRHICommandListImmediate& RHICmdList)
+        {
+            isPollQueued = false;
+            if (!Readback || !Readback->IsReady()) {
+                return;
+            }
+
+            int32 rowPitchInPixels = 0;
+            const uint8* mappedPixels = static_cast<const uint8*>(Readback->Lock(rowPitchInPixels));
+            if (mappedPixels) {
+                rgbDataToCompress.SetNumUninitialized(TextureWidth * TextureHeight * 3);
+
+                // mapped rows are swizzled straight into the encoder input
+                ParallelFor(TextureHeight, [this, mappedPixels, rowPitchInPixels](int32 row)
+                    {
+                        SwizzleBGRAToRGB(mappedPixels + (int64)row * rowPitchInPixels * 4, rgbDataToCompress.GetData() + (int64)row * TextureWidth * 3, TextureWidth);
+                    });
+            }
+            Readback->Unlock();
+            Readback.Reset();
+
+            if (!mappedPixels) {
+                UE_LOG(LogReplicatedTexture, Error, TEXT("FCompressTask::PollReadback failed to map the readback"));
+                isFinished = true;
+                return;
+            }
+
+            Launch();
+        });
 }
 
-bool FCompressThread::Init()
+void FCompressTask::Launch()
 {
-    return true;
+    Async(EAsyncExecution::TaskGraph, [Task = AsShared()]()
+        {
+            Task->DoWork();
+        });
 }
 
-uint32 FCompressThread::Run()
+void FCompressTask::DoWork()
 {
-    UE_LOG(LogReplicatedTexture, Warning, TEXT("FCompressThread::Run begin"));
-
-    bool hasCompressed = false;
-    int maxRetry = 15;
-    int retry = 0;
-
-    while (!hasCompressed && retry++ < maxRetry) {
-        if (!isTooJPEGCompressing) {
-            isTooJPEGCompressing = true;
-            TooJpeg::writeJpeg(
-                [](unsigned char byte, void* data) -> void {
-                    TArray<uint8>& dest = *reinterpret_cast<TArray<uint8>*>(data);
-                    dest.Add(byte);
-                    if (dest.Num() % 1000000 == 0) { // sleep thread to avoid consuming all CPU ressource
-                        FPlatformProcess::Sleep(0.033f);
-                    }
-                },
-                [](bool res) -> void {
-                    
-                },
-                rgbDataResult,
-                    rgbDataToCompress, TextureWidth, TextureHeight, true, quality, false, nullptr, &hasCompressed);
-           
-        }
-        else {
-            FPlatformProcess::Sleep(1.0f);
-        }
-        isTooJPEGCompressing = false;
+    UE_LOG(LogReplicatedTexture, Warning, TEXT("FCompressTask::DoWork begin"));
+
+    // about a quarter of the RGB size, enough for most images to avoid any reallocation
+    rgbDataResult.Reserve(TextureWidth * TextureHeight * 3 / 4);
+
+    // roughly one strip per worker, strips are rounded to whole MCU rows by the encoder
+    const int32 NumWorkers = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+    const int32 StripHeight = FMath::Clamp(FMath::DivideAndRoundUp(TextureHeight, NumWorkers), MinStripHeight, (int32)MAX_uint16);
+
+    bool hasCompressed = TextureWidth <= MAX_uint16 && TextureHeight <= MAX_uint16 && TooJpeg::writeJpegStrips(&FCompressTask::WriteBytes, &rgbDataResult,
+        rgbDataToCompress.GetData(), TextureWidth, TextureHeight, true, quality, false, StripHeight, &FCompressTask::ParallelForStrips, nullptr);
+
+    if (!hasCompressed) {
+        UE_LOG(LogReplicatedTexture, Error, TEXT("FCompressTask::DoWork failed to compress %d %d"), TextureWidth, TextureHeight);
+        rgbDataResult.Reset();
     }
-    
 
-    UE_LOG(LogReplicatedTexture, Warning, TEXT("FCompressThread::Run end %d %d %d"), rgbDataResult->Num(), TextureWidth, TextureHeight);
+    UE_LOG(LogReplicatedTexture, Warning, TEXT("FCompressTask::DoWork end %d %d %d"), rgbDataResult.Num(), TextureWidth, TextureHeight);
 
     isFinished = true;
-
-    return 0;
 }
 
-void FCompressThread::Stop()
+void FCompressTask::WriteBytes(const unsigned char* bytes, unsigned int numBytes, void* data_ptr)
 {
+    reinterpret_cast<TArray<uint8>*>(data_ptr)->Append(bytes, numBytes);
+}
 
+void FCompressTask::ParallelForStrips(int numTasks, void (*task)(int, void*), void* task_ptr, void* parallel_ptr)
+{
+    ParallelFor(numTasks, [task, task_ptr](int32 taskIndex)
+        {
+            task(taskIndex, task_ptr);
+        });
 }
 
 void URuntimeTextureCompressionBPLib::ByteArrayAppend(UPARAM(ref) TArray<uint8>& Destination, const TArray<uint8>& DataToAppend, int32 AppendStartIndex, int32 AppendEndIndex) {
@@ -1,8 +1,56 @@
 // Replicated Texture MeoPlay Copyright (C) 2023 MeoPlay <contact@meoplay.com> All Rights Reserved.
 
 #include "AsyncDecompressTexture.h"
-#include "ImageWriteBlueprintLibrary.h"
+#include "AsyncCompressTexture.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
 
+namespace
+{
+    // R8G8B8 from the decoder to B8G8R8A8 with opaque alpha
+    void SwizzleRGBToBGRA(const uint8* src, uint8* dst, int32 numPixels)
+    {
+        int32 i = 0;
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+        for (; i + 16 <= numPixels; i += 16) {
+            const uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+            uint8x16x4_t bgra;
+            bgra.val[0] = rgb.val[2];
+            bgra.val[1] = rgb.val[1];
+            bgra.val[2] = rgb.val[0];
+            bgra.val[3] = vdupq_n_u8(255);
+            vst4q_u8(dst + i * 4, bgra);
+        }
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_ALWAYS_HAS_SSE4_1
+        // 4 pixels per step, the 16 byte load reads 4 bytes of the next pixels so stop 2 pixels early
+        const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+        const __m128i alpha = _mm_set1_epi32(0xFF000000);
+        for (; i + 6 <= numPixels; i += 4) {
+            const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+        }
+#endif
+        for (; i < numPixels; i++) {
+            dst[i * 4] = src[i * 3 + 2];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + 2] = src[i * 3];
+            dst[i * 4 + 3] = 255;
+        }
+    }
+
+    // 8 bit luminance to B8G8R8A8 with opaque alpha
+    void SwizzleGrayToBGRA(const uint8* src, uint8* dst, int32 numPixels)
+    {
+        for (int32 i = 0; i < numPixels; i++) {
+            dst[i * 4] = dst[i * 4 + 1] = dst[i * 4 + 2] = src[i];
+            dst[i * 4 + 3] = 255;
+        }
+    }
+
+    // rows converted per ParallelFor task
+    constexpr int32 SwizzleRowsPerTask = 64;
+}
 
 UAsyncDecompressTexture::UAsyncDecompressTexture(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer), WorldContextObject(nullptr)
 {
@@ -12,15 +60,17 @@ UAsyncDecompressTexture::UAsyncDecompressTexture(const FObjectInitializer& Objec
 UAsyncDecompressTexture* UAsyncDecompressTexture::DecompressTexture(const UObject* WorldContextObject,
     TArray<uint8> inputRGBDataJPEG,
     TextureCompressionSettings textureCompressionSettings = TextureCompressionSettings::TC_Default,
-    bool textureSettingSRGB = false, bool exportToDisk = false, FString pathExportToDisk = "")
+    bool textureSettingSRGB = false, bool exportToDisk = false, FString pathExportToDisk = "", int32 scaleDenominator = 1)
 {
     UAsyncDecompressTexture* BlueprintNode = NewObject<UAsyncDecompressTexture>();
     BlueprintNode->WorldContextObject = WorldContextObject;
-    BlueprintNode->inputRGBDataJPEG = inputRGBDataJPEG;
     BlueprintNode->exportToDisk = exportToDisk;
     BlueprintNode->pathExportToDisk = pathExportToDisk;
     BlueprintNode->textureCompressionSettings = textureCompressionSettings;
     BlueprintNode->textureSettingSRGB = textureSettingSRGB;
+
+    const int32 scaleShift = scaleDenominator >= 8 ? 3 : scaleDenominator >= 4 ? 2 : scaleDenominator >= 2 ? 1 : 0;
+    BlueprintNode->DecompressTask = MakeShared<FDecompressTask, ESPMode::ThreadSafe>(MoveTemp(inputRGBDataJPEG), scaleShift, exportToDisk ? pathExportToDisk : FString());
     return BlueprintNode;
 }
 
@@ -32,99 +82,43 @@ void UAsyncDecompressTexture::Activate()
         return;
     }
 
-    WorldContextObject->GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UAsyncDecompressTexture::LaunchDecompressThread);
+    UE_LOG(LogReplicatedTexture, Warning, TEXT("UAsyncDecompressTexture::Activate"));
 
-    WorldContextObject->GetWorld()->GetTimerManager().SetTimer(timerPollDecompressThread, this, &UAsyncDecompressTexture::PollDecompressThread, 0.200f, true);
+    DecompressTask->Launch([WeakThis = TWeakObjectPtr<UAsyncDecompressTexture>(this)]()
+        {
+            if (UAsyncDecompressTexture* This = WeakThis.Get()) {
+                This->OnDecompressFinished();
+            }
+        });
 }
 
-void UAsyncDecompressTexture::LaunchDecompressThread()
+void UAsyncDecompressTexture::OnDecompressFinished()
 {
-    UE_LOG(LogReplicatedTexture, Warning, TEXT("UAsyncCompressTexture::LaunchDecompressThread"));
-
-    DecompressThread = new FDecompressThread(&inputRGBDataJPEG);
-    return;
-}
-
-void UAsyncDecompressTexture::checkExportResult(bool success) {
-    UE_LOG(LogReplicatedTexture, Warning, TEXT("checkExportResult success %d "), success);
-}
-
-void UAsyncDecompressTexture::PollDecompressThread() {
-    if (DecompressThread->isFinished) {
-        UE_LOG(LogReplicatedTexture, Warning, TEXT("PollDecompressThread finished, starting creating Unreal texture2D"));
-        WorldContextObject->GetWorld()->GetTimerManager().ClearTimer(timerPollDecompressThread);
-        timerPollDecompressThread.Invalidate();
+    int32 widthDecoded = DecompressTask->decodedWidth;
+    int32 heightDecoded = DecompressTask->decodedHeight;
+    UE_LOG(LogReplicatedTexture, Warning, TEXT("OnDecompressFinished, textureJpegResult CreateTransient %d %d"), widthDecoded, heightDecoded);
 
+    textureJpegResult = DecompressTask->pixelsBGRA.Num() > 0 ? UTexture2D::CreateTransient(widthDecoded, heightDecoded) : nullptr;
 
-        int32 widthDecoded = DecompressThread->decodedWidth;
-        int32 heightDecoded = DecompressThread->decodedHeight;
-        UE_LOG(LogReplicatedTexture, Warning, TEXT("textureJpegResult CreateTransient %d %d"), widthDecoded, heightDecoded);
-
-        textureJpegResult = UTexture2D::CreateTransient(widthDecoded, heightDecoded);
-
-        if (textureJpegResult)
-        {
-            textureJpegResult->CompressionSettings = textureCompressionSettings;
-            textureJpegResult->SRGB = textureSettingSRGB;
-            textureJpegResult->UpdateResource();
-            int32 nbBytesArrayRBGA = sizeof(uint8) * widthDecoded * heightDecoded * 4;
-            uint8* PixelsDraw = (uint8*)malloc(nbBytesArrayRBGA);
-
-            //UE_LOG(LogReplicatedTexture, Warning, TEXT("textureJpegResult PixelsDraw size %d decoderimage size %d"), nbBytesArrayRBGA, decoder.GetImageSize());
-
-            for (int32 y = 0; y < heightDecoded; y++)
+    if (textureJpegResult)
+    {
+        textureJpegResult->CompressionSettings = textureCompressionSettings;
+        textureJpegResult->SRGB = textureSettingSRGB;
+        textureJpegResult->UpdateResource();
+
+        // the converted pixels go to the render thread as they are, freed once uploaded
+        TArray<uint8>* pixelsBGRA = new TArray<uint8>(MoveTemp(DecompressTask->pixelsBGRA));
+        textureJpegResult->UpdateTextureRegions(0, 1, new FUpdateTextureRegion2D(0, 0, 0, 0, widthDecoded, heightDecoded), widthDecoded * 4, 4, pixelsBGRA->GetData(),
+            [pixelsBGRA](uint8*, const FUpdateTextureRegion2D* region)
             {
-                for (int32 x = 0; x < widthDecoded; x++)
-                {
-                    //Get the current pixel
-                    int32 CurrentPixelIndex = ((y * widthDecoded) + x);
-                    int32 CurrentPixelIndexRGB = 3 * CurrentPixelIndex;
-                    int32 CurrentPixelIndexRGBA = 4 * CurrentPixelIndex;
-                    PixelsDraw[CurrentPixelIndexRGBA] = DecompressThread->decoder->GetImage()[CurrentPixelIndexRGB + 2]; //b
-                    PixelsDraw[CurrentPixelIndexRGBA + 1] = DecompressThread->decoder->GetImage()[CurrentPixelIndexRGB + 1]; //g
-                    PixelsDraw[CurrentPixelIndexRGBA + 2] = DecompressThread->decoder->GetImage()[CurrentPixelIndexRGB]; //r
-                    PixelsDraw[CurrentPixelIndexRGBA + 3] = 255; //set A channel always to maximum
-                }
-            }
-
-            //Lock the mipmap data so it can be modified
-            textureJpegResult->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-            uint8* TextureData = (uint8*)textureJpegResult->GetPlatformData()->Mips[0].BulkData.Realloc(widthDecoded * heightDecoded * 4);
-            //Copy the pixel data into the Texture data
-            FMemory::Memcpy(TextureData, PixelsDraw, sizeof(uint8) * widthDecoded * heightDecoded * 4);
-            textureJpegResult->GetPlatformData()->Mips[0].BulkData.Unlock();
-            textureJpegResult->UpdateResource();
-
-
-            UE_LOG(LogReplicatedTexture, Warning, TEXT("textureJpegResult %d || !textureJpegResult->GetResource() %d || !textureJpegResult->GetResource()->TextureRHI %d "),
-                textureJpegResult != nullptr,
-                textureJpegResult != nullptr && textureJpegResult->GetResource() != nullptr,
-                textureJpegResult != nullptr && textureJpegResult->GetResource() != nullptr && textureJpegResult->GetResource()->TextureRHI != nullptr);
-
-            if (exportToDisk) {
-                WorldContextObject->GetWorld()->GetTimerManager().SetTimer(timerLaunchExportFile, this, &UAsyncDecompressTexture::LaunchExportFile, 1.0f, false);
-            }
+                delete pixelsBGRA;
+                delete region;
+            });
 
-            UE_LOG(LogReplicatedTexture, Warning, TEXT("textureJpegResult end update %d %d "), textureJpegResult->GetSizeX(), textureJpegResult->GetSizeY());
-        }
-
-        if (!exportToDisk) {
-            delegateDecompressTextureComplete.Broadcast(textureJpegResult);
-        }
+        UE_LOG(LogReplicatedTexture, Warning, TEXT("textureJpegResult end update %d %d "), textureJpegResult->GetSizeX(), textureJpegResult->GetSizeY());
     }
-}
 
-void UAsyncDecompressTexture::LaunchExportFile()
-{
-    FOnImageWriteComplete OnCompleteExport;
-    OnCompleteExport.BindDynamic(this, &UAsyncDecompressTexture::checkExportResult);
-    FImageWriteOptions exportOptions;
-    exportOptions.bAsync = true;
-    exportOptions.bOverwriteFile = true;
-    exportOptions.CompressionQuality = 100;
-    exportOptions.Format = EDesiredImageFormat::JPG;
-    exportOptions.OnComplete = OnCompleteExport;
-    UImageWriteBlueprintLibrary::ExportToDisk(textureJpegResult, pathExportToDisk, exportOptions);
+    DecompressTask.Reset();
 
     delegateDecompressTextureComplete.Broadcast(textureJpegResult);
 }
@@ -132,40 +126,45 @@ void UAsyncDecompressTexture::LaunchExportFile()
 
 
 /////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////// FDecompressThread ////////////////////////////////
+//////////////////////////////// FDecompressTask ////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////
-FDecompressThread::FDecompressThread(TArray<uint8>* _rgbDataToDecode)
-    : rgbDataToDecode(_rgbDataToDecode)
+FDecompressTask::FDecompressTask(TArray<uint8>&& _rgbDataToDecode, int32 _scaleShift, FString _pathExportToDisk)
+    : rgbDataToDecode(MoveTemp(_rgbDataToDecode)), scaleShift(_scaleShift), pathExportToDisk(MoveTemp(_pathExportToDisk))
 {
-    Thread = FRunnableThread::Create(this, TEXT("FDecompressThread"), 0, TPri_BelowNormal); //windows default = 8mb for thread, could specify more
-    isFinished = false;
 }
 
-FDecompressThread::~FDecompressThread()
+void FDecompressTask::Launch(TFunction<void()>&& onFinished)
 {
-    delete Thread;
-    Thread = NULL;
-}
+    Async(EAsyncExecution::TaskGraph, [Task = AsShared(), onFinished = MoveTemp(onFinished)]() mutable
+        {
+            Task->DoWork();
 
-bool FDecompressThread::Init()
-{
-    return true;
+            AsyncTask(ENamedThreads::GameThread, [Task, onFinished = MoveTemp(onFinished)]()
+                {
+                    onFinished();
+                });
+        });
 }
 
-uint32 FDecompressThread::Run()
+void FDecompressTask::DoWork()
 {
-    UE_LOG(LogReplicatedTexture, Warning, TEXT("FDecompressThread::Run begin"));
+    UE_LOG(LogReplicatedTexture, Warning, TEXT("FDecompressTask::DoWork begin"));
 
-    ////////////////// debut decompression ////////////////////
-    size_t size = rgbDataToDecode->Num();
-    unsigned char* buf = rgbDataToDecode->GetData();
+    if (!pathExportToDisk.IsEmpty() && !FFileHelper::SaveArrayToFile(rgbDataToDecode, *pathExportToDisk)) {
+        UE_LOG(LogReplicatedTexture, Warning, TEXT("FDecompressTask::DoWork failed to export %s"), *pathExportToDisk);
+    }
 
-    decoder = new Jpeg::Decoder(buf, size);
+    TUniquePtr<Jpeg::Decoder> decoder = MakeUnique<Jpeg::Decoder>(rgbDataToDecode.GetData(), rgbDataToDecode.Num(), scaleShift);
+
+    // very small images can't be decoded scaled (chroma narrower than 3 pixels), decode them at full size
+    if (decoder->GetResult() == Jpeg::Decoder::Unsupported && scaleShift > 0) {
+        decoder = MakeUnique<Jpeg::Decoder>(rgbDataToDecode.GetData(), rgbDataToDecode.Num());
+    }
 
     if (decoder->GetResult() != Jpeg::Decoder::OK)
     {
-        UE_LOG(LogReplicatedTexture, Warning, TEXT("Error decoding the input file"));
-        return 1;
+        UE_LOG(LogReplicatedTexture, Warning, TEXT("Error decoding the input file %d"), (int32)decoder->GetResult());
+        return;
     }
 
     decodedWidth = decoder->GetWidth();
@@ -174,16 +173,25 @@ uint32 FDecompressThread::Run()
     UE_LOG(LogReplicatedTexture, Warning, TEXT("decoder.GetImageSize w %d h %d GetImageSize %d iscolor %d"),
         decoder->GetWidth(), decoder->GetHeight(), decoder->GetImageSize(), decoder->IsColor());
 
-    ////////////////// fin decompression ////////////////////
+    const uint8* decodedPixels = decoder->GetImage();
+    const bool isColor = decoder->IsColor();
+    const int32 bytesPerPixel = isColor ? 3 : 1;
 
-    UE_LOG(LogReplicatedTexture, Warning, TEXT("FDecompressThread::Run end"));
+    pixelsBGRA.SetNumUninitialized(decodedWidth * decodedHeight * 4);
+    ParallelFor(FMath::DivideAndRoundUp(decodedHeight, SwizzleRowsPerTask), [this, decodedPixels, isColor, bytesPerPixel](int32 taskIndex)
+        {
+            const int32 firstRow = taskIndex * SwizzleRowsPerTask;
+            const int32 numPixels = FMath::Min(SwizzleRowsPerTask, decodedHeight - firstRow) * decodedWidth;
+            const uint8* src = decodedPixels + (int64)firstRow * decodedWidth * bytesPerPixel;
+            uint8* dst = pixelsBGRA.GetData() + (int64)firstRow * decodedWidth * 4;
 
-    isFinished = true;
+            if (isColor) {
+                SwizzleRGBToBGRA(src, dst, numPixels);
+            }
+            else {
+                SwizzleGrayToBGRA(src, dst, numPixels);
+            }
+        });
 
-    return 0;
+    UE_LOG(LogReplicatedTexture, Warning, TEXT("FDecompressTask::DoWork end"));
 }
-
-void FDecompressThread::Stop()
-{
-
-}
\ No newline at end of file
@@ -6,14 +6,14 @@
 #include "Engine/Texture.h"
 #include "Engine/World.h"
 #include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
 #include "Materials/MaterialInterface.h"
 #include "Materials/MaterialInstanceDynamic.h"
 
 #include "TextureResource.h"
 
 #include "TimerManager.h"
-#include "HAL/Runnable.h"
-#include "HAL/RunnableThread.h"
+#include <atomic>
 
 #include "Kismet/BlueprintAsyncActionBase.h"
 #include "Kismet/BlueprintFunctionLibrary.h" 
@@ -26,7 +26,8 @@
 DECLARE_LOG_CATEGORY_EXTERN(LogReplicatedTexture, Log, All);
 
 // forward declaration
-class FCompressThread;
+class FCompressTask;
+class FRHIGPUTextureReadback;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCompressTextureComplete, const TArray<uint8>&, JPEGBytes);
 
@@ -55,7 +56,11 @@ private:
 
 private:
 	UObject* WorldContextObject;
-	UTexture2D* textureToCompress;
+
+	// texture or render target, drawn through MaterialRT into a pooled render target
+	UPROPERTY()
+		UTexture* textureToCompress;
+
 	int32 quality;
 	bool exportCompressedTextureToDisk;
 	FString pathExportCompressedTextureToDisk;
@@ -63,7 +68,7 @@ private:
 
 	UTexture2D* textureJpegResult;
 
-	FCompressThread* CompressThread;
+	TSharedPtr<FCompressTask, ESPMode::ThreadSafe> CompressTask;
 	FTimerHandle timerPollCompressThread;
 
 
@@ -79,32 +84,46 @@ private:
 };
 
 
-class FCompressThread : public FRunnable
+/* JPEG compression running on the task graph. Any number of compressions can run at the same time,
+ * images taller than a strip are additionally split into restart-interval strips encoded in parallel.
+ * The pixels come from an asynchronous GPU readback, so the game thread never waits for the GPU. */
+class FCompressTask : public TSharedFromThis<FCompressTask, ESPMode::ThreadSafe>
 {
 public:
-	/** Thread to run the worker FRunnable on */
-	FRunnableThread* Thread;
-
 	//Constructor / Destructor
-	FCompressThread(uint8* _rgbDataToEncode, TArray<uint8>* _rgbDataResult, int32 _quality, int32 _TextureWidth, int32 _TextureHeight);
-	virtual ~FCompressThread();
+	FCompressTask(int32 _quality, int32 _TextureWidth, int32 _TextureHeight);
+	~FCompressTask();
+
+	// game thread: queue the copy of a B8G8R8A8 render target into a staging texture
+	void EnqueueReadback(UTextureRenderTarget2D* _renderTarget);
 
-	// Begin FRunnable interface.
-	virtual bool Init();
-	virtual uint32 Run();
-	virtual void Stop();
-	// End FRunnable interface
+	// game thread: once the copy has landed, swizzle it into rgbDataToCompress and start compressing
+	void PollReadback();
 
-	bool isFinished = false;
+	std::atomic<bool> isFinished{ false };
 
-	uint8* rgbDataToCompress;
-	TArray<uint8>* rgbDataResult;
+	TArray<uint8> rgbDataToCompress;
+	TArray<uint8> rgbDataResult;
 	int32 quality;
 	int32 TextureWidth;
 	int32 TextureHeight;
 
-	static bool isTooJPEGCompressing;
+	// strips are never shorter than this, so small images are encoded as a single strip
+	static constexpr int32 MinStripHeight = 128;
+
+private:
+	void Launch();
+	void DoWork();
+
+	// render thread only
+	TUniquePtr<FRHIGPUTextureReadback> Readback;
+
+	// at most one map attempt queued on the render thread at a time
+	std::atomic<bool> isPollQueued{ false };
 
+	// TooJpeg callbacks
+	static void WriteBytes(const unsigned char* bytes, unsigned int numBytes, void* data_ptr);
+	static void ParallelForStrips(int numTasks, void (*task)(int, void*), void* task_ptr, void* parallel_ptr);
 };
 
 /* bp library */
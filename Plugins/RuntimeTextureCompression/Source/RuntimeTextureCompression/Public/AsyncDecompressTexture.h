@@ -12,8 +12,6 @@
 #include "TextureResource.h"
 
 #include "TimerManager.h"
-#include "HAL/Runnable.h"
-#include "HAL/RunnableThread.h"
 
 #include "Kismet/BlueprintAsyncActionBase.h"
 #include "Kismet/BlueprintFunctionLibrary.h" 
@@ -24,7 +22,7 @@
 #include "AsyncDecompressTexture.generated.h"
 
 // forward declaration
-class FDecompressThread;
+class FDecompressTask;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDecompressTextureComplete, UTexture2D*, decompressedTexture);
 
@@ -37,8 +35,9 @@ public:
 	UPROPERTY(BlueprintAssignable)
 		FDecompressTextureComplete delegateDecompressTextureComplete;
 
+	// scaleDenominator 2, 4 or 8 decodes a half, quarter or eighth size image (thumbnails), anything else the full size
 	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"), Category = "RuntimeTextureCompression")
-		static UAsyncDecompressTexture* DecompressTexture(const UObject* WorldContextObject, TArray<uint8> inputRGBDataJPEG, TextureCompressionSettings textureCompressionSettings, bool textureSettingSRGB, bool exportToDisk, FString pathExportToDisk);
+		static UAsyncDecompressTexture* DecompressTexture(const UObject* WorldContextObject, TArray<uint8> inputRGBDataJPEG, TextureCompressionSettings textureCompressionSettings, bool textureSettingSRGB, bool exportToDisk, FString pathExportToDisk, int32 scaleDenominator);
 
 	// UBlueprintAsyncActionBase interface
 	virtual void Activate() override;
@@ -47,63 +46,47 @@ public:
 private:
 	const UObject* WorldContextObject;
 
-	FDecompressThread* DecompressThread;
-	FTimerHandle timerPollDecompressThread;
-
-	UPROPERTY()
-		TArray<uint8> inputRGBDataJPEG;
+	TSharedPtr<FDecompressTask, ESPMode::ThreadSafe> DecompressTask;
 
 	UPROPERTY()
 		UTexture2D* textureJpegResult;
 
 	TextureCompressionSettings textureCompressionSettings;
-	ETextureMipLoadOptions textureMipLoadOptions;
-	TextureGroup textureLODGroup;
 
 	bool textureSettingSRGB;
 
-	FTimerHandle timerLaunchExportFile;
 	bool exportToDisk = false;
 	FString pathExportToDisk = "";
 
 
 private:
-	UFUNCTION()
-		void LaunchDecompressThread();
-
-	UFUNCTION()
-		void PollDecompressThread();
-
-	UFUNCTION()
-		void LaunchExportFile();
-
-	UFUNCTION()
-		void checkExportResult(bool success);
+	void OnDecompressFinished();
 };
 
 
-class FDecompressThread : public FRunnable
+/* JPEG decoding on the task graph. The decoded pixels are converted to BGRA on the worker, ready
+ * for UpdateTextureRegions, and the game thread is notified as soon as they are. */
+class FDecompressTask : public TSharedFromThis<FDecompressTask, ESPMode::ThreadSafe>
 {
 public:
-	/** Thread to run the worker FRunnable on */
-	FRunnableThread* Thread;
-
 	//Constructor / Destructor
-	FDecompressThread(TArray<uint8>* _rgbDataToDecode);
-	virtual ~FDecompressThread();
+	FDecompressTask(TArray<uint8>&& _rgbDataToDecode, int32 _scaleShift, FString _pathExportToDisk);
 
-	// Begin FRunnable interface.
-	virtual bool Init();
-	virtual uint32 Run();
-	virtual void Stop();
-	// End FRunnable interface
+	// calls onFinished on the game thread once pixelsBGRA is filled, or decoding failed
+	void Launch(TFunction<void()>&& onFinished);
 
-	TArray<uint8>* rgbDataToDecode;
+	TArray<uint8> rgbDataToDecode;
 
-	int32 decodedWidth;
-	int32 decodedHeight;
-	bool isFinished = false;
+	// 1 << scaleShift is the scale denominator
+	int32 scaleShift;
 
-	Jpeg::Decoder* decoder;
-};
+	// exported as is when not empty, the received bytes already are the JPEG file
+	FString pathExportToDisk;
+
+	int32 decodedWidth = 0;
+	int32 decodedHeight = 0;
+	TArray<uint8> pixelsBGRA;
 
+private:
+	void DoWork();
+};
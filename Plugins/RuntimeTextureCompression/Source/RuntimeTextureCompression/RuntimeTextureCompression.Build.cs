@@ -49,6 +49,8 @@ public class RuntimeTextureCompression : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"RenderCore",
+				"RHI",
 				"Slate",
 				"SlateCore",
 				"Projects",
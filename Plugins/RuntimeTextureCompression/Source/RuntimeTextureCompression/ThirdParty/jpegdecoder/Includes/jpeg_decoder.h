@@ -60,6 +60,10 @@ namespace Jpeg
         // decode the raw data. object is very large, and probably shouldn't
         // go on the stack.
         Decoder(const unsigned char* data, size_t size, void *(*allocFunc)(size_t) = malloc, void (*freeFunc)(void*) = free);
+
+        // decode at 1/2, 1/4 or 1/8 of the size (scaleShift 1, 2 or 3), every 8x8 block becomes 4x4, 2x2 or 1x1 pixels
+        // 1/8 only uses the DC coefficient of each block and skips the IDCT entirely
+        Decoder(const unsigned char* data, size_t size, int scaleShift, void *(*allocFunc)(size_t) = malloc, void (*freeFunc)(void*) = free);
         ~Decoder();
 
         // the result of decode
@@ -120,6 +124,7 @@ namespace Jpeg
             int buf, bufbits;
             int block[64];
             int rstinterval;
+            int scaleshift;
             unsigned char *rgb;
         };
 
@@ -346,6 +351,11 @@ namespace Jpeg
             ctx.mbsizey = ssymax << 3;
             ctx.mbwidth = (ctx.width + ctx.mbsizex - 1) / ctx.mbsizex;
             ctx.mbheight = (ctx.height + ctx.mbsizey - 1) / ctx.mbsizey;
+            // scaled decoding: same number of MCUs, each one covers fewer output pixels
+            ctx.mbsizex >>= ctx.scaleshift;
+            ctx.mbsizey >>= ctx.scaleshift;
+            ctx.width = (ctx.width + (1 << ctx.scaleshift) - 1) >> ctx.scaleshift;
+            ctx.height = (ctx.height + (1 << ctx.scaleshift) - 1) >> ctx.scaleshift;
             for (i = 0, c = ctx.comp;  i < ctx.ncomp;  ++i, ++c) {
                 c->width = (ctx.width * c->ssx + ssxmax - 1) / ssxmax;
                 c->stride = (c->width + 7) & 0x7FFFFFF8;
@@ -453,10 +463,31 @@ namespace Jpeg
                 if (coef > 63) JPEG_DECODER_THROW(SyntaxError);
                 ctx.block[(int) ZZ[coef]] = value * ctx.qtab[c->qtsel][coef];
             } while (coef < 63);
+            if (ctx.scaleshift == 3) {
+                // the DC coefficient is the block average, same rounding as the IDCT of a flat block
+                *out = _Clip(((ctx.block[0] + 4) >> 3) + 128);
+                return;
+            }
             for (coef = 0;  coef < 64;  coef += 8)
                 _RowIDCT(&ctx.block[coef]);
+            if (!ctx.scaleshift) {
+                for (coef = 0;  coef < 8;  ++coef)
+                    _ColIDCT(&ctx.block[coef], &out[coef], c->stride);
+                return;
+            }
+            // 1/2 and 1/4: box filter the full block
+            unsigned char full[64];
             for (coef = 0;  coef < 8;  ++coef)
-                _ColIDCT(&ctx.block[coef], &out[coef], c->stride);
+                _ColIDCT(&ctx.block[coef], &full[coef], 8);
+            const int step = 1 << ctx.scaleshift, size = 8 >> ctx.scaleshift, round = 1 << (2 * ctx.scaleshift - 1);
+            for (int y = 0;  y < size;  ++y)
+                for (int x = 0;  x < size;  ++x) {
+                    int sum = 0;
+                    for (int dy = 0;  dy < step;  ++dy)
+                        for (int dx = 0;  dx < step;  ++dx)
+                            sum += full[(y * step + dy) * 8 + x * step + dx];
+                    out[y * c->stride + x] = (unsigned char) ((sum + round) >> (2 * ctx.scaleshift));
+                }
         }
 
         inline void _DecodeScan(void) {
@@ -481,11 +512,12 @@ namespace Jpeg
                     for (i = 0, c = ctx.comp;  i < ctx.ncomp;  ++i, ++c)
                         for (sby = 0;  sby < c->ssy;  ++sby)
                             for (sbx = 0;  sbx < c->ssx;  ++sbx) {
-                                _DecodeBlock(c, &c->pixels[((mby * c->ssy + sby) * c->stride + mbx * c->ssx + sbx) << 3]);
+                                _DecodeBlock(c, &c->pixels[((mby * c->ssy + sby) * c->stride + mbx * c->ssx + sbx) << (3 - ctx.scaleshift)]);
                                 if (ctx.error)
                                 return;
                             }
-                    if (ctx.rstinterval && !(--rstcount)) {
+                    // no restart marker follows the last interval, even if it is complete
+                    if (ctx.rstinterval && !(--rstcount) && ((mby < ctx.mbheight - 1) || (mbx < ctx.mbwidth - 1))) {
                         _ByteAlign();
                         i = _GetBits(16);
                         if (((i & 0xFFF8) != 0xFFD0) || ((i & 7) != nextrst)) JPEG_DECODER_THROW(SyntaxError);
@@ -665,6 +697,20 @@ inline Decoder::Decoder(const unsigned char* data, size_t size, void *(*allocFun
     _Decode(data, size);
 }
 
+inline Decoder::Decoder(const unsigned char* data, size_t size, int scaleShift, void *(*allocFunc)(size_t), void (*freeFunc)(void*))
+    : AllocMem(allocFunc)
+    , FreeMem(freeFunc)
+{
+    char temp[64] = { 0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18,
+        11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28, 35,
+        42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45,
+        38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+    memcpy(ZZ, temp, sizeof(ZZ));
+    memset(&ctx, 0, sizeof(Context));
+    ctx.scaleshift = (scaleShift < 0) ? 0 : ((scaleShift > 3) ? 3 : scaleShift);
+    _Decode(data, size);
+}
+
 inline Decoder::DecodeResult Decoder::GetResult() const { return ctx.error; }
 inline int Decoder::GetWidth() const { return ctx.width; }
 inline int Decoder::GetHeight() const { return ctx.height; }
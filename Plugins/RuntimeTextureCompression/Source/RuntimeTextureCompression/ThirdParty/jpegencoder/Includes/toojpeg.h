@@ -35,6 +35,21 @@ namespace TooJpeg
     // comment      - optional JPEG comment (0/NULL if no comment), must not contain ASCII code 0xFF
     bool writeJpeg(WRITE_ONE_BYTE output, END_OFF_FILE_JPEG endOfFileJPEG, void* data_ptr, const void* pixels, unsigned short width, unsigned short height,
         bool isRGB = true, unsigned char quality = 90, bool downsample = false, const char* comment = nullptr, bool* eof = nullptr);
+
+    // write a block of bytes (to disk, memory, ...)
+    typedef void (*WRITE_BYTES)(const unsigned char* bytes, unsigned int numBytes, void* data_ptr);
+    // run task(0, task_ptr) ... task(numTasks - 1, task_ptr), possibly in parallel, and return once all of them are done
+    typedef void (*PARALLEL_FOR)(int numTasks, void (*task)(int taskIndex, void* task_ptr), void* task_ptr, void* parallel_ptr);
+
+    // same as writeJpeg, but the scan is split into strips of stripHeight pixel rows (rounded up to whole MCU rows)
+    // separated by restart markers, so each strip can be encoded independently
+    // output       - callback that stores a block of bytes, called in file order from the calling thread only
+    // stripHeight  - 0 encodes the whole image as a single strip without restart markers (same bytes as writeJpeg)
+    // parallelFor  - runs the strip encoders, nullptr encodes them one after another on the calling thread
+    // parallel_ptr - passed through to parallelFor
+    bool writeJpegStrips(WRITE_BYTES output, void* data_ptr, const void* pixels, unsigned short width, unsigned short height,
+        bool isRGB = true, unsigned char quality = 90, bool downsample = false, unsigned short stripHeight = 0,
+        PARALLEL_FOR parallelFor = nullptr, void* parallel_ptr = nullptr, const char* comment = nullptr);
 } // namespace TooJpeg
 
 // My main inspiration was Jon Olick's Minimalistic JPEG writer
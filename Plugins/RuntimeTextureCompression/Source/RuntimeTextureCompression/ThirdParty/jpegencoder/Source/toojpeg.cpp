@@ -6,6 +6,9 @@
 
 #include "toojpeg.h"
 
+#include <cstddef>
+#include <vector>
+
 // - the "official" specifications: https://www.w3.org/Graphics/JPEG/itu-t81.pdf and https://www.w3.org/Graphics/JPEG/jfif3.pdf
 // - Wikipedia has a short description of the JFIF/JPEG file format: https://en.wikipedia.org/wiki/JPEG_File_Interchange_Format
 // - the popular STB Image library includes Jon's JPEG encoder as well: https://github.com/nothings/stb/blob/master/stb_image_write.h
@@ -104,14 +107,30 @@ namespace // anonymous namespace to hide local functions / constants / etc.
         uint8_t  numBits;    // number of valid bits
     };
 
-    // wrapper for bit output operations
-    struct BitWriter
+    // byte sinks for BitWriter
+    // - CallbackSink passes every byte to the user-supplied callback (used by writeJpeg)
+    // - BufferSink appends to a memory buffer (used by writeJpegStrips, which outputs whole blocks)
+    struct CallbackSink
     {
-        // user-supplied callback that writes/stores one byte
         TooJpeg::WRITE_ONE_BYTE output;
         void* data_ptr;
+        void operator()(uint8_t oneByte) { output(oneByte, data_ptr); }
+    };
+
+    struct BufferSink
+    {
+        std::vector<uint8_t>* buffer;
+        void operator()(uint8_t oneByte) { buffer->push_back(oneByte); }
+    };
+
+    // wrapper for bit output operations
+    template <typename Sink>
+    struct BitWriter
+    {
+        // writes/stores one byte
+        Sink output;
         // initialize writer
-        explicit BitWriter(TooJpeg::WRITE_ONE_BYTE output_, void* data_ptr_) : output(output_), data_ptr(data_ptr_) {}
+        explicit BitWriter(Sink output_) : output(output_) {}
 
         // store the most recently encoded bits that are not written yet
         struct BitBuffer
@@ -134,10 +153,10 @@ namespace // anonymous namespace to hide local functions / constants / etc.
                 // extract highest 8 bits
                 buffer.numBits -= 8;
                 auto oneByte = uint8_t(buffer.data >> buffer.numBits);
-                output(oneByte, data_ptr);
+                output(oneByte);
 
                 if (oneByte == 0xFF) // 0xFF has a special meaning for JPEGs (it's a block marker)
-                    output(0, data_ptr);         // therefore pad a zero to indicate "nope, this one ain't a marker, it's just a coincidence"
+                    output(0);         // therefore pad a zero to indicate "nope, this one ain't a marker, it's just a coincidence"
 
                   // note: I don't clear those written bits, therefore buffer.bits may contain garbage in the high bits
                   //       if you really want to "clean up" (e.g. for debugging purposes) then uncomment the following line
@@ -157,7 +176,7 @@ namespace // anonymous namespace to hide local functions / constants / etc.
         // write a single byte
         BitWriter& operator<<(uint8_t oneByte)
         {
-            output(oneByte, data_ptr);
+            output(oneByte);
             return *this;
         }
 
@@ -166,16 +185,16 @@ namespace // anonymous namespace to hide local functions / constants / etc.
         BitWriter& operator<<(T(&manyBytes)[Size])
         {
             for (auto c : manyBytes)
-                output(c, data_ptr);
+                output(c);
             return *this;
         }
 
         // start a new JFIF block
         void addMarker(uint8_t id, uint16_t length)
         {
-            output(0xFF, data_ptr); output(id, data_ptr);     // ID, always preceded by 0xFF
-            output(uint8_t(length >> 8), data_ptr); // length of the block (big-endian, includes the 2 length bytes as well)
-            output(uint8_t(length & 0xFF), data_ptr);
+            output(0xFF); output(id);     // ID, always preceded by 0xFF
+            output(uint8_t(length >> 8)); // length of the block (big-endian, includes the 2 length bytes as well)
+            output(uint8_t(length & 0xFF));
         }
     };
 
@@ -250,7 +269,8 @@ namespace // anonymous namespace to hide local functions / constants / etc.
     }
 
     // run DCT, quantize and write Huffman bit codes
-    int16_t encodeBlock(BitWriter& writer, float block[8][8], const float scaled[8 * 8], int16_t lastDC,
+    template <typename Writer>
+    int16_t encodeBlock(Writer& writer, float block[8][8], const float scaled[8 * 8], int16_t lastDC,
         const BitCode huffmanDC[256], const BitCode huffmanAC[256], const BitCode* codewords)
     {
         // "linearize" the 8x8 block, treat it as a flat array of 64 floats
@@ -340,37 +360,107 @@ namespace // anonymous namespace to hide local functions / constants / etc.
         }
     }
 
-} // end of anonymous namespace
+    // everything derived from quality and color format, read-only while encoding
+    // writeJpegStrips shares a single instance between all strips of an image
+    struct EncoderTables
+    {
+        uint8_t quantLuminance[8 * 8];
+        uint8_t quantChrominance[8 * 8];
 
-// -------------------- externally visible code --------------------
+        // quantization tables adjusted with AAN scaling factors to simplify DCT
+        float scaledLuminance[8 * 8];
+        float scaledChrominance[8 * 8];
 
-namespace TooJpeg
-{
+        BitCode huffmanLuminanceDC[256];
+        BitCode huffmanLuminanceAC[256];
+        BitCode huffmanChrominanceDC[256];
+        BitCode huffmanChrominanceAC[256];
 
-    // the only exported function ...
-    bool writeJpeg(WRITE_ONE_BYTE output, END_OFF_FILE_JPEG endOfFileJPEG, void* data_ptr, const void* pixels_, unsigned short width, unsigned short height,
-        bool isRGB, unsigned char quality_, bool downsample, const char* comment, bool *eof)
-    {
-        // reject invalid pointers
-        if (output == nullptr || pixels_ == nullptr)
-            return false;
-        // check image format
-        if (width == 0 || height == 0)
-            return false;
+        // note: quantized[i] is found at codewordsArray[quantized[i] + CodeWordLimit]
+        BitCode codewordsArray[2 * CodeWordLimit];
+        const BitCode* codewords() const { return &codewordsArray[CodeWordLimit]; } // allow negative indices
+
+        EncoderTables(unsigned char quality_, bool isRGB)
+        {
+            // ////////////////////////////////////////
+            // adjust quantization tables to desired quality
+
+            // quality level must be in 1 ... 100
+            auto quality = clamp<uint16_t>(quality_, 1, 100);
+            // convert to an internal JPEG quality factor, formula taken from libjpeg
+            quality = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+            for (auto i = 0; i < 8 * 8; i++)
+            {
+                int luminance = (DefaultQuantLuminance[ZigZagInv[i]] * quality + 50) / 100;
+                int chrominance = (DefaultQuantChrominance[ZigZagInv[i]] * quality + 50) / 100;
 
+                // clamp to 1..255
+                quantLuminance[i] = clamp(luminance, 1, 255);
+                quantChrominance[i] = clamp(chrominance, 1, 255);
+            }
+
+            // ////////////////////////////////////////
+            // compute actual Huffman code tables (see Jon's code for precalculated tables)
+            generateHuffmanTable(DcLuminanceCodesPerBitsize, DcLuminanceValues, huffmanLuminanceDC);
+            generateHuffmanTable(AcLuminanceCodesPerBitsize, AcLuminanceValues, huffmanLuminanceAC);
+            // chrominance is only relevant for color images
+            if (isRGB)
+            {
+                generateHuffmanTable(DcChrominanceCodesPerBitsize, DcChrominanceValues, huffmanChrominanceDC);
+                generateHuffmanTable(AcChrominanceCodesPerBitsize, AcChrominanceValues, huffmanChrominanceAC);
+            }
+
+            // ////////////////////////////////////////
+            // adjust quantization tables with AAN scaling factors to simplify DCT
+            for (auto i = 0; i < 8 * 8; i++)
+            {
+                auto row = ZigZagInv[i] / 8; // same as ZigZagInv[i] >> 3
+                auto column = ZigZagInv[i] % 8; // same as ZigZagInv[i] &  7
+
+                // scaling constants for AAN DCT algorithm: AanScaleFactors[0] = 1, AanScaleFactors[k=1..7] = cos(k*PI/16) * sqrt(2)
+                static const float AanScaleFactors[8] = { 1, 1.387039845f, 1.306562965f, 1.175875602f, 1, 0.785694958f, 0.541196100f, 0.275899379f };
+                auto factor = 1 / (AanScaleFactors[row] * AanScaleFactors[column] * 8);
+                scaledLuminance[ZigZagInv[i]] = factor / quantLuminance[i];
+                scaledChrominance[ZigZagInv[i]] = factor / quantChrominance[i];
+                // if you really want JPEGs that are bitwise identical to Jon Olick's code then you need slightly different formulas (note: sqrt(8) = 2.828427125f)
+                //static const float aasf[] = { 1.0f * 2.828427125f, 1.387039845f * 2.828427125f, 1.306562965f * 2.828427125f, 1.175875602f * 2.828427125f, 1.0f * 2.828427125f, 0.785694958f * 2.828427125f, 0.541196100f * 2.828427125f, 0.275899379f * 2.828427125f }; // line 240 of jo_jpeg.cpp
+                //scaledLuminance  [ZigZagInv[i]] = 1 / (quantLuminance  [i] * aasf[row] * aasf[column]); // lines 266-267 of jo_jpeg.cpp
+                //scaledChrominance[ZigZagInv[i]] = 1 / (quantChrominance[i] * aasf[row] * aasf[column]);
+            }
+
+            // ////////////////////////////////////////
+            // precompute JPEG codewords for quantized DCT
+            BitCode* codewords = &codewordsArray[CodeWordLimit];
+            uint8_t numBits = 1; // each codeword has at least one bit (value == 0 is undefined)
+            int32_t mask = 1; // mask is always 2^numBits - 1, initial value 2^1-1 = 2-1 = 1
+            for (int16_t value = 1; value < CodeWordLimit; value++)
+            {
+                // numBits = position of highest set bit (ignoring the sign)
+                // mask    = (2^numBits) - 1
+                if (value > mask) // one more bit ?
+                {
+                    numBits++;
+                    mask = (mask << 1) | 1; // append a set bit
+                }
+                codewords[-value] = BitCode(mask - value, numBits); // note that I use a negative index => codewords[-value] = codewordsArray[CodeWordLimit  value]
+                codewords[+value] = BitCode(value, numBits);
+            }
+        }
+    };
+
+    // write all JFIF headers up to and including the start of scan
+    // restartInterval is the number of MCUs between restart markers, 0 disables restart markers
+    template <typename Writer>
+    void writeHeaders(Writer& bitWriter, const EncoderTables& tables, unsigned short width, unsigned short height,
+        bool isRGB, bool downsample, const char* comment, uint16_t restartInterval)
+    {
         // number of components
         const auto numComponents = isRGB ? 3 : 1;
         // note: if there is just one component (=grayscale), then only luminance needs to be stored in the file
         //       thus everything related to chrominance need not to be written to the JPEG
         //       I still compute a few things, like quantization tables to avoid a complete code mess
 
-        // grayscale images can't be downsampled (because there are no Cb + Cr channels)
-        if (!isRGB)
-            downsample = false;
-
-        // wrapper for all output operations
-        BitWriter bitWriter(output, data_ptr);
-
         // ////////////////////////////////////////
         // JFIF headers
         const uint8_t HeaderJfif[2 + 2 + 16] =
@@ -400,33 +490,13 @@ namespace TooJpeg
                 bitWriter << comment[i];
         }
 
-        // ////////////////////////////////////////
-        // adjust quantization tables to desired quality
-
-        // quality level must be in 1 ... 100
-        auto quality = clamp<uint16_t>(quality_, 1, 100);
-        // convert to an internal JPEG quality factor, formula taken from libjpeg
-        quality = quality < 50 ? 5000 / quality : 200 - quality * 2;
-
-        uint8_t quantLuminance[8 * 8];
-        uint8_t quantChrominance[8 * 8];
-        for (auto i = 0; i < 8 * 8; i++)
-        {
-            int luminance = (DefaultQuantLuminance[ZigZagInv[i]] * quality + 50) / 100;
-            int chrominance = (DefaultQuantChrominance[ZigZagInv[i]] * quality + 50) / 100;
-
-            // clamp to 1..255
-            quantLuminance[i] = clamp(luminance, 1, 255);
-            quantChrominance[i] = clamp(chrominance, 1, 255);
-        }
-
         // write quantization tables
         bitWriter.addMarker(0xDB, 2 + (isRGB ? 2 : 1) * (1 + 8 * 8)); // length: 65 bytes per table + 2 bytes for this length field
                                                                     // each table has 64 entries and is preceded by an ID byte
 
-        bitWriter << 0x00 << quantLuminance;   // first  quantization table
+        bitWriter << 0x00 << tables.quantLuminance;   // first  quantization table
         if (isRGB)
-            bitWriter << 0x01 << quantChrominance; // second quantization table, only relevant for color images
+            bitWriter << 0x01 << tables.quantChrominance; // second quantization table, only relevant for color images
 
           // ////////////////////////////////////////
           // write image infos (SOF0 - start of frame)
@@ -464,15 +534,7 @@ namespace TooJpeg
             << AcLuminanceCodesPerBitsize
             << AcLuminanceValues;
 
-        // compute actual Huffman code tables (see Jon's code for precalculated tables)
-        BitCode huffmanLuminanceDC[256];
-        BitCode huffmanLuminanceAC[256];
-        generateHuffmanTable(DcLuminanceCodesPerBitsize, DcLuminanceValues, huffmanLuminanceDC);
-        generateHuffmanTable(AcLuminanceCodesPerBitsize, AcLuminanceValues, huffmanLuminanceAC);
-
         // chrominance is only relevant for color images
-        BitCode huffmanChrominanceDC[256];
-        BitCode huffmanChrominanceAC[256];
         if (isRGB)
         {
             // store luminance's DC+AC Huffman table definitions
@@ -482,10 +544,15 @@ namespace TooJpeg
             bitWriter << 0x11 // highest 4 bits: 1 => AC, lowest 4 bits: 1 => Cr,Cb (baseline)
                 << AcChrominanceCodesPerBitsize
                 << AcChrominanceValues;
+        }
 
-            // compute actual Huffman code tables (see Jon's code for precalculated tables)
-            generateHuffmanTable(DcChrominanceCodesPerBitsize, DcChrominanceValues, huffmanChrominanceDC);
-            generateHuffmanTable(AcChrominanceCodesPerBitsize, AcChrominanceValues, huffmanChrominanceAC);
+        // ////////////////////////////////////////
+        // DRI marker - define restart interval (optional)
+        // each interval starts with fresh DC predictions and is terminated by a RSTn marker, so intervals can be encoded independently
+        if (restartInterval > 0)
+        {
+            bitWriter.addMarker(0xDD, 2 + 2); // 2 bytes for the length field, 2 bytes for the interval
+            bitWriter << uint8_t(restartInterval >> 8) << uint8_t(restartInterval & 0xFF);
         }
 
         // ////////////////////////////////////////
@@ -502,48 +569,15 @@ namespace TooJpeg
           // constant values for our baseline JPEGs (which have a single sequential scan)
         static const uint8_t Spectral[3] = { 0, 63, 0 }; // spectral selection: must be from 0 to 63; successive approximation must be 0
         bitWriter << Spectral;
+    }
 
-        // ////////////////////////////////////////
-        // adjust quantization tables with AAN scaling factors to simplify DCT
-        float scaledLuminance[8 * 8];
-        float scaledChrominance[8 * 8];
-        for (auto i = 0; i < 8 * 8; i++)
-        {
-            auto row = ZigZagInv[i] / 8; // same as ZigZagInv[i] >> 3
-            auto column = ZigZagInv[i] % 8; // same as ZigZagInv[i] &  7
-
-            // scaling constants for AAN DCT algorithm: AanScaleFactors[0] = 1, AanScaleFactors[k=1..7] = cos(k*PI/16) * sqrt(2)
-            static const float AanScaleFactors[8] = { 1, 1.387039845f, 1.306562965f, 1.175875602f, 1, 0.785694958f, 0.541196100f, 0.275899379f };
-            auto factor = 1 / (AanScaleFactors[row] * AanScaleFactors[column] * 8);
-            scaledLuminance[ZigZagInv[i]] = factor / quantLuminance[i];
-            scaledChrominance[ZigZagInv[i]] = factor / quantChrominance[i];
-            // if you really want JPEGs that are bitwise identical to Jon Olick's code then you need slightly different formulas (note: sqrt(8) = 2.828427125f)
-            //static const float aasf[] = { 1.0f * 2.828427125f, 1.387039845f * 2.828427125f, 1.306562965f * 2.828427125f, 1.175875602f * 2.828427125f, 1.0f * 2.828427125f, 0.785694958f * 2.828427125f, 0.541196100f * 2.828427125f, 0.275899379f * 2.828427125f }; // line 240 of jo_jpeg.cpp
-            //scaledLuminance  [ZigZagInv[i]] = 1 / (quantLuminance  [i] * aasf[row] * aasf[column]); // lines 266-267 of jo_jpeg.cpp
-            //scaledChrominance[ZigZagInv[i]] = 1 / (quantChrominance[i] * aasf[row] * aasf[column]);
-        }
-
-        // ////////////////////////////////////////
-        // precompute JPEG codewords for quantized DCT
-        BitCode  codewordsArray[2 * CodeWordLimit];          // note: quantized[i] is found at codewordsArray[quantized[i] + CodeWordLimit]
-        BitCode* codewords = &codewordsArray[CodeWordLimit]; // allow negative indices, so quantized[i] is at codewords[quantized[i]]
-        uint8_t numBits = 1; // each codeword has at least one bit (value == 0 is undefined)
-        int32_t mask = 1; // mask is always 2^numBits - 1, initial value 2^1-1 = 2-1 = 1
-        for (int16_t value = 1; value < CodeWordLimit; value++)
-        {
-            // numBits = position of highest set bit (ignoring the sign)
-            // mask    = (2^numBits) - 1
-            if (value > mask) // one more bit ?
-            {
-                numBits++;
-                mask = (mask << 1) | 1; // append a set bit
-            }
-            codewords[-value] = BitCode(mask - value, numBits); // note that I use a negative index => codewords[-value] = codewordsArray[CodeWordLimit  value]
-            codewords[+value] = BitCode(value, numBits);
-        }
-
-        // just convert image data from void*
-        auto pixels = (const uint8_t*)pixels_;
+    // encode the MCU rows [firstMcuRow, lastMcuRow) and flush the bit buffer
+    // DC predictions start at zero, which is what the decoder expects at the beginning of a scan or after a RSTn marker
+    template <typename Writer>
+    void encodeMcuRows(Writer& bitWriter, const EncoderTables& tables, const uint8_t* pixels, unsigned short width, unsigned short height,
+        bool isRGB, bool downsample, int firstMcuRow, int lastMcuRow)
+    {
+        const BitCode* codewords = tables.codewords();
 
         // the next two variables are frequently used when checking for image borders
         const auto maxWidth = width - 1; // "last row"
@@ -558,7 +592,8 @@ namespace TooJpeg
         // convert from RGB to YCbCr
         float Y[8][8], Cb[8][8], Cr[8][8];
 
-        for (auto mcuY = 0; mcuY < height; mcuY += mcuSize) // each step is either 8 or 16 (=mcuSize)
+        const auto endY = minimum(lastMcuRow * mcuSize, int(height));
+        for (auto mcuY = firstMcuRow * mcuSize; mcuY < endY; mcuY += mcuSize) // each step is either 8 or 16 (=mcuSize)
             for (auto mcuX = 0; mcuX < width; mcuX += mcuSize)
             {
                 // YCbCr 4:4:4 format: each MCU is a 8x8 block - the same applies to grayscale images, too
@@ -601,7 +636,7 @@ namespace TooJpeg
                         }
 
                         // encode Y channel
-                        lastYDC = encodeBlock(bitWriter, Y, scaledLuminance, lastYDC, huffmanLuminanceDC, huffmanLuminanceAC, codewords);
+                        lastYDC = encodeBlock(bitWriter, Y, tables.scaledLuminance, lastYDC, tables.huffmanLuminanceDC, tables.huffmanLuminanceAC, codewords);
                         // Cb and Cr are encoded about 50 lines below
                     }
 
@@ -653,19 +688,153 @@ namespace TooJpeg
                     } // end of YCbCr420 code for Cb and Cr
 
                   // encode Cb and Cr
-                lastCbDC = encodeBlock(bitWriter, Cb, scaledChrominance, lastCbDC, huffmanChrominanceDC, huffmanChrominanceAC, codewords);
-                lastCrDC = encodeBlock(bitWriter, Cr, scaledChrominance, lastCrDC, huffmanChrominanceDC, huffmanChrominanceAC, codewords);
+                lastCbDC = encodeBlock(bitWriter, Cb, tables.scaledChrominance, lastCbDC, tables.huffmanChrominanceDC, tables.huffmanChrominanceAC, codewords);
+                lastCrDC = encodeBlock(bitWriter, Cr, tables.scaledChrominance, lastCrDC, tables.huffmanChrominanceDC, tables.huffmanChrominanceAC, codewords);
             }
 
-        bitWriter.flush(); // now image is completely encoded, write any bits still left in the buffer
+        bitWriter.flush(); // write any bits still left in the buffer, pad the last byte
+    }
+
+    // shared state of all strips of a writeJpegStrips call
+    struct StripJob
+    {
+        const EncoderTables* tables;
+        const uint8_t* pixels;
+        unsigned short width, height;
+        bool isRGB, downsample;
+        int mcuRowsPerStrip;
+        int numMcuRows;
+        std::size_t reserveBytes;      // expected compressed size of one strip
+        std::vector<uint8_t>* strips; // one output buffer per strip
+    };
+
+    // encode a single strip into its own buffer, safe to run concurrently with other strips
+    void encodeStrip(int stripIndex, void* job_ptr)
+    {
+        auto& job = *static_cast<StripJob*>(job_ptr);
+        auto& strip = job.strips[stripIndex];
+        strip.reserve(job.reserveBytes);
+
+        BitWriter<BufferSink> bitWriter(BufferSink{ &strip });
+        const auto firstMcuRow = stripIndex * job.mcuRowsPerStrip;
+        encodeMcuRows(bitWriter, *job.tables, job.pixels, job.width, job.height, job.isRGB, job.downsample,
+            firstMcuRow, minimum(firstMcuRow + job.mcuRowsPerStrip, job.numMcuRows));
+    }
+
+} // end of anonymous namespace
+
+// -------------------- externally visible code --------------------
+
+namespace TooJpeg
+{
+
+    // the original single-threaded, byte-by-byte writer
+    bool writeJpeg(WRITE_ONE_BYTE output, END_OFF_FILE_JPEG endOfFileJPEG, void* data_ptr, const void* pixels_, unsigned short width, unsigned short height,
+        bool isRGB, unsigned char quality_, bool downsample, const char* comment, bool *eof)
+    {
+        // reject invalid pointers
+        if (output == nullptr || pixels_ == nullptr)
+            return false;
+        // check image format
+        if (width == 0 || height == 0)
+            return false;
+
+        // grayscale images can't be downsampled (because there are no Cb + Cr channels)
+        if (!isRGB)
+            downsample = false;
+
+        // wrapper for all output operations
+        BitWriter<CallbackSink> bitWriter(CallbackSink{ output, data_ptr });
+
+        const EncoderTables tables(quality_, isRGB);
+        writeHeaders(bitWriter, tables, width, height, isRGB, downsample, comment, 0);
+
+        const auto mcuSize = downsample ? 16 : 8;
+        encodeMcuRows(bitWriter, tables, (const uint8_t*)pixels_, width, height, isRGB, downsample, 0, (height + mcuSize - 1) / mcuSize);
 
         // ///////////////////////////
         // EOI marker
         bitWriter << 0xFF << 0xD9; // this marker has no length, therefore I can't use addMarker()
 
-        endOfFileJPEG(true);
-        *eof = true;
+        if (endOfFileJPEG != nullptr)
+            endOfFileJPEG(true);
+        if (eof != nullptr)
+            *eof = true;
 
         return true;
     } // writeJpeg()
+
+    bool writeJpegStrips(WRITE_BYTES output, void* data_ptr, const void* pixels_, unsigned short width, unsigned short height,
+        bool isRGB, unsigned char quality_, bool downsample, unsigned short stripHeight, PARALLEL_FOR parallelFor, void* parallel_ptr, const char* comment)
+    {
+        // reject invalid pointers
+        if (output == nullptr || pixels_ == nullptr)
+            return false;
+        // check image format
+        if (width == 0 || height == 0)
+            return false;
+
+        // grayscale images can't be downsampled (because there are no Cb + Cr channels)
+        if (!isRGB)
+            downsample = false;
+
+        // strips always cover whole MCU rows
+        const auto mcuSize = downsample ? 16 : 8;
+        const auto numMcuColumns = (width + mcuSize - 1) / mcuSize;
+        const auto numMcuRows = (height + mcuSize - 1) / mcuSize;
+
+        auto mcuRowsPerStrip = stripHeight == 0 ? numMcuRows : clamp((stripHeight + mcuSize - 1) / mcuSize, 1, numMcuRows);
+        // the restart interval is counted in MCUs and stored in 16 bits
+        if (mcuRowsPerStrip < numMcuRows && mcuRowsPerStrip * numMcuColumns > 0xFFFF)
+            mcuRowsPerStrip = 0xFFFF / numMcuColumns;
+        const auto numStrips = (numMcuRows + mcuRowsPerStrip - 1) / mcuRowsPerStrip;
+
+        const EncoderTables tables(quality_, isRGB);
+
+        // headers, a single strip doesn't need restart markers and produces the same bytes as writeJpeg
+        std::vector<uint8_t> header;
+        BitWriter<BufferSink> headerWriter(BufferSink{ &header });
+        writeHeaders(headerWriter, tables, width, height, isRGB, downsample, comment, numStrips > 1 ? uint16_t(mcuRowsPerStrip * numMcuColumns) : 0);
+        output(header.data(), (unsigned int)header.size(), data_ptr);
+
+        // scan data, about a quarter of the raw pixel size is a generous estimate for typical photo content
+        std::vector<std::vector<uint8_t>> strips(numStrips);
+        StripJob job;
+        job.tables = &tables;
+        job.pixels = (const uint8_t*)pixels_;
+        job.width = width;
+        job.height = height;
+        job.isRGB = isRGB;
+        job.downsample = downsample;
+        job.mcuRowsPerStrip = mcuRowsPerStrip;
+        job.numMcuRows = numMcuRows;
+        job.reserveBytes = std::size_t(width) * mcuRowsPerStrip * mcuSize * (isRGB ? 3 : 1) / 4;
+        job.strips = strips.data();
+
+        if (parallelFor != nullptr && numStrips > 1)
+            parallelFor(numStrips, &encodeStrip, &job, parallel_ptr);
+        else
+            for (auto i = 0; i < numStrips; i++)
+                encodeStrip(i, &job);
+
+        // stitch strips together, separated by RST0 ... RST7 (cycling)
+        for (auto i = 0; i < numStrips; i++)
+        {
+            output(strips[i].data(), (unsigned int)strips[i].size(), data_ptr);
+            std::vector<uint8_t>().swap(strips[i]); // release early, large images have large strips
+
+            if (i + 1 < numStrips)
+            {
+                const uint8_t restartMarker[2] = { 0xFF, uint8_t(0xD0 + (i & 7)) };
+                output(restartMarker, 2, data_ptr);
+            }
+        }
+
+        // ///////////////////////////
+        // EOI marker
+        const uint8_t endOfImage[2] = { 0xFF, 0xD9 };
+        output(endOfImage, 2, data_ptr);
+
+        return true;
+    } // writeJpegStrips()
 } // namespace TooJpeg
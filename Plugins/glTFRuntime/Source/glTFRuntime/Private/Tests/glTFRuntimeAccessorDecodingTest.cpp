@@ -0,0 +1,272 @@
+// Copyright 2023, Roberto De Ioris.
+
+#include "glTFRuntimeParser.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Base64.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace glTFRuntimeAccessorDecodingTest
+{
+	// accessors of the test asset, one per layout decoded by the specialized loops
+	struct FAccessorLayout
+	{
+		const TCHAR* Name;
+		int32 BufferView;
+		int32 ByteOffset;
+		int32 ComponentType;
+		const TCHAR* Type;
+		bool bNormalized;
+	};
+
+	static const FAccessorLayout Accessors[] =
+	{
+		{ TEXT("float VEC3"), 0, 0, 5126, TEXT("VEC3"), false },
+		{ TEXT("strided float VEC3"), 1, 0, 5126, TEXT("VEC3"), false },
+		// KHR_mesh_quantization normals and positions
+		{ TEXT("strided normalized short VEC3"), 1, 12, 5122, TEXT("VEC3"), true },
+		{ TEXT("strided short VEC3"), 1, 12, 5122, TEXT("VEC3"), false },
+		{ TEXT("strided normalized unsigned byte VEC2"), 1, 20, 5121, TEXT("VEC2"), true },
+		{ TEXT("normalized byte VEC4"), 2, 0, 5120, TEXT("VEC4"), true },
+		{ TEXT("unsigned short VEC4"), 3, 0, 5123, TEXT("VEC4"), false },
+		{ TEXT("unsigned short SCALAR"), 4, 0, 5123, TEXT("SCALAR"), false },
+		{ TEXT("float SCALAR"), 5, 0, 5126, TEXT("SCALAR"), false },
+	};
+
+	constexpr int32 InterleavedStride = 24;
+
+	TSharedPtr<FglTFRuntimeParser> CreateParser(const int32 Count)
+	{
+		FRandomStream RandomStream(Count);
+		TArray<uint8> Buffer;
+		TArray<FString> BufferViews;
+
+		auto AddBufferView = [&Buffer, &BufferViews](const int32 ByteLength, const int32 ByteStride)
+		{
+			const FString Stride = ByteStride > 0 ? FString::Printf(TEXT(", \"byteStride\": %d"), ByteStride) : FString();
+			BufferViews.Add(FString::Printf(TEXT("{ \"buffer\": 0, \"byteOffset\": %d, \"byteLength\": %d%s }"), Buffer.Num(), ByteLength, *Stride));
+			return Buffer.AddZeroed(ByteLength);
+		};
+		auto WriteFloats = [&Buffer, &RandomStream](const int32 Offset, const int32 Num)
+		{
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				const float Value = RandomStream.FRandRange(-100, 100);
+				FMemory::Memcpy(Buffer.GetData() + Offset + Index * sizeof(float), &Value, sizeof(float));
+			}
+		};
+		auto WriteBytes = [&Buffer, &RandomStream](const int32 Offset, const int32 Num)
+		{
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				Buffer[Offset + Index] = static_cast<uint8>(RandomStream.RandHelper(256));
+			}
+		};
+
+		WriteFloats(AddBufferView(Count * 12, 0), Count * 3);
+
+		// float VEC3, short VEC4 (the VEC3 accessors skip the padding component), unsigned byte VEC2 and 2 bytes of padding
+		const int32 InterleavedOffset = AddBufferView(Count * InterleavedStride, InterleavedStride);
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			WriteFloats(InterleavedOffset + Index * InterleavedStride, 3);
+			WriteBytes(InterleavedOffset + Index * InterleavedStride + 12, 10);
+		}
+
+		WriteBytes(AddBufferView(Count * 4, 0), Count * 4);
+		WriteBytes(AddBufferView(Count * 8, 0), Count * 8);
+		WriteBytes(AddBufferView(Count * 2, 0), Count * 2);
+		WriteFloats(AddBufferView(Count * 4, 0), Count);
+
+		TArray<FString> JsonAccessors;
+		for (const FAccessorLayout& Accessor : Accessors)
+		{
+			JsonAccessors.Add(FString::Printf(TEXT("{ \"bufferView\": %d, \"byteOffset\": %d, \"componentType\": %d, \"normalized\": %s, \"count\": %d, \"type\": \"%s\" }"),
+				Accessor.BufferView, Accessor.ByteOffset, Accessor.ComponentType, Accessor.bNormalized ? TEXT("true") : TEXT("false"), Count, Accessor.Type));
+		}
+
+		const FString JsonData = FString::Printf(TEXT("{ \"asset\": { \"version\": \"2.0\" }, \"buffers\": [ { \"byteLength\": %d, \"uri\": \"data:application/octet-stream;base64,%s\" } ], \"bufferViews\": [ %s ], \"accessors\": [ %s ] }"),
+			Buffer.Num(), *FBase64::Encode(Buffer), *FString::Join(BufferViews, TEXT(", ")), *FString::Join(JsonAccessors, TEXT(", ")));
+
+		return FglTFRuntimeParser::FromString(JsonData, FglTFRuntimeConfig());
+	}
+
+	template<typename T>
+	bool Decode(FglTFRuntimeParser& Parser, const int32 AccessorIndex, const int64 Elements, TArray<T>& Data)
+	{
+		TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+		JsonObject->SetNumberField("accessor", AccessorIndex);
+		Data.Reset();
+		if (Elements == 1)
+		{
+			return Parser.BuildFromAccessorField(JsonObject, "accessor", Data, { 5126, 5120, 5121, 5122, 5123 }, INDEX_NONE, false, nullptr);
+		}
+		return Parser.BuildFromAccessorField(JsonObject, "accessor", Data, { Elements }, { 5126, 5120, 5121, 5122, 5123 }, INDEX_NONE, false, nullptr);
+	}
+
+	// switches the parser between the specialized loops and the generic one, restoring the previous mode when destroyed
+	struct FScopedSpecializedDecoding
+	{
+		IConsoleVariable* CVar;
+		int32 PreviousValue;
+
+		FScopedSpecializedDecoding(const bool bEnabled) : CVar(IConsoleManager::Get().FindConsoleVariable(TEXT("glTFRuntime.SpecializedAccessorDecoding"))), PreviousValue(1)
+		{
+			if (CVar)
+			{
+				PreviousValue = CVar->GetInt();
+				CVar->Set(bEnabled ? 1 : 0, ECVF_SetByCode);
+			}
+		}
+
+		~FScopedSpecializedDecoding()
+		{
+			if (CVar)
+			{
+				CVar->Set(PreviousValue, ECVF_SetByCode);
+			}
+		}
+	};
+
+	// calls Function(AccessorIndex, Elements, Data) with an array of the type the parser decodes the accessor to
+	template<typename Callback>
+	bool ForEachAccessor(FglTFRuntimeParser& Parser, Callback Function)
+	{
+		for (int32 AccessorIndex = 0; AccessorIndex < UE_ARRAY_COUNT(Accessors); AccessorIndex++)
+		{
+			const FString Type = Accessors[AccessorIndex].Type;
+			bool bSuccess = false;
+			if (Type == TEXT("SCALAR"))
+			{
+				if (Accessors[AccessorIndex].ComponentType == 5126)
+				{
+					TArray<float> Data;
+					bSuccess = Function(AccessorIndex, 1, Data);
+				}
+				else
+				{
+					TArray<uint32> Data;
+					bSuccess = Function(AccessorIndex, 1, Data);
+				}
+			}
+			else if (Type == TEXT("VEC2"))
+			{
+				TArray<FVector2D> Data;
+				bSuccess = Function(AccessorIndex, 2, Data);
+			}
+			else if (Type == TEXT("VEC3"))
+			{
+				TArray<FVector> Data;
+				bSuccess = Function(AccessorIndex, 3, Data);
+			}
+			else if (Accessors[AccessorIndex].ComponentType == 5123)
+			{
+				TArray<FglTFRuntimeUInt16Vector4> Data;
+				bSuccess = Function(AccessorIndex, 4, Data);
+			}
+			else
+			{
+				TArray<FVector4> Data;
+				bSuccess = Function(AccessorIndex, 4, Data);
+			}
+
+			if (!bSuccess)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FglTFRuntimeAccessorDecodingTest, "glTFRuntime.AccessorDecoding.MatchesGenericPath", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FglTFRuntimeAccessorDecodingTest::RunTest(const FString& Parameters)
+{
+	using namespace glTFRuntimeAccessorDecodingTest;
+
+	// not a multiple of the vector widths, so the tails of the loops are covered too
+	constexpr int32 Count = 1021;
+
+	TSharedPtr<FglTFRuntimeParser> Parser = CreateParser(Count);
+	if (!TestTrue("Parser is valid", Parser.IsValid()))
+	{
+		return false;
+	}
+
+	return ForEachAccessor(*Parser, [this, &Parser, Count](const int32 AccessorIndex, const int64 Elements, auto& Specialized)
+		{
+			auto Generic = Specialized;
+			{
+				FScopedSpecializedDecoding SpecializedDecoding(true);
+				if (!TestTrue(FString::Printf(TEXT("%s decoded by the specialized path"), Accessors[AccessorIndex].Name), Decode(*Parser, AccessorIndex, Elements, Specialized)))
+				{
+					return false;
+				}
+			}
+			{
+				FScopedSpecializedDecoding SpecializedDecoding(false);
+				if (!TestTrue(FString::Printf(TEXT("%s decoded by the generic path"), Accessors[AccessorIndex].Name), Decode(*Parser, AccessorIndex, Elements, Generic)))
+				{
+					return false;
+				}
+			}
+
+			return TestEqual(FString::Printf(TEXT("%s count"), Accessors[AccessorIndex].Name), Specialized.Num(), Count) &&
+				TestEqual(FString::Printf(TEXT("%s generic count"), Accessors[AccessorIndex].Name), Generic.Num(), Count) &&
+				TestTrue(FString::Printf(TEXT("%s values match"), Accessors[AccessorIndex].Name), FMemory::Memcmp(Specialized.GetData(), Generic.GetData(), Specialized.Num() * Specialized.GetTypeSize()) == 0);
+		});
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FglTFRuntimeAccessorDecodingBenchmark, "glTFRuntime.AccessorDecoding.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FglTFRuntimeAccessorDecodingBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace glTFRuntimeAccessorDecodingTest;
+
+	// about the vertex count of a detailed character
+	constexpr int32 Count = 256 * 1024;
+	constexpr int32 Iterations = 5;
+
+	TSharedPtr<FglTFRuntimeParser> Parser = CreateParser(Count);
+	if (!TestTrue("Parser is valid", Parser.IsValid()))
+	{
+		return false;
+	}
+
+	return ForEachAccessor(*Parser, [this, &Parser](const int32 AccessorIndex, const int64 Elements, auto& Data)
+		{
+			// best of a few runs, the first one also warms up the buffer cache
+			auto BestTime = [&](const bool bSpecialized)
+			{
+				FScopedSpecializedDecoding SpecializedDecoding(bSpecialized);
+				double Best = MAX_dbl;
+				for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+				{
+					const double StartTime = FPlatformTime::Seconds();
+					if (!Decode(*Parser, AccessorIndex, Elements, Data))
+					{
+						return -1.0;
+					}
+					Best = FMath::Min(Best, FPlatformTime::Seconds() - StartTime);
+				}
+				return Best;
+			};
+
+			const double GenericTime = BestTime(false);
+			const double SpecializedTime = BestTime(true);
+			if (!TestTrue(FString::Printf(TEXT("%s decoded"), Accessors[AccessorIndex].Name), GenericTime >= 0 && SpecializedTime >= 0))
+			{
+				return false;
+			}
+
+			AddInfo(FString::Printf(TEXT("%s: generic %.3f ms, specialized %.3f ms (x%.2f)"), Accessors[AccessorIndex].Name,
+				GenericTime * 1000, SpecializedTime * 1000, SpecializedTime > 0 ? GenericTime / SpecializedTime : 0));
+			return true;
+		});
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Copyright 2023, Roberto De Ioris.
+
+#include "glTFRuntimeParser.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FglTFRuntimeBlockCompressionMaterialTest, "glTFRuntime.BlockCompression.MaterialTextures", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FglTFRuntimeBlockCompressionMaterialTest::RunTest(const FString& Parameters)
+{
+	if (!GPixelFormats[EPixelFormat::PF_BC5].Supported || !GPixelFormats[EPixelFormat::PF_DXT1].Supported)
+	{
+		AddInfo("BC formats are not supported by the current RHI, skipping");
+		return true;
+	}
+
+	// normalTexture comes before occlusionTexture and emissiveTexture, they must not inherit its normal map compression
+	const FString JsonData = TEXT(R"({
+		"asset": { "version": "2.0" },
+		"images": [ { "uri": "data:application/octet-stream;base64,AAAA" }, { "uri": "data:application/octet-stream;base64,AAAA" }, { "uri": "data:application/octet-stream;base64,AAAA" } ],
+		"textures": [ { "source": 0 }, { "source": 1 }, { "source": 2 } ],
+		"materials": [ {
+			"normalTexture": { "index": 0 },
+			"occlusionTexture": { "index": 1 },
+			"emissiveTexture": { "index": 2 }
+		} ]
+	})");
+
+	TSharedPtr<FglTFRuntimeParser> Parser = FglTFRuntimeParser::FromString(JsonData, FglTFRuntimeConfig());
+	if (!TestTrue("Parser is valid", Parser.IsValid()))
+	{
+		return false;
+	}
+
+	// skip the image decoder, every image is an opaque 8x8 one
+	FDelegateHandle TexturePixelsHandle = FglTFRuntimeParser::OnTexturePixels.AddLambda([](TSharedRef<FglTFRuntimeParser> InParser, TSharedRef<FJsonObject> JsonImageObject, const TArray64<uint8>& Blob, int32& Width, int32& Height, EPixelFormat& PixelFormat, TArray64<uint8>& UncompressedBytes, const FglTFRuntimeImagesConfig& ImagesConfig)
+		{
+			Width = 8;
+			Height = 8;
+			PixelFormat = EPixelFormat::PF_B8G8R8A8;
+			UncompressedBytes.Init(255, Width * Height * 4);
+		});
+
+	FglTFRuntimeMaterialsConfig MaterialsConfig;
+	MaterialsConfig.ImagesConfig.BlockCompression = EglTFRuntimeBlockCompression::Auto;
+
+	FString MaterialName;
+	UMaterialInstanceDynamic* Material = Cast<UMaterialInstanceDynamic>(Parser->LoadMaterial(0, MaterialsConfig, false, MaterialName));
+
+	FglTFRuntimeParser::OnTexturePixels.Remove(TexturePixelsHandle);
+
+	if (!TestNotNull("Material is a dynamic instance", Material))
+	{
+		return false;
+	}
+
+	auto TestPixelFormat = [this, Material](const FName& TextureName, const EPixelFormat ExpectedPixelFormat)
+	{
+		UTexture* Texture = nullptr;
+		Material->GetTextureParameterValue(FMaterialParameterInfo(TextureName), Texture);
+		UTexture2D* Texture2D = Cast<UTexture2D>(Texture);
+		if (TestNotNull(FString::Printf(TEXT("%s is set"), *TextureName.ToString()), Texture2D))
+		{
+			TestEqual(FString::Printf(TEXT("%s pixel format"), *TextureName.ToString()), static_cast<int32>(Texture2D->GetPixelFormat()), static_cast<int32>(ExpectedPixelFormat));
+		}
+	};
+
+	TestPixelFormat("normalTexture", EPixelFormat::PF_BC5);
+	TestPixelFormat("occlusionTexture", EPixelFormat::PF_DXT1);
+	TestPixelFormat("emissiveTexture", EPixelFormat::PF_DXT1);
+
+	return true;
+}
+
+#endif
@@ -2,9 +2,13 @@
 
 
 #include "glTFRuntimeAssetActorAsync.h"
+#include "glTFRuntimeLoaderPool.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine/StaticMeshSocket.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
 
 // Sets default values
 AglTFRuntimeAssetActorAsync::AglTFRuntimeAssetActorAsync()
@@ -135,27 +139,62 @@ void AglTFRuntimeAssetActorAsync::LoadNextMeshAsync()
 		return;
 	}
 
-	auto It = MeshesToLoad.CreateIterator();
-	if (UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(It->Key))
+	// the camera moves while loading, so pick the best candidate every time
+	TPair<UPrimitiveComponent*, FglTFRuntimeNode>* Next = nullptr;
+	float NextPriority = 0;
+	for (TPair<UPrimitiveComponent*, FglTFRuntimeNode>& Pair : MeshesToLoad)
+	{
+		const float Priority = GetLoadingPriority(Pair.Key);
+		if (!Next || Priority > NextPriority)
+		{
+			Next = &Pair;
+			NextPriority = Priority;
+		}
+	}
+
+	if (UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Next->Key))
 	{
 		CurrentPrimitiveComponent = StaticMeshComponent;
 		if (StaticMeshConfig.Outer == nullptr)
 		{
 			StaticMeshConfig.Outer = StaticMeshComponent;
 		}
+		StaticMeshConfig.AsyncLoadingPriority = NextPriority;
 		FglTFRuntimeStaticMeshAsync Delegate;
 		Delegate.BindDynamic(this, &AglTFRuntimeAssetActorAsync::LoadStaticMeshAsync);
-		Asset->LoadStaticMeshAsync(It->Value.MeshIndex, Delegate, StaticMeshConfig);
+		Asset->LoadStaticMeshAsync(Next->Value.MeshIndex, Delegate, StaticMeshConfig);
 	}
-	else if (USkeletalMeshComponent* SkeletalMeshComponent = Cast<USkeletalMeshComponent>(It->Key))
+	else if (USkeletalMeshComponent* SkeletalMeshComponent = Cast<USkeletalMeshComponent>(Next->Key))
 	{
 		CurrentPrimitiveComponent = SkeletalMeshComponent;
+		SkeletalMeshConfig.AsyncLoadingPriority = NextPriority;
 		FglTFRuntimeSkeletalMeshAsync Delegate;
 		Delegate.BindDynamic(this, &AglTFRuntimeAssetActorAsync::LoadSkeletalMeshAsync);
-		Asset->LoadSkeletalMeshAsync(It->Value.MeshIndex, It->Value.SkinIndex, Delegate, SkeletalMeshConfig);
+		Asset->LoadSkeletalMeshAsync(Next->Value.MeshIndex, Next->Value.SkinIndex, Delegate, SkeletalMeshConfig);
 	}
 }
 
+float AglTFRuntimeAssetActorAsync::GetLoadingPriority(const UPrimitiveComponent* PrimitiveComponent) const
+{
+	const UWorld* World = GetWorld();
+	const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
+	{
+		return 0;
+	}
+
+	// bounds are unknown until the mesh is loaded, so the component location stands in for the mesh
+	const FVector CameraToMesh = PrimitiveComponent->GetComponentLocation() - PlayerController->PlayerCameraManager->GetCameraLocation();
+	float Distance = CameraToMesh.Size();
+	if ((CameraToMesh | PlayerController->PlayerCameraManager->GetCameraRotation().Vector()) < 0)
+	{
+		// meshes behind the camera wait for the visible ones a few times farther away
+		Distance *= 4;
+	}
+
+	return -Distance;
+}
+
 void AglTFRuntimeAssetActorAsync::LoadStaticMeshAsync(UStaticMesh* StaticMesh)
 {
 	if (UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(CurrentPrimitiveComponent))
@@ -255,6 +294,11 @@ void AglTFRuntimeAssetActorAsync::ReceiveOnScenesLoaded_Implementation()
 
 void AglTFRuntimeAssetActorAsync::PostUnregisterAllComponents()
 {
+	if (FglTFRuntimeLoaderPool* LoaderPool = FglTFRuntimeLoaderPool::GetPtr())
+	{
+		LoaderPool->Cancel(this);
+	}
+
 	if (Asset)
 	{
 		Asset->ClearCache();
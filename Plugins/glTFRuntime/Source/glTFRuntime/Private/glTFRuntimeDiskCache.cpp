@@ -0,0 +1,153 @@
+// Copyright 2023, Roberto De Ioris.
+
+#include "glTFRuntimeDiskCache.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<FString> CVarglTFRuntimeDiskCacheDirectory(
+	TEXT("glTFRuntime.DiskCacheDirectory"),
+	TEXT(""),
+	TEXT("Directory for the cooked glTFRuntime meshes and textures, empty means Saved/glTFRuntimeCache."),
+	ECVF_Default);
+
+namespace glTFRuntimeDiskCache
+{
+	constexpr uint32 Magic = 0x43544C47; // GLTC
+	// bump whenever the layout of any cached record changes
+	constexpr uint32 Version = 1;
+	constexpr int64 Alignment = 16;
+
+	FString GetDirectory()
+	{
+		const FString Directory = CVarglTFRuntimeDiskCacheDirectory.GetValueOnAnyThread();
+		return Directory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("glTFRuntimeCache")) : Directory;
+	}
+
+	uint64 Hash(const void* Bytes, const int64 Size, const uint64 Seed)
+	{
+		// CityHash takes 32 bit sizes, big buffers are chained
+		constexpr int64 ChunkSize = 1024 * 1024 * 1024;
+		const char* Ptr = reinterpret_cast<const char*>(Bytes);
+		uint64 Result = CityHash64WithSeed(reinterpret_cast<const char*>(&Size), sizeof(Size), Seed);
+		for (int64 ChunkOffset = 0; ChunkOffset < Size; ChunkOffset += ChunkSize)
+		{
+			Result = CityHash64WithSeed(Ptr + ChunkOffset, static_cast<uint32>(FMath::Min(ChunkSize, Size - ChunkOffset)), Result);
+		}
+		return Result;
+	}
+}
+
+FglTFRuntimeDiskCacheWriter::FglTFRuntimeDiskCacheWriter()
+{
+	Write(glTFRuntimeDiskCache::Magic);
+	Write(glTFRuntimeDiskCache::Version);
+	Write(static_cast<uint32>(sizeof(FVector)));
+}
+
+void FglTFRuntimeDiskCacheWriter::WriteBytes(const void* Bytes, const int64 Size)
+{
+	if (Size > 0)
+	{
+		Data.Append(reinterpret_cast<const uint8*>(Bytes), Size);
+	}
+}
+
+void FglTFRuntimeDiskCacheWriter::Align()
+{
+	Data.AddZeroed(::Align(Data.Num(), glTFRuntimeDiskCache::Alignment) - Data.Num());
+}
+
+void FglTFRuntimeDiskCacheWriter::WriteString(const FString& Value)
+{
+	FTCHARToUTF8 UTF8(*Value);
+	TArray<uint8> Bytes(reinterpret_cast<const uint8*>(UTF8.Get()), UTF8.Length());
+	WriteArray(Bytes);
+}
+
+bool FglTFRuntimeDiskCacheWriter::Save(const FString& Filename) const
+{
+	const FString TempFilename = Filename + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Data, *TempFilename))
+	{
+		return false;
+	}
+
+	if (!IFileManager::Get().Move(*Filename, *TempFilename, true, true, false, true))
+	{
+		IFileManager::Get().Delete(*TempFilename, false, true, true);
+		return false;
+	}
+
+	return true;
+}
+
+bool FglTFRuntimeDiskCacheReader::Open(const FString& Filename)
+{
+	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*Filename))
+	{
+		return false;
+	}
+
+	MappedFile = FglTFRuntimeMappedFile::Open(Filename);
+	if (MappedFile)
+	{
+		Data = MappedFile->GetData();
+		Size = MappedFile->Num();
+	}
+	// not every platform file supports mapping (e.g. pak files)
+	else
+	{
+		if (!FFileHelper::LoadFileToArray(FallbackData, *Filename, FILEREAD_Silent))
+		{
+			return false;
+		}
+		Data = FallbackData.GetData();
+		Size = FallbackData.Num();
+	}
+
+	Offset = 0;
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	uint32 VectorSize = 0;
+	return Read(FileMagic) && Read(FileVersion) && Read(VectorSize) &&
+		FileMagic == glTFRuntimeDiskCache::Magic && FileVersion == glTFRuntimeDiskCache::Version && VectorSize == sizeof(FVector);
+}
+
+bool FglTFRuntimeDiskCacheReader::ReadBytes(void* Bytes, const int64 BytesSize)
+{
+	if (BytesSize < 0 || Offset + BytesSize > Size)
+	{
+		return false;
+	}
+
+	if (BytesSize > 0)
+	{
+		FMemory::Memcpy(Bytes, Data + Offset, BytesSize);
+	}
+	Offset += BytesSize;
+	return true;
+}
+
+void FglTFRuntimeDiskCacheReader::Align()
+{
+	Offset = ::Align(Offset, glTFRuntimeDiskCache::Alignment);
+}
+
+bool FglTFRuntimeDiskCacheReader::ReadString(FString& Value)
+{
+	TArray<uint8> Bytes;
+	if (!ReadArray(Bytes))
+	{
+		return false;
+	}
+
+	FUTF8ToTCHAR TCHARData(reinterpret_cast<const ANSICHAR*>(Bytes.GetData()), Bytes.Num());
+	Value = FString(TCHARData.Length(), TCHARData.Get());
+	return true;
+}
@@ -2,6 +2,7 @@
 
 
 #include "glTFRuntimeFunctionLibrary.h"
+#include "glTFRuntimeLoaderPool.h"
 #include "Async/Async.h"
 #include "HttpModule.h"
 #include "HAL/PlatformApplicationMisc.h"
@@ -56,23 +57,22 @@ void UglTFRuntimeFunctionLibrary::glTFLoadAssetFromFilenameAsync(const FString&
 		OverrideConfig.bSearchContentDir = true;
 	}
 
-	Async(EAsyncExecution::Thread, [Filename, Asset, Completed, OverrideConfig]()
-		{
-			TSharedPtr<FglTFRuntimeParser> Parser = FglTFRuntimeParser::FromFilename(Filename, OverrideConfig);
-
+	TSharedRef<TSharedPtr<FglTFRuntimeParser>, ESPMode::ThreadSafe> Parser = MakeShared<TSharedPtr<FglTFRuntimeParser>, ESPMode::ThreadSafe>();
 
-			FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([Parser, Asset, Completed]()
-				{
-					if (Parser.IsValid() && Asset->SetParser(Parser.ToSharedRef()))
-					{
-						Completed.ExecuteIfBound(Asset);
-					}
-					else
-					{
-						Completed.ExecuteIfBound(nullptr);
-					}
-				}, TStatId(), nullptr, ENamedThreads::GameThread);
-			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
+	FglTFRuntimeLoaderPool::Get().Enqueue(nullptr, 0, Completed.GetUObject(), [Filename, Parser, OverrideConfig]()
+		{
+			*Parser = FglTFRuntimeParser::FromFilename(Filename, OverrideConfig);
+		},
+		[Parser, Asset, Completed]()
+		{
+			if (Parser->IsValid() && Asset->SetParser(Parser->ToSharedRef()))
+			{
+				Completed.ExecuteIfBound(Asset);
+			}
+			else
+			{
+				Completed.ExecuteIfBound(nullptr);
+			}
 		});
 }
 
@@ -0,0 +1,203 @@
+// Copyright 2023, Roberto De Ioris.
+
+#include "glTFRuntimeLoaderPool.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+
+static TAutoConsoleVariable<int32> CVarglTFRuntimeLoaderThreads(
+	TEXT("glTFRuntime.LoaderThreads"),
+	0,
+	TEXT("Number of threads running async glTFRuntime loads, 0 picks one from the core count. Read when the pool is created."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarglTFRuntimeFinalizeBudgetMs(
+	TEXT("glTFRuntime.FinalizeBudgetMs"),
+	4.0f,
+	TEXT("Milliseconds per frame the game thread spends finalizing async glTFRuntime loads (at least one finalize always runs)."),
+	ECVF_Default);
+
+static FglTFRuntimeLoaderPool* GglTFRuntimeLoaderPool = nullptr;
+
+FglTFRuntimeLoaderPool& FglTFRuntimeLoaderPool::Get()
+{
+	check(IsInGameThread());
+	if (!GglTFRuntimeLoaderPool)
+	{
+		GglTFRuntimeLoaderPool = new FglTFRuntimeLoaderPool();
+	}
+	return *GglTFRuntimeLoaderPool;
+}
+
+FglTFRuntimeLoaderPool* FglTFRuntimeLoaderPool::GetPtr()
+{
+	return GglTFRuntimeLoaderPool;
+}
+
+void FglTFRuntimeLoaderPool::Shutdown()
+{
+	delete GglTFRuntimeLoaderPool;
+	GglTFRuntimeLoaderPool = nullptr;
+}
+
+FglTFRuntimeLoaderPool::FglTFRuntimeLoaderPool() : RunningJobs(0), NextSerial(0)
+{
+	MaxRunningJobs = CVarglTFRuntimeLoaderThreads.GetValueOnGameThread();
+	if (MaxRunningJobs <= 0)
+	{
+		// leave room for the game and render threads
+		MaxRunningJobs = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 2, 1, 4);
+	}
+
+	ThreadPool = FQueuedThreadPool::Allocate();
+	// material and image decoding go deep on the stack
+	ThreadPool->Create(MaxRunningJobs, 1024 * 1024, TPri_BelowNormal, TEXT("glTFRuntimeLoader"));
+
+#if ENGINE_MAJOR_VERSION > 4
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FglTFRuntimeLoaderPool::Tick));
+#else
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FglTFRuntimeLoaderPool::Tick));
+#endif
+}
+
+FglTFRuntimeLoaderPool::~FglTFRuntimeLoaderPool()
+{
+#if ENGINE_MAJOR_VERSION > 4
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	PendingJobs.Empty();
+
+	// waits for the running jobs, their finalizers are dropped with the queue
+	ThreadPool->Destroy();
+	delete ThreadPool;
+}
+
+void FglTFRuntimeLoaderPool::Enqueue(const void* Key, const float Priority, const UObject* Owner, TFunction<void()> Work, TFunction<void()> Finalize)
+{
+	check(IsInGameThread());
+
+	TSharedRef<FJob, ESPMode::ThreadSafe> Job = MakeShared<FJob, ESPMode::ThreadSafe>();
+	Job->Key = Key;
+	Job->Priority = Priority;
+	Job->Serial = NextSerial++;
+	Job->bHasOwner = Owner != nullptr;
+	Job->Owner = Owner;
+	Job->Work = MoveTemp(Work);
+	Job->Finalize = MoveTemp(Finalize);
+
+	PendingJobs.Add(Job);
+	Dispatch();
+}
+
+void FglTFRuntimeLoaderPool::Cancel(const UObject* Owner)
+{
+	check(IsInGameThread());
+
+	// compare the weak pointers, as an owner in its teardown may no longer resolve
+	const TWeakObjectPtr<const UObject> WeakOwner = Owner;
+
+	PendingJobs.RemoveAll([&WeakOwner](const TSharedRef<FJob, ESPMode::ThreadSafe>& Job) { return Job->bHasOwner && Job->Owner == WeakOwner; });
+
+	// already running work cannot be interrupted, but its finalizer will not run
+	for (const TSharedRef<FJob, ESPMode::ThreadSafe>& Job : RunningJobsList)
+	{
+		if (Job->bHasOwner && Job->Owner == WeakOwner)
+		{
+			Job->bCancelled = true;
+		}
+	}
+}
+
+void FglTFRuntimeLoaderPool::Dispatch()
+{
+	while (RunningJobs < MaxRunningJobs)
+	{
+		int32 BestIndex = INDEX_NONE;
+		for (int32 JobIndex = PendingJobs.Num() - 1; JobIndex >= 0; JobIndex--)
+		{
+			const TSharedRef<FJob, ESPMode::ThreadSafe>& Job = PendingJobs[JobIndex];
+			if (Job->IsCancelled())
+			{
+				PendingJobs.RemoveAt(JobIndex);
+				if (BestIndex != INDEX_NONE)
+				{
+					BestIndex--;
+				}
+				continue;
+			}
+
+			if (Job->Key && BusyKeys.Contains(Job->Key))
+			{
+				continue;
+			}
+
+			if (BestIndex == INDEX_NONE)
+			{
+				BestIndex = JobIndex;
+				continue;
+			}
+
+			// higher priority first, then first come first served
+			const TSharedRef<FJob, ESPMode::ThreadSafe>& BestJob = PendingJobs[BestIndex];
+			if (Job->Priority > BestJob->Priority || (Job->Priority == BestJob->Priority && Job->Serial < BestJob->Serial))
+			{
+				BestIndex = JobIndex;
+			}
+		}
+
+		if (BestIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		TSharedRef<FJob, ESPMode::ThreadSafe> Job = PendingJobs[BestIndex];
+		PendingJobs.RemoveAt(BestIndex);
+
+		if (Job->Key)
+		{
+			BusyKeys.Add(Job->Key);
+		}
+		RunningJobs++;
+		RunningJobsList.Add(Job);
+
+		AsyncPool(*ThreadPool, [this, Job]()
+			{
+				Job->Work();
+				FinalizeQueue.Enqueue(Job);
+			});
+	}
+}
+
+bool FglTFRuntimeLoaderPool::Tick(float DeltaTime)
+{
+	const double Deadline = FPlatformTime::Seconds() + CVarglTFRuntimeFinalizeBudgetMs.GetValueOnGameThread() / 1000.0;
+
+	// the first finalize ignores the budget, loads always progress even with a budget <= 0 or a slow frame
+	bool bFirstFinalize = true;
+	TSharedPtr<FJob, ESPMode::ThreadSafe> Job;
+	while ((bFirstFinalize || FPlatformTime::Seconds() < Deadline) && FinalizeQueue.Dequeue(Job))
+	{
+		bFirstFinalize = false;
+
+		if (!Job->IsCancelled() && Job->Finalize)
+		{
+			Job->Finalize();
+		}
+
+		// the key is released only now, as the finalizer still uses the parser state
+		if (Job->Key)
+		{
+			BusyKeys.Remove(Job->Key);
+		}
+		RunningJobs--;
+		RunningJobsList.RemoveSwap(Job.ToSharedRef());
+	}
+
+	Dispatch();
+
+	return true;
+}
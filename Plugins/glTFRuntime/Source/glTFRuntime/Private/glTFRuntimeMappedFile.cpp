@@ -0,0 +1,26 @@
+// Copyright 2023, Roberto De Ioris.
+
+#include "glTFRuntimeMappedFile.h"
+#include "HAL/PlatformFileManager.h"
+
+TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> FglTFRuntimeMappedFile::Open(const FString& Filename)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IMappedFileHandle> MappedHandle(PlatformFile.OpenMapped(*Filename));
+	if (!MappedHandle || MappedHandle->GetFileSize() <= 0)
+	{
+		return nullptr;
+	}
+
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedHandle->MapRegion());
+	if (!MappedRegion)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> MappedFile = MakeShared<FglTFRuntimeMappedFile, ESPMode::ThreadSafe>();
+	MappedFile->MappedHandle = MoveTemp(MappedHandle);
+	MappedFile->MappedRegion = MoveTemp(MappedRegion);
+	return MappedFile;
+}
@@ -1,7 +1,11 @@
 // Copyright 2020-2023, Roberto De Ioris.
 
 #include "glTFRuntimeParser.h"
+#include "glTFRuntimeDiskCache.h"
+#include "glTFRuntimeLoaderPool.h"
 #include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
 #include "Runtime/Launch/Resources/Version.h"
 #include "Engine/Texture2D.h"
 #include "Misc/FileHelper.h"
@@ -40,6 +44,23 @@ FglTFRuntimeOnPreCreatedStaticMesh FglTFRuntimeParser::OnPreCreatedStaticMesh;
 FglTFRuntimeOnPostCreatedStaticMesh FglTFRuntimeParser::OnPostCreatedStaticMesh;
 FglTFRuntimeOnPreCreatedSkeletalMesh FglTFRuntimeParser::OnPreCreatedSkeletalMesh;
 
+static TAutoConsoleVariable<int32> CVarglTFRuntimeParallelPrimitives(
+	TEXT("glTFRuntime.ParallelPrimitives"),
+	1,
+	TEXT("Decode the primitives of a mesh in parallel (materials are always loaded on the calling thread)."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarglTFRuntimeSpecializedAccessorDecoding(
+	TEXT("glTFRuntime.SpecializedAccessorDecoding"),
+	1,
+	TEXT("Decode accessors with loops specialized on their layout, 0 uses the generic per component loop (for testing and benchmarking)."),
+	ECVF_Default);
+
+bool FglTFRuntimeParser::IsSpecializedAccessorDecodingEnabled()
+{
+	return CVarglTFRuntimeSpecializedAccessorDecoding.GetValueOnAnyThread() != 0;
+}
+
 TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromFilename(const FString& Filename, const FglTFRuntimeConfig& LoaderConfig)
 {
 	SCOPED_NAMED_EVENT(FglTFRuntimeParser_FromFilename, FColor::Magenta);
@@ -75,14 +96,24 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromFilename(const FString& F
 		}
 	}
 
+	// GLB BIN chunks are referenced directly from the mapping, without copying them
+	TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> MappedFile = FglTFRuntimeMappedFile::Open(TruePath);
 	TArray64<uint8> Content;
-	if (!FFileHelper::LoadFileToArray(Content, *TruePath))
+	if (!MappedFile && !FFileHelper::LoadFileToArray(Content, *TruePath))
 	{
 		UE_LOG(LogGLTFRuntime, Error, TEXT("Unable to load file %s"), *Filename);
 		return nullptr;
 	}
 
-	TSharedPtr<FglTFRuntimeParser> Parser = FromData(Content.GetData(), Content.Num(), LoaderConfig);
+	// Content could be moved into the parser, but its allocation stays valid
+	const uint8* DataPtr = MappedFile ? MappedFile->GetData() : Content.GetData();
+	const int64 DataNum = MappedFile ? MappedFile->Num() : Content.Num();
+
+	TSharedPtr<FglTFRuntimeParser> Parser = FromData_Internal(DataPtr, DataNum, LoaderConfig, MappedFile, MappedFile ? nullptr : &Content);
+	if (Parser)
+	{
+		Parser->EnableDiskCache(DataPtr, DataNum, LoaderConfig);
+	}
 
 	if (Parser && LoaderConfig.bAllowExternalFiles)
 	{
@@ -94,11 +125,66 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromFilename(const FString& F
 }
 
 TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromData(const uint8* DataPtr, int64 DataNum, const FglTFRuntimeConfig& LoaderConfig)
+{
+	TSharedPtr<FglTFRuntimeParser> Parser = FromData_Internal(DataPtr, DataNum, LoaderConfig, nullptr, nullptr);
+	if (Parser)
+	{
+		Parser->EnableDiskCache(DataPtr, DataNum, LoaderConfig);
+	}
+	return Parser;
+}
+
+void FglTFRuntimeParser::EnableDiskCache(const uint8* DataPtr, const int64 DataNum, const FglTFRuntimeConfig& LoaderConfig)
+{
+	if (!LoaderConfig.bDiskCache || LoaderConfig.bAsBlob)
+	{
+		return;
+	}
+
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_EnableDiskCache, FColor::Magenta);
+
+	// external files can change without the main asset changing, so they cannot be part of the content hash (archives are fine)
+	if (!ZipFile)
+	{
+		for (const FString& Field : { FString("buffers"), FString("images") })
+		{
+			const TArray<TSharedPtr<FJsonValue>>* JsonArray;
+			if (!Root->TryGetArrayField(Field, JsonArray))
+			{
+				continue;
+			}
+
+			for (const TSharedPtr<FJsonValue>& JsonValue : *JsonArray)
+			{
+				const TSharedPtr<FJsonObject>* JsonObject;
+				FString Uri;
+				if (JsonValue->TryGetObject(JsonObject) && (*JsonObject)->TryGetStringField("uri", Uri) && !Uri.StartsWith("data:"))
+				{
+					UE_LOG(LogGLTFRuntime, Verbose, TEXT("Disk cache disabled, the asset references the external file %s"), *Uri);
+					return;
+				}
+			}
+		}
+	}
+
+	uint64 SceneHash = glTFRuntimeDiskCache::Hash(DataPtr, DataNum);
+	SceneHash = glTFRuntimeDiskCache::Hash(&SceneBasis, sizeof(FMatrix), SceneHash);
+	SceneHash = glTFRuntimeDiskCache::Hash(&SceneScale, sizeof(float), SceneHash);
+	// 0 is reserved for "disabled"
+	DiskCacheContentHash = SceneHash ? SceneHash : 1;
+}
+
+FString FglTFRuntimeParser::GetDiskCacheFilename(const TCHAR* Kind, const uint64 Key) const
+{
+	return FPaths::Combine(glTFRuntimeDiskCache::GetDirectory(), FString::Printf(TEXT("%016llx_%s_%016llx.bin"), DiskCacheContentHash, Kind, Key));
+}
+
+TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromData_Internal(const uint8* DataPtr, int64 DataNum, const FglTFRuntimeConfig& LoaderConfig, TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> MappedFile, TArray64<uint8>* OwnedData)
 {
 	SCOPED_NAMED_EVENT(FglTFRuntimeParser_FromData, FColor::Magenta);
 
 	// required for Gzip;
-	TArray<uint8> UncompressedData;
+	TArray64<uint8> UncompressedData;
 
 	// Gzip Compressed ? 10 bytes header and 8 bytes footer
 	if (DataNum > 18 && DataPtr[0] == 0x1F && DataPtr[1] == 0x8B && DataPtr[2] == 0x08)
@@ -180,6 +266,9 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromData(const uint8* DataPtr
 
 		DataPtr = UncompressedData.GetData();
 		DataNum = *GzipOriginalSize;
+		// the uncompressed buffer is the only copy, the parser can take it
+		MappedFile.Reset();
+		OwnedData = &UncompressedData;
 	}
 	// LZ4 ? magic number(4) + 3 + 8 bytes size (expects uncompressed size)
 	else if (DataNum > 15 && DataPtr[0] == 0x04 && DataPtr[1] == 0x22 && DataPtr[2] == 0x4D && DataPtr[3] == 0x18)
@@ -238,6 +327,8 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromData(const uint8* DataPtr
 			DataPtr = nullptr;
 			DataNum = 0;
 		}
+		MappedFile.Reset();
+		OwnedData = &UnzippedData;
 	}
 
 	if (LoaderConfig.bAsBlob)
@@ -245,7 +336,14 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromData(const uint8* DataPtr
 		TSharedPtr<FglTFRuntimeParser> NewParser = MakeShared<FglTFRuntimeParser>(MakeShared<FJsonObject>(), LoaderConfig.GetMatrix(), LoaderConfig.SceneScale);
 		if (NewParser)
 		{
-			NewParser->AsBlob.Append(DataPtr, DataNum);
+			if (OwnedData && OwnedData->GetData() == DataPtr)
+			{
+				NewParser->AsBlob = MoveTemp(*OwnedData);
+			}
+			else
+			{
+				NewParser->AsBlob.Append(DataPtr, DataNum);
+			}
 			NewParser->ZipFile = ZipFile;
 		}
 		return NewParser;
@@ -259,7 +357,7 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromData(const uint8* DataPtr
 			DataPtr[2] == 0x54 &&
 			DataPtr[3] == 0x46)
 		{
-			return FromBinary(DataPtr, DataNum, LoaderConfig, ZipFile);
+			return FromBinary_Internal(DataPtr, DataNum, LoaderConfig, ZipFile, MappedFile, OwnedData);
 		}
 	}
 
@@ -312,11 +410,17 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromString(const FString& Jso
 }
 
 TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromBinary(const uint8* DataPtr, int64 DataNum, const FglTFRuntimeConfig& LoaderConfig, TSharedPtr<FglTFRuntimeZipFile> InZipFile)
+{
+	return FromBinary_Internal(DataPtr, DataNum, LoaderConfig, InZipFile, nullptr, nullptr);
+}
+
+TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromBinary_Internal(const uint8* DataPtr, int64 DataNum, const FglTFRuntimeConfig& LoaderConfig, TSharedPtr<FglTFRuntimeZipFile> InZipFile, TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> MappedFile, TArray64<uint8>* OwnedData)
 {
 	SCOPED_NAMED_EVENT(FglTFRuntimeParser_FromBinary, FColor::Magenta);
 
 	FString JsonData;
-	TArray64<uint8> BinaryBuffer;
+	int64 BinaryOffset = 0;
+	int64 BinarySize = 0;
 
 	bool bJsonFound = false;
 	bool bBinaryFound = false;
@@ -348,7 +452,8 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromBinary(const uint8* DataP
 		else if (*ChunkType == 0x004E4942 && !bBinaryFound)
 		{
 			bBinaryFound = true;
-			BinaryBuffer.Append(&DataPtr[BlobIndex], *ChunkLength);
+			BinaryOffset = BlobIndex;
+			BinarySize = *ChunkLength;
 		}
 
 		BlobIndex += *ChunkLength;
@@ -365,7 +470,24 @@ TSharedPtr<FglTFRuntimeParser> FglTFRuntimeParser::FromBinary(const uint8* DataP
 	{
 		if (bBinaryFound)
 		{
-			Parser->SetBinaryBuffer(BinaryBuffer);
+			if (MappedFile)
+			{
+				Parser->BinaryBufferMappedFile = MappedFile;
+				// the mapping is read only, blobs are never written to
+				Parser->BinaryBufferBlob.Data = const_cast<uint8*>(DataPtr) + BinaryOffset;
+			}
+			else if (OwnedData && OwnedData->GetData() == DataPtr)
+			{
+				// keeps the whole GLB (the JSON chunk overhead is negligible) to avoid a copy of the BIN chunk
+				Parser->BinaryBuffer = MoveTemp(*OwnedData);
+				Parser->BinaryBufferBlob.Data = Parser->BinaryBuffer.GetData() + BinaryOffset;
+			}
+			else
+			{
+				Parser->BinaryBuffer.Append(&DataPtr[BinaryOffset], BinarySize);
+				Parser->BinaryBufferBlob.Data = Parser->BinaryBuffer.GetData();
+			}
+			Parser->BinaryBufferBlob.Num = BinarySize;
 		}
 	}
 
@@ -524,6 +646,8 @@ FglTFRuntimeParser::FglTFRuntimeParser(TSharedRef<FJsonObject> JsonObject, const
 	bAllNodesCached = false;
 	DownloadTime = 0;
 
+	BuildRootArrays();
+
 	if (IsInGameThread())
 	{
 		LoadAndFillBaseMaterials();
@@ -642,22 +766,12 @@ bool FglTFRuntimeParser::LoadNodesRecursive(const int32 NodeIndex, TArray<FglTFR
 
 int32 FglTFRuntimeParser::GetNumMeshes() const
 {
-	const TArray<TSharedPtr<FJsonValue>>* JsonArray;
-	if (Root->TryGetArrayField("meshes", JsonArray))
-	{
-		return JsonArray->Num();
-	}
-	return 0;
+	return GetRootArrayNum(EglTFRuntimeRootArray::Meshes);
 }
 
 int32 FglTFRuntimeParser::GetNumImages() const
 {
-	const TArray<TSharedPtr<FJsonValue>>* JsonArray;
-	if (Root->TryGetArrayField("images", JsonArray))
-	{
-		return JsonArray->Num();
-	}
-	return 0;
+	return GetRootArrayNum(EglTFRuntimeRootArray::Images);
 }
 
 bool FglTFRuntimeParser::LoadScenes(TArray<FglTFRuntimeScene>& Scenes)
@@ -710,13 +824,76 @@ bool FglTFRuntimeParser::CheckJsonIndex(TSharedRef<FJsonObject> JsonObject, cons
 
 TSharedPtr<FJsonObject> FglTFRuntimeParser::GetJsonObjectFromIndex(TSharedRef<FJsonObject> JsonObject, const FString& FieldName, const int32 Index)
 {
-	TArray<TSharedRef<FJsonValue>> JsonArray;
-	if (!CheckJsonIndex(JsonObject, FieldName, Index, JsonArray))
+	if (Index < 0)
 	{
 		return nullptr;
 	}
 
-	return JsonArray[Index]->AsObject();
+	const TArray<TSharedPtr<FJsonValue>>* JsonArray;
+	if (!JsonObject->TryGetArrayField(FieldName, JsonArray))
+	{
+		return nullptr;
+	}
+
+	if (Index >= JsonArray->Num())
+	{
+		return nullptr;
+	}
+
+	return (*JsonArray)[Index]->AsObject();
+}
+
+static const TCHAR* const GglTFRuntimeRootArraysNames[] =
+{
+	TEXT("accessors"),
+	TEXT("animations"),
+	TEXT("bufferViews"),
+	TEXT("cameras"),
+	TEXT("images"),
+	TEXT("materials"),
+	TEXT("meshes"),
+	TEXT("nodes"),
+	TEXT("scenes"),
+	TEXT("skins"),
+	TEXT("textures"),
+};
+static_assert(UE_ARRAY_COUNT(GglTFRuntimeRootArraysNames) == static_cast<int32>(EglTFRuntimeRootArray::Num), "glTFRuntime root arrays names mismatch");
+
+void FglTFRuntimeParser::BuildRootArrays()
+{
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_BuildRootArrays, FColor::Magenta);
+
+	for (int32 RootArrayIndex = 0; RootArrayIndex < static_cast<int32>(EglTFRuntimeRootArray::Num); RootArrayIndex++)
+	{
+		TArray<TSharedPtr<FJsonObject>>& JsonObjects = RootArrays[RootArrayIndex];
+		JsonObjects.Empty();
+
+		const TArray<TSharedPtr<FJsonValue>>* JsonArray;
+		if (!Root->TryGetArrayField(GglTFRuntimeRootArraysNames[RootArrayIndex], JsonArray))
+		{
+			continue;
+		}
+
+		JsonObjects.Reserve(JsonArray->Num());
+		for (const TSharedPtr<FJsonValue>& JsonValue : *JsonArray)
+		{
+			const TSharedPtr<FJsonObject>* JsonObject = nullptr;
+			JsonObjects.Add(JsonValue->TryGetObject(JsonObject) ? *JsonObject : nullptr);
+		}
+	}
+}
+
+TSharedPtr<FJsonObject> FglTFRuntimeParser::GetJsonObjectFromRootIndex(const FString& FieldName, const int32 Index)
+{
+	for (int32 RootArrayIndex = 0; RootArrayIndex < static_cast<int32>(EglTFRuntimeRootArray::Num); RootArrayIndex++)
+	{
+		if (FieldName.Equals(GglTFRuntimeRootArraysNames[RootArrayIndex], ESearchCase::CaseSensitive))
+		{
+			return GetJsonObjectFromRootIndex(static_cast<EglTFRuntimeRootArray>(RootArrayIndex), Index);
+		}
+	}
+
+	return GetJsonObjectFromIndex(Root, FieldName, Index);
 }
 
 TSharedPtr<FJsonObject> FglTFRuntimeParser::GetJsonObjectFromExtensionIndex(TSharedRef<FJsonObject> JsonObject, const FString& ExtensionName, const FString& FieldName, const int32 Index)
@@ -967,7 +1144,7 @@ TArray<double> FglTFRuntimeParser::GetJsonExtensionObjectNumbers(TSharedRef<FJso
 
 bool FglTFRuntimeParser::LoadScene(int32 SceneIndex, FglTFRuntimeScene& Scene)
 {
-	TSharedPtr<FJsonObject> JsonSceneObject = GetJsonObjectFromRootIndex("scenes", SceneIndex);
+	TSharedPtr<FJsonObject> JsonSceneObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Scenes, SceneIndex);
 	if (!JsonSceneObject)
 	{
 		return false;
@@ -1093,7 +1270,11 @@ bool FglTFRuntimeParser::LoadJointByName(const int64 RootBoneIndex, const FStrin
 void FglTFRuntimeParser::AddError(const FString& ErrorContext, const FString& ErrorMessage)
 {
 	FString FullMessage = ErrorContext + ": " + ErrorMessage;
-	Errors.Add(FullMessage);
+	{
+		// primitives can be decoded in parallel
+		FScopeLock ErrorsScopeLock(&ErrorsLock);
+		Errors.Add(FullMessage);
+	}
 	UE_LOG(LogGLTFRuntime, Error, TEXT("%s"), *FullMessage);
 	if (OnError.IsBound())
 	{
@@ -1641,7 +1822,7 @@ bool FglTFRuntimeParser::LoadCameraIntoCameraComponent(const int32 CameraIndex,
 		return false;
 	}
 
-	TSharedPtr<FJsonObject> CameraObject = GetJsonObjectFromRootIndex("cameras", CameraIndex);
+	TSharedPtr<FJsonObject> CameraObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Cameras, CameraIndex);
 	if (!CameraObject)
 	{
 		AddError("LoadCameraIntoCameraComponent()", "Invalid Camera Index.");
@@ -1723,7 +1904,7 @@ bool FglTFRuntimeParser::LoadCameraIntoCameraComponent(const int32 CameraIndex,
 
 USkeleton* FglTFRuntimeParser::LoadSkeleton(const int32 SkinIndex, const FglTFRuntimeSkeletonConfig& SkeletonConfig)
 {
-	TSharedPtr<FJsonObject> JsonSkinObject = GetJsonObjectFromRootIndex("skins", SkinIndex);
+	TSharedPtr<FJsonObject> JsonSkinObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Skins, SkinIndex);
 	if (!JsonSkinObject)
 	{
 		return nullptr;
@@ -2437,24 +2618,122 @@ bool FglTFRuntimeParser::LoadPrimitives(TSharedRef<FJsonObject> JsonMeshObject,
 
 	int32 FirstPrimitive = Primitives.Num();
 
-	for (TSharedPtr<FJsonValue> JsonPrimitive : *JsonPrimitives)
+	// the delegates could alter the primitives in ways the cache cannot track
+	FString DiskCacheFilename;
+	if (DiskCacheContentHash && !OnPreLoadedPrimitive.IsBound() && !OnLoadedPrimitive.IsBound())
 	{
-		TSharedPtr<FJsonObject> JsonPrimitiveObject = JsonPrimitive->AsObject();
-		if (!JsonPrimitiveObject)
+		const int32 MeshIndex = RootArrays[static_cast<int32>(EglTFRuntimeRootArray::Meshes)].IndexOfByKey(JsonMeshObject);
+		if (MeshIndex != INDEX_NONE)
 		{
-			return false;
+			DiskCacheFilename = GetDiskCacheFilename(TEXT("mesh"), MeshIndex);
 		}
+	}
 
-		FglTFRuntimePrimitive Primitive;
-		if (!LoadPrimitive(JsonPrimitiveObject.ToSharedRef(), Primitive, MaterialsConfig))
+	if (!DiskCacheFilename.IsEmpty() && LoadPrimitivesFromDiskCache(DiskCacheFilename, *JsonPrimitives, Primitives, MaterialsConfig))
+	{
+		UE_LOG(LogGLTFRuntime, Verbose, TEXT("Primitives loaded from disk cache %s"), *DiskCacheFilename);
+	}
+	else
+	{
+		// a partially read cache could have left some primitive
+		Primitives.SetNum(FirstPrimitive);
+
+		TArray<TSharedRef<FJsonObject>> JsonPrimitiveObjects;
+		for (const TSharedPtr<FJsonValue>& JsonPrimitive : *JsonPrimitives)
 		{
-			return false;
+			TSharedPtr<FJsonObject> JsonPrimitiveObject = JsonPrimitive->AsObject();
+			if (!JsonPrimitiveObject)
+			{
+				return false;
+			}
+			JsonPrimitiveObjects.Add(JsonPrimitiveObject.ToSharedRef());
+		}
+
+		TArray<FglTFRuntimePrimitive> NewPrimitives;
+		NewPrimitives.SetNum(JsonPrimitiveObjects.Num());
+
+		// the primitive delegates are not thread safe, and in UE4 the JSON DOM refcounting is not thread safe too
+		const bool bParallel = ENGINE_MAJOR_VERSION > 4 && CVarglTFRuntimeParallelPrimitives.GetValueOnAnyThread() && JsonPrimitiveObjects.Num() > 1 &&
+			!OnPreLoadedPrimitive.IsBound() && !OnLoadedPrimitive.IsBound();
+
+		if (bParallel)
+		{
+			// fills the buffers, bufferViews and sparse caches, so that the decoding tasks only read them
+			for (TSharedRef<FJsonObject> JsonPrimitiveObject : JsonPrimitiveObjects)
+			{
+				PrefetchPrimitiveAccessors(JsonPrimitiveObject);
+			}
+
+			TArray<bool> Results;
+			Results.AddZeroed(JsonPrimitiveObjects.Num());
+			ParallelFor(JsonPrimitiveObjects.Num(), [&](const int32 PrimitiveIndex)
+				{
+					Results[PrimitiveIndex] = LoadPrimitiveGeometry(JsonPrimitiveObjects[PrimitiveIndex], NewPrimitives[PrimitiveIndex]);
+				});
+
+			// materials are UObjects, they are loaded in the original order
+			for (int32 PrimitiveIndex = 0; PrimitiveIndex < JsonPrimitiveObjects.Num(); PrimitiveIndex++)
+			{
+				if (!Results[PrimitiveIndex] || !LoadPrimitiveMaterial(JsonPrimitiveObjects[PrimitiveIndex], NewPrimitives[PrimitiveIndex], MaterialsConfig))
+				{
+					return false;
+				}
+			}
+		}
+		else
+		{
+			for (int32 PrimitiveIndex = 0; PrimitiveIndex < JsonPrimitiveObjects.Num(); PrimitiveIndex++)
+			{
+				if (!LoadPrimitive(JsonPrimitiveObjects[PrimitiveIndex], NewPrimitives[PrimitiveIndex], MaterialsConfig))
+				{
+					return false;
+				}
+			}
 		}
 
-		// add the primitive only if it has at least one index 
-		if (Primitive.Indices.Num() > 0)
+		// morph targets generally use sparse accessors: their densified copy is not needed anymore, the primitives have the decoded data
+		for (TSharedRef<FJsonObject> JsonPrimitiveObject : JsonPrimitiveObjects)
 		{
-			Primitives.Add(Primitive);
+			const TArray<TSharedPtr<FJsonValue>>* JsonTargetsArray;
+			if (!JsonPrimitiveObject->TryGetArrayField("targets", JsonTargetsArray))
+			{
+				continue;
+			}
+
+			for (const TSharedPtr<FJsonValue>& JsonTargetItem : *JsonTargetsArray)
+			{
+				const TSharedPtr<FJsonObject>* JsonTargetObject;
+				if (!JsonTargetItem->TryGetObject(JsonTargetObject))
+				{
+					continue;
+				}
+
+				for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*JsonTargetObject)->Values)
+				{
+					int32 AccessorIndex;
+					if (Pair.Value->TryGetNumber(AccessorIndex))
+					{
+						SparseAccessorsCache.Remove(AccessorIndex);
+						SparseAccessorsStridesCache.Remove(AccessorIndex);
+					}
+				}
+			}
+		}
+
+		TArray<int32> JsonPrimitiveIndices;
+		for (int32 JsonPrimitiveIndex = 0; JsonPrimitiveIndex < NewPrimitives.Num(); JsonPrimitiveIndex++)
+		{
+			// add the primitive only if it has at least one index 
+			if (NewPrimitives[JsonPrimitiveIndex].Indices.Num() > 0)
+			{
+				Primitives.Add(MoveTemp(NewPrimitives[JsonPrimitiveIndex]));
+				JsonPrimitiveIndices.Add(JsonPrimitiveIndex);
+			}
+		}
+
+		if (!DiskCacheFilename.IsEmpty())
+		{
+			SavePrimitivesToDiskCache(DiskCacheFilename, JsonPrimitiveIndices, MakeArrayView(Primitives.GetData() + FirstPrimitive, Primitives.Num() - FirstPrimitive));
 		}
 	}
 
@@ -2531,6 +2810,166 @@ bool FglTFRuntimeParser::LoadPrimitives(TSharedRef<FJsonObject> JsonMeshObject,
 	return true;
 }
 
+bool FglTFRuntimeParser::LoadPrimitivesFromDiskCache(const FString& Filename, const TArray<TSharedPtr<FJsonValue>>& JsonPrimitives, TArray<FglTFRuntimePrimitive>& Primitives, const FglTFRuntimeMaterialsConfig& MaterialsConfig)
+{
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_LoadPrimitivesFromDiskCache, FColor::Magenta);
+
+	FglTFRuntimeDiskCacheReader Reader;
+	if (!Reader.Open(Filename))
+	{
+		return false;
+	}
+
+	int32 NumPrimitives = 0;
+	if (!Reader.Read(NumPrimitives))
+	{
+		return false;
+	}
+
+	for (int32 CachedPrimitiveIndex = 0; CachedPrimitiveIndex < NumPrimitives; CachedPrimitiveIndex++)
+	{
+		int32 JsonPrimitiveIndex = INDEX_NONE;
+		if (!Reader.Read(JsonPrimitiveIndex) || !JsonPrimitives.IsValidIndex(JsonPrimitiveIndex))
+		{
+			return false;
+		}
+
+		TSharedPtr<FJsonObject> JsonPrimitiveObject = JsonPrimitives[JsonPrimitiveIndex]->AsObject();
+		if (!JsonPrimitiveObject)
+		{
+			return false;
+		}
+
+		FglTFRuntimePrimitive Primitive;
+		int32 NumUVs = 0;
+		int32 NumJoints = 0;
+		int32 NumWeights = 0;
+		int32 NumMorphTargets = 0;
+		if (!Reader.Read(Primitive.Mode) || !Reader.Read(Primitive.AdditionalBufferView) ||
+			!Reader.Read(Primitive.bHighPrecisionUVs) || !Reader.Read(Primitive.bHighPrecisionWeights) ||
+			!Reader.ReadArray(Primitive.Positions) || !Reader.ReadArray(Primitive.Normals) || !Reader.ReadArray(Primitive.Tangents) ||
+			!Reader.ReadArray(Primitive.Indices) || !Reader.ReadArray(Primitive.Colors) || !Reader.Read(NumUVs) || NumUVs < 0)
+		{
+			return false;
+		}
+
+		Primitive.UVs.SetNum(NumUVs);
+		for (TArray<FVector2D>& UV : Primitive.UVs)
+		{
+			if (!Reader.ReadArray(UV))
+			{
+				return false;
+			}
+		}
+
+		if (!Reader.Read(NumJoints) || NumJoints < 0)
+		{
+			return false;
+		}
+
+		Primitive.Joints.SetNum(NumJoints);
+		for (TArray<FglTFRuntimeUInt16Vector4>& Joints : Primitive.Joints)
+		{
+			if (!Reader.ReadArray(Joints))
+			{
+				return false;
+			}
+		}
+
+		if (!Reader.Read(NumWeights) || NumWeights < 0)
+		{
+			return false;
+		}
+
+		Primitive.Weights.SetNum(NumWeights);
+		for (TArray<FVector4>& Weights : Primitive.Weights)
+		{
+			if (!Reader.ReadArray(Weights))
+			{
+				return false;
+			}
+		}
+
+		if (!Reader.Read(NumMorphTargets) || NumMorphTargets < 0)
+		{
+			return false;
+		}
+
+		Primitive.MorphTargets.SetNum(NumMorphTargets);
+		for (FglTFRuntimeMorphTarget& MorphTarget : Primitive.MorphTargets)
+		{
+			if (!Reader.ReadString(MorphTarget.Name) || !Reader.ReadArray(MorphTarget.Positions) || !Reader.ReadArray(MorphTarget.Normals))
+			{
+				return false;
+			}
+		}
+
+		// materials are UObjects, they are always loaded from the asset
+		if (!LoadPrimitiveMaterial(JsonPrimitiveObject.ToSharedRef(), Primitive, MaterialsConfig))
+		{
+			return false;
+		}
+
+		Primitives.Add(MoveTemp(Primitive));
+	}
+
+	return true;
+}
+
+void FglTFRuntimeParser::SavePrimitivesToDiskCache(const FString& Filename, const TArray<int32>& JsonPrimitiveIndices, TArrayView<const FglTFRuntimePrimitive> Primitives) const
+{
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_SavePrimitivesToDiskCache, FColor::Magenta);
+
+	FglTFRuntimeDiskCacheWriter Writer;
+	Writer.Write(Primitives.Num());
+
+	for (int32 PrimitiveIndex = 0; PrimitiveIndex < Primitives.Num(); PrimitiveIndex++)
+	{
+		const FglTFRuntimePrimitive& Primitive = Primitives[PrimitiveIndex];
+		Writer.Write(JsonPrimitiveIndices[PrimitiveIndex]);
+		Writer.Write(Primitive.Mode);
+		Writer.Write(Primitive.AdditionalBufferView);
+		Writer.Write(Primitive.bHighPrecisionUVs);
+		Writer.Write(Primitive.bHighPrecisionWeights);
+		Writer.WriteArray(Primitive.Positions);
+		Writer.WriteArray(Primitive.Normals);
+		Writer.WriteArray(Primitive.Tangents);
+		Writer.WriteArray(Primitive.Indices);
+		Writer.WriteArray(Primitive.Colors);
+
+		Writer.Write(Primitive.UVs.Num());
+		for (const TArray<FVector2D>& UV : Primitive.UVs)
+		{
+			Writer.WriteArray(UV);
+		}
+
+		Writer.Write(Primitive.Joints.Num());
+		for (const TArray<FglTFRuntimeUInt16Vector4>& Joints : Primitive.Joints)
+		{
+			Writer.WriteArray(Joints);
+		}
+
+		Writer.Write(Primitive.Weights.Num());
+		for (const TArray<FVector4>& Weights : Primitive.Weights)
+		{
+			Writer.WriteArray(Weights);
+		}
+
+		Writer.Write(Primitive.MorphTargets.Num());
+		for (const FglTFRuntimeMorphTarget& MorphTarget : Primitive.MorphTargets)
+		{
+			Writer.WriteString(MorphTarget.Name);
+			Writer.WriteArray(MorphTarget.Positions);
+			Writer.WriteArray(MorphTarget.Normals);
+		}
+	}
+
+	if (!Writer.Save(Filename))
+	{
+		UE_LOG(LogGLTFRuntime, Warning, TEXT("Unable to write disk cache %s"), *Filename);
+	}
+}
+
 FVector FglTFRuntimeParser::TransformVector(FVector Vector) const
 {
 	return SceneBasis.TransformVector(Vector);
@@ -2552,6 +2991,25 @@ bool FglTFRuntimeParser::LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObje
 
 	OnPreLoadedPrimitive.Broadcast(AsShared(), JsonPrimitiveObject, Primitive);
 
+	if (!LoadPrimitiveGeometry(JsonPrimitiveObject, Primitive))
+	{
+		return false;
+	}
+
+	if (!LoadPrimitiveMaterial(JsonPrimitiveObject, Primitive, MaterialsConfig))
+	{
+		return false;
+	}
+
+	OnLoadedPrimitive.Broadcast(AsShared(), JsonPrimitiveObject, Primitive);
+
+	return true;
+}
+
+bool FglTFRuntimeParser::LoadPrimitiveGeometry(TSharedRef<FJsonObject> JsonPrimitiveObject, FglTFRuntimePrimitive& Primitive)
+{
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_LoadPrimitiveGeometry, FColor::Magenta);
+
 	if (!JsonPrimitiveObject->TryGetNumberField("mode", Primitive.Mode))
 	{
 		Primitive.Mode = 4; // triangles
@@ -2573,6 +3031,9 @@ bool FglTFRuntimeParser::LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObje
 
 	const bool bHasMeshQuantization = ExtensionsRequired.Contains("KHR_mesh_quantization");
 
+	// folding the scene scale into the basis saves a vector multiply per position
+	const FMatrix ScaledSceneBasis = SceneBasis * FScaleMatrix(SceneScale);
+
 	TArray<int64> SupportedPositionComponentTypes = { 5126 };
 	TArray<int64> SupportedNormalComponentTypes = { 5126 };
 	TArray<int64> SupportedTangentComponentTypes = { 5126 };
@@ -2587,7 +3048,7 @@ bool FglTFRuntimeParser::LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObje
 	}
 
 	if (!BuildFromAccessorField(JsonAttributesObject->ToSharedRef(), "POSITION", Primitive.Positions,
-		{ 3 }, SupportedPositionComponentTypes, [&](FVector Value) -> FVector {return SceneBasis.TransformPosition(Value) * SceneScale; }, Primitive.AdditionalBufferView, false, nullptr))
+		{ 3 }, SupportedPositionComponentTypes, [&](FVector Value) -> FVector { return ScaledSceneBasis.TransformPosition(Value); }, Primitive.AdditionalBufferView, false, nullptr))
 	{
 		AddError("LoadPrimitive()", "Unable to load POSITION attribute");
 		return false;
@@ -2776,7 +3237,7 @@ bool FglTFRuntimeParser::LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObje
 			if (JsonTargetObject->HasField("POSITION"))
 			{
 				if (!BuildFromAccessorField(JsonTargetObject.ToSharedRef(), "POSITION", MorphTarget.Positions,
-					{ 3 }, SupportedPositionComponentTypes, [&](FVector Value) -> FVector { return SceneBasis.TransformPosition(Value) * SceneScale; }, INDEX_NONE, false, nullptr))
+					{ 3 }, SupportedPositionComponentTypes, [&](FVector Value) -> FVector { return ScaledSceneBasis.TransformPosition(Value); }, INDEX_NONE, false, nullptr))
 				{
 					AddError("LoadPrimitive()", "Unable to load POSITION attribute for MorphTarget");
 					return false;
@@ -2915,6 +3376,63 @@ bool FglTFRuntimeParser::LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObje
 		Primitive.Indices = FanIndices;
 	}
 
+	return true;
+}
+
+void FglTFRuntimeParser::PrefetchPrimitiveAccessors(TSharedRef<FJsonObject> JsonPrimitiveObject)
+{
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_PrefetchPrimitiveAccessors, FColor::Magenta);
+
+	TArray<int64> AccessorIndices;
+	auto CollectAccessors = [&AccessorIndices](const TSharedPtr<FJsonObject>& JsonAttributesObject)
+		{
+			for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : JsonAttributesObject->Values)
+			{
+				int64 AccessorIndex;
+				if (Pair.Value->TryGetNumber(AccessorIndex))
+				{
+					AccessorIndices.AddUnique(AccessorIndex);
+				}
+			}
+		};
+
+	const TSharedPtr<FJsonObject>* JsonAttributesObject;
+	if (JsonPrimitiveObject->TryGetObjectField("attributes", JsonAttributesObject))
+	{
+		CollectAccessors(*JsonAttributesObject);
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* JsonTargetsArray;
+	if (JsonPrimitiveObject->TryGetArrayField("targets", JsonTargetsArray))
+	{
+		for (const TSharedPtr<FJsonValue>& JsonTargetItem : *JsonTargetsArray)
+		{
+			const TSharedPtr<FJsonObject>* JsonTargetObject;
+			if (JsonTargetItem->TryGetObject(JsonTargetObject))
+			{
+				CollectAccessors(*JsonTargetObject);
+			}
+		}
+	}
+
+	int64 IndicesAccessorIndex;
+	if (JsonPrimitiveObject->TryGetNumberField("indices", IndicesAccessorIndex))
+	{
+		AccessorIndices.AddUnique(IndicesAccessorIndex);
+	}
+
+	// failures are ignored here, they will be reported by the decoding
+	for (const int64 AccessorIndex : AccessorIndices)
+	{
+		int64 ComponentType, Stride, Elements, ElementSize, Count;
+		bool bNormalized = false;
+		FglTFRuntimeBlob Blob;
+		GetAccessor(AccessorIndex, ComponentType, Stride, Elements, ElementSize, Count, bNormalized, Blob, nullptr);
+	}
+}
+
+bool FglTFRuntimeParser::LoadPrimitiveMaterial(TSharedRef<FJsonObject> JsonPrimitiveObject, FglTFRuntimePrimitive& Primitive, const FglTFRuntimeMaterialsConfig& MaterialsConfig)
+{
 	Primitive.Material = UMaterial::GetDefaultMaterial(MD_Surface);
 
 	if (!MaterialsConfig.bSkipLoad)
@@ -2961,7 +3479,7 @@ bool FglTFRuntimeParser::LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObje
 			Primitive.Material = LoadMaterial(MaterialIndex, MaterialsConfig, Primitive.Colors.Num() > 0, Primitive.MaterialName);
 			if (!Primitive.Material)
 			{
-				AddError("LoadPrimitive()", FString::Printf(TEXT("Unable to load material %lld"), MaterialIndex));
+				AddError("LoadPrimitiveMaterial()", FString::Printf(TEXT("Unable to load material %lld"), MaterialIndex));
 				return false;
 			}
 			Primitive.bHasMaterial = true;
@@ -2973,8 +3491,6 @@ bool FglTFRuntimeParser::LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObje
 		}
 	}
 
-	OnLoadedPrimitive.Broadcast(AsShared(), JsonPrimitiveObject, Primitive);
-
 	return true;
 }
 
@@ -2986,10 +3502,9 @@ bool FglTFRuntimeParser::GetBuffer(const int32 Index, FglTFRuntimeBlob& Blob)
 		return false;
 	}
 
-	if (Index == 0 && BinaryBuffer.Num() > 0)
+	if (Index == 0 && BinaryBufferBlob.Num > 0)
 	{
-		Blob.Data = BinaryBuffer.GetData();
-		Blob.Num = BinaryBuffer.Num();
+		Blob = BinaryBufferBlob;
 		return true;
 	}
 
@@ -3001,6 +3516,13 @@ bool FglTFRuntimeParser::GetBuffer(const int32 Index, FglTFRuntimeBlob& Blob)
 		return true;
 	}
 
+	if (MappedBuffersCache.Contains(Index))
+	{
+		Blob.Data = const_cast<uint8*>(MappedBuffersCache[Index]->GetData());
+		Blob.Num = MappedBuffersCache[Index]->Num();
+		return true;
+	}
+
 	const TArray<TSharedPtr<FJsonValue>>* JsonBuffers;
 
 	// no buffers ?
@@ -3038,7 +3560,7 @@ bool FglTFRuntimeParser::GetBuffer(const int32 Index, FglTFRuntimeBlob& Blob)
 		TArray64<uint8> Base64Data;
 		if (ParseBase64Uri(Uri, Base64Data))
 		{
-			BuffersCache.Add(Index, Base64Data);
+			BuffersCache.Add(Index, MoveTemp(Base64Data));
 			Blob.Data = BuffersCache[Index].GetData();
 			Blob.Num = BuffersCache[Index].Num();
 			return true;
@@ -3051,7 +3573,7 @@ bool FglTFRuntimeParser::GetBuffer(const int32 Index, FglTFRuntimeBlob& Blob)
 		TArray64<uint8> ZipData;
 		if (ZipFile->GetFileContent(Uri, ZipData))
 		{
-			BuffersCache.Add(Index, ZipData);
+			BuffersCache.Add(Index, MoveTemp(ZipData));
 			Blob.Data = BuffersCache[Index].GetData();
 			Blob.Num = BuffersCache[Index].Num();
 			return true;
@@ -3061,10 +3583,20 @@ bool FglTFRuntimeParser::GetBuffer(const int32 Index, FglTFRuntimeBlob& Blob)
 	// fallback
 	if (!BaseDirectory.IsEmpty())
 	{
+		const FString BufferFilename = FPaths::Combine(BaseDirectory, Uri);
+		TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> BufferMappedFile = FglTFRuntimeMappedFile::Open(BufferFilename);
+		if (BufferMappedFile)
+		{
+			MappedBuffersCache.Add(Index, BufferMappedFile);
+			Blob.Data = const_cast<uint8*>(BufferMappedFile->GetData());
+			Blob.Num = BufferMappedFile->Num();
+			return true;
+		}
+
 		TArray64<uint8> FileData;
-		if (FFileHelper::LoadFileToArray(FileData, *FPaths::Combine(BaseDirectory, Uri)))
+		if (FFileHelper::LoadFileToArray(FileData, *BufferFilename))
 		{
-			BuffersCache.Add(Index, FileData);
+			BuffersCache.Add(Index, MoveTemp(FileData));
 			Blob.Data = BuffersCache[Index].GetData();
 			Blob.Num = BuffersCache[Index].Num();
 			return true;
@@ -3098,7 +3630,7 @@ bool FglTFRuntimeParser::ParseBase64Uri(const FString& Uri, TArray64<uint8>& Byt
 
 bool FglTFRuntimeParser::GetBufferView(const int32 Index, FglTFRuntimeBlob& Blob, int64& Stride)
 {
-	TSharedPtr<FJsonObject> JsonBufferViewObject = GetJsonObjectFromRootIndex("bufferViews", Index);
+	TSharedPtr<FJsonObject> JsonBufferViewObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::BufferViews, Index);
 	if (!JsonBufferViewObject)
 	{
 		return false;
@@ -3194,7 +3726,7 @@ bool FglTFRuntimeParser::GetBufferView(const int32 Index, FglTFRuntimeBlob& Blob
 bool FglTFRuntimeParser::GetAccessor(const int32 Index, int64& ComponentType, int64& Stride, int64& Elements, int64& ElementSize, int64& Count, bool& bNormalized, FglTFRuntimeBlob& Blob, const FglTFRuntimeBlob* AdditionalBufferView)
 {
 
-	TSharedPtr<FJsonObject> JsonAccessorObject = GetJsonObjectFromRootIndex("accessors", Index);
+	TSharedPtr<FJsonObject> JsonAccessorObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Accessors, Index);
 	if (!JsonAccessorObject)
 	{
 		return false;
@@ -3544,34 +4076,43 @@ void FglTFRuntimeParser::ClearCache()
 	TransmissionMaterialsMap.Empty();
 }
 
-float FglTFRuntimeParser::FindBestFrames(const TArray<float>& FramesTimes, float WantedTime, int32& FirstIndex, int32& SecondIndex)
+void FglTFRuntimeParser::ReleaseMappedFiles()
 {
-	SecondIndex = INDEX_NONE;
-	// first search for second (higher value)
-	for (int32 i = 0; i < FramesTimes.Num(); i++)
+	if (BinaryBufferMappedFile)
 	{
-		float TimeValue = FramesTimes[i] - FramesTimes[0];
-		if (FMath::IsNearlyEqual(TimeValue, WantedTime))
-		{
-			FirstIndex = i;
-			SecondIndex = i;
-			return 0;
-		}
-		else if (TimeValue > WantedTime)
-		{
-			SecondIndex = i;
-			break;
-		}
+		BinaryBufferMappedFile.Reset();
+		BinaryBufferBlob.Data = nullptr;
+		BinaryBufferBlob.Num = 0;
+	}
+
+	MappedBuffersCache.Empty();
+}
+
+static bool IsFrameAtOrAfter(const TArray<float>& FramesTimes, const int32 Index, const float WantedTime)
+{
+	const float TimeValue = FramesTimes[Index] - FramesTimes[0];
+	return FMath::IsNearlyEqual(TimeValue, WantedTime) || TimeValue > WantedTime;
+}
+
+static float ResolveBestFrames(const TArray<float>& FramesTimes, float WantedTime, const int32 FoundIndex, int32& FirstIndex, int32& SecondIndex)
+{
+	SecondIndex = FoundIndex;
+
+	if (SecondIndex < FramesTimes.Num() && FMath::IsNearlyEqual(FramesTimes[SecondIndex] - FramesTimes[0], WantedTime))
+	{
+		FirstIndex = SecondIndex;
+		return 0;
 	}
 
 	// not found ? use the last value
-	if (SecondIndex == INDEX_NONE)
+	if (SecondIndex >= FramesTimes.Num())
 	{
 		SecondIndex = FramesTimes.Num() - 1;
 	}
 
-	if (SecondIndex == 0)
+	if (SecondIndex <= 0)
 	{
+		SecondIndex = 0;
 		FirstIndex = 0;
 		return 1.f;
 	}
@@ -3581,6 +4122,45 @@ float FglTFRuntimeParser::FindBestFrames(const TArray<float>& FramesTimes, float
 	return ((WantedTime + FramesTimes[0]) - FramesTimes[FirstIndex]) / (FramesTimes[SecondIndex] - FramesTimes[FirstIndex]);
 }
 
+float FglTFRuntimeParser::FindBestFrames(const TArray<float>& FramesTimes, float WantedTime, int32& FirstIndex, int32& SecondIndex)
+{
+	// glTF inputs are strictly increasing, so the first key at or after the wanted time can be bisected
+	int32 Low = 0;
+	int32 High = FramesTimes.Num();
+	while (Low < High)
+	{
+		const int32 Middle = Low + (High - Low) / 2;
+		if (IsFrameAtOrAfter(FramesTimes, Middle, WantedTime))
+		{
+			High = Middle;
+		}
+		else
+		{
+			Low = Middle + 1;
+		}
+	}
+
+	return ResolveBestFrames(FramesTimes, WantedTime, Low, FirstIndex, SecondIndex);
+}
+
+float FglTFRuntimeParser::FindBestFrames(const TArray<float>& FramesTimes, float WantedTime, int32& FirstIndex, int32& SecondIndex, int32& Cursor)
+{
+	// the cursor is only valid while the wanted time keeps moving forward, otherwise bisect again
+	if (Cursor < 0 || Cursor > FramesTimes.Num() || (Cursor > 0 && IsFrameAtOrAfter(FramesTimes, Cursor - 1, WantedTime)))
+	{
+		const float Alpha = FindBestFrames(FramesTimes, WantedTime, FirstIndex, SecondIndex);
+		Cursor = SecondIndex;
+		return Alpha;
+	}
+
+	while (Cursor < FramesTimes.Num() && !IsFrameAtOrAfter(FramesTimes, Cursor, WantedTime))
+	{
+		Cursor++;
+	}
+
+	return ResolveBestFrames(FramesTimes, WantedTime, Cursor, FirstIndex, SecondIndex);
+}
+
 bool FglTFRuntimeParser::MergePrimitives(TArray<FglTFRuntimePrimitive> SourcePrimitives, FglTFRuntimePrimitive& OutPrimitive)
 {
 	if (SourcePrimitives.Num() < 1)
@@ -3694,7 +4274,7 @@ bool FglTFRuntimeParser::MergePrimitives(TArray<FglTFRuntimePrimitive> SourcePri
 
 bool FglTFRuntimeParser::GetMorphTargetNames(const int32 MeshIndex, TArray<FName>& MorphTargetNames)
 {
-	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 	if (!JsonMeshObject)
 	{
 		AddError("GetMorphTargetNames()", FString::Printf(TEXT("Unable to find Mesh with index %d"), MeshIndex));
@@ -4247,7 +4827,7 @@ bool FglTFRuntimeParser::GetNumberArrayFromExtras(const FString& Key, TArray<flo
 
 TSharedPtr<FJsonObject> FglTFRuntimeParser::GetNodeExtensionObject(const int32 NodeIndex, const FString& ExtensionName)
 {
-	TSharedPtr<FJsonObject> JsonNodeObject = GetJsonObjectFromRootIndex("nodes", NodeIndex);
+	TSharedPtr<FJsonObject> JsonNodeObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Nodes, NodeIndex);
 	if (!JsonNodeObject)
 	{
 		return nullptr;
@@ -4258,7 +4838,7 @@ TSharedPtr<FJsonObject> FglTFRuntimeParser::GetNodeExtensionObject(const int32 N
 
 TSharedPtr<FJsonObject> FglTFRuntimeParser::GetNodeObject(const int32 NodeIndex)
 {
-	return GetJsonObjectFromRootIndex("nodes", NodeIndex);
+	return GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Nodes, NodeIndex);
 }
 
 bool FglTFRuntimeParser::DecompressMeshOptimizer(const FglTFRuntimeBlob& Blob, const int64 Stride, const int64 Elements, const FString& Mode, const FString& Filter, TArray64<uint8>& UncompressedBytes)
@@ -4971,24 +5551,24 @@ bool FglTFRuntimeParser::GetBlobByName(const FString& Name, TArray64<uint8>& Blo
 
 void FglTFRuntimeParser::LoadMeshAsRuntimeLODAsync(const int32 MeshIndex, const FglTFRuntimeMeshLODAsync& AsyncCallback, const FglTFRuntimeMaterialsConfig& MaterialsConfig)
 {
-	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 	if (!JsonMeshObject)
 	{
 		AsyncCallback.ExecuteIfBound(false, FglTFRuntimeMeshLOD());
+		return;
 	}
 
-	Async(EAsyncExecution::Thread, [this, JsonMeshObject, MaterialsConfig, AsyncCallback]()
-		{
-			FglTFRuntimeMeshLOD* LOD;
-			bool bSuccess = LoadMeshIntoMeshLOD(JsonMeshObject.ToSharedRef(), LOD, MaterialsConfig);
-			FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([bSuccess, LOD, AsyncCallback]()
-				{
-					AsyncCallback.ExecuteIfBound(bSuccess, bSuccess ? *LOD : FglTFRuntimeMeshLOD());
-				}, TStatId(), nullptr, ENamedThreads::GameThread);
-			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
-		}
+	// the LOD points into the parser cache, which stays untouched until the finalizer has run
+	TSharedRef<TPair<bool, FglTFRuntimeMeshLOD*>, ESPMode::ThreadSafe> Result = MakeShared<TPair<bool, FglTFRuntimeMeshLOD*>, ESPMode::ThreadSafe>(false, nullptr);
 
-	);
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, 0, AsyncCallback.GetUObject(), [this, JsonMeshObject, MaterialsConfig, Result]()
+		{
+			Result->Key = LoadMeshIntoMeshLOD(JsonMeshObject.ToSharedRef(), Result->Value, MaterialsConfig);
+		},
+		[Result, AsyncCallback]()
+		{
+			AsyncCallback.ExecuteIfBound(Result->Key, Result->Key ? *Result->Value : FglTFRuntimeMeshLOD());
+		});
 }
 
 bool FglTFRuntimeParser::LoadPathToBlob(const FString& Path, TArray64<uint8>& Blob)
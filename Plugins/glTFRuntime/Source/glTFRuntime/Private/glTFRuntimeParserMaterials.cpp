@@ -1,7 +1,9 @@
 // Copyright 2020-2023, Roberto De Ioris.
 
 #include "glTFRuntimeParser.h"
+#include "glTFRuntimeDiskCache.h"
 #include "Runtime/Launch/Resources/Version.h"
+#include "Async/ParallelFor.h"
 #include "Engine/Texture2D.h"
 #include "IImageWrapperModule.h"
 #include "IImageWrapper.h"
@@ -151,14 +153,16 @@ UMaterialInterface* FglTFRuntimeParser::LoadMaterial_Internal(const int32 Index,
 				return nullptr;
 			}
 
-			// hack for allowing BC5 compression for plugins
+			// hack for allowing BC5 compression for plugins (restored after the load, the config is shared by all of the material textures)
+			FglTFRuntimeImagesConfig& ImagesConfig = const_cast<FglTFRuntimeImagesConfig&>(MaterialsConfig.ImagesConfig);
+			const TEnumAsByte<TextureCompressionSettings> Compression = ImagesConfig.Compression;
 			if (bForceNormalMapCompression)
 			{
-				FglTFRuntimeImagesConfig& ImagesConfig = const_cast<FglTFRuntimeImagesConfig&>(MaterialsConfig.ImagesConfig);
 				ImagesConfig.Compression = TextureCompressionSettings::TC_Normalmap;
 			}
 
 			ParamTextureCache = LoadTexture(TextureIndex, ParamMips, sRGB, MaterialsConfig, Sampler);
+			ImagesConfig.Compression = Compression;
 			return *JsonTextureObject;
 		}
 		return nullptr;
@@ -726,7 +730,7 @@ bool FglTFRuntimeParser::LoadImageFromBlob(const TArray64<uint8>& Blob, TSharedR
 bool FglTFRuntimeParser::LoadImageBytes(const int32 ImageIndex, TSharedPtr<FJsonObject>& JsonImageObject, TArray64<uint8>& Bytes)
 {
 
-	JsonImageObject = GetJsonObjectFromRootIndex("images", ImageIndex);
+	JsonImageObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Images, ImageIndex);
 	if (!JsonImageObject)
 	{
 		AddError("LoadImageBytes()", FString::Printf(TEXT("Unable to load image %d"), ImageIndex));
@@ -775,19 +779,7 @@ UTexture2D* FglTFRuntimeParser::LoadTexture(const int32 TextureIndex, TArray<Fgl
 		return TexturesCache[TextureIndex];
 	}
 
-	const TArray<TSharedPtr<FJsonValue>>* JsonTextures;
-	// no images ?
-	if (!Root->TryGetArrayField("textures", JsonTextures))
-	{
-		return nullptr;
-	}
-
-	if (TextureIndex >= JsonTextures->Num())
-	{
-		return nullptr;
-	}
-
-	TSharedPtr<FJsonObject> JsonTextureObject = (*JsonTextures)[TextureIndex]->AsObject();
+	TSharedPtr<FJsonObject> JsonTextureObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Textures, TextureIndex);
 	if (!JsonTextureObject)
 	{
 		return nullptr;
@@ -886,8 +878,141 @@ UTexture2D* FglTFRuntimeParser::LoadTexture(const int32 TextureIndex, TArray<Fgl
 	return nullptr;
 }
 
+namespace glTFRuntimeMips
+{
+#if ENGINE_MAJOR_VERSION > 4
+	using FVectorRegister = VectorRegister4Float;
+#else
+	using FVectorRegister = VectorRegister;
+#endif
+
+	struct FTables
+	{
+		static constexpr int32 EncodeSize = 16384;
+
+		float Decode[256];
+		float DecodeSRGB[256];
+		uint8 EncodeSRGB[EncodeSize];
+
+		FTables()
+		{
+			for (int32 Index = 0; Index < 256; Index++)
+			{
+				const float Value = Index / 255.f;
+				Decode[Index] = Value;
+				DecodeSRGB[Index] = Value <= 0.04045f ? Value / 12.92f : FMath::Pow((Value + 0.055f) / 1.055f, 2.4f);
+			}
+
+			for (int32 Index = 0; Index < EncodeSize; Index++)
+			{
+				const float Value = Index / static_cast<float>(EncodeSize - 1);
+				const float Encoded = Value <= 0.0031308f ? Value * 12.92f : 1.055f * FMath::Pow(Value, 1.f / 2.4f) - 0.055f;
+				EncodeSRGB[Index] = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Encoded * 255.f), 0, 255));
+			}
+		}
+	};
+
+	static const FTables& GetTables()
+	{
+		static const FTables Tables;
+		return Tables;
+	}
+
+	struct FTap
+	{
+		int32 Index;
+		float Weight;
+	};
+
+	// every destination texel averages the source texels it covers, weighted by coverage, so odd sizes do not shift the image
+	static void BuildTaps(const int32 SourceSize, const int32 DestinationSize, TArray<FTap>& Taps, TArray<int32>& TapsOffsets)
+	{
+		const float Ratio = static_cast<float>(SourceSize) / DestinationSize;
+		TapsOffsets.SetNumUninitialized(DestinationSize + 1);
+		for (int32 DestinationIndex = 0; DestinationIndex < DestinationSize; DestinationIndex++)
+		{
+			TapsOffsets[DestinationIndex] = Taps.Num();
+			const float Start = DestinationIndex * Ratio;
+			const float End = FMath::Min((DestinationIndex + 1) * Ratio, static_cast<float>(SourceSize));
+			for (int32 SourceIndex = FMath::FloorToInt(Start); SourceIndex < SourceSize && SourceIndex < End; SourceIndex++)
+			{
+				const float Coverage = FMath::Min(End, SourceIndex + 1.f) - FMath::Max(Start, static_cast<float>(SourceIndex));
+				if (Coverage > 0)
+				{
+					Taps.Add({ SourceIndex, Coverage / Ratio });
+				}
+			}
+		}
+		TapsOffsets[DestinationSize] = Taps.Num();
+	}
+
+	// downsamples a 4 x 8bit image (color channels first, alpha last), filtering in linear space when sRGB is set
+	static void Downsample(const uint8* Source, const int32 SourceWidth, const int32 SourceHeight, uint8* Destination, const int32 DestinationWidth, const int32 DestinationHeight, const bool sRGB)
+	{
+		const FTables& Tables = GetTables();
+		const float* ColorDecode = sRGB ? Tables.DecodeSRGB : Tables.Decode;
+
+		TArray<FTap> TapsX;
+		TArray<int32> TapsOffsetsX;
+		BuildTaps(SourceWidth, DestinationWidth, TapsX, TapsOffsetsX);
+
+		TArray<FTap> TapsY;
+		TArray<int32> TapsOffsetsY;
+		BuildTaps(SourceHeight, DestinationHeight, TapsY, TapsOffsetsY);
+
+		// small mips are not worth the scheduling
+		const bool bSingleThread = static_cast<int64>(DestinationWidth) * DestinationHeight < 128 * 128;
+
+		ParallelFor(DestinationHeight, [&](const int32 DestinationY)
+			{
+				uint8* DestinationRow = Destination + static_cast<int64>(DestinationY) * DestinationWidth * 4;
+				for (int32 DestinationX = 0; DestinationX < DestinationWidth; DestinationX++)
+				{
+					FVectorRegister Accumulator = VectorZero();
+					for (int32 TapY = TapsOffsetsY[DestinationY]; TapY < TapsOffsetsY[DestinationY + 1]; TapY++)
+					{
+						const uint8* SourceRow = Source + static_cast<int64>(TapsY[TapY].Index) * SourceWidth * 4;
+						for (int32 TapX = TapsOffsetsX[DestinationX]; TapX < TapsOffsetsX[DestinationX + 1]; TapX++)
+						{
+							const uint8* Texel = SourceRow + TapsX[TapX].Index * 4;
+							const float Linear[4] = { ColorDecode[Texel[0]], ColorDecode[Texel[1]], ColorDecode[Texel[2]], Tables.Decode[Texel[3]] };
+							Accumulator = VectorMultiplyAdd(VectorLoad(Linear), VectorSetFloat1(TapsX[TapX].Weight * TapsY[TapY].Weight), Accumulator);
+						}
+					}
+
+					alignas(16) float Result[4];
+					VectorStoreAligned(VectorMin(VectorMax(Accumulator, VectorZero()), VectorOne()), Result);
+
+					uint8* Texel = DestinationRow + DestinationX * 4;
+					for (int32 Channel = 0; Channel < 3; Channel++)
+					{
+						Texel[Channel] = sRGB ? Tables.EncodeSRGB[FMath::RoundToInt(Result[Channel] * (FTables::EncodeSize - 1))] : static_cast<uint8>(FMath::RoundToInt(Result[Channel] * 255.f));
+					}
+					Texel[3] = static_cast<uint8>(FMath::RoundToInt(Result[3] * 255.f));
+				}
+			}, bSingleThread);
+	}
+}
+
 bool FglTFRuntimeParser::LoadBlobToMips(const int32 TextureIndex, TSharedRef<FJsonObject> JsonTextureObject, TSharedRef<FJsonObject> JsonImageObject, const TArray64<uint8>& Blob, TArray<FglTFRuntimeMipMap>& Mips, const bool sRGB, const FglTFRuntimeMaterialsConfig& MaterialsConfig)
 {
+	// decoder delegates only depend on the blob (that is part of the content hash), observers and filters would be skipped on a hit
+	FString DiskCacheFilename;
+	if (DiskCacheContentHash && TextureIndex >= 0 && Mips.Num() == 0 && !OnLoadedTexturePixels.IsBound() && !OnTextureFilterMips.IsBound())
+	{
+		const FglTFRuntimeImagesConfig& ImagesConfig = MaterialsConfig.ImagesConfig;
+		const int32 CacheKey[] = { TextureIndex, sRGB, MaterialsConfig.bLoadMipMaps, MaterialsConfig.bGeneratesMipMaps,
+			ImagesConfig.Compression, ImagesConfig.MaxWidth, ImagesConfig.MaxHeight, ImagesConfig.bVerticalFlip, ImagesConfig.bForceHDR,
+			static_cast<int32>(ImagesConfig.BlockCompression) };
+		DiskCacheFilename = GetDiskCacheFilename(TEXT("texture"), glTFRuntimeDiskCache::Hash(CacheKey, sizeof(CacheKey)));
+
+		if (LoadMipsFromDiskCache(DiskCacheFilename, Mips, TextureIndex))
+		{
+			return true;
+		}
+		Mips.Empty();
+	}
+
 	if (MaterialsConfig.bLoadMipMaps)
 	{
 		OnTextureMips.Broadcast(AsShared(), TextureIndex, JsonTextureObject, JsonImageObject, Blob, Mips, MaterialsConfig.ImagesConfig);
@@ -941,68 +1066,107 @@ bool FglTFRuntimeParser::LoadBlobToMips(const int32 TextureIndex, TSharedRef<FJs
 
 			int32 NumOfMips = 1;
 
-			TArray64<FColor> UncompressedColors;
-
-			if (MaterialsConfig.bGeneratesMipMaps && GPixelFormats[PixelFormat].BlockSizeX == 1 && GPixelFormats[PixelFormat].BlockSizeY == 1 && FMath::IsPowerOfTwo(Width) && FMath::IsPowerOfTwo(Height))
+			if (MaterialsConfig.bGeneratesMipMaps && (PixelFormat == EPixelFormat::PF_B8G8R8A8 || PixelFormat == EPixelFormat::PF_R8G8B8A8))
 			{
 				NumOfMips = FMath::FloorLog2(FMath::Max(Width, Height)) + 1;
-
-				for (int32 MipY = 0; MipY < Height; MipY++)
-				{
-					for (int32 MipX = 0; MipX < Width; MipX++)
-					{
-						int64 MipColorIndex = ((MipY * Width) + MipX) * 4;
-						uint8 MipColorB = UncompressedBytes[MipColorIndex];
-						uint8 MipColorG = UncompressedBytes[MipColorIndex + 1];
-						uint8 MipColorR = UncompressedBytes[MipColorIndex + 2];
-						uint8 MipColorA = UncompressedBytes[MipColorIndex + 3];
-						UncompressedColors.Add(FColor(MipColorR, MipColorG, MipColorB, MipColorA));
-					}
-				}
 			}
 
+			// allocate the whole chain upfront, every level is then filtered from the previous one
+			const int32 FirstMip = Mips.Num();
+			Mips.Reserve(FirstMip + NumOfMips);
+
 			int32 MipWidth = Width;
 			int32 MipHeight = Height;
 
 			for (int32 MipIndex = 0; MipIndex < NumOfMips; MipIndex++)
 			{
-				FglTFRuntimeMipMap MipMap(TextureIndex);
-				MipMap.Width = MipWidth;
-				MipMap.Height = MipHeight;
-				MipMap.PixelFormat = PixelFormat;
-
-				// Resize Image
+				FglTFRuntimeMipMap& MipMap = Mips.Emplace_GetRef(TextureIndex, PixelFormat, MipWidth, MipHeight);
 				if (MipIndex > 0)
 				{
-					TArray64<FColor> ResizedMipData;
-					ResizedMipData.AddUninitialized(MipWidth * MipHeight);
-					FImageUtils::ImageResize(Width, Height, UncompressedColors, MipWidth, MipHeight, ResizedMipData, sRGB);
-					for (FColor& Color : ResizedMipData)
-					{
-						MipMap.Pixels.Add(Color.B);
-						MipMap.Pixels.Add(Color.G);
-						MipMap.Pixels.Add(Color.R);
-						MipMap.Pixels.Add(Color.A);
-					}
+					MipMap.Pixels.SetNumUninitialized(static_cast<int64>(MipWidth) * MipHeight * 4);
 				}
 				else
 				{
-					MipMap.Pixels = UncompressedBytes;
+					MipMap.Pixels = MoveTemp(UncompressedBytes);
 				}
 
-				Mips.Add(MipMap);
-
 				MipWidth = FMath::Max(MipWidth / 2, 1);
 				MipHeight = FMath::Max(MipHeight / 2, 1);
 			}
+
+			for (int32 MipIndex = FirstMip + 1; MipIndex < Mips.Num(); MipIndex++)
+			{
+				const FglTFRuntimeMipMap& SourceMip = Mips[MipIndex - 1];
+				FglTFRuntimeMipMap& MipMap = Mips[MipIndex];
+				glTFRuntimeMips::Downsample(SourceMip.Pixels.GetData(), SourceMip.Width, SourceMip.Height, MipMap.Pixels.GetData(), MipMap.Width, MipMap.Height, sRGB);
+			}
 		}
 	}
 
 	OnTextureFilterMips.Broadcast(AsShared(), Mips, MaterialsConfig.ImagesConfig);
 
+	if (Mips.Num() > 0)
+	{
+		const EPixelFormat BlockPixelFormat = FglTFRuntimeBlockCompressor::GetPixelFormat(Mips[0], MaterialsConfig.ImagesConfig);
+		if (BlockPixelFormat != EPixelFormat::PF_Unknown)
+		{
+			FglTFRuntimeBlockCompressor::CompressMips(Mips, BlockPixelFormat);
+		}
+	}
+
+	if (!DiskCacheFilename.IsEmpty() && Mips.Num() > 0)
+	{
+		SaveMipsToDiskCache(DiskCacheFilename, Mips);
+	}
+
 	return true;
 }
 
+bool FglTFRuntimeParser::LoadMipsFromDiskCache(const FString& Filename, TArray<FglTFRuntimeMipMap>& Mips, const int32 TextureIndex)
+{
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_LoadMipsFromDiskCache, FColor::Magenta);
+
+	FglTFRuntimeDiskCacheReader Reader;
+	int32 NumMips = 0;
+	if (!Reader.Open(Filename) || !Reader.Read(NumMips) || NumMips <= 0)
+	{
+		return false;
+	}
+
+	for (int32 MipIndex = 0; MipIndex < NumMips; MipIndex++)
+	{
+		FglTFRuntimeMipMap& MipMap = Mips.Emplace_GetRef(TextureIndex);
+		uint8 PixelFormat = 0;
+		if (!Reader.Read(MipMap.Width) || !Reader.Read(MipMap.Height) || !Reader.Read(PixelFormat) || PixelFormat >= PF_MAX || !Reader.ReadArray(MipMap.Pixels))
+		{
+			return false;
+		}
+		MipMap.PixelFormat = static_cast<EPixelFormat>(PixelFormat);
+	}
+
+	return true;
+}
+
+void FglTFRuntimeParser::SaveMipsToDiskCache(const FString& Filename, const TArray<FglTFRuntimeMipMap>& Mips) const
+{
+	SCOPED_NAMED_EVENT(FglTFRuntimeParser_SaveMipsToDiskCache, FColor::Magenta);
+
+	FglTFRuntimeDiskCacheWriter Writer;
+	Writer.Write(Mips.Num());
+	for (const FglTFRuntimeMipMap& MipMap : Mips)
+	{
+		Writer.Write(MipMap.Width);
+		Writer.Write(MipMap.Height);
+		Writer.Write(static_cast<uint8>(MipMap.PixelFormat));
+		Writer.WriteArray(MipMap.Pixels);
+	}
+
+	if (!Writer.Save(Filename))
+	{
+		UE_LOG(LogGLTFRuntime, Warning, TEXT("Unable to write disk cache %s"), *Filename);
+	}
+}
+
 UMaterialInterface* FglTFRuntimeParser::LoadMaterial(const int32 Index, const FglTFRuntimeMaterialsConfig& MaterialsConfig, const bool bUseVertexColors, FString& MaterialName)
 {
 	if (Index < 0)
@@ -1025,20 +1189,7 @@ UMaterialInterface* FglTFRuntimeParser::LoadMaterial(const int32 Index, const Fg
 		return MaterialsCache[Index];
 	}
 
-	const TArray<TSharedPtr<FJsonValue>>* JsonMaterials;
-
-	// no materials ?
-	if (!Root->TryGetArrayField("materials", JsonMaterials))
-	{
-		return nullptr;
-	}
-
-	if (Index >= JsonMaterials->Num())
-	{
-		return nullptr;
-	}
-
-	TSharedPtr<FJsonObject> JsonMaterialObject = (*JsonMaterials)[Index]->AsObject();
+	TSharedPtr<FJsonObject> JsonMaterialObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Materials, Index);
 	if (!JsonMaterialObject)
 	{
 		return nullptr;
@@ -1275,6 +1426,350 @@ UTexture2DArray* FglTFRuntimeParser::BuildTextureArray(UObject* Outer, const TAr
 	return Texture;
 }
 
+namespace glTFRuntimeBlockCompression
+{
+	// texels are B, G, R, A as in PF_B8G8R8A8
+	using FBlock = uint8[16][4];
+
+	static uint16 PackRGB565(const float R, const float G, const float B)
+	{
+		const uint16 R5 = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(R * 31.f / 255.f), 0, 31));
+		const uint16 G6 = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(G * 63.f / 255.f), 0, 63));
+		const uint16 B5 = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(B * 31.f / 255.f), 0, 31));
+		return (R5 << 11) | (G6 << 5) | B5;
+	}
+
+	static void UnpackRGB565(const uint16 Color, int32 RGB[3])
+	{
+		const int32 R5 = (Color >> 11) & 0x1F;
+		const int32 G6 = (Color >> 5) & 0x3F;
+		const int32 B5 = Color & 0x1F;
+		RGB[0] = (R5 << 3) | (R5 >> 2);
+		RGB[1] = (G6 << 2) | (G6 >> 4);
+		RGB[2] = (B5 << 3) | (B5 >> 2);
+	}
+
+	// returns the squared error of the block
+	static int32 FindBC1Indices(const FBlock& Texels, const uint16 Color0, const uint16 Color1, uint32& Indices)
+	{
+		int32 Palette[4][3];
+		UnpackRGB565(Color0, Palette[0]);
+		UnpackRGB565(Color1, Palette[1]);
+		for (int32 Channel = 0; Channel < 3; Channel++)
+		{
+			Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+			Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+		}
+
+		int32 Error = 0;
+		Indices = 0;
+		for (int32 TexelIndex = 0; TexelIndex < 16; TexelIndex++)
+		{
+			int32 BestIndex = 0;
+			int32 BestDistance = MAX_int32;
+			for (int32 PaletteIndex = 0; PaletteIndex < 4; PaletteIndex++)
+			{
+				const int32 DeltaR = Texels[TexelIndex][2] - Palette[PaletteIndex][0];
+				const int32 DeltaG = Texels[TexelIndex][1] - Palette[PaletteIndex][1];
+				const int32 DeltaB = Texels[TexelIndex][0] - Palette[PaletteIndex][2];
+				const int32 Distance = DeltaR * DeltaR + DeltaG * DeltaG + DeltaB * DeltaB;
+				if (Distance < BestDistance)
+				{
+					BestDistance = Distance;
+					BestIndex = PaletteIndex;
+				}
+			}
+			Indices |= BestIndex << (TexelIndex * 2);
+			Error += BestDistance;
+		}
+		return Error;
+	}
+
+	static void WriteBC1(uint8* Output, uint16 Color0, uint16 Color1, uint32 Indices)
+	{
+		// always use the four colors mode, swapping the endpoints means swapping 0 <-> 1 and 2 <-> 3
+		if (Color0 < Color1)
+		{
+			Swap(Color0, Color1);
+			Indices ^= 0x55555555;
+		}
+		else if (Color0 == Color1)
+		{
+			Indices = 0;
+		}
+
+		Output[0] = Color0 & 0xFF;
+		Output[1] = Color0 >> 8;
+		Output[2] = Color1 & 0xFF;
+		Output[3] = Color1 >> 8;
+		FMemory::Memcpy(Output + 4, &Indices, 4);
+	}
+
+	static void EncodeBC1(const FBlock& Texels, uint8* Output)
+	{
+		// endpoints along the principal axis of the colors
+		float Mean[3] = { 0, 0, 0 };
+		for (int32 TexelIndex = 0; TexelIndex < 16; TexelIndex++)
+		{
+			Mean[0] += Texels[TexelIndex][2];
+			Mean[1] += Texels[TexelIndex][1];
+			Mean[2] += Texels[TexelIndex][0];
+		}
+		for (int32 Channel = 0; Channel < 3; Channel++)
+		{
+			Mean[Channel] /= 16;
+		}
+
+		float Covariance[6] = { 0, 0, 0, 0, 0, 0 };
+		for (int32 TexelIndex = 0; TexelIndex < 16; TexelIndex++)
+		{
+			const float R = Texels[TexelIndex][2] - Mean[0];
+			const float G = Texels[TexelIndex][1] - Mean[1];
+			const float B = Texels[TexelIndex][0] - Mean[2];
+			Covariance[0] += R * R;
+			Covariance[1] += R * G;
+			Covariance[2] += R * B;
+			Covariance[3] += G * G;
+			Covariance[4] += G * B;
+			Covariance[5] += B * B;
+		}
+
+		float Axis[3] = { 1, 1, 1 };
+		for (int32 Iteration = 0; Iteration < 8; Iteration++)
+		{
+			const float X = Covariance[0] * Axis[0] + Covariance[1] * Axis[1] + Covariance[2] * Axis[2];
+			const float Y = Covariance[1] * Axis[0] + Covariance[3] * Axis[1] + Covariance[4] * Axis[2];
+			const float Z = Covariance[2] * Axis[0] + Covariance[4] * Axis[1] + Covariance[5] * Axis[2];
+			const float Length = FMath::Max3(FMath::Abs(X), FMath::Abs(Y), FMath::Abs(Z));
+			if (Length < KINDA_SMALL_NUMBER)
+			{
+				break;
+			}
+			Axis[0] = X / Length;
+			Axis[1] = Y / Length;
+			Axis[2] = Z / Length;
+		}
+
+		int32 MinTexel = 0;
+		int32 MaxTexel = 0;
+		float MinProjection = MAX_flt;
+		float MaxProjection = -MAX_flt;
+		for (int32 TexelIndex = 0; TexelIndex < 16; TexelIndex++)
+		{
+			const float Projection = Texels[TexelIndex][2] * Axis[0] + Texels[TexelIndex][1] * Axis[1] + Texels[TexelIndex][0] * Axis[2];
+			if (Projection < MinProjection)
+			{
+				MinProjection = Projection;
+				MinTexel = TexelIndex;
+			}
+			if (Projection > MaxProjection)
+			{
+				MaxProjection = Projection;
+				MaxTexel = TexelIndex;
+			}
+		}
+
+		uint16 Color0 = PackRGB565(Texels[MaxTexel][2], Texels[MaxTexel][1], Texels[MaxTexel][0]);
+		uint16 Color1 = PackRGB565(Texels[MinTexel][2], Texels[MinTexel][1], Texels[MinTexel][0]);
+		uint32 Indices;
+		int32 Error = FindBC1Indices(Texels, Color0, Color1, Indices);
+
+		// one least squares refinement of the endpoints for the chosen indices
+		if (Error > 0 && Color0 != Color1)
+		{
+			static const float Weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+			float AlphaSquared = 0, BetaSquared = 0, AlphaBeta = 0;
+			float AlphaX[3] = { 0, 0, 0 };
+			float BetaX[3] = { 0, 0, 0 };
+			for (int32 TexelIndex = 0; TexelIndex < 16; TexelIndex++)
+			{
+				const float Alpha = Weights[(Indices >> (TexelIndex * 2)) & 3];
+				const float Beta = 1.f - Alpha;
+				AlphaSquared += Alpha * Alpha;
+				BetaSquared += Beta * Beta;
+				AlphaBeta += Alpha * Beta;
+				for (int32 Channel = 0; Channel < 3; Channel++)
+				{
+					const float Value = Texels[TexelIndex][2 - Channel];
+					AlphaX[Channel] += Alpha * Value;
+					BetaX[Channel] += Beta * Value;
+				}
+			}
+
+			const float Determinant = AlphaSquared * BetaSquared - AlphaBeta * AlphaBeta;
+			if (FMath::Abs(Determinant) > KINDA_SMALL_NUMBER)
+			{
+				float Endpoint0[3];
+				float Endpoint1[3];
+				for (int32 Channel = 0; Channel < 3; Channel++)
+				{
+					Endpoint0[Channel] = (AlphaX[Channel] * BetaSquared - BetaX[Channel] * AlphaBeta) / Determinant;
+					Endpoint1[Channel] = (BetaX[Channel] * AlphaSquared - AlphaX[Channel] * AlphaBeta) / Determinant;
+				}
+
+				const uint16 RefinedColor0 = PackRGB565(Endpoint0[0], Endpoint0[1], Endpoint0[2]);
+				const uint16 RefinedColor1 = PackRGB565(Endpoint1[0], Endpoint1[1], Endpoint1[2]);
+				uint32 RefinedIndices;
+				const int32 RefinedError = FindBC1Indices(Texels, RefinedColor0, RefinedColor1, RefinedIndices);
+				if (RefinedError < Error)
+				{
+					Color0 = RefinedColor0;
+					Color1 = RefinedColor1;
+					Indices = RefinedIndices;
+				}
+			}
+		}
+
+		WriteBC1(Output, Color0, Color1, Indices);
+	}
+
+	// single channel block, also the alpha part of BC3 and each half of BC5
+	static void EncodeBC4(const FBlock& Texels, const int32 Channel, uint8* Output)
+	{
+		uint8 MinValue = 255;
+		uint8 MaxValue = 0;
+		for (int32 TexelIndex = 0; TexelIndex < 16; TexelIndex++)
+		{
+			MinValue = FMath::Min(MinValue, Texels[TexelIndex][Channel]);
+			MaxValue = FMath::Max(MaxValue, Texels[TexelIndex][Channel]);
+		}
+
+		Output[0] = MaxValue;
+		Output[1] = MinValue;
+
+		uint64 Indices = 0;
+		if (MaxValue > MinValue)
+		{
+			// eight values mode: 0 is max, 1 is min, 2-7 are the interpolated steps from max to min
+			const float Scale = 7.f / (MaxValue - MinValue);
+			for (int32 TexelIndex = 0; TexelIndex < 16; TexelIndex++)
+			{
+				const int32 Step = FMath::RoundToInt((MaxValue - Texels[TexelIndex][Channel]) * Scale);
+				const uint64 Index = Step == 0 ? 0 : (Step == 7 ? 1 : Step + 1);
+				Indices |= Index << (TexelIndex * 3);
+			}
+		}
+
+		for (int32 ByteIndex = 0; ByteIndex < 6; ByteIndex++)
+		{
+			Output[2 + ByteIndex] = (Indices >> (ByteIndex * 8)) & 0xFF;
+		}
+	}
+
+	static void CompressMip(const FglTFRuntimeMipMap& Source, const EPixelFormat PixelFormat, TArray64<uint8>& Output)
+	{
+		const int32 BlockBytes = GPixelFormats[PixelFormat].BlockBytes;
+		const int32 BlocksX = FMath::DivideAndRoundUp(Source.Width, 4);
+		const int32 BlocksY = FMath::DivideAndRoundUp(Source.Height, 4);
+		Output.SetNumUninitialized(static_cast<int64>(BlocksX) * BlocksY * BlockBytes);
+
+		const uint8* Pixels = Source.Pixels.GetData();
+		ParallelFor(BlocksY, [&](const int32 BlockY)
+			{
+				FBlock Texels;
+				for (int32 BlockX = 0; BlockX < BlocksX; BlockX++)
+				{
+					// mips smaller than a block repeat their last row/column
+					for (int32 TexelY = 0; TexelY < 4; TexelY++)
+					{
+						const int32 Y = FMath::Min(BlockY * 4 + TexelY, Source.Height - 1);
+						for (int32 TexelX = 0; TexelX < 4; TexelX++)
+						{
+							const int32 X = FMath::Min(BlockX * 4 + TexelX, Source.Width - 1);
+							FMemory::Memcpy(Texels[TexelY * 4 + TexelX], Pixels + (static_cast<int64>(Y) * Source.Width + X) * 4, 4);
+						}
+					}
+
+					uint8* Block = Output.GetData() + (static_cast<int64>(BlockY) * BlocksX + BlockX) * BlockBytes;
+					if (PixelFormat == EPixelFormat::PF_DXT1)
+					{
+						EncodeBC1(Texels, Block);
+					}
+					else if (PixelFormat == EPixelFormat::PF_DXT5)
+					{
+						EncodeBC4(Texels, 3, Block);
+						EncodeBC1(Texels, Block + 8);
+					}
+					else
+					{
+						EncodeBC4(Texels, 2, Block);
+						EncodeBC4(Texels, 1, Block + 8);
+					}
+				}
+			}, BlocksX * BlocksY < 256);
+	}
+}
+
+EPixelFormat FglTFRuntimeBlockCompressor::GetPixelFormat(const FglTFRuntimeMipMap& MipMap, const FglTFRuntimeImagesConfig& ImagesConfig)
+{
+	if (ImagesConfig.BlockCompression == EglTFRuntimeBlockCompression::None || MipMap.PixelFormat != EPixelFormat::PF_B8G8R8A8 ||
+		MipMap.Width % 4 != 0 || MipMap.Height % 4 != 0)
+	{
+		return EPixelFormat::PF_Unknown;
+	}
+
+	EPixelFormat PixelFormat = EPixelFormat::PF_Unknown;
+	switch (ImagesConfig.BlockCompression)
+	{
+	case EglTFRuntimeBlockCompression::BC1:
+		PixelFormat = EPixelFormat::PF_DXT1;
+		break;
+	case EglTFRuntimeBlockCompression::BC3:
+		PixelFormat = EPixelFormat::PF_DXT5;
+		break;
+	case EglTFRuntimeBlockCompression::BC5:
+		PixelFormat = EPixelFormat::PF_BC5;
+		break;
+	default:
+		if (ImagesConfig.Compression == TextureCompressionSettings::TC_Normalmap)
+		{
+			PixelFormat = EPixelFormat::PF_BC5;
+		}
+		else
+		{
+			PixelFormat = EPixelFormat::PF_DXT1;
+			for (int64 Offset = 3; Offset < MipMap.Pixels.Num(); Offset += 4)
+			{
+				if (MipMap.Pixels[Offset] < 255)
+				{
+					PixelFormat = EPixelFormat::PF_DXT5;
+					break;
+				}
+			}
+		}
+		break;
+	}
+
+	// mobile RHIs usually lack BC support, keep the image uncompressed there
+	return GPixelFormats[PixelFormat].Supported ? PixelFormat : EPixelFormat::PF_Unknown;
+}
+
+bool FglTFRuntimeBlockCompressor::CompressMips(TArray<FglTFRuntimeMipMap>& Mips, const EPixelFormat PixelFormat)
+{
+	if (PixelFormat != EPixelFormat::PF_DXT1 && PixelFormat != EPixelFormat::PF_DXT5 && PixelFormat != EPixelFormat::PF_BC5)
+	{
+		return false;
+	}
+
+	for (const FglTFRuntimeMipMap& MipMap : Mips)
+	{
+		if (MipMap.PixelFormat != EPixelFormat::PF_B8G8R8A8 || MipMap.Pixels.Num() != static_cast<int64>(MipMap.Width) * MipMap.Height * 4)
+		{
+			return false;
+		}
+	}
+
+	for (FglTFRuntimeMipMap& MipMap : Mips)
+	{
+		TArray64<uint8> Blocks;
+		glTFRuntimeBlockCompression::CompressMip(MipMap, PixelFormat, Blocks);
+		MipMap.Pixels = MoveTemp(Blocks);
+		MipMap.PixelFormat = PixelFormat;
+	}
+
+	return true;
+}
+
 FglTFRuntimeDDS::FglTFRuntimeDDS(const TArray64<uint8>& InData) : Data(InData)
 {
 
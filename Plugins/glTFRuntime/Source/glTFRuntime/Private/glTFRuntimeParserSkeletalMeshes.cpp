@@ -1,6 +1,8 @@
 // Copyright 2020-2023, Roberto De Ioris.
 
 #include "glTFRuntimeParser.h"
+#include "glTFRuntimeLoaderPool.h"
+#include "Async/ParallelFor.h"
 #include "Runtime/Launch/Resources/Version.h"
 #if ENGINE_MAJOR_VERSION > 4
 #include "Animation/AnimData/AnimDataModel.h"
@@ -51,31 +53,76 @@
 #define MAX_BONE_INFLUENCE_WEIGHT 0xff
 #endif
 
-struct FglTFRuntimeSkeletalMeshContextFinalizer
+/*
+ * Builds the sparse deltas of a single morph target: skeletal mesh vertices are not indexed (every index is a vertex),
+ * so a delta is generated for every index pointing to a non empty morph target position.
+ */
+struct FglTFRuntimeMorphTargetBuildJob
 {
-	TSharedRef<FglTFRuntimeSkeletalMeshContext, ESPMode::ThreadSafe> SkeletalMeshContext;
-	FglTFRuntimeSkeletalMeshAsync AsyncCallback;
+	const FglTFRuntimePrimitive* Primitive = nullptr;
+	const FglTFRuntimeMorphTarget* MorphTargetData = nullptr;
+	int32 SectionIndex = 0;
+	int32 BaseIndex = 0;
+	FMorphTargetLODModel MorphTargetLODModel;
 
-	FglTFRuntimeSkeletalMeshContextFinalizer(TSharedRef<FglTFRuntimeSkeletalMeshContext, ESPMode::ThreadSafe> InSkeletalMeshContext, FglTFRuntimeSkeletalMeshAsync InAsyncCallback) :
-		SkeletalMeshContext(InSkeletalMeshContext),
-		AsyncCallback(InAsyncCallback)
+	void Build(const float DeltaThreshold)
 	{
-	}
+		MorphTargetLODModel.NumBaseMeshVerts = Primitive->Indices.Num();
+		MorphTargetLODModel.SectionIndices.Add(SectionIndex);
 
-	~FglTFRuntimeSkeletalMeshContextFinalizer()
-	{
-		FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([this]()
+		const TArray<FVector>& Positions = MorphTargetData->Positions;
+
+		// most of the (ARKit/visemes) targets only touch a small area, check which vertices need a delta upfront
+		TBitArray<> NonEmptyVertices(false, Positions.Num());
+		int32 NumNonEmptyVertices = 0;
+		for (int32 VertexIndex = 0; VertexIndex < Positions.Num(); VertexIndex++)
+		{
+			if (!Positions[VertexIndex].IsNearlyZero(DeltaThreshold))
+			{
+				NonEmptyVertices[VertexIndex] = true;
+				NumNonEmptyVertices++;
+			}
+		}
+
+		if (NumNonEmptyVertices > 0)
+		{
+			for (int32 Index = 0; Index < Primitive->Indices.Num(); Index++)
 			{
-				if (SkeletalMeshContext->SkeletalMesh)
+				const int32 VertexIndex = Primitive->Indices[Index];
+				if (VertexIndex >= Positions.Num() || !NonEmptyVertices[VertexIndex])
 				{
-					SkeletalMeshContext->SkeletalMesh = SkeletalMeshContext->Parser->FinalizeSkeletalMeshWithLODs(SkeletalMeshContext);
+					continue;
 				}
-				AsyncCallback.ExecuteIfBound(SkeletalMeshContext->SkeletalMesh);
-			}, TStatId(), nullptr, ENamedThreads::GameThread);
-		FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
+
+				const FVector& PositionDelta = Positions[VertexIndex];
+
+				FMorphTargetDelta& Delta = MorphTargetLODModel.Vertices.AddDefaulted_GetRef();
+#if ENGINE_MAJOR_VERSION > 4
+				Delta.PositionDelta = FVector3f(PositionDelta);
+				Delta.TangentZDelta = FVector3f::ZeroVector;
+#else
+				Delta.PositionDelta = PositionDelta;
+				Delta.TangentZDelta = FVector::ZeroVector;
+#endif
+				Delta.SourceIdx = BaseIndex + Index;
+			}
+		}
+
+#if ENGINE_MAJOR_VERSION > 4
+		MorphTargetLODModel.NumVertices = MorphTargetLODModel.Vertices.Num();
+#endif
 	}
 };
 
+static void FinalizeSkeletalMeshContextAsync(TSharedRef<FglTFRuntimeSkeletalMeshContext, ESPMode::ThreadSafe> SkeletalMeshContext, const FglTFRuntimeSkeletalMeshAsync& AsyncCallback)
+{
+	if (SkeletalMeshContext->SkeletalMesh)
+	{
+		SkeletalMeshContext->SkeletalMesh = SkeletalMeshContext->Parser->FinalizeSkeletalMeshWithLODs(SkeletalMeshContext);
+	}
+	AsyncCallback.ExecuteIfBound(SkeletalMeshContext->SkeletalMesh);
+}
+
 void FglTFRuntimeParser::NormalizeSkeletonScale(FReferenceSkeleton& RefSkeleton)
 {
 	FReferenceSkeletonModifier Modifier = FReferenceSkeletonModifier(RefSkeleton, nullptr);
@@ -231,7 +278,7 @@ USkeletalMesh* FglTFRuntimeParser::CreateSkeletalMeshFromLODs(TSharedRef<FglTFRu
 	TMap<int32, FName> MainBoneMap;
 	if (!SkeletalMeshContext->SkeletalMeshConfig.bIgnoreSkin && SkeletalMeshContext->SkinIndex > INDEX_NONE)
 	{
-		TSharedPtr<FJsonObject>	JsonSkinObject = GetJsonObjectFromRootIndex("skins", SkeletalMeshContext->SkinIndex);
+		TSharedPtr<FJsonObject>	JsonSkinObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Skins, SkeletalMeshContext->SkinIndex);
 		if (!JsonSkinObject)
 		{
 			AddError("CreateSkeletalMeshFromLODs()", "Unable to fill RefSkeleton.");
@@ -886,132 +933,109 @@ USkeletalMesh* FglTFRuntimeParser::FinalizeSkeletalMeshWithLODs(TSharedRef<FglTF
 			TMap<FString, UMorphTarget*> MorphTargetNamesHistory;
 			TMap<FString, int32> MorphTargetNamesDuplicateCounter;
 
+			// deltas of every morph target are built in parallel, the UMorphTargets are then created in the original order
+			TArray<FglTFRuntimeMorphTargetBuildJob> MorphTargetBuildJobs;
 			int32 BaseIndex = 0;
-
 			for (int32 PrimitiveIndex = 0; PrimitiveIndex < SkeletalMeshContext->LODs[LODIndex]->Primitives.Num(); PrimitiveIndex++)
 			{
-
-				FglTFRuntimePrimitive& Primitive = SkeletalMeshContext->LODs[LODIndex]->Primitives[PrimitiveIndex];
-
-				for (FglTFRuntimeMorphTarget& MorphTargetData : Primitive.MorphTargets)
+				const FglTFRuntimePrimitive& Primitive = SkeletalMeshContext->LODs[LODIndex]->Primitives[PrimitiveIndex];
+				for (const FglTFRuntimeMorphTarget& MorphTargetData : Primitive.MorphTargets)
 				{
-					bool bSkip = true;
-					FMorphTargetLODModel MorphTargetLODModel;
-					MorphTargetLODModel.NumBaseMeshVerts = Primitive.Indices.Num();
-					MorphTargetLODModel.SectionIndices.Add(PrimitiveIndex);
+					FglTFRuntimeMorphTargetBuildJob& MorphTargetBuildJob = MorphTargetBuildJobs.AddDefaulted_GetRef();
+					MorphTargetBuildJob.Primitive = &Primitive;
+					MorphTargetBuildJob.MorphTargetData = &MorphTargetData;
+					MorphTargetBuildJob.SectionIndex = PrimitiveIndex;
+					MorphTargetBuildJob.BaseIndex = BaseIndex;
+				}
+				BaseIndex += Primitive.Indices.Num();
+			}
 
-					for (int32 Index = 0; Index < Primitive.Indices.Num(); Index++)
+			{
+				SCOPED_NAMED_EVENT(FglTFRuntimeParser_BuildMorphTargetsDeltas, FColor::Magenta);
+				const float DeltaThreshold = SkeletalMeshContext->SkeletalMeshConfig.MorphTargetsDeltaThreshold;
+				ParallelFor(MorphTargetBuildJobs.Num(), [&MorphTargetBuildJobs, DeltaThreshold](const int32 JobIndex)
 					{
-						FMorphTargetDelta Delta;
-						int32 VertexIndex = Primitive.Indices[Index];
-						if (VertexIndex < MorphTargetData.Positions.Num())
-						{
-#if ENGINE_MAJOR_VERSION > 4
-							Delta.PositionDelta = FVector3f(MorphTargetData.Positions[VertexIndex]);
-#else
-							Delta.PositionDelta = MorphTargetData.Positions[VertexIndex];
-#endif
-						}
-						else
-						{
-#if ENGINE_MAJOR_VERSION > 4
-							Delta.PositionDelta = FVector3f::ZeroVector;
-#else
-							Delta.PositionDelta = FVector::ZeroVector;
-#endif
-						}
+						MorphTargetBuildJobs[JobIndex].Build(DeltaThreshold);
+					});
+			}
 
-						if (!Delta.PositionDelta.IsNearlyZero())
-						{
-							bSkip = false;
-						}
+			for (FglTFRuntimeMorphTargetBuildJob& MorphTargetBuildJob : MorphTargetBuildJobs)
+			{
+				const FglTFRuntimeMorphTarget& MorphTargetData = *MorphTargetBuildJob.MorphTargetData;
+				FMorphTargetLODModel& MorphTargetLODModel = MorphTargetBuildJob.MorphTargetLODModel;
 
-						Delta.SourceIdx = BaseIndex + Index;
-#if ENGINE_MAJOR_VERSION > 4
-						Delta.TangentZDelta = FVector3f::ZeroVector;
-#else
-						Delta.TangentZDelta = FVector::ZeroVector;
-#endif
-						MorphTargetLODModel.Vertices.Add(Delta);
-#if ENGINE_MAJOR_VERSION > 4
-						MorphTargetLODModel.NumVertices = MorphTargetLODModel.Vertices.Num();
-#endif
-					}
+				if (SkeletalMeshContext->SkeletalMeshConfig.bIgnoreEmptyMorphTargets && MorphTargetLODModel.Vertices.Num() == 0)
+				{
+					continue;
+				}
 
-					if (SkeletalMeshContext->SkeletalMeshConfig.bIgnoreEmptyMorphTargets && bSkip)
-					{
-						continue;
-					}
+				FString MorphTargetName = MorphTargetData.Name;
+				if (MorphTargetName.IsEmpty())
+				{
+					MorphTargetName = FString::Printf(TEXT("MorphTarget_%d"), MorphTargetIndex);
+				}
 
-					FString MorphTargetName = MorphTargetData.Name;
-					if (MorphTargetName.IsEmpty())
+				bool bAddMorphTarget = false;
+				if (MorphTargetNamesHistory.Contains(MorphTargetName))
+				{
+					UMorphTarget* CurrentMorphTarget = MorphTargetNamesHistory[MorphTargetName];
+					EglTFRuntimeMorphTargetsDuplicateStrategy DuplicateStrategy = SkeletalMeshContext->SkeletalMeshConfig.MorphTargetsDuplicateStrategy;
+					if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::Ignore)
 					{
-						MorphTargetName = FString::Printf(TEXT("MorphTarget_%d"), MorphTargetIndex);
+						// NOP
 					}
-
-					bool bAddMorphTarget = false;
-					if (MorphTargetNamesHistory.Contains(MorphTargetName))
+					else if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::Merge)
 					{
-						UMorphTarget* CurrentMorphTarget = MorphTargetNamesHistory[MorphTargetName];
-						EglTFRuntimeMorphTargetsDuplicateStrategy DuplicateStrategy = SkeletalMeshContext->SkeletalMeshConfig.MorphTargetsDuplicateStrategy;
-						if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::Ignore)
-						{
-							// NOP
-						}
-						else if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::Merge)
-						{
 #if ENGINE_MAJOR_VERSION > 4
-							CurrentMorphTarget->GetMorphLODModels()[0].NumBaseMeshVerts += MorphTargetLODModel.NumBaseMeshVerts;
-							CurrentMorphTarget->GetMorphLODModels()[0].SectionIndices.Append(MorphTargetLODModel.SectionIndices);
-							CurrentMorphTarget->GetMorphLODModels()[0].Vertices.Append(MorphTargetLODModel.Vertices);
-							CurrentMorphTarget->GetMorphLODModels()[0].NumVertices = CurrentMorphTarget->GetMorphLODModels()[0].Vertices.Num();
+						CurrentMorphTarget->GetMorphLODModels()[0].NumBaseMeshVerts += MorphTargetLODModel.NumBaseMeshVerts;
+						CurrentMorphTarget->GetMorphLODModels()[0].SectionIndices.Append(MorphTargetLODModel.SectionIndices);
+						CurrentMorphTarget->GetMorphLODModels()[0].Vertices.Append(MorphTargetLODModel.Vertices);
+						CurrentMorphTarget->GetMorphLODModels()[0].NumVertices = CurrentMorphTarget->GetMorphLODModels()[0].Vertices.Num();
 #else
-							CurrentMorphTarget->MorphLODModels[0].NumBaseMeshVerts += MorphTargetLODModel.NumBaseMeshVerts;
-							CurrentMorphTarget->MorphLODModels[0].SectionIndices.Append(MorphTargetLODModel.SectionIndices);
-							CurrentMorphTarget->MorphLODModels[0].Vertices.Append(MorphTargetLODModel.Vertices);
+						CurrentMorphTarget->MorphLODModels[0].NumBaseMeshVerts += MorphTargetLODModel.NumBaseMeshVerts;
+						CurrentMorphTarget->MorphLODModels[0].SectionIndices.Append(MorphTargetLODModel.SectionIndices);
+						CurrentMorphTarget->MorphLODModels[0].Vertices.Append(MorphTargetLODModel.Vertices);
 #endif
-						}
-						else if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::AppendDuplicateCounter)
+					}
+					else if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::AppendDuplicateCounter)
+					{
+						if (MorphTargetNamesDuplicateCounter.Contains(MorphTargetName))
 						{
-							if (MorphTargetNamesDuplicateCounter.Contains(MorphTargetName))
-							{
-								MorphTargetName = FString::Printf(TEXT("%s_%d"), *MorphTargetName, MorphTargetNamesDuplicateCounter[MorphTargetName] + 1);
-								MorphTargetNamesDuplicateCounter[MorphTargetName] += 1;
-							}
-							else
-							{
-								MorphTargetName = FString::Printf(TEXT("%s_1"), *MorphTargetName);
-								MorphTargetNamesDuplicateCounter.Add(MorphTargetName, 1);
-							}
-							bAddMorphTarget = true;
+							MorphTargetName = FString::Printf(TEXT("%s_%d"), *MorphTargetName, MorphTargetNamesDuplicateCounter[MorphTargetName] + 1);
+							MorphTargetNamesDuplicateCounter[MorphTargetName] += 1;
 						}
-						else if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::AppendMorphIndex)
+						else
 						{
-							MorphTargetName = FString::Printf(TEXT("%s_%d"), *MorphTargetName, MorphTargetIndex);
-							bAddMorphTarget = true;
+							MorphTargetName = FString::Printf(TEXT("%s_1"), *MorphTargetName);
+							MorphTargetNamesDuplicateCounter.Add(MorphTargetName, 1);
 						}
+						bAddMorphTarget = true;
 					}
-					else
+					else if (DuplicateStrategy == EglTFRuntimeMorphTargetsDuplicateStrategy::AppendMorphIndex)
 					{
+						MorphTargetName = FString::Printf(TEXT("%s_%d"), *MorphTargetName, MorphTargetIndex);
 						bAddMorphTarget = true;
 					}
+				}
+				else
+				{
+					bAddMorphTarget = true;
+				}
 
-					if (bAddMorphTarget)
-					{
-						UMorphTarget* MorphTarget = NewObject<UMorphTarget>(SkeletalMeshContext->SkeletalMesh, *MorphTargetName, RF_Public);
+				if (bAddMorphTarget)
+				{
+					UMorphTarget* MorphTarget = NewObject<UMorphTarget>(SkeletalMeshContext->SkeletalMesh, *MorphTargetName, RF_Public);
 #if ENGINE_MAJOR_VERSION > 4
-						MorphTarget->GetMorphLODModels().Add(MorphTargetLODModel);
+					MorphTarget->GetMorphLODModels().Add(MoveTemp(MorphTargetLODModel));
 #else
-						MorphTarget->MorphLODModels.Add(MorphTargetLODModel);
+					MorphTarget->MorphLODModels.Add(MoveTemp(MorphTargetLODModel));
 #endif
-						SkeletalMeshContext->SkeletalMesh->RegisterMorphTarget(MorphTarget, false);
-						MorphTargetNamesHistory.Add(MorphTargetName, MorphTarget);
-						bHasMorphTargets = true;
-					}
-
-					MorphTargetIndex++;
+					SkeletalMeshContext->SkeletalMesh->RegisterMorphTarget(MorphTarget, false);
+					MorphTargetNamesHistory.Add(MorphTargetName, MorphTarget);
+					bHasMorphTargets = true;
 				}
-				BaseIndex += Primitive.Indices.Num();
+
+				MorphTargetIndex++;
 			}
 		}
 
@@ -1586,7 +1610,7 @@ USkeletalMesh* FglTFRuntimeParser::LoadSkeletalMesh(const int32 MeshIndex, const
 		return SkeletalMeshesCache[MeshIndex];
 	}
 
-	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 	if (!JsonMeshObject)
 	{
 		AddError("LoadSkeletalMesh()", FString::Printf(TEXT("Unable to find Mesh with index %d"), MeshIndex));
@@ -1629,11 +1653,9 @@ void FglTFRuntimeParser::LoadSkeletalMeshAsync(const int32 MeshIndex, const int3
 	TSharedRef<FglTFRuntimeSkeletalMeshContext, ESPMode::ThreadSafe> SkeletalMeshContext = MakeShared<FglTFRuntimeSkeletalMeshContext, ESPMode::ThreadSafe>(AsShared(), SkeletalMeshConfig);
 	SkeletalMeshContext->SkinIndex = SkinIndex;
 
-	Async(EAsyncExecution::Thread, [this, SkeletalMeshContext, MeshIndex, AsyncCallback]()
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, SkeletalMeshConfig.AsyncLoadingPriority, AsyncCallback.GetUObject(), [this, SkeletalMeshContext, MeshIndex]()
 		{
-			FglTFRuntimeSkeletalMeshContextFinalizer AsyncFinalizer(SkeletalMeshContext, AsyncCallback);
-
-			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 			if (!JsonMeshObject)
 			{
 				AddError("LoadSkeletalMeshAsync()", FString::Printf(TEXT("Unable to find Mesh with index %d"), MeshIndex));
@@ -1649,6 +1671,10 @@ void FglTFRuntimeParser::LoadSkeletalMeshAsync(const int32 MeshIndex, const int3
 			SkeletalMeshContext->LODs.Add(LOD);
 
 			SkeletalMeshContext->SkeletalMesh = CreateSkeletalMeshFromLODs(SkeletalMeshContext);
+		},
+		[SkeletalMeshContext, AsyncCallback]()
+		{
+			FinalizeSkeletalMeshContextAsync(SkeletalMeshContext, AsyncCallback);
 		});
 }
 
@@ -1659,7 +1685,7 @@ USkeletalMesh* FglTFRuntimeParser::LoadSkeletalMeshLODs(const TArray<int32>& Mes
 
 	for (const int32 MeshIndex : MeshIndices)
 	{
-		TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+		TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 		if (!JsonMeshObject)
 		{
 			AddError("LoadSkeletalMesh()", FString::Printf(TEXT("Unable to find Mesh with index %d"), MeshIndex));
@@ -1709,9 +1735,8 @@ void FglTFRuntimeParser::LoadSkeletalMeshRecursiveAsync(const FString& NodeName,
 {
 	TSharedRef<FglTFRuntimeSkeletalMeshContext, ESPMode::ThreadSafe> SkeletalMeshContext = MakeShared<FglTFRuntimeSkeletalMeshContext, ESPMode::ThreadSafe>(AsShared(), SkeletalMeshConfig);
 
-	Async(EAsyncExecution::Thread, [this, SkeletalMeshContext, ExcludeNodes, NodeName, SkinIndex, AsyncCallback, TransformApplyRecursiveMode]()
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, SkeletalMeshConfig.AsyncLoadingPriority, AsyncCallback.GetUObject(), [this, SkeletalMeshContext, ExcludeNodes, NodeName, SkinIndex, TransformApplyRecursiveMode]()
 		{
-			FglTFRuntimeSkeletalMeshContextFinalizer AsyncFinalizer(SkeletalMeshContext, AsyncCallback);
 			// ensure to cache it as the finalizer requires LOD access
 			FglTFRuntimeMeshLOD& CombinedLOD = SkeletalMeshContext->CachedRuntimeMeshLODs.AddDefaulted_GetRef();
 			int32 NewSkinIndex = SkinIndex;
@@ -1724,6 +1749,10 @@ void FglTFRuntimeParser::LoadSkeletalMeshRecursiveAsync(const FString& NodeName,
 			SkeletalMeshContext->LODs.Add(&CombinedLOD);
 
 			SkeletalMeshContext->SkeletalMesh = CreateSkeletalMeshFromLODs(SkeletalMeshContext);
+		},
+		[SkeletalMeshContext, AsyncCallback]()
+		{
+			FinalizeSkeletalMeshContextAsync(SkeletalMeshContext, AsyncCallback);
 		});
 }
 
@@ -1781,7 +1810,7 @@ UAnimSequence* FglTFRuntimeParser::LoadNodeSkeletalAnimation(USkeletalMesh* Skel
 	// this could be a static mesh read as a skeletal one...
 	if (Node.SkinIndex > INDEX_NONE)
 	{
-		TSharedPtr<FJsonObject> JsonSkinObject = GetJsonObjectFromRootIndex("skins", Node.SkinIndex);
+		TSharedPtr<FJsonObject> JsonSkinObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Skins, Node.SkinIndex);
 		if (!JsonSkinObject)
 		{
 			AddError("LoadNodeSkeletalAnimation()", "No skins defined in the asset");
@@ -1853,7 +1882,7 @@ UAnimSequence* FglTFRuntimeParser::LoadSkeletalAnimation(USkeletalMesh* Skeletal
 		return nullptr;
 	}
 
-	TSharedPtr<FJsonObject> JsonAnimationObject = GetJsonObjectFromRootIndex("animations", AnimationIndex);
+	TSharedPtr<FJsonObject> JsonAnimationObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Animations, AnimationIndex);
 	if (!JsonAnimationObject)
 	{
 		AddError("LoadNodeSkeletalAnimation()", FString::Printf(TEXT("Unable to find animation %d"), AnimationIndex));
@@ -1869,6 +1898,67 @@ UAnimSequence* FglTFRuntimeParser::LoadSkeletalAnimation(USkeletalMesh* Skeletal
 		return nullptr;
 	}
 
+	return CreateSkeletalAnimationFromTracks(SkeletalMesh, Tracks, MorphTargetCurves, Duration, SkeletalAnimationConfig);
+}
+
+void FglTFRuntimeParser::LoadSkeletalAnimationAsync(USkeletalMesh* SkeletalMesh, const int32 AnimationIndex, const FglTFRuntimeSkeletalAnimationAsync& AsyncCallback, const FglTFRuntimeSkeletalAnimationConfig& SkeletalAnimationConfig)
+{
+	struct FglTFRuntimeSkeletalAnimationAsyncResult
+	{
+		bool bValid = false;
+		float Duration = 0;
+		TMap<FString, FRawAnimSequenceTrack> Tracks;
+		TMap<FName, TArray<TPair<float, float>>> MorphTargetCurves;
+	};
+
+	TSharedRef<FglTFRuntimeSkeletalAnimationAsyncResult, ESPMode::ThreadSafe> Result = MakeShared<FglTFRuntimeSkeletalAnimationAsyncResult, ESPMode::ThreadSafe>();
+
+	auto BakeTracks = [Parser = AsShared(), Result, AnimationIndex, SkeletalAnimationConfig]()
+		{
+			TSharedPtr<FJsonObject> JsonAnimationObject = Parser->GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Animations, AnimationIndex);
+			if (!JsonAnimationObject)
+			{
+				Parser->AddError("LoadSkeletalAnimationAsync()", FString::Printf(TEXT("Unable to find animation %d"), AnimationIndex));
+				return;
+			}
+
+			Result->bValid = Parser->LoadSkeletalAnimation_Internal(JsonAnimationObject.ToSharedRef(), Result->Tracks, Result->MorphTargetCurves, Result->Duration, SkeletalAnimationConfig, [](const FglTFRuntimeNode& Node) -> bool { return true; });
+		};
+
+	// blueprint remappers and the retarget assets are only safe on the game thread, so in that case everything happens in the finalizer
+	const bool bBakeOnGameThread = SkeletalAnimationConfig.CurveRemapper.Remapper.IsBound() ||
+		SkeletalAnimationConfig.FrameRotationRemapper.Remapper.IsBound() ||
+		SkeletalAnimationConfig.FrameTranslationRemapper.Remapper.IsBound() ||
+		SkeletalAnimationConfig.RetargetTo ||
+		SkeletalAnimationConfig.RetargetToSkeletalMesh;
+
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, 0, AsyncCallback.GetUObject(), [bBakeOnGameThread, BakeTracks]()
+		{
+			if (!bBakeOnGameThread)
+			{
+				BakeTracks();
+			}
+		},
+		[Parser = AsShared(), Result, bBakeOnGameThread, BakeTracks, WeakSkeletalMesh = TWeakObjectPtr<USkeletalMesh>(SkeletalMesh), AsyncCallback, SkeletalAnimationConfig]()
+		{
+			USkeletalMesh* SkeletalMesh = WeakSkeletalMesh.Get();
+			if (SkeletalMesh && bBakeOnGameThread)
+			{
+				BakeTracks();
+			}
+
+			UAnimSequence* AnimSequence = nullptr;
+			if (SkeletalMesh && Result->bValid)
+			{
+				AnimSequence = Parser->CreateSkeletalAnimationFromTracks(SkeletalMesh, Result->Tracks, Result->MorphTargetCurves, Result->Duration, SkeletalAnimationConfig);
+			}
+
+			AsyncCallback.ExecuteIfBound(AnimSequence);
+		});
+}
+
+UAnimSequence* FglTFRuntimeParser::CreateSkeletalAnimationFromTracks(USkeletalMesh* SkeletalMesh, TMap<FString, FRawAnimSequenceTrack>& Tracks, TMap<FName, TArray<TPair<float, float>>>& MorphTargetCurves, const float Duration, const FglTFRuntimeSkeletalAnimationConfig& SkeletalAnimationConfig)
+{
 	int32 NumFrames = FMath::Max<int32>(Duration * SkeletalAnimationConfig.FramesPerSecond, 1);
 	UAnimSequence* AnimSequence = NewObject<UAnimSequence>(GetTransientPackage(), NAME_None, RF_Public);
 #if ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION > 26
@@ -2370,7 +2460,7 @@ UAnimSequence* FglTFRuntimeParser::CreateAnimationFromPose(USkeletalMesh* Skelet
 	TArray<int32> Joints;
 	if (SkinIndex > INDEX_NONE)
 	{
-		TSharedPtr<FJsonObject> SkinObject = GetJsonObjectFromRootIndex("skins", SkinIndex);
+		TSharedPtr<FJsonObject> SkinObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Skins, SkinIndex);
 		if (!SkinObject)
 		{
 			return nullptr;
@@ -2772,7 +2862,7 @@ bool FglTFRuntimeParser::LoadSkeletalAnimation_Internal(TSharedRef<FJsonObject>
 	{
 		if (SkeletalAnimationConfig.RetargetSkinIndex > INDEX_NONE)
 		{
-			TSharedPtr<FJsonObject>	JsonSkinObject = GetJsonObjectFromRootIndex("skins", SkeletalAnimationConfig.RetargetSkinIndex);
+			TSharedPtr<FJsonObject>	JsonSkinObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Skins, SkeletalAnimationConfig.RetargetSkinIndex);
 			if (!JsonSkinObject)
 			{
 				AddError("LoadSkeletalAnimation_Internal()", "Unable to find retarget skin.");
@@ -2851,6 +2941,23 @@ bool FglTFRuntimeParser::LoadSkeletalAnimation_Internal(TSharedRef<FJsonObject>
 			return FTransform(WorldRetargetMatrix * WorldRetargetParentPoseTransform.ToMatrixWithScale().Inverse());
 		};
 
+	// channels are only collected here, the per frame baking runs in parallel once all of them are known
+	struct FglTFRuntimeTrackBakeJob
+	{
+		FString TrackName;
+		FglTFRuntimeNode Node;
+		FString Path;
+		FglTFRuntimeAnimationCurve Curve;
+		FTransform NodeWorldTransform;
+		FTransform ParentNodeWorldTransform;
+		TArray<FQuat> RotKeys;
+		TArray<FVector> PosKeys;
+		TArray<FVector> ScaleKeys;
+	};
+
+	TArray<FglTFRuntimeTrackBakeJob> BakeJobs;
+	const bool bRetarget = SkeletalAnimationConfig.RetargetTo || SkeletalAnimationConfig.RetargetToSkeletalMesh;
+
 	auto Callback = [&](const FglTFRuntimeNode& Node, const FString& Path, const FglTFRuntimeAnimationCurve& Curve)
 		{
 			FString TrackName = Node.Name;
@@ -2870,15 +2977,13 @@ bool FglTFRuntimeParser::LoadSkeletalAnimation_Internal(TSharedRef<FJsonObject>
 				return;
 			}
 
-			int32 NumFrames = FMath::Max<int32>(Duration * SkeletalAnimationConfig.FramesPerSecond, 1);
-
-			float FrameDelta = 1.f / SkeletalAnimationConfig.FramesPerSecond;
-
-			if (Path == "rotation" && !SkeletalAnimationConfig.bRemoveRotations)
+			if ((Path == "rotation" && !SkeletalAnimationConfig.bRemoveRotations) ||
+				(Path == "translation" && !SkeletalAnimationConfig.bRemoveTranslations) ||
+				(Path == "scale" && !SkeletalAnimationConfig.bRemoveScales))
 			{
 				if (Curve.Timeline.Num() != Curve.Values.Num())
 				{
-					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Animation input/output mismatch (%d/%d) for rotation on node %d"), Curve.Timeline.Num(), Curve.Values.Num(), Node.Index));
+					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Animation input/output mismatch (%d/%d) for %s on node %d"), Curve.Timeline.Num(), Curve.Values.Num(), *Path, Node.Index));
 					return;
 				}
 
@@ -2887,254 +2992,310 @@ bool FglTFRuntimeParser::LoadSkeletalAnimation_Internal(TSharedRef<FJsonObject>
 					Tracks.Add(TrackName, FRawAnimSequenceTrack());
 				}
 
-				FRawAnimSequenceTrack& Track = Tracks[TrackName];
+				FglTFRuntimeTrackBakeJob& BakeJob = BakeJobs.AddDefaulted_GetRef();
+				BakeJob.TrackName = TrackName;
+				BakeJob.Node = Node;
+				BakeJob.Path = Path;
+				BakeJob.Curve = Curve;
+
+				// the node hierarchy walk touches the parser caches, so it cannot happen in the parallel part
+				if (bRetarget && AnimWorldTransforms.Num() == 0 && Path != "scale")
+				{
+					BakeJob.NodeWorldTransform = GetNodeWorldTransform(Node);
+					BakeJob.ParentNodeWorldTransform = GetParentNodeWorldTransform(Node);
+				}
+			}
+			else if (Path == "weights" && !SkeletalAnimationConfig.bRemoveMorphTargets)
+			{
+				TArray<FName> MorphTargetNames;
+				if (!GetMorphTargetNames(Node.MeshIndex, MorphTargetNames))
+				{
+					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Mesh %d has no MorphTargets"), Node.Index));
+					return;
+				}
 
-				for (int32 Frame = 0; Frame < NumFrames; Frame++)
+				if (Curve.Timeline.Num() * MorphTargetNames.Num() != Curve.Values.Num())
 				{
-					const float FrameBase = FrameDelta * Frame;
-					FQuat AnimQuat;
-					int32 FirstIndex;
-					int32 SecondIndex;
-					float Alpha = FindBestFrames(Curve.Timeline, FrameBase, FirstIndex, SecondIndex);
-					FVector4 FirstQuatV = Curve.Values[FirstIndex];
-					FVector4 SecondQuatV = Curve.Values[SecondIndex];
-					FQuat FirstQuat = FQuat(FirstQuatV.X, FirstQuatV.Y, FirstQuatV.Z, FirstQuatV.W).GetNormalized();
-					FQuat SecondQuat = FQuat(SecondQuatV.X, SecondQuatV.Y, SecondQuatV.Z, SecondQuatV.W).GetNormalized();
+					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Animation input/output mismatch (%d/%d) for weights on node %d"), Curve.Timeline.Num(), Curve.Values.Num() / MorphTargetNames.Num(), Node.Index));
+					return;
+				}
 
-					// cubic spline ?
-					if (FirstIndex != SecondIndex && Curve.Values.Num() == Curve.InTangents.Num() && Curve.InTangents.Num() == Curve.OutTangents.Num())
+				for (int32 MorphTargetIndex = 0; MorphTargetIndex < MorphTargetNames.Num(); MorphTargetIndex++)
+				{
+					FName MorphTargetName = MorphTargetNames[MorphTargetIndex];
+					TArray<TPair<float, float>> Curves;
+
+					for (int32 TimelineIndex = 0; TimelineIndex < Curve.Timeline.Num(); TimelineIndex++)
 					{
-						FVector4 CubicValue = CubicSpline(FrameBase, Curve.Timeline[FirstIndex], Curve.Timeline[SecondIndex], FirstQuatV, Curve.OutTangents[FirstIndex], SecondQuatV, Curve.InTangents[SecondIndex]);
+						TPair<float, float> NewCurve = TPair<float, float>(Curve.Timeline[TimelineIndex], Curve.Values[TimelineIndex * MorphTargetNames.Num() + MorphTargetIndex].X);
+						Curves.Add(NewCurve);
+					}
+					MorphTargetCurves.Add(MorphTargetName, Curves);
+				}
+			}
+		};
 
-						AnimQuat = { CubicValue.X, CubicValue.Y, CubicValue.Z, CubicValue.W };
+	FString IgnoredName;
+	if (!LoadAnimation_Internal(JsonAnimationObject, Duration, IgnoredName, Callback, Filter, SkeletalAnimationConfig.OverrideTrackNameFromExtension))
+	{
+		return false;
+	}
 
-						FMatrix RotationMatrix = SceneBasis.Inverse() * FQuatRotationMatrix(AnimQuat.GetNormalized()) * SceneBasis;
+	const int32 NumFrames = FMath::Max<int32>(Duration * SkeletalAnimationConfig.FramesPerSecond, 1);
+	const float FrameDelta = 1.f / SkeletalAnimationConfig.FramesPerSecond;
+	const FMatrix SceneBasisInverse = SceneBasis.Inverse();
 
-						AnimQuat = RotationMatrix.ToQuat();
-					}
-					else if (FirstIndex == SecondIndex)
-					{
-						FMatrix RotationMatrix = SceneBasis.Inverse() * FQuatRotationMatrix(FirstQuat) * SceneBasis;
+	auto BakeRotations = [&](FglTFRuntimeTrackBakeJob& BakeJob)
+		{
+			const FglTFRuntimeAnimationCurve& Curve = BakeJob.Curve;
+			const FString& TrackName = BakeJob.TrackName;
+			const FglTFRuntimeNode& Node = BakeJob.Node;
 
-						AnimQuat = RotationMatrix.ToQuat();
-					}
-					else
-					{
+			BakeJob.RotKeys.Reserve(NumFrames);
 
-						FMatrix FirstMatrix = SceneBasis.Inverse() * FQuatRotationMatrix(FirstQuat) * SceneBasis;
-						FMatrix SecondMatrix = SceneBasis.Inverse() * FQuatRotationMatrix(SecondQuat) * SceneBasis;
-						FirstQuat = FirstMatrix.ToQuat();
-						SecondQuat = SecondMatrix.ToQuat();
-						AnimQuat = FQuat::Slerp(FirstQuat, SecondQuat, Alpha);
-					}
+			int32 Cursor = 0;
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
+			{
+				const float FrameBase = FrameDelta * Frame;
+				FQuat AnimQuat;
+				int32 FirstIndex;
+				int32 SecondIndex;
+				float Alpha = FindBestFrames(Curve.Timeline, FrameBase, FirstIndex, SecondIndex, Cursor);
+				FVector4 FirstQuatV = Curve.Values[FirstIndex];
+				FVector4 SecondQuatV = Curve.Values[SecondIndex];
+				FQuat FirstQuat = FQuat(FirstQuatV.X, FirstQuatV.Y, FirstQuatV.Z, FirstQuatV.W).GetNormalized();
+				FQuat SecondQuat = FQuat(SecondQuatV.X, SecondQuatV.Y, SecondQuatV.Z, SecondQuatV.W).GetNormalized();
+
+				// cubic spline ?
+				if (FirstIndex != SecondIndex && Curve.Values.Num() == Curve.InTangents.Num() && Curve.InTangents.Num() == Curve.OutTangents.Num())
+				{
+					FVector4 CubicValue = CubicSpline(FrameBase, Curve.Timeline[FirstIndex], Curve.Timeline[SecondIndex], FirstQuatV, Curve.OutTangents[FirstIndex], SecondQuatV, Curve.InTangents[SecondIndex]);
+
+					AnimQuat = { CubicValue.X, CubicValue.Y, CubicValue.Z, CubicValue.W };
+
+					FMatrix RotationMatrix = SceneBasisInverse * FQuatRotationMatrix(AnimQuat.GetNormalized()) * SceneBasis;
+
+					AnimQuat = RotationMatrix.ToQuat();
+				}
+				else if (FirstIndex == SecondIndex)
+				{
+					FMatrix RotationMatrix = SceneBasisInverse * FQuatRotationMatrix(FirstQuat) * SceneBasis;
+
+					AnimQuat = RotationMatrix.ToQuat();
+				}
+				else
+				{
 
-					if (SkeletalAnimationConfig.RetargetTo || SkeletalAnimationConfig.RetargetToSkeletalMesh)
+					FMatrix FirstMatrix = SceneBasisInverse * FQuatRotationMatrix(FirstQuat) * SceneBasis;
+					FMatrix SecondMatrix = SceneBasisInverse * FQuatRotationMatrix(SecondQuat) * SceneBasis;
+					FirstQuat = FirstMatrix.ToQuat();
+					SecondQuat = SecondMatrix.ToQuat();
+					AnimQuat = FQuat::Slerp(FirstQuat, SecondQuat, Alpha);
+				}
+
+				if (bRetarget)
+				{
+					const int32 RetargetBoneIndex = RetargetRefSkeleton.FindBoneIndex(*TrackName);
+					if (RetargetBoneIndex > INDEX_NONE)
 					{
-						const int32 RetargetBoneIndex = RetargetRefSkeleton.FindBoneIndex(*TrackName);
-						if (RetargetBoneIndex > INDEX_NONE)
-						{
-							const int32 RetargetParentBoneIndex = RetargetRefSkeleton.GetParentIndex(RetargetBoneIndex);
+						const int32 RetargetParentBoneIndex = RetargetRefSkeleton.GetParentIndex(RetargetBoneIndex);
 
-							if (AnimWorldTransforms.Num() > 0)
-							{
-								const int32 AnimBoneIndex = AnimRefSkeleton.FindBoneIndex(*Node.Name);
-								if (AnimBoneIndex > INDEX_NONE)
-								{
-									const int32 AnimParentBoneIndex = AnimRefSkeleton.GetParentIndex(AnimBoneIndex);
-
-									AnimQuat = RetargetQuat(AnimQuat,
-										AnimWorldTransforms[AnimBoneIndex].GetRotation(),
-										AnimParentBoneIndex > INDEX_NONE ? AnimWorldTransforms[AnimParentBoneIndex].GetRotation() : FQuat::Identity,
-										RetargetWorldTransforms[RetargetBoneIndex].GetRotation(),
-										RetargetParentBoneIndex > INDEX_NONE ? RetargetWorldTransforms[RetargetParentBoneIndex].GetRotation() : FQuat::Identity
-									).GetNormalized();
-								}
-							}
-							else
+						if (AnimWorldTransforms.Num() > 0)
+						{
+							const int32 AnimBoneIndex = AnimRefSkeleton.FindBoneIndex(*Node.Name);
+							if (AnimBoneIndex > INDEX_NONE)
 							{
+								const int32 AnimParentBoneIndex = AnimRefSkeleton.GetParentIndex(AnimBoneIndex);
+
 								AnimQuat = RetargetQuat(AnimQuat,
-									GetNodeWorldTransform(Node).GetRotation(),
-									GetParentNodeWorldTransform(Node).GetRotation(),
+									AnimWorldTransforms[AnimBoneIndex].GetRotation(),
+									AnimParentBoneIndex > INDEX_NONE ? AnimWorldTransforms[AnimParentBoneIndex].GetRotation() : FQuat::Identity,
 									RetargetWorldTransforms[RetargetBoneIndex].GetRotation(),
 									RetargetParentBoneIndex > INDEX_NONE ? RetargetWorldTransforms[RetargetParentBoneIndex].GetRotation() : FQuat::Identity
 								).GetNormalized();
 							}
 						}
+						else
+						{
+							AnimQuat = RetargetQuat(AnimQuat,
+								BakeJob.NodeWorldTransform.GetRotation(),
+								BakeJob.ParentNodeWorldTransform.GetRotation(),
+								RetargetWorldTransforms[RetargetBoneIndex].GetRotation(),
+								RetargetParentBoneIndex > INDEX_NONE ? RetargetWorldTransforms[RetargetParentBoneIndex].GetRotation() : FQuat::Identity
+							).GetNormalized();
+						}
 					}
+				}
 
-					if (SkeletalAnimationConfig.TransformPose.Contains(TrackName))
-					{
-						AnimQuat = SkeletalAnimationConfig.TransformPose[TrackName].TransformRotation(AnimQuat);
-					}
-
-					if (SkeletalAnimationConfig.FrameRotationRemapper.Remapper.IsBound())
-					{
-						AnimQuat = SkeletalAnimationConfig.FrameRotationRemapper.Remapper.Execute(TrackName, Frame, AnimQuat.Rotator(), SkeletalAnimationConfig.FrameRotationRemapper.Context).Quaternion();
-					}
-
-#if ENGINE_MAJOR_VERSION > 4
-					Track.RotKeys.Add(FQuat4f(AnimQuat));
-#else
-					Track.RotKeys.Add(AnimQuat);
-#endif
+				if (SkeletalAnimationConfig.TransformPose.Contains(TrackName))
+				{
+					AnimQuat = SkeletalAnimationConfig.TransformPose[TrackName].TransformRotation(AnimQuat);
 				}
+
+				BakeJob.RotKeys.Add(AnimQuat);
 			}
-			else if (Path == "translation" && !SkeletalAnimationConfig.bRemoveTranslations)
+		};
+
+	auto BakeTranslations = [&](FglTFRuntimeTrackBakeJob& BakeJob)
+		{
+			const FglTFRuntimeAnimationCurve& Curve = BakeJob.Curve;
+			const FString& TrackName = BakeJob.TrackName;
+			const FglTFRuntimeNode& Node = BakeJob.Node;
+
+			BakeJob.PosKeys.Reserve(NumFrames);
+
+			int32 Cursor = 0;
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
 			{
-				if (Curve.Timeline.Num() != Curve.Values.Num())
+				const float FrameBase = FrameDelta * Frame;
+				FVector AnimLocation;
+				int32 FirstIndex;
+				int32 SecondIndex;
+				float Alpha = FindBestFrames(Curve.Timeline, FrameBase, FirstIndex, SecondIndex, Cursor);
+				FVector4 First = Curve.Values[FirstIndex];
+				FVector4 Second = Curve.Values[SecondIndex];
+
+				// cubic spline ?
+				if (FirstIndex != SecondIndex && Curve.Values.Num() == Curve.InTangents.Num() && Curve.InTangents.Num() == Curve.OutTangents.Num())
 				{
-					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Animation input/output mismatch (%d/%d) for translation on node %d"), Curve.Timeline.Num(), Curve.Values.Num(), Node.Index));
-					return;
-				}
+					FVector4 CubicValue = CubicSpline(FrameBase, Curve.Timeline[FirstIndex], Curve.Timeline[SecondIndex], First, Curve.OutTangents[FirstIndex], Second, Curve.InTangents[SecondIndex]);
 
-				if (!Tracks.Contains(TrackName))
+					AnimLocation = SceneBasis.TransformPosition(CubicValue) * SceneScale;
+				}
+				else
 				{
-					Tracks.Add(TrackName, FRawAnimSequenceTrack());
+					AnimLocation = SceneBasis.TransformPosition(FMath::Lerp(First, Second, Alpha)) * SceneScale;
 				}
 
-				FRawAnimSequenceTrack& Track = Tracks[TrackName];
-
-				for (int32 Frame = 0; Frame < NumFrames; Frame++)
+				if (bRetarget)
 				{
-					const float FrameBase = FrameDelta * Frame;
-					FVector AnimLocation;
-					int32 FirstIndex;
-					int32 SecondIndex;
-					float Alpha = FindBestFrames(Curve.Timeline, FrameBase, FirstIndex, SecondIndex);
-					FVector4 First = Curve.Values[FirstIndex];
-					FVector4 Second = Curve.Values[SecondIndex];
-
-					// cubic spline ?
-					if (FirstIndex != SecondIndex && Curve.Values.Num() == Curve.InTangents.Num() && Curve.InTangents.Num() == Curve.OutTangents.Num())
+					const int32 RetargetBoneIndex = RetargetRefSkeleton.FindBoneIndex(*TrackName);
+					if (RetargetBoneIndex > INDEX_NONE)
 					{
-						FVector4 CubicValue = CubicSpline(FrameBase, Curve.Timeline[FirstIndex], Curve.Timeline[SecondIndex], First, Curve.OutTangents[FirstIndex], Second, Curve.InTangents[SecondIndex]);
+						const int32 RetargetParentBoneIndex = RetargetRefSkeleton.GetParentIndex(RetargetBoneIndex);
 
-						AnimLocation = SceneBasis.TransformPosition(CubicValue) * SceneScale;
-					}
-					else
-					{
-						AnimLocation = SceneBasis.TransformPosition(FMath::Lerp(First, Second, Alpha)) * SceneScale;
-					}
-
-					if (SkeletalAnimationConfig.RetargetTo || SkeletalAnimationConfig.RetargetToSkeletalMesh)
-					{
-						const int32 RetargetBoneIndex = RetargetRefSkeleton.FindBoneIndex(*TrackName);
-						if (RetargetBoneIndex > INDEX_NONE)
+						if (AnimWorldTransforms.Num() > 0)
 						{
-							const int32 RetargetParentBoneIndex = RetargetRefSkeleton.GetParentIndex(RetargetBoneIndex);
-
-							if (AnimWorldTransforms.Num() > 0)
+							const int32 AnimBoneIndex = AnimRefSkeleton.FindBoneIndex(*Node.Name);
+							if (AnimBoneIndex > INDEX_NONE)
 							{
-								const int32 AnimBoneIndex = AnimRefSkeleton.FindBoneIndex(*Node.Name);
-								if (AnimBoneIndex > INDEX_NONE)
-								{
-									const int32 AnimParentBoneIndex = AnimRefSkeleton.GetParentIndex(AnimBoneIndex);
-
-									FTransform LocalAnimTransform = AnimRefSkeleton.GetRefBonePose()[AnimBoneIndex];
-									LocalAnimTransform.SetLocation(AnimLocation);
+								const int32 AnimParentBoneIndex = AnimRefSkeleton.GetParentIndex(AnimBoneIndex);
 
-									AnimLocation = RetargetTransform(LocalAnimTransform,
-										AnimWorldTransforms[AnimBoneIndex],
-										AnimParentBoneIndex > INDEX_NONE ? AnimWorldTransforms[AnimParentBoneIndex] : FTransform::Identity,
-										RetargetWorldTransforms[RetargetBoneIndex],
-										RetargetParentBoneIndex > INDEX_NONE ? RetargetWorldTransforms[RetargetParentBoneIndex] : FTransform::Identity
-									).GetLocation();
-								}
-							}
-							else
-							{
-								FTransform LocalAnimTransform = Node.Transform;
+								FTransform LocalAnimTransform = AnimRefSkeleton.GetRefBonePose()[AnimBoneIndex];
 								LocalAnimTransform.SetLocation(AnimLocation);
 
 								AnimLocation = RetargetTransform(LocalAnimTransform,
-									GetNodeWorldTransform(Node),
-									GetParentNodeWorldTransform(Node),
+									AnimWorldTransforms[AnimBoneIndex],
+									AnimParentBoneIndex > INDEX_NONE ? AnimWorldTransforms[AnimParentBoneIndex] : FTransform::Identity,
 									RetargetWorldTransforms[RetargetBoneIndex],
 									RetargetParentBoneIndex > INDEX_NONE ? RetargetWorldTransforms[RetargetParentBoneIndex] : FTransform::Identity
 								).GetLocation();
 							}
 						}
+						else
+						{
+							FTransform LocalAnimTransform = Node.Transform;
+							LocalAnimTransform.SetLocation(AnimLocation);
+
+							AnimLocation = RetargetTransform(LocalAnimTransform,
+								BakeJob.NodeWorldTransform,
+								BakeJob.ParentNodeWorldTransform,
+								RetargetWorldTransforms[RetargetBoneIndex],
+								RetargetParentBoneIndex > INDEX_NONE ? RetargetWorldTransforms[RetargetParentBoneIndex] : FTransform::Identity
+							).GetLocation();
+						}
 					}
-
-					if (SkeletalAnimationConfig.TransformPose.Contains(TrackName))
-					{
-						AnimLocation = SkeletalAnimationConfig.TransformPose[TrackName].TransformPosition(AnimLocation);
-					}
-
-					if (SkeletalAnimationConfig.FrameTranslationRemapper.Remapper.IsBound())
-					{
-						AnimLocation = SkeletalAnimationConfig.FrameTranslationRemapper.Remapper.Execute(TrackName, Frame, AnimLocation, SkeletalAnimationConfig.FrameRotationRemapper.Context);
-					}
-
-#if ENGINE_MAJOR_VERSION > 4
-					Track.PosKeys.Add(FVector3f(AnimLocation));
-#else
-					Track.PosKeys.Add(AnimLocation);
-#endif
-				}
-			}
-			else if (Path == "scale" && !SkeletalAnimationConfig.bRemoveScales)
-			{
-				if (Curve.Timeline.Num() != Curve.Values.Num())
-				{
-					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Animation input/output mismatch (%d/%d) for scale on node %d"), Curve.Timeline.Num(), Curve.Values.Num(), Node.Index));
-					return;
 				}
 
-				if (!Tracks.Contains(TrackName))
+				if (SkeletalAnimationConfig.TransformPose.Contains(TrackName))
 				{
-					Tracks.Add(TrackName, FRawAnimSequenceTrack());
+					AnimLocation = SkeletalAnimationConfig.TransformPose[TrackName].TransformPosition(AnimLocation);
 				}
 
-				FRawAnimSequenceTrack& Track = Tracks[TrackName];
+				BakeJob.PosKeys.Add(AnimLocation);
+			}
+		};
 
-				for (int32 Frame = 0; Frame < NumFrames; Frame++)
-				{
-					const float FrameBase = FrameDelta * Frame;
-					int32 FirstIndex;
-					int32 SecondIndex;
-					float Alpha = FindBestFrames(Curve.Timeline, FrameBase, FirstIndex, SecondIndex);
-					FVector4 First = Curve.Values[FirstIndex];
-					FVector4 Second = Curve.Values[SecondIndex];
-#if ENGINE_MAJOR_VERSION > 4
-					Track.ScaleKeys.Add(FVector3f((SceneBasis.Inverse() * FScaleMatrix(FMath::Lerp(First, Second, Alpha)) * SceneBasis).ExtractScaling()));
-#else
-					Track.ScaleKeys.Add((SceneBasis.Inverse() * FScaleMatrix(FMath::Lerp(First, Second, Alpha)) * SceneBasis).ExtractScaling());
-#endif
-				}
+	auto BakeScales = [&](FglTFRuntimeTrackBakeJob& BakeJob)
+		{
+			const FglTFRuntimeAnimationCurve& Curve = BakeJob.Curve;
+
+			BakeJob.ScaleKeys.Reserve(NumFrames);
+
+			int32 Cursor = 0;
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
+			{
+				const float FrameBase = FrameDelta * Frame;
+				int32 FirstIndex;
+				int32 SecondIndex;
+				float Alpha = FindBestFrames(Curve.Timeline, FrameBase, FirstIndex, SecondIndex, Cursor);
+				FVector4 First = Curve.Values[FirstIndex];
+				FVector4 Second = Curve.Values[SecondIndex];
+				BakeJob.ScaleKeys.Add((SceneBasisInverse * FScaleMatrix(FMath::Lerp(First, Second, Alpha)) * SceneBasis).ExtractScaling());
 			}
-			else if (Path == "weights" && !SkeletalAnimationConfig.bRemoveMorphTargets)
+		};
+
+	ParallelFor(BakeJobs.Num(), [&](const int32 BakeJobIndex)
+		{
+			FglTFRuntimeTrackBakeJob& BakeJob = BakeJobs[BakeJobIndex];
+			if (BakeJob.Path == "rotation")
 			{
-				TArray<FName> MorphTargetNames;
-				if (!GetMorphTargetNames(Node.MeshIndex, MorphTargetNames))
-				{
-					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Mesh %d has no MorphTargets"), Node.Index));
-					return;
-				}
+				BakeRotations(BakeJob);
+			}
+			else if (BakeJob.Path == "translation")
+			{
+				BakeTranslations(BakeJob);
+			}
+			else
+			{
+				BakeScales(BakeJob);
+			}
+		});
 
-				if (Curve.Timeline.Num() * MorphTargetNames.Num() != Curve.Values.Num())
-				{
-					AddError("LoadSkeletalAnimation_Internal()", FString::Printf(TEXT("Animation input/output mismatch (%d/%d) for weights on node %d"), Curve.Timeline.Num(), Curve.Values.Num() / MorphTargetNames.Num(), Node.Index));
-					return;
-				}
+	// the frame remappers may be blueprint code, so they run here on the calling thread, in channel order
+	for (FglTFRuntimeTrackBakeJob& BakeJob : BakeJobs)
+	{
+		FRawAnimSequenceTrack& Track = Tracks[BakeJob.TrackName];
 
-				for (int32 MorphTargetIndex = 0; MorphTargetIndex < MorphTargetNames.Num(); MorphTargetIndex++)
-				{
-					FName MorphTargetName = MorphTargetNames[MorphTargetIndex];
-					TArray<TPair<float, float>> Curves;
+		for (int32 Frame = 0; Frame < BakeJob.RotKeys.Num(); Frame++)
+		{
+			FQuat AnimQuat = BakeJob.RotKeys[Frame];
+			if (SkeletalAnimationConfig.FrameRotationRemapper.Remapper.IsBound())
+			{
+				AnimQuat = SkeletalAnimationConfig.FrameRotationRemapper.Remapper.Execute(BakeJob.TrackName, Frame, AnimQuat.Rotator(), SkeletalAnimationConfig.FrameRotationRemapper.Context).Quaternion();
+			}
+#if ENGINE_MAJOR_VERSION > 4
+			Track.RotKeys.Add(FQuat4f(AnimQuat));
+#else
+			Track.RotKeys.Add(AnimQuat);
+#endif
+		}
 
-					for (int32 TimelineIndex = 0; TimelineIndex < Curve.Timeline.Num(); TimelineIndex++)
-					{
-						TPair<float, float> NewCurve = TPair<float, float>(Curve.Timeline[TimelineIndex], Curve.Values[TimelineIndex * MorphTargetNames.Num() + MorphTargetIndex].X);
-						Curves.Add(NewCurve);
-					}
-					MorphTargetCurves.Add(MorphTargetName, Curves);
-				}
+		for (int32 Frame = 0; Frame < BakeJob.PosKeys.Num(); Frame++)
+		{
+			FVector AnimLocation = BakeJob.PosKeys[Frame];
+			if (SkeletalAnimationConfig.FrameTranslationRemapper.Remapper.IsBound())
+			{
+				AnimLocation = SkeletalAnimationConfig.FrameTranslationRemapper.Remapper.Execute(BakeJob.TrackName, Frame, AnimLocation, SkeletalAnimationConfig.FrameRotationRemapper.Context);
 			}
-		};
+#if ENGINE_MAJOR_VERSION > 4
+			Track.PosKeys.Add(FVector3f(AnimLocation));
+#else
+			Track.PosKeys.Add(AnimLocation);
+#endif
+		}
 
-	FString IgnoredName;
-	return LoadAnimation_Internal(JsonAnimationObject, Duration, IgnoredName, Callback, Filter, SkeletalAnimationConfig.OverrideTrackNameFromExtension);
+		for (const FVector& AnimScale : BakeJob.ScaleKeys)
+		{
+#if ENGINE_MAJOR_VERSION > 4
+			Track.ScaleKeys.Add(FVector3f(AnimScale));
+#else
+			Track.ScaleKeys.Add(AnimScale);
+#endif
+		}
+	}
+
+	return true;
 }
 
 
@@ -3220,7 +3381,7 @@ bool FglTFRuntimeParser::LoadSkinnedMeshRecursiveAsRuntimeLOD(const FString& Nod
 		}
 		if (ChildNode.MeshIndex > INDEX_NONE)
 		{
-			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", ChildNode.MeshIndex);
+			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, ChildNode.MeshIndex);
 			if (!JsonMeshObject)
 			{
 				AddError("LoadSkinnedMeshRecursiveAsRuntimeLOD()", FString::Printf(TEXT("Unable to find Mesh with index %d"), ChildNode.MeshIndex));
@@ -3245,7 +3406,7 @@ bool FglTFRuntimeParser::LoadSkinnedMeshRecursiveAsRuntimeLOD(const FString& Nod
 			{
 				FReferenceSkeleton FakeRefSkeleton;
 
-				TSharedPtr<FJsonObject> JsonSkinObject = GetJsonObjectFromRootIndex("skins", ChildNode.SkinIndex);
+				TSharedPtr<FJsonObject> JsonSkinObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Skins, ChildNode.SkinIndex);
 				if (!JsonSkinObject)
 				{
 					AddError("LoadSkinnedMeshRecursiveAsRuntimeLOD()", FString::Printf(TEXT("Unable to fill skin %d"), ChildNode.SkinIndex));
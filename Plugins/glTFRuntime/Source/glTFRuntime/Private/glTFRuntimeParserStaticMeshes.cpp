@@ -1,6 +1,7 @@
 // Copyright 2020-2022, Roberto De Ioris.
 
 #include "glTFRuntimeParser.h"
+#include "glTFRuntimeLoaderPool.h"
 #include "MeshDescription.h"
 #include "StaticMeshAttributes.h"
 #include "StaticMeshOperations.h"
@@ -58,10 +59,10 @@ void FglTFRuntimeParser::LoadStaticMeshAsync(const int32 MeshIndex, const FglTFR
 
 	TSharedRef<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe> StaticMeshContext = MakeShared<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe>(AsShared(), StaticMeshConfig);
 
-	Async(EAsyncExecution::Thread, [this, StaticMeshContext, MeshIndex, AsyncCallback]()
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, StaticMeshConfig.AsyncLoadingPriority, AsyncCallback.GetUObject(), [this, StaticMeshContext, MeshIndex]()
 		{
 
-			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 			if (JsonMeshObject)
 			{
 
@@ -73,25 +74,23 @@ void FglTFRuntimeParser::LoadStaticMeshAsync(const int32 MeshIndex, const FglTFR
 					StaticMeshContext->StaticMesh = LoadStaticMesh_Internal(StaticMeshContext);
 				}
 			}
+		},
+		[MeshIndex, StaticMeshContext, AsyncCallback]()
+		{
+			if (StaticMeshContext->StaticMesh)
+			{
+				StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
+			}
 
-			FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([MeshIndex, StaticMeshContext, AsyncCallback]()
+			if (StaticMeshContext->StaticMesh)
+			{
+				if (StaticMeshContext->Parser->CanWriteToCache(StaticMeshContext->StaticMeshConfig.CacheMode))
 				{
-					if (StaticMeshContext->StaticMesh)
-					{
-						StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
-					}
-
-					if (StaticMeshContext->StaticMesh)
-					{
-						if (StaticMeshContext->Parser->CanWriteToCache(StaticMeshContext->StaticMeshConfig.CacheMode))
-						{
-							StaticMeshContext->Parser->StaticMeshesCache.Add(MeshIndex, StaticMeshContext->StaticMesh);
-						}
-					}
+					StaticMeshContext->Parser->StaticMeshesCache.Add(MeshIndex, StaticMeshContext->StaticMesh);
+				}
+			}
 
-					AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
-				}, TStatId(), nullptr, ENamedThreads::GameThread);
-			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
+			AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
 		});
 }
 
@@ -780,7 +779,7 @@ bool FglTFRuntimeParser::LoadMeshIntoMeshLOD(TSharedRef<FJsonObject> JsonMeshObj
 UStaticMesh* FglTFRuntimeParser::LoadStaticMesh(const int32 MeshIndex, const FglTFRuntimeStaticMeshConfig& StaticMeshConfig)
 {
 
-	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 	if (!JsonMeshObject)
 	{
 		return nullptr;
@@ -823,7 +822,7 @@ TArray<UStaticMesh*> FglTFRuntimeParser::LoadStaticMeshesFromPrimitives(const in
 {
 	TArray<UStaticMesh*> StaticMeshes;
 
-	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 	if (!JsonMeshObject)
 	{
 		return StaticMeshes;
@@ -869,7 +868,7 @@ UStaticMesh* FglTFRuntimeParser::LoadStaticMeshLODs(const TArray<int32>& MeshInd
 
 	for (const int32 MeshIndex : MeshIndices)
 	{
-		TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+		TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 		if (!JsonMeshObject)
 		{
 			return nullptr;
@@ -897,12 +896,12 @@ void FglTFRuntimeParser::LoadStaticMeshLODsAsync(const TArray<int32>& MeshIndice
 {
 	TSharedRef<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe> StaticMeshContext = MakeShared<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe>(AsShared(), StaticMeshConfig);
 
-	Async(EAsyncExecution::Thread, [this, StaticMeshContext, MeshIndices, AsyncCallback]()
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, StaticMeshConfig.AsyncLoadingPriority, AsyncCallback.GetUObject(), [this, StaticMeshContext, MeshIndices]()
 		{
 			bool bSuccess = true;
 			for (const int32 MeshIndex : MeshIndices)
 			{
-				TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+				TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 				if (!JsonMeshObject)
 				{
 					bSuccess = false;
@@ -924,17 +923,15 @@ void FglTFRuntimeParser::LoadStaticMeshLODsAsync(const TArray<int32>& MeshIndice
 			{
 				StaticMeshContext->StaticMesh = LoadStaticMesh_Internal(StaticMeshContext);
 			}
+		},
+		[StaticMeshContext, AsyncCallback]()
+		{
+			if (StaticMeshContext->StaticMesh)
+			{
+				StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
+			}
 
-			FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([StaticMeshContext, AsyncCallback]()
-				{
-					if (StaticMeshContext->StaticMesh)
-					{
-						StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
-					}
-
-					AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
-				}, TStatId(), nullptr, ENamedThreads::GameThread);
-			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
+			AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
 		});
 }
 
@@ -945,7 +942,7 @@ bool FglTFRuntimeParser::LoadStaticMeshIntoProceduralMeshComponent(const int32 M
 		return false;
 	}
 
-	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 	if (!JsonMeshObject)
 	{
 		return false;
@@ -1073,7 +1070,7 @@ UStaticMesh* FglTFRuntimeParser::LoadStaticMeshRecursive(const FString& NodeName
 
 		if (ChildNode.MeshIndex != INDEX_NONE)
 		{
-			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", ChildNode.MeshIndex);
+			TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, ChildNode.MeshIndex);
 			if (!JsonMeshObject)
 			{
 				return nullptr;
@@ -1126,7 +1123,7 @@ void FglTFRuntimeParser::LoadStaticMeshRecursiveAsync(const FString& NodeName, c
 	TSharedRef<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe> StaticMeshContext = MakeShared<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe>(AsShared(), StaticMeshConfig);
 
 
-	Async(EAsyncExecution::Thread, [this, StaticMeshContext, StaticMeshConfig, ExcludeNodes, NodeName, AsyncCallback]()
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, StaticMeshConfig.AsyncLoadingPriority, AsyncCallback.GetUObject(), [this, StaticMeshContext, StaticMeshConfig, ExcludeNodes, NodeName]()
 		{
 
 			FglTFRuntimeNode Node;
@@ -1165,7 +1162,8 @@ void FglTFRuntimeParser::LoadStaticMeshRecursiveAsync(const FString& NodeName, c
 				}
 			}
 
-			FglTFRuntimeMeshLOD CombinedLOD;
+			// owned by the context, as the finalizer runs after this returns
+			FglTFRuntimeMeshLOD& CombinedLOD = StaticMeshContext->AddContextLOD();
 
 			for (FglTFRuntimeNode& ChildNode : Nodes)
 			{
@@ -1176,7 +1174,7 @@ void FglTFRuntimeParser::LoadStaticMeshRecursiveAsync(const FString& NodeName, c
 
 				if (ChildNode.MeshIndex != INDEX_NONE)
 				{
-					TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", ChildNode.MeshIndex);
+					TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, ChildNode.MeshIndex);
 					if (!JsonMeshObject)
 					{
 						return;
@@ -1212,26 +1210,22 @@ void FglTFRuntimeParser::LoadStaticMeshRecursiveAsync(const FString& NodeName, c
 				}
 			}
 
-			StaticMeshContext->LODs.Add(&CombinedLOD);
-
 			StaticMeshContext->StaticMesh = LoadStaticMesh_Internal(StaticMeshContext);
+		},
+		[StaticMeshContext, AsyncCallback]()
+		{
+			if (StaticMeshContext->StaticMesh)
+			{
+				StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
+			}
 
-			FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([StaticMeshContext, AsyncCallback]()
-				{
-					if (StaticMeshContext->StaticMesh)
-					{
-						StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
-					}
-
-					AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
-				}, TStatId(), nullptr, ENamedThreads::GameThread);
-			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
+			AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
 		});
 }
 
 bool FglTFRuntimeParser::LoadMeshAsRuntimeLOD(const int32 MeshIndex, FglTFRuntimeMeshLOD& RuntimeLOD, const FglTFRuntimeMaterialsConfig& MaterialsConfig)
 {
-	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex("meshes", MeshIndex);
+	TSharedPtr<FJsonObject> JsonMeshObject = GetJsonObjectFromRootIndex(EglTFRuntimeRootArray::Meshes, MeshIndex);
 	if (!JsonMeshObject)
 	{
 		return false;
@@ -1269,25 +1263,23 @@ void FglTFRuntimeParser::LoadStaticMeshFromRuntimeLODsAsync(const TArray<FglTFRu
 {
 	TSharedRef<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe> StaticMeshContext = MakeShared<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe>(AsShared(), StaticMeshConfig);
 
-	Async(EAsyncExecution::Thread, [this, StaticMeshContext, StaticMeshConfig, RuntimeLODs, AsyncCallback]()
+	// the context keeps its own copy alive until the finalizer has run
+	for (const FglTFRuntimeMeshLOD& RuntimeLOD : RuntimeLODs)
+	{
+		StaticMeshContext->AddContextLOD() = RuntimeLOD;
+	}
+
+	FglTFRuntimeLoaderPool::Get().Enqueue(this, StaticMeshConfig.AsyncLoadingPriority, AsyncCallback.GetUObject(), [this, StaticMeshContext]()
 		{
-			for (const FglTFRuntimeMeshLOD& RuntimeLOD : RuntimeLODs)
+			StaticMeshContext->StaticMesh = LoadStaticMesh_Internal(StaticMeshContext);
+		},
+		[StaticMeshContext, AsyncCallback]()
+		{
+			if (StaticMeshContext->StaticMesh)
 			{
-				StaticMeshContext->LODs.Add(&RuntimeLOD);
+				StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
 			}
 
-			StaticMeshContext->StaticMesh = LoadStaticMesh_Internal(StaticMeshContext);
-
-			FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([StaticMeshContext, AsyncCallback]()
-				{
-					if (StaticMeshContext->StaticMesh)
-					{
-						StaticMeshContext->StaticMesh = StaticMeshContext->Parser->FinalizeStaticMesh(StaticMeshContext);
-					}
-
-					AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
-				}, TStatId(), nullptr, ENamedThreads::GameThread);
-			FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
-		}
-	);
+			AsyncCallback.ExecuteIfBound(StaticMeshContext->StaticMesh);
+		});
 }
\ No newline at end of file
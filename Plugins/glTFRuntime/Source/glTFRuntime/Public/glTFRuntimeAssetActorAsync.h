@@ -64,6 +64,8 @@ private:
 
 	void LoadNextMeshAsync();
 
+	float GetLoadingPriority(const UPrimitiveComponent* PrimitiveComponent) const;
+
 	UFUNCTION()
 	void LoadStaticMeshAsync(UStaticMesh* StaticMesh);
 
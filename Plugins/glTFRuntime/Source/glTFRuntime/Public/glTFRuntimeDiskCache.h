@@ -0,0 +1,93 @@
+// Copyright 2023, Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "glTFRuntimeMappedFile.h"
+
+/*
+ * Cooked data cache files: a small header followed by plain values and arrays.
+ * Every array payload starts 16 bytes aligned, so a mapped file can be copied into
+ * (or used in place of) the runtime arrays without any per element decoding.
+ * Only trivially copyable types can be stored, and the header records the size of
+ * FVector so float (UE4) and double (UE5) vector caches never get mixed.
+ */
+class GLTFRUNTIME_API FglTFRuntimeDiskCacheWriter
+{
+public:
+	FglTFRuntimeDiskCacheWriter();
+
+	template<typename T>
+	void Write(const T& Value)
+	{
+		WriteBytes(&Value, sizeof(T));
+	}
+
+	template<typename T, typename AllocatorType>
+	void WriteArray(const TArray<T, AllocatorType>& Array)
+	{
+		const int64 Num = Array.Num();
+		Write(Num);
+		Align();
+		WriteBytes(Array.GetData(), Num * sizeof(T));
+	}
+
+	void WriteString(const FString& Value);
+
+	// written to a temporary file and then moved, so concurrent readers never see partial files
+	bool Save(const FString& Filename) const;
+
+private:
+	void WriteBytes(const void* Bytes, const int64 Size);
+	void Align();
+
+	TArray64<uint8> Data;
+};
+
+class GLTFRUNTIME_API FglTFRuntimeDiskCacheReader
+{
+public:
+	bool Open(const FString& Filename);
+
+	template<typename T>
+	bool Read(T& Value)
+	{
+		return ReadBytes(&Value, sizeof(T));
+	}
+
+	template<typename T, typename AllocatorType>
+	bool ReadArray(TArray<T, AllocatorType>& Array)
+	{
+		int64 Num = 0;
+		if (!Read(Num) || Num < 0 || Num > TNumericLimits<typename AllocatorType::SizeType>::Max())
+		{
+			return false;
+		}
+		Align();
+		if (Offset + Num * static_cast<int64>(sizeof(T)) > Size)
+		{
+			return false;
+		}
+		Array.SetNumUninitialized(Num);
+		return ReadBytes(Array.GetData(), Num * sizeof(T));
+	}
+
+	bool ReadString(FString& Value);
+
+private:
+	bool ReadBytes(void* Bytes, const int64 BytesSize);
+	void Align();
+
+	TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> MappedFile;
+	TArray64<uint8> FallbackData;
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	int64 Offset = 0;
+};
+
+namespace glTFRuntimeDiskCache
+{
+	GLTFRUNTIME_API FString GetDirectory();
+	GLTFRUNTIME_API uint64 Hash(const void* Bytes, const int64 Size, const uint64 Seed = 0);
+}
@@ -0,0 +1,71 @@
+// Copyright 2023, Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Runtime/Launch/Resources/Version.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "Misc/QueuedThreadPool.h"
+#include "UObject/WeakObjectPtr.h"
+
+/*
+ * Runs the async loaders on a bounded set of threads instead of a new thread per request.
+ * Pending jobs are started by descending priority, jobs sharing a key (the parser) never overlap,
+ * and the game thread part of each job is run from a ticker within a per frame time budget.
+ */
+class GLTFRUNTIME_API FglTFRuntimeLoaderPool
+{
+public:
+	static FglTFRuntimeLoaderPool& Get();
+	// does not create the pool, for callers that only need to cancel
+	static FglTFRuntimeLoaderPool* GetPtr();
+	static void Shutdown();
+
+	/*
+	 * Work runs on a loader thread, Finalize on the game thread once Work is done.
+	 * Both are skipped when Owner was given and is destroyed before they start.
+	 * A null Key means the job can run alongside any other.
+	 */
+	void Enqueue(const void* Key, const float Priority, const UObject* Owner, TFunction<void()> Work, TFunction<void()> Finalize);
+
+	void Cancel(const UObject* Owner);
+
+	~FglTFRuntimeLoaderPool();
+
+private:
+	FglTFRuntimeLoaderPool();
+
+	struct FJob
+	{
+		const void* Key = nullptr;
+		float Priority = 0;
+		uint64 Serial = 0;
+		bool bHasOwner = false;
+		TWeakObjectPtr<const UObject> Owner;
+		TFunction<void()> Work;
+		TFunction<void()> Finalize;
+		bool bCancelled = false;
+
+		bool IsCancelled() const { return bCancelled || (bHasOwner && !Owner.IsValid()); }
+	};
+
+	bool Tick(float DeltaTime);
+	void Dispatch();
+
+	FQueuedThreadPool* ThreadPool;
+	int32 MaxRunningJobs;
+	int32 RunningJobs;
+	uint64 NextSerial;
+
+	TArray<TSharedRef<FJob, ESPMode::ThreadSafe>> PendingJobs;
+	TArray<TSharedRef<FJob, ESPMode::ThreadSafe>> RunningJobsList;
+	TSet<const void*> BusyKeys;
+	TQueue<TSharedPtr<FJob, ESPMode::ThreadSafe>, EQueueMode::Mpsc> FinalizeQueue;
+
+#if ENGINE_MAJOR_VERSION > 4
+	FTSTicker::FDelegateHandle TickerHandle;
+#else
+	FDelegateHandle TickerHandle;
+#endif
+};
@@ -0,0 +1,26 @@
+// Copyright 2023, Roberto De Ioris.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+
+/*
+ * Read only memory mapping of a whole file.
+ * Views into the mapping (like FglTFRuntimeBlob) are valid as long as the object is alive,
+ * so it is generally shared between the parser and the data referencing it.
+ */
+class GLTFRUNTIME_API FglTFRuntimeMappedFile
+{
+public:
+	// returns nullptr if the platform file does not support mapping (e.g. pak files) or the file is empty
+	static TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> Open(const FString& Filename);
+
+	const uint8* GetData() const { return MappedRegion->GetMappedPtr(); }
+	int64 Num() const { return MappedRegion->GetMappedSize(); }
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	// declared after the handle, regions must be released before their file handle
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+};
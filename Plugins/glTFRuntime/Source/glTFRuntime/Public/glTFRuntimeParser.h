@@ -21,12 +21,16 @@
 #include "Components/AudioComponent.h"
 #include "Components/LightComponent.h"
 #include "glTFRuntimeAnimationCurve.h"
+#include "glTFRuntimeLoaderPool.h"
+#include "glTFRuntimeMappedFile.h"
 #include "ProceduralMeshComponent.h"
 #if WITH_EDITOR
 #include "Rendering/SkeletalMeshLODImporterData.h"
 #endif
 #include "Serialization/ArrayReader.h"
 #include "Streaming/TextureMipDataProvider.h"
+#include "Templates/IsFloatingPoint.h"
+#include "Templates/IsSigned.h"
 #include "UObject/Package.h"
 #include "glTFRuntimeParser.generated.h"
 
@@ -111,6 +115,17 @@ enum class EglTFRuntimeRecursiveMode : uint8
 	Tree
 };
 
+UENUM()
+enum class EglTFRuntimeBlockCompression : uint8
+{
+	None,
+	// BC5 for normal maps, BC3 for images with alpha, BC1 for everything else
+	Auto,
+	BC1,
+	BC3,
+	BC5
+};
+
 USTRUCT(BlueprintType)
 struct FglTFRuntimeBasisMatrix
 {
@@ -194,6 +209,10 @@ struct FglTFRuntimeConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
 	FString PrefixForUnnamedNodes;
 
+	// decoded primitives and textures are stored (keyed by the content hash) in glTFRuntime.DiskCacheDirectory
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
+	bool bDiskCache;
+
 	FglTFRuntimeConfig()
 	{
 		TransformBaseType = EglTFRuntimeTransformBaseType::Default;
@@ -207,6 +226,7 @@ struct FglTFRuntimeConfig
 		RuntimeContextObject = nullptr;
 		bAsBlob = false;
 		PrefixForUnnamedNodes = "node";
+		bDiskCache = false;
 	}
 
 	FMatrix GetMatrix() const
@@ -434,6 +454,10 @@ struct FglTFRuntimeImagesConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
 	int32 LODBias;
 
+	// block compress decoded images on the cpu (ignored when the RHI does not support BC formats or the size is not a multiple of 4)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
+	EglTFRuntimeBlockCompression BlockCompression;
+
 	FglTFRuntimeImagesConfig()
 	{
 		Compression = TextureCompressionSettings::TC_Default;
@@ -446,6 +470,7 @@ struct FglTFRuntimeImagesConfig
 		bCompressMips = false;
 		bStreaming = false;
 		LODBias = 0;
+		BlockCompression = EglTFRuntimeBlockCompression::None;
 	}
 };
 
@@ -626,6 +651,9 @@ struct FglTFRuntimeStaticMeshConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
 	float LODScreenSizeMultiplier;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
+	float AsyncLoadingPriority;
+
 	template<typename T>
 	T* GetCustomConfig() const
 	{
@@ -656,6 +684,7 @@ struct FglTFRuntimeStaticMeshConfig
 		bGenerateStaticMeshDescription = false;
 		bBuildNavCollision = false;
 		LODScreenSizeMultiplier = 2;
+		AsyncLoadingPriority = 0;
 	}
 };
 
@@ -1049,6 +1078,10 @@ struct FglTFRuntimeSkeletalMeshConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
 	bool bIgnoreEmptyMorphTargets;
 
+	// position deltas with all the components below this value are not stored
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
+	float MorphTargetsDeltaThreshold;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
 	EglTFRuntimeMorphTargetsDuplicateStrategy MorphTargetsDuplicateStrategy;
 
@@ -1088,6 +1121,9 @@ struct FglTFRuntimeSkeletalMeshConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
 	FglTFRuntimeBoneBoundsFilterHook BoneBoundsFilter;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "glTFRuntime")
+	float AsyncLoadingPriority;
+
 	FglTFRuntimeSkeletalMeshConfig()
 	{
 		CacheMode = EglTFRuntimeCacheMode::ReadWrite;
@@ -1103,6 +1139,7 @@ struct FglTFRuntimeSkeletalMeshConfig
 		bPerPolyCollision = false;
 		bDisableMorphTargets = false;
 		bIgnoreEmptyMorphTargets = true;
+		MorphTargetsDeltaThreshold = KINDA_SMALL_NUMBER;
 		MorphTargetsDuplicateStrategy = EglTFRuntimeMorphTargetsDuplicateStrategy::Ignore;
 		ShiftBounds = FVector::ZeroVector;
 		bUseHighPrecisionUVs = false;
@@ -1113,6 +1150,7 @@ struct FglTFRuntimeSkeletalMeshConfig
 		bReverseTangents = false;
 		bAutoGeneratePhysicsAssetBodies = false;
 		bAutoGeneratePhysicsAssetConstraints = false;
+		AsyncLoadingPriority = 0;
 	}
 };
 
@@ -1912,6 +1950,13 @@ protected:
 	const TArray64<uint8>& Data;
 };
 
+class FglTFRuntimeBlockCompressor
+{
+public:
+	static EPixelFormat GetPixelFormat(const FglTFRuntimeMipMap& MipMap, const FglTFRuntimeImagesConfig& ImagesConfig);
+	static bool CompressMips(TArray<FglTFRuntimeMipMap>& Mips, const EPixelFormat PixelFormat);
+};
+
 // generic struct for plugins cache
 struct FglTFRuntimePluginCacheData
 {
@@ -1920,6 +1965,7 @@ struct FglTFRuntimePluginCacheData
 
 DECLARE_DYNAMIC_DELEGATE_OneParam(FglTFRuntimeStaticMeshAsync, UStaticMesh*, StaticMesh);
 DECLARE_DYNAMIC_DELEGATE_OneParam(FglTFRuntimeSkeletalMeshAsync, USkeletalMesh*, SkeletalMesh);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FglTFRuntimeSkeletalAnimationAsync, UAnimSequence*, Animation);
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FglTFRuntimeMeshLODAsync, const bool, bValid, const FglTFRuntimeMeshLOD&, MeshLOD);
 
 using FglTFRuntimeStaticMeshContextRef = TSharedRef<FglTFRuntimeStaticMeshContext, ESPMode::ThreadSafe>;
@@ -1940,6 +1986,23 @@ DECLARE_MULTICAST_DELEGATE_OneParam(FglTFRuntimeOnPostCreatedStaticMesh, FglTFRu
 DECLARE_MULTICAST_DELEGATE_OneParam(FglTFRuntimeOnPreCreatedSkeletalMesh, FglTFRuntimeSkeletalMeshContextRef);
 DECLARE_MULTICAST_DELEGATE_ThreeParams(FglTFRuntimeOnFinalizedStaticMesh, TSharedRef<FglTFRuntimeParser>, UStaticMesh*, const FglTFRuntimeStaticMeshConfig&);
 
+// root arrays resolved once when the parser is created
+enum class EglTFRuntimeRootArray : uint8
+{
+	Accessors,
+	Animations,
+	BufferViews,
+	Cameras,
+	Images,
+	Materials,
+	Meshes,
+	Nodes,
+	Scenes,
+	Skins,
+	Textures,
+	Num
+};
+
 /**
  *
  */
@@ -1997,6 +2060,7 @@ public:
 
 	void LoadSkeletalMeshAsync(const int32 MeshIndex, const int32 SkinIndex, const FglTFRuntimeSkeletalMeshAsync& AsyncCallback, const FglTFRuntimeSkeletalMeshConfig& SkeletalMeshConfig);
 	void LoadStaticMeshAsync(const int32 MeshIndex, const FglTFRuntimeStaticMeshAsync& AsyncCallback, const FglTFRuntimeStaticMeshConfig& StaticMeshConfig);
+	void LoadSkeletalAnimationAsync(USkeletalMesh* SkeletalMesh, const int32 AnimationIndex, const FglTFRuntimeSkeletalAnimationAsync& AsyncCallback, const FglTFRuntimeSkeletalAnimationConfig& SkeletalAnimationConfig);
 
 	void LoadStaticMeshLODsAsync(const TArray<int32>& MeshIndices, const FglTFRuntimeStaticMeshAsync& AsyncCallback, const FglTFRuntimeStaticMeshConfig& StaticMeshConfig);
 
@@ -2036,6 +2100,9 @@ public:
 
 	bool LoadPrimitives(TSharedRef<FJsonObject> JsonMeshObject, TArray<FglTFRuntimePrimitive>& Primitives, const FglTFRuntimeMaterialsConfig& MaterialsConfig);
 	bool LoadPrimitive(TSharedRef<FJsonObject> JsonPrimitiveObject, FglTFRuntimePrimitive& Primitive, const FglTFRuntimeMaterialsConfig& MaterialsConfig);
+	bool LoadPrimitiveGeometry(TSharedRef<FJsonObject> JsonPrimitiveObject, FglTFRuntimePrimitive& Primitive);
+	void PrefetchPrimitiveAccessors(TSharedRef<FJsonObject> JsonPrimitiveObject);
+	bool LoadPrimitiveMaterial(TSharedRef<FJsonObject> JsonPrimitiveObject, FglTFRuntimePrimitive& Primitive, const FglTFRuntimeMaterialsConfig& MaterialsConfig);
 
 	void AddError(const FString& ErrorContext, const FString& ErrorMessage);
 	void ClearErrors();
@@ -2055,6 +2122,9 @@ public:
 	void SetBinaryBuffer(const TArray64<uint8>& InBinaryBuffer)
 	{
 		BinaryBuffer = InBinaryBuffer;
+		BinaryBufferMappedFile.Reset();
+		BinaryBufferBlob.Data = BinaryBuffer.GetData();
+		BinaryBufferBlob.Num = BinaryBuffer.Num();
 	}
 
 	bool LoadStaticMeshIntoProceduralMeshComponent(const int32 MeshIndex, UProceduralMeshComponent* ProceduralMeshComponent, const FglTFRuntimeProceduralMeshConfig& ProceduralMeshConfig);
@@ -2196,10 +2266,18 @@ public:
 
 	void ClearCache();
 
+	// drops the memory mapped buffers, so their files are not kept open (e.g. to delete or replace them).
+	// Blobs taken before are invalidated and the GLB BIN chunk cannot be read anymore, call it once everything needed was loaded.
+	void ReleaseMappedFiles();
+
 protected:
 	void LoadAndFillBaseMaterials();
+	void BuildRootArrays();
 	TSharedRef<FJsonObject> Root;
 
+	// index tables for the hot root arrays (non object items are nullptr), avoids string lookups on every accessor/node access
+	TArray<TSharedPtr<FJsonObject>> RootArrays[static_cast<int32>(EglTFRuntimeRootArray::Num)];
+
 	TMap<int32, UStaticMesh*> StaticMeshesCache;
 	TMap<int32, UMaterialInterface*> MaterialsCache;
 	TMap<int32, USkeleton*> SkeletonsCache;
@@ -2207,6 +2285,7 @@ protected:
 	TMap<int32, UTexture2D*> TexturesCache;
 
 	TMap<int32, TArray64<uint8>> BuffersCache;
+	TMap<int32, TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe>> MappedBuffersCache;
 	TMap<int32, TArray64<uint8>> CompressedBufferViewsCache;
 	TMap<int32, int64> CompressedBufferViewsStridesCache;
 
@@ -2217,7 +2296,10 @@ protected:
 
 	TMap<TSharedRef<FJsonObject>, FglTFRuntimeMeshLOD> LODsCache;
 
+	// the GLB BIN chunk, pointing into BinaryBuffer or into BinaryBufferMappedFile
 	TArray64<uint8> BinaryBuffer;
+	TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> BinaryBufferMappedFile;
+	FglTFRuntimeBlob BinaryBufferBlob;
 
 	bool LoadMeshIntoMeshLOD(TSharedRef<FJsonObject> JsonMeshObject, FglTFRuntimeMeshLOD*& LOD, const FglTFRuntimeMaterialsConfig& MaterialsConfig);
 
@@ -2226,6 +2308,7 @@ protected:
 	bool LoadNode_Internal(int32 Index, TSharedRef<FJsonObject> JsonNodeObject, int32 NodesCount, FglTFRuntimeNode& Node);
 
 	bool LoadSkeletalAnimation_Internal(TSharedRef<FJsonObject> JsonAnimationObject, TMap<FString, FRawAnimSequenceTrack>& Tracks, TMap<FName, TArray<TPair<float, float>>>& MorphTargetCurves, float& Duration, const FglTFRuntimeSkeletalAnimationConfig& SkeletalAnimationConfig, TFunctionRef<bool(const FglTFRuntimeNode& Node)> Filter);
+	UAnimSequence* CreateSkeletalAnimationFromTracks(USkeletalMesh* SkeletalMesh, TMap<FString, FRawAnimSequenceTrack>& Tracks, TMap<FName, TArray<TPair<float, float>>>& MorphTargetCurves, const float Duration, const FglTFRuntimeSkeletalAnimationConfig& SkeletalAnimationConfig);
 
 	bool LoadAnimation_Internal(TSharedRef<FJsonObject> JsonAnimationObject, float& Duration, FString& Name, TFunctionRef<void(const FglTFRuntimeNode& Node, const FString& Path, const FglTFRuntimeAnimationCurve& Curve)> Callback, TFunctionRef<bool(const FglTFRuntimeNode& Node)> NodeFilter, const TArray<FglTFRuntimePathItem>& OverrideTrackNameFromExtension);
 
@@ -2254,7 +2337,13 @@ public:
 	bool CheckJsonIndex(TSharedRef<FJsonObject> JsonObject, const FString& FieldName, const int32 Index, TArray<TSharedRef<FJsonValue>>& JsonItems);
 	bool CheckJsonRootIndex(const FString FieldName, const int32 Index, TArray<TSharedRef<FJsonValue>>& JsonItems) { return CheckJsonIndex(Root, FieldName, Index, JsonItems); }
 	TSharedPtr<FJsonObject> GetJsonObjectFromIndex(TSharedRef<FJsonObject> JsonObject, const FString& FieldName, const int32 Index);
-	TSharedPtr<FJsonObject> GetJsonObjectFromRootIndex(const FString& FieldName, const int32 Index) { return GetJsonObjectFromIndex(Root, FieldName, Index); }
+	TSharedPtr<FJsonObject> GetJsonObjectFromRootIndex(const FString& FieldName, const int32 Index);
+	TSharedPtr<FJsonObject> GetJsonObjectFromRootIndex(const EglTFRuntimeRootArray RootArray, const int32 Index) const
+	{
+		const TArray<TSharedPtr<FJsonObject>>& JsonObjects = RootArrays[static_cast<int32>(RootArray)];
+		return JsonObjects.IsValidIndex(Index) ? JsonObjects[Index] : nullptr;
+	}
+	int32 GetRootArrayNum(const EglTFRuntimeRootArray RootArray) const { return RootArrays[static_cast<int32>(RootArray)].Num(); }
 	TSharedPtr<FJsonObject> GetJsonObjectFromExtensionIndex(TSharedRef<FJsonObject> JsonObject, const FString& ExtensionName, const FString& FieldName, const int32 Index);
 	TSharedPtr<FJsonObject> GetJsonObjectFromRootExtensionIndex(const FString& ExtensionName, const FString& FieldName, const int32 Index) { return GetJsonObjectFromExtensionIndex(Root, ExtensionName, FieldName, Index); }
 	TArray<TSharedRef<FJsonObject>> GetJsonObjectArrayFromExtension(TSharedRef<FJsonObject> JsonObject, const FString& ExtensionName, const FString& FieldName);
@@ -2276,6 +2365,8 @@ protected:
 	bool FillJsonMatrix(const TArray<TSharedPtr<FJsonValue>>* JsonMatrixValues, FMatrix& Matrix);
 
 	float FindBestFrames(const TArray<float>& FramesTimes, float WantedTime, int32& FirstIndex, int32& SecondIndex);
+	/* same as above for monotonically increasing WantedTime, Cursor (starting at 0) keeps the position of the previous lookup */
+	float FindBestFrames(const TArray<float>& FramesTimes, float WantedTime, int32& FirstIndex, int32& SecondIndex, int32& Cursor);
 
 	void NormalizeSkeletonScale(FReferenceSkeleton& RefSkeleton);
 	void NormalizeSkeletonBoneScale(FReferenceSkeletonModifier& Modifier, const int32 BoneIndex, FVector BoneScale);
@@ -2301,11 +2392,130 @@ protected:
 	TMap<EglTFRuntimeMaterialType, UMaterialInterface*> ClearCoatMaterialsMap;
 
 	TArray<FString> Errors;
+	FCriticalSection ErrorsLock;
 
 	FString BaseDirectory;
 
 	TArray64<uint8> AsBlob;
 
+	struct FglTFRuntimeAccessorIdentity
+	{
+		template<typename T>
+		FORCEINLINE T operator()(const T& InValue) const { return InValue; }
+	};
+
+	template<typename SourceType, bool bNormalized>
+	static FORCEINLINE auto DecodeAccessorComponent(const SourceType Value)
+	{
+		if constexpr (!bNormalized || TIsFloatingPoint<SourceType>::Value)
+		{
+			return Value;
+		}
+		else if constexpr (TIsSigned<SourceType>::Value)
+		{
+			return FMath::Max(static_cast<float>(Value) / static_cast<float>(TNumericLimits<SourceType>::Max()), -1.f);
+		}
+		else
+		{
+			return static_cast<float>(Value) / static_cast<float>(TNumericLimits<SourceType>::Max());
+		}
+	}
+
+	static bool IsSpecializedAccessorDecodingEnabled();
+
+	// NumElements == 0 marks a scalar destination
+	template<typename T, typename SourceType, int32 NumElements, bool bNormalized, typename Callback>
+	static void DecodeAccessorStream(const uint8* Source, const int64 Stride, const int64 Count, T* Destination, Callback& Filter)
+	{
+		constexpr int64 PackedSize = sizeof(SourceType) * (NumElements > 0 ? NumElements : 1);
+		constexpr bool bBitwise = !bNormalized && sizeof(T) == PackedSize && (TIsSame<T, SourceType>::Value || (TIsSame<T, FglTFRuntimeUInt16Vector4>::Value && TIsSame<SourceType, uint16>::Value));
+
+		if constexpr (bBitwise && TIsSame<Callback, FglTFRuntimeAccessorIdentity>::Value)
+		{
+			if (Stride == PackedSize)
+			{
+				FMemory::Memcpy(Destination, Source, Count * PackedSize);
+				return;
+			}
+		}
+
+		for (int64 ElementIndex = 0; ElementIndex < Count; ElementIndex++)
+		{
+			const SourceType* Ptr = reinterpret_cast<const SourceType*>(Source + ElementIndex * Stride);
+			T Value;
+			if constexpr (NumElements == 0)
+			{
+				Value = DecodeAccessorComponent<SourceType, bNormalized>(Ptr[0]);
+			}
+			else
+			{
+				for (int32 i = 0; i < NumElements; i++)
+				{
+					Value[i] = DecodeAccessorComponent<SourceType, bNormalized>(Ptr[i]);
+				}
+			}
+			Destination[ElementIndex] = Filter(Value);
+		}
+	}
+
+	template<typename T, int32 NumElements, typename Callback>
+	static bool DecodeAccessorStream(const int64 ComponentType, const bool bNormalized, const uint8* Source, const int64 Stride, const int64 Count, T* Destination, Callback& Filter)
+	{
+		switch (ComponentType)
+		{
+		// FLOAT
+		case 5126:
+			DecodeAccessorStream<T, float, NumElements, false>(Source, Stride, Count, Destination, Filter);
+			return true;
+		// BYTE
+		case 5120:
+			if (bNormalized)
+			{
+				DecodeAccessorStream<T, int8, NumElements, true>(Source, Stride, Count, Destination, Filter);
+			}
+			else
+			{
+				DecodeAccessorStream<T, int8, NumElements, false>(Source, Stride, Count, Destination, Filter);
+			}
+			return true;
+		// UNSIGNED_BYTE
+		case 5121:
+			if (bNormalized)
+			{
+				DecodeAccessorStream<T, uint8, NumElements, true>(Source, Stride, Count, Destination, Filter);
+			}
+			else
+			{
+				DecodeAccessorStream<T, uint8, NumElements, false>(Source, Stride, Count, Destination, Filter);
+			}
+			return true;
+		// SHORT
+		case 5122:
+			if (bNormalized)
+			{
+				DecodeAccessorStream<T, int16, NumElements, true>(Source, Stride, Count, Destination, Filter);
+			}
+			else
+			{
+				DecodeAccessorStream<T, int16, NumElements, false>(Source, Stride, Count, Destination, Filter);
+			}
+			return true;
+		// UNSIGNED_SHORT
+		case 5123:
+			if (bNormalized)
+			{
+				DecodeAccessorStream<T, uint16, NumElements, true>(Source, Stride, Count, Destination, Filter);
+			}
+			else
+			{
+				DecodeAccessorStream<T, uint16, NumElements, false>(Source, Stride, Count, Destination, Filter);
+			}
+			return true;
+		default:
+			return false;
+		}
+	}
+
 public:
 
 	FVector TransformVector(FVector Vector) const;
@@ -2356,6 +2566,32 @@ public:
 		}
 
 		Data.AddUninitialized(Count);
+
+		// the layout is fixed for the whole accessor, so select a specialized loop once instead of branching per component
+		bool bDecoded = false;
+		switch (IsSpecializedAccessorDecodingEnabled() ? Elements : 0)
+		{
+		case 1:
+			bDecoded = DecodeAccessorStream<T, 1>(ComponentType, bNormalized, Blob.Data, Stride, Count, Data.GetData(), Filter);
+			break;
+		case 2:
+			bDecoded = DecodeAccessorStream<T, 2>(ComponentType, bNormalized, Blob.Data, Stride, Count, Data.GetData(), Filter);
+			break;
+		case 3:
+			bDecoded = DecodeAccessorStream<T, 3>(ComponentType, bNormalized, Blob.Data, Stride, Count, Data.GetData(), Filter);
+			break;
+		case 4:
+			bDecoded = DecodeAccessorStream<T, 4>(ComponentType, bNormalized, Blob.Data, Stride, Count, Data.GetData(), Filter);
+			break;
+		default:
+			break;
+		}
+
+		if (bDecoded)
+		{
+			return true;
+		}
+
 		for (int64 ElementIndex = 0; ElementIndex < Count; ElementIndex++)
 		{
 			int64 Index = ElementIndex * Stride;
@@ -2452,6 +2688,12 @@ public:
 		}
 
 		Data.AddUninitialized(Count);
+
+		if (IsSpecializedAccessorDecodingEnabled() && DecodeAccessorStream<T, 0>(ComponentType, bNormalized, Blob.Data, Stride, Count, Data.GetData(), Filter))
+		{
+			return true;
+		}
+
 		for (int64 ElementIndex = 0; ElementIndex < Count; ElementIndex++)
 		{
 			int64 Index = ElementIndex * Stride;
@@ -2501,13 +2743,13 @@ public:
 	template<typename T>
 	bool BuildFromAccessorField(TSharedRef<FJsonObject> JsonObject, const FString& Name, TArray<T>& Data, const TArray<int64>& SupportedElements, const TArray<int64>& SupportedTypes, const int64 AdditionalBufferView, const bool bDefaultNormalized, int64* ComponentTypePtr)
 	{
-		return BuildFromAccessorField(JsonObject, Name, Data, SupportedElements, SupportedTypes, [&](T InValue) -> T {return InValue; }, AdditionalBufferView, bDefaultNormalized, ComponentTypePtr);
+		return BuildFromAccessorField(JsonObject, Name, Data, SupportedElements, SupportedTypes, FglTFRuntimeAccessorIdentity(), AdditionalBufferView, bDefaultNormalized, ComponentTypePtr);
 	}
 
 	template<typename T>
 	bool BuildFromAccessorField(TSharedRef<FJsonObject> JsonObject, const FString& Name, TArray<T>& Data, const TArray<int64>& SupportedTypes, const int64 AdditionalBufferView, const bool bDefaultNormalized, int64* ComponentTypePtr)
 	{
-		return BuildFromAccessorField(JsonObject, Name, Data, SupportedTypes, [&](T InValue) -> T {return InValue; }, AdditionalBufferView, bDefaultNormalized, ComponentTypePtr);
+		return BuildFromAccessorField(JsonObject, Name, Data, SupportedTypes, FglTFRuntimeAccessorIdentity(), AdditionalBufferView, bDefaultNormalized, ComponentTypePtr);
 	}
 
 	template<int32 Num, typename T>
@@ -2535,6 +2777,23 @@ protected:
 
 	TSharedPtr<FglTFRuntimeZipFile> ZipFile;
 
+	/*
+	 * MappedFile and OwnedData (both optional) tell where DataPtr comes from: in those cases the GLB BIN chunk is referenced
+	 * (from the mapping or by moving OwnedData into the parser) instead of being copied.
+	 */
+	static TSharedPtr<FglTFRuntimeParser> FromData_Internal(const uint8* DataPtr, int64 DataNum, const FglTFRuntimeConfig& LoaderConfig, TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> MappedFile, TArray64<uint8>* OwnedData);
+	static TSharedPtr<FglTFRuntimeParser> FromBinary_Internal(const uint8* DataPtr, int64 DataNum, const FglTFRuntimeConfig& LoaderConfig, TSharedPtr<FglTFRuntimeZipFile> InZipFile, TSharedPtr<FglTFRuntimeMappedFile, ESPMode::ThreadSafe> MappedFile, TArray64<uint8>* OwnedData);
+
+	void EnableDiskCache(const uint8* DataPtr, const int64 DataNum, const FglTFRuntimeConfig& LoaderConfig);
+	FString GetDiskCacheFilename(const TCHAR* Kind, const uint64 Key) const;
+	bool LoadPrimitivesFromDiskCache(const FString& Filename, const TArray<TSharedPtr<FJsonValue>>& JsonPrimitives, TArray<FglTFRuntimePrimitive>& Primitives, const FglTFRuntimeMaterialsConfig& MaterialsConfig);
+	void SavePrimitivesToDiskCache(const FString& Filename, const TArray<int32>& JsonPrimitiveIndices, TArrayView<const FglTFRuntimePrimitive> Primitives) const;
+	bool LoadMipsFromDiskCache(const FString& Filename, TArray<FglTFRuntimeMipMap>& Mips, const int32 TextureIndex);
+	void SaveMipsToDiskCache(const FString& Filename, const TArray<FglTFRuntimeMipMap>& Mips) const;
+
+	// 0 when the disk cache is disabled
+	uint64 DiskCacheContentHash = 0;
+
 	template<typename T>
 	T GetSafeValue(const TArray<T>& Values, const int32 Index, const T DefaultValue, bool& bMissing)
 	{
@@ -2568,18 +2827,16 @@ public:
 	template<typename FUNCTION>
 	void LoadAsRuntimeLODAsync(FUNCTION Function, const FglTFRuntimeMeshLODAsync& AsyncCallback)
 	{
-		Async(EAsyncExecution::Thread, [Function, AsyncCallback]()
-			{
-				FglTFRuntimeMeshLOD LOD;
-				bool bSuccess = Function(LOD);
-				FGraphEventRef Task = FFunctionGraphTask::CreateAndDispatchWhenReady([bSuccess, &LOD, AsyncCallback]()
-					{
-						AsyncCallback.ExecuteIfBound(bSuccess, bSuccess ? LOD : FglTFRuntimeMeshLOD());
-					}, TStatId(), nullptr, ENamedThreads::GameThread);
-				FTaskGraphInterface::Get().WaitUntilTaskCompletes(Task);
-			}
+		TSharedRef<TPair<bool, FglTFRuntimeMeshLOD>, ESPMode::ThreadSafe> Result = MakeShared<TPair<bool, FglTFRuntimeMeshLOD>, ESPMode::ThreadSafe>(false, FglTFRuntimeMeshLOD());
 
-		);
+		FglTFRuntimeLoaderPool::Get().Enqueue(this, 0, AsyncCallback.GetUObject(), [Function, Result]()
+			{
+				Result->Key = Function(Result->Value);
+			},
+			[Result, AsyncCallback]()
+			{
+				AsyncCallback.ExecuteIfBound(Result->Key, Result->Key ? Result->Value : FglTFRuntimeMeshLOD());
+			});
 	}
 
 	TMap<FString, TSharedPtr<FglTFRuntimePluginCacheData>> PluginsCacheData;
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CaptureFrameRing.h"
+
+FCaptureFrameRing::FCaptureFrameRing()
+	: Published(1)
+	, PublishedFrames(0)
+	, DroppedFrames(0)
+	, ReusedFrames(0)
+{
+}
+
+FCaptureFrame& FCaptureFrameRing::BeginWrite(const FIntVector2D& Size)
+{
+	FCaptureFrame& Frame = Frames[WriteIndex];
+
+	if (Frame.Size != Size)
+	{
+		Frame.Pixels.SetNumUninitialized(Size.X * Size.Y * 4);
+		Frame.Size = Size;
+	}
+
+	Frame.Regions.Reset();
+	return Frame;
+}
+
+bool FCaptureFrameRing::EndWrite()
+{
+	Frames[WriteIndex].Sequence = NextSequence++;
+
+	const uint32 Previous = Published.exchange(WriteIndex | FreshBit, std::memory_order_acq_rel);
+	WriteIndex = Previous & IndexMask;
+
+	PublishedFrames.fetch_add(1, std::memory_order_relaxed);
+
+	if (Previous & FreshBit)
+	{
+		DroppedFrames.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+const FCaptureFrame* FCaptureFrameRing::AcquireRead()
+{
+	if (!(Published.load(std::memory_order_acquire) & FreshBit))
+	{
+		ReusedFrames.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	const uint32 Previous = Published.exchange(ReadIndex, std::memory_order_acq_rel);
+	ReadIndex = Previous & IndexMask;
+
+	return &Frames[ReadIndex];
+}
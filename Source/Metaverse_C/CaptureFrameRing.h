@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "CaptureMachineProperties.h"
+#include <atomic>
+
+/**
+ * One pooled frame of the capture ring.
+ * Only the pixels covered by Regions are valid, the rest of the buffer may hold older frames.
+ */
+struct FCaptureFrame
+{
+	TArray<uint8> Pixels;
+	TArray<FUpdateTextureRegion2D> Regions;
+	FIntVector2D Size;
+	uint64 Sequence = 0;
+};
+
+/**
+ * Lock-free triple buffer between the capture thread (single writer) and the render thread (single reader).
+ * The writer always owns one frame, the reader owns one and the third is the latest published frame.
+ * Publishing and acquiring are a single atomic exchange, buffers are reused so the steady state
+ * does not allocate, and the reader never sees a frame the writer is still filling.
+ */
+class METAVERSE_C_API FCaptureFrameRing
+{
+public:
+	FCaptureFrameRing();
+
+	/** Frame the capture thread may fill. Reallocates its pixels only when Size changed. */
+	FCaptureFrame& BeginWrite(const FIntVector2D& Size);
+
+	/**
+	 * Hand the frame returned by BeginWrite to the reader.
+	 * Returns false when the previous published frame was never acquired, its regions are then lost
+	 * and the caller has to upload the whole frame next time.
+	 */
+	bool EndWrite();
+
+	/** Latest published frame for the render thread, nullptr if nothing new was published since the last call. */
+	const FCaptureFrame* AcquireRead();
+
+	int32 GetPublishedFrames() const { return PublishedFrames.load(std::memory_order_relaxed); }
+	int32 GetDroppedFrames() const { return DroppedFrames.load(std::memory_order_relaxed); }
+	int32 GetReusedFrames() const { return ReusedFrames.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr uint32 FreshBit = 4;
+	static constexpr uint32 IndexMask = 3;
+
+	FCaptureFrame Frames[3];
+
+	// Owned by the writer
+	uint32 WriteIndex = 0;
+	uint64 NextSequence = 1;
+
+	// Index of the published frame plus FreshBit while it is unread
+	std::atomic<uint32> Published;
+
+	// Owned by the reader
+	uint32 ReadIndex = 2;
+
+	std::atomic<int32> PublishedFrames;
+	std::atomic<int32> DroppedFrames;
+	std::atomic<int32> ReusedFrames;
+};
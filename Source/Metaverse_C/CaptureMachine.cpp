@@ -2,14 +2,9 @@
 
 #include "CaptureMachine.h"
 #include "Engine/Texture2D.h"
+#include "RenderingThread.h"
 #include "Async/Async.h"
-#include "Internationalization/Regex.h"
-#include "Runtime/Core/Public/HAL/RunnableThread.h"
-#include "WCWorkerThread.h"
-
-#if PLATFORM_WINDOWS
-#include <dwmapi.h>
-#endif
+#include "CaptureScheduler.h"
 
 UCaptureMachine::UCaptureMachine()
 {
@@ -17,23 +12,17 @@ UCaptureMachine::UCaptureMachine()
 
 void UCaptureMachine::Start()
 {
-#if PLATFORM_WINDOWS
-	CaptureWorkerThread = new FWCWorkerThread([this] { return DoCapture(); }, 1.0f / (float)Properties.FrameRate);
-	CaptureThread = FRunnableThread::Create(CaptureWorkerThread, TEXT("UCaptureMachine CaptureThread"));
-#endif
+	m_CaptureHandle = FCaptureScheduler::Get().Register([this] { return DoCapture(); },
+		(float)Properties.FrameRate, (float)Properties.MinFrameRate, Properties.AdaptiveFrameRate);
 }
 
 void UCaptureMachine::Stop()
 {
-#if PLATFORM_WINDOWS
-
-	if (CaptureThread)
+	if (m_CaptureHandle)
 	{
-		CaptureThread->Kill(true);
-		CaptureThread->WaitForCompletion();
-
-		delete CaptureThread;
-		CaptureThread = nullptr;
+		// Blocks until a capture in flight has finished
+		FCaptureScheduler::Get().Unregister(m_CaptureHandle);
+		m_CaptureHandle = 0;
 	}
 
 	if (TextureTarget)
@@ -41,244 +30,164 @@ void UCaptureMachine::Stop()
 		TextureTarget->ReleaseResource();
 		TextureTarget = nullptr;
 	}
-
-	if (CaptureWorkerThread)
-	{
-		delete CaptureWorkerThread;
-		CaptureWorkerThread = nullptr;
-	}
-#endif
-
 }
 
 
 void UCaptureMachine::Dispose()
 {
-#if PLATFORM_WINDOWS
-	if (m_hBmp)
+	if (m_FrameSource)
 	{
-		::DeleteObject(m_hBmp);
-		m_BitmapBuffer = nullptr;
+		m_FrameSource->Close();
+		m_FrameSource.Reset();
 	}
 
-	if (m_MemDC)
-	{
-		::DeleteDC(m_MemDC);
-		m_MemDC = nullptr;
-	}
-
-	if (m_hOriginalBmp)
-	{
-		::DeleteObject(m_hOriginalBmp);
-		m_hOriginalBmp = nullptr;
-	}
-
-	if (m_OriginalMemDC)
-	{
-		::DeleteDC(m_OriginalMemDC);
-		m_OriginalMemDC = nullptr;
-	}
-
-#endif
-
+	m_FrameRing.Reset();
 }
 
 
 bool UCaptureMachine::DoCapture()
 {
-#if PLATFORM_WINDOWS
-	if (!m_TargetWindow) return true;
-	if (!TextureTarget) return true;
+	if (!m_FrameSource) return false;
+	if (!TextureTarget) return false;
 
 	if (Properties.CheckWindowSize)
 	{
-		const FIntVector2D oldWindowSize = m_WindowSize;
-		GetWindowSize(m_TargetWindow);
-		if (m_WindowSize != oldWindowSize)
+		if (m_FrameSource->RefreshFrameSize())
 		{
 			ReCreateTexture();
 			ChangeTexture.Broadcast(TextureTarget);
 		}
 
-		if (!TextureTarget) return true;
+		if (!TextureTarget) return false;
 	}
 
-
-	if (Properties.CutShadow)
+	if (m_FrameSource->CaptureFrame())
 	{
-		::PrintWindow(m_TargetWindow, m_OriginalMemDC, 2);
-		::BitBlt(m_MemDC, 0, 0, m_WindowSize.X, m_WindowSize.Y, m_OriginalMemDC, m_WindowOffset.X, m_WindowOffset.Y, SRCCOPY);
+		return UpdateTexture();
 	}
-	else
-	{
-		::PrintWindow(m_TargetWindow, m_MemDC, 2);
-	}
-
-	UpdateTexture();
-#endif
 
-	return true;
+	return false;
 }
 
 UTexture2D* UCaptureMachine::CreateTexture()
 {
-#if PLATFORM_WINDOWS
-	m_TargetWindow = nullptr;
-
-	::EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL
-		{
-			UCaptureMachine* my = (UCaptureMachine*)lParam;
-			return my->FindTargetWindow(hwnd);
-		}, (LPARAM)this);
-
-	if (!m_TargetWindow) return nullptr;
+	m_FrameSource = IFrameSource::Create(Properties);
 
-	GetWindowSize(m_TargetWindow);
-
-	HDC foundDC = ::GetDC(m_TargetWindow);
-	m_MemDC = ::CreateCompatibleDC(foundDC);
-	if (Properties.CutShadow)
+	if (!m_FrameSource || !m_FrameSource->Open())
 	{
-		m_OriginalMemDC = ::CreateCompatibleDC(foundDC);
+		m_FrameSource.Reset();
+		return nullptr;
 	}
 
-	ReleaseDC(m_TargetWindow, foundDC);
-
+	m_FrameRing = MakeShared<FCaptureFrameRing, ESPMode::ThreadSafe>();
 	ReCreateTexture();
 
 	return TextureTarget;
-#endif
-	return nullptr;
 }
 
-bool UCaptureMachine::FindTargetWindow(HWND hWnd)
+bool UCaptureMachine::UpdateTexture()
 {
-#if PLATFORM_WINDOWS
-	__wchar_t windowTitle[1024];
-	GetWindowText(hWnd, windowTitle, 1024);
-	FString title(windowTitle);
-
-	if (title.IsEmpty()) return true;
-
-	bool isMatch = false;
+	if (!TextureTarget || !m_FrameRing) return false;
 
-	switch (Properties.TitleMatchingWindowSearch)
-	{
-	case ETitleMatchingWindowSearch::PerfectMatch:
-		isMatch = title.Equals(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
-		break;
-
-	case ETitleMatchingWindowSearch::ForwardMatch:
-		isMatch = title.StartsWith(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
-		break;
+	FTextureResource* Resource = TextureTarget->GetResource();
+	if (!Resource) return false;
 
-	case ETitleMatchingWindowSearch::PartialMatch:
-		isMatch = title.Contains(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
-		break;
+	const FIntVector2D FrameSize = m_FrameSource->GetFrameSize();
+	const int32 Pitch = m_FrameSource->GetPitch();
+	const uint8* Pixels = m_FrameSource->GetPixels();
 
-	case ETitleMatchingWindowSearch::BackwardMatch:
-		isMatch = title.EndsWith(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
-		break;
+	FCaptureFrame& Frame = m_FrameRing->BeginWrite(FrameSize);
 
-	case ETitleMatchingWindowSearch::RegularExpression:
+	if (Properties.UploadChangedTilesOnly)
 	{
-		const FRegexPattern pattern = FRegexPattern(Properties.CaptureTargetTitle);
-		FRegexMatcher matcher(pattern, title);
-
-		isMatch = matcher.FindNext();
+		m_TileDiff.Update(Pixels, Pitch, Frame.Regions);
 	}
-	break;
+	else
+	{
+		Frame.Regions.Emplace(0, 0, 0, 0, FrameSize.X, FrameSize.Y);
 	}
 
-	if (isMatch)
+	// Static frame, nothing to upload
+	if (Frame.Regions.Num() == 0)
 	{
-		m_TargetWindow = hWnd;
+		++m_StaticFrames;
 		return false;
 	}
-#endif
 
-	return true;
-}
+	// Only the changed regions are copied, the render thread never reads outside of them
+	for (const FUpdateTextureRegion2D& Region : Frame.Regions)
+	{
+		const int32 RowBytes = Region.Width * 4;
+		for (uint32 Row = 0; Row < Region.Height; ++Row)
+		{
+			const int64 Offset = static_cast<int64>(Region.SrcY + Row) * Pitch + Region.SrcX * 4;
+			FMemory::Memcpy(Frame.Pixels.GetData() + Offset, Pixels + Offset, RowBytes);
+		}
+	}
 
-void UCaptureMachine::UpdateTexture() const
-{
-#if PLATFORM_WINDOWS
-	if (!TextureTarget) return;
+	OnFrameCaptured.Broadcast(Pixels, Pitch, FrameSize, Frame.Regions);
 
-	const auto Region = new FUpdateTextureRegion2D(0, 0, 0, 0, TextureTarget->GetSizeX(), TextureTarget->GetSizeY());
-	TextureTarget->UpdateTextureRegions(0, 1, Region, 4 * TextureTarget->GetSizeX(), 4, reinterpret_cast<uint8*>(m_BitmapBuffer));
-#endif
-}
-
-void UCaptureMachine::GetWindowSize(HWND hWnd)
-{
-#if PLATFORM_WINDOWS
-	if (!::IsWindow(hWnd))
+	if (!m_FrameRing->EndWrite())
 	{
-		m_OriginalWindowSize = FIntVector2D(0, 0);
-		m_WindowSize = m_OriginalWindowSize;
-		m_WindowOffset = FIntVector2D(0, 0);
-		return;
+		// The previous frame was replaced before its regions were uploaded, resend everything with the next frame
+		m_TileDiff.Invalidate();
 	}
 
-	RECT rect;
-	::GetWindowRect(hWnd, &rect);
+	ENQUEUE_RENDER_COMMAND(UpdateCaptureTexture)(
+		[Ring = m_FrameRing, Resource, FrameSize](FRHICommandListImmediate& RHICmdList)
+		{
+			const FCaptureFrame* Latest = Ring->AcquireRead();
+			if (!Latest || Latest->Size != FrameSize) return;
+
+			FRHITexture2D* Texture = Resource->GetTexture2DRHI();
+			if (!Texture) return;
 
-	if (Properties.CutShadow)
-	{
-		RECT dwmWindowRect;
-		::DwmGetWindowAttribute(hWnd, DWMWA_EXTENDED_FRAME_BOUNDS, &dwmWindowRect, sizeof(RECT));
+			const uint32 SrcPitch = Latest->Size.X * 4;
+			for (const FUpdateTextureRegion2D& Region : Latest->Regions)
+			{
+				RHIUpdateTexture2D(Texture, 0, Region, SrcPitch, Latest->Pixels.GetData() + Region.SrcY * SrcPitch + Region.SrcX * 4);
+			}
+		});
+
+	return true;
+}
+
+FCaptureFrameStats UCaptureMachine::GetFrameStats() const
+{
+	FCaptureFrameStats Stats;
+	Stats.StaticFrames = m_StaticFrames;
 
-		m_OriginalWindowSize = FIntVector2D(rect.right - rect.left, rect.bottom - rect.top);
-		m_WindowSize = FIntVector2D(dwmWindowRect.right - dwmWindowRect.left, dwmWindowRect.bottom - dwmWindowRect.top);
-		m_WindowOffset = FIntVector2D(dwmWindowRect.left - rect.left, dwmWindowRect.top - rect.top);
+	if (m_FrameRing)
+	{
+		Stats.PublishedFrames = m_FrameRing->GetPublishedFrames();
+		Stats.DroppedFrames = m_FrameRing->GetDroppedFrames();
+		Stats.ReusedFrames = m_FrameRing->GetReusedFrames();
 	}
-	else
+
+	FCaptureSourceStats ScheduleStats;
+	if (m_CaptureHandle && FCaptureScheduler::Get().GetStats(m_CaptureHandle, ScheduleStats))
 	{
-		m_OriginalWindowSize = FIntVector2D(rect.right - rect.left, rect.bottom - rect.top);
-		m_WindowSize = m_OriginalWindowSize;
-		m_WindowOffset = FIntVector2D(0, 0);
+		Stats.FrameRate = ScheduleStats.FrameRate;
+		Stats.AverageJitterMs = ScheduleStats.AverageJitterMs;
+		Stats.MaxJitterMs = ScheduleStats.MaxJitterMs;
+		Stats.MissedDeadlines = ScheduleStats.MissedDeadlines;
 	}
-#endif
+
+	return Stats;
 }
 
 void UCaptureMachine::ReCreateTexture()
 {
-#if PLATFORM_WINDOWS
-	if (m_hBmp)
-	{
-		::DeleteObject(m_hBmp);
-		m_BitmapBuffer = nullptr;
-	}
+	const FIntVector2D FrameSize = m_FrameSource->GetFrameSize();
 
-	if (m_WindowSize.X == 0 || m_WindowSize.Y == 0)
+	if (FrameSize.X == 0 || FrameSize.Y == 0)
 	{
 		TextureTarget = nullptr;
 		return;
 	}
 
-	m_BitmapBuffer = new char[m_WindowSize.X * m_WindowSize.Y * 4];
-
-
-	TextureTarget = UTexture2D::CreateTransient(m_WindowSize.X, m_WindowSize.Y, PF_B8G8R8A8);
+	TextureTarget = UTexture2D::CreateTransient(FrameSize.X, FrameSize.Y, PF_B8G8R8A8);
 	TextureTarget->UpdateResource();
 
-	BITMAPINFO bmpInfo;
-	bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-	bmpInfo.bmiHeader.biWidth = m_WindowSize.X;
-	bmpInfo.bmiHeader.biHeight = m_WindowSize.Y;
-	bmpInfo.bmiHeader.biPlanes = 1;
-	bmpInfo.bmiHeader.biBitCount = 32;
-	bmpInfo.bmiHeader.biCompression = BI_RGB;
-
-	m_hBmp = ::CreateDIBSection(NULL, &bmpInfo, DIB_RGB_COLORS, (void**)&m_BitmapBuffer, NULL, 0);
-
-	::SelectObject(m_MemDC, m_hBmp);
-
-	if (Properties.CutShadow)
-	{
-		m_hOriginalBmp = ::CreateCompatibleBitmap(m_MemDC, m_OriginalWindowSize.X, m_OriginalWindowSize.Y);
-		::SelectObject(m_OriginalMemDC, m_hOriginalBmp);
-	}
-#endif
-}
\ No newline at end of file
+	m_TileDiff.Reset(FrameSize.X, FrameSize.Y);
+}
@@ -5,17 +5,52 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "CaptureMachineProperties.h"
-#if PLATFORM_WINDOWS
-#include "Windows/WindowsHWrapper.h"
-#include <WinUser.h>
-#else
-using HBITMAP = void*;
-using HDC = void*;
-using HWND = void*;
-#endif
+#include "CaptureTileDiff.h"
+#include "FrameSource.h"
+#include "CaptureFrameRing.h"
 #include "CaptureMachine.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCaptureMachineChangeTexture, UTexture2D*, NewTexture);
+
+// Broadcast on the capture thread with the pixels and changed regions of every published frame
+DECLARE_MULTICAST_DELEGATE_FourParams(FCaptureMachineFrameCaptured, const uint8* /*Pixels*/, int32 /*Pitch*/, const FIntVector2D& /*Size*/, const TArray<FUpdateTextureRegion2D>& /*Regions*/);
+
+USTRUCT(BlueprintType)
+struct METAVERSE_C_API FCaptureFrameStats
+{
+	GENERATED_BODY()
+
+	// Frames handed from the capture thread to the render thread
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	int32 PublishedFrames = 0;
+
+	// Published frames replaced by a newer one before the render thread uploaded them
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	int32 DroppedFrames = 0;
+
+	// Render thread uploads that found no new frame and kept the current texture
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	int32 ReusedFrames = 0;
+
+	// Captured frames without any changed tile, never published
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	int32 StaticFrames = 0;
+
+	// Current capture rate, lower than Properties.FrameRate while adaptive rate throttles static content
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	float FrameRate = 0.0f;
+
+	// How late captures start relative to their scheduled time
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	float AverageJitterMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	float MaxJitterMs = 0.0f;
+
+	// Capture deadlines skipped because the previous capture overran
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	int32 MissedDeadlines = 0;
+};
 /**
  * 
  */
@@ -35,9 +70,7 @@ public:
 	UTexture2D* CreateTexture();
 
 protected:
-	bool FindTargetWindow(HWND hWnd);
-	void UpdateTexture() const;
-	void GetWindowSize(HWND hWnd);
+	bool UpdateTexture();
 	void ReCreateTexture();
 	bool DoCapture();
 
@@ -52,20 +85,22 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = SceneCapture)
 	FCaptureMachineChangeTexture ChangeTexture;
 
+	UFUNCTION(BlueprintPure, Category = WindowCapture2D)
+	FCaptureFrameStats GetFrameStats() const;
+
+	// Bind before Start and unbind after Stop, it is invoked from the capture thread
+	FCaptureMachineFrameCaptured OnFrameCaptured;
+
 private:
-	char* m_BitmapBuffer = nullptr;
+	TUniquePtr<IFrameSource> m_FrameSource;
 
-	HBITMAP m_hBmp = nullptr;
-	HDC m_MemDC = nullptr;
-	HBITMAP m_hOriginalBmp = nullptr;
-	HDC m_OriginalMemDC = nullptr;
-	HWND m_TargetWindow = nullptr;
+	FCaptureTileDiff m_TileDiff;
 
-	FIntVector2D m_WindowSize;
-	FIntVector2D m_OriginalWindowSize;
-	FIntVector2D m_WindowOffset;
+	// Shared with in-flight render commands, which may outlive this object
+	TSharedPtr<FCaptureFrameRing, ESPMode::ThreadSafe> m_FrameRing;
+	std::atomic<int32> m_StaticFrames{ 0 };
 
-	class FWCWorkerThread* CaptureWorkerThread = nullptr;
-	class FRunnableThread* CaptureThread = nullptr;
+	// Registration with FCaptureScheduler, 0 while stopped
+	uint32 m_CaptureHandle = 0;
 	
 };
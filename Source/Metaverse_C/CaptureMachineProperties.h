@@ -21,7 +21,7 @@ struct FIntVector2D
 	{
 	}
 
-	bool operator != (const FIntVector2D& obj)
+	bool operator != (const FIntVector2D& obj) const
 	{
 		return X != obj.X || Y != obj.Y;
 	}
@@ -36,6 +36,17 @@ enum class ETitleMatchingWindowSearch : uint8
 	BackwardMatch,
 	RegularExpression
 };
+
+UENUM(BlueprintType)
+enum class ECaptureFrameSource : uint8
+{
+	// Desktop window, GDI on Windows and X11 on Linux
+	Window,
+	// Directory of images or a raw BGRA8 frame file
+	ImageSequence,
+	// Generated test pattern
+	Synthetic
+};
 /**
  * 
  */
@@ -47,6 +58,9 @@ struct METAVERSE_C_API FCaptureMachineProperties
 public:
 	GENERATED_BODY()
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	ECaptureFrameSource FrameSource = ECaptureFrameSource::Window;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
 	FString CaptureTargetTitle = TEXT("WindowCapture2D");
 
@@ -56,10 +70,30 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
 	int32 FrameRate = 30;
 
+	// Lower the capture rate step by step while the content is static, back to FrameRate on the first change
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	bool AdaptiveFrameRate = true;
+
+	// Floor of the adaptive capture rate
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	int32 MinFrameRate = 5;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
 	bool CheckWindowSize = false;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
 	bool CutShadow = true;
+
+	// Only upload the 64x64 tiles that changed since the previous frame, static frames skip the upload
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	bool UploadChangedTilesOnly = true;
+
+	// Image directory or raw BGRA8 frame file used by the ImageSequence frame source
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	FString ImageSequencePath;
+
+	// Frame size of the Synthetic frame source and of raw frame files
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	FIntPoint SyntheticFrameSize = FIntPoint(1920, 1080);
 	
 };
@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CaptureScheduler.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+namespace CaptureScheduler
+{
+	// Waits shorter than this are spent yielding instead of on the event, whose timeout has 1 ms granularity
+	constexpr double SpinThresholdSeconds = 0.002;
+
+	// Static content for this long halves the rate of an adaptive source
+	constexpr double StaticSecondsBeforeSlowdown = 0.5;
+
+	constexpr int32 MaxWorkers = 4;
+}
+
+FCaptureScheduler& FCaptureScheduler::Get()
+{
+	static FCaptureScheduler Instance;
+	return Instance;
+}
+
+FCaptureScheduler::FCaptureScheduler()
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FCaptureScheduler::~FCaptureScheduler()
+{
+	StopWorkers();
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+uint32 FCaptureScheduler::Register(TFunction<bool()> Work, float FrameRate, float MinFrameRate, bool bAdaptive)
+{
+	TSharedPtr<FSource> Source = MakeShared<FSource>();
+	Source->Work = MoveTemp(Work);
+	Source->BaseInterval = 1.0 / FMath::Max(FrameRate, 1.0f);
+	Source->MaxInterval = FMath::Max(Source->BaseInterval, 1.0 / FMath::Max(MinFrameRate, 1.0f));
+	Source->Interval = Source->BaseInterval;
+	Source->bAdaptive = bAdaptive;
+	Source->NextDeadline = FPlatformTime::Seconds();
+
+	bool bFirstSource = false;
+	{
+		FScopeLock Lock(&Mutex);
+		Source->Handle = NextHandle++;
+		Sources.Add(Source);
+		bFirstSource = Sources.Num() == 1;
+	}
+
+	if (bFirstSource)
+	{
+		StartWorkers();
+	}
+
+	WakeEvent->Trigger();
+	return Source->Handle;
+}
+
+void FCaptureScheduler::Unregister(uint32 Handle)
+{
+	TSharedPtr<FSource> Source;
+	{
+		FScopeLock Lock(&Mutex);
+		for (const TSharedPtr<FSource>& Candidate : Sources)
+		{
+			if (Candidate->Handle == Handle)
+			{
+				Source = Candidate;
+				Source->bRemoved = true;
+				break;
+			}
+		}
+	}
+
+	if (!Source) return;
+
+	bool bLastSource = false;
+	for (;;)
+	{
+		{
+			FScopeLock Lock(&Mutex);
+			if (!Source->bRunning)
+			{
+				Sources.Remove(Source);
+				bLastSource = Sources.Num() == 0;
+				break;
+			}
+		}
+
+		FPlatformProcess::SleepNoStats(0.0001f);
+	}
+
+	if (bLastSource)
+	{
+		StopWorkers();
+	}
+}
+
+bool FCaptureScheduler::GetStats(uint32 Handle, FCaptureSourceStats& OutStats) const
+{
+	FScopeLock Lock(&Mutex);
+	for (const TSharedPtr<FSource>& Source : Sources)
+	{
+		if (Source->Handle == Handle)
+		{
+			OutStats.FrameRate = static_cast<float>(1.0 / Source->Interval);
+			OutStats.AverageJitterMs = Source->Captures > 0 ? static_cast<float>(Source->JitterSum / Source->Captures * 1000.0) : 0.0f;
+			OutStats.MaxJitterMs = static_cast<float>(Source->JitterMax * 1000.0);
+			OutStats.MissedDeadlines = Source->MissedDeadlines;
+			OutStats.Captures = Source->Captures;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FCaptureScheduler::StartWorkers()
+{
+	if (Threads.Num() > 0) return;
+
+	const int32 NumWorkers = FMath::Clamp(FPlatformMisc::NumberOfCores() / 4, 1, CaptureScheduler::MaxWorkers);
+	for (int32 Index = 0; Index < NumWorkers; ++Index)
+	{
+		FWorker* Worker = Workers.Emplace_GetRef(MakeUnique<FWorker>(*this)).Get();
+		Threads.Emplace(FRunnableThread::Create(Worker, *FString::Printf(TEXT("CaptureScheduler Worker %d"), Index)));
+	}
+}
+
+void FCaptureScheduler::StopWorkers()
+{
+	for (const TUniquePtr<FWorker>& Worker : Workers)
+	{
+		Worker->Stop();
+		WakeEvent->Trigger();
+	}
+
+	// Without sources a worker sleeps at most 100 ms, so a missed trigger only delays the join
+	for (const TUniquePtr<FRunnableThread>& Thread : Threads)
+	{
+		Thread->Kill(true);
+	}
+
+	Threads.Empty();
+	Workers.Empty();
+}
+
+uint32 FCaptureScheduler::FWorker::Run()
+{
+	while (!bStopping)
+	{
+		Owner.Step(*this);
+	}
+
+	return 0;
+}
+
+void FCaptureScheduler::Step(const FWorker& Worker)
+{
+	TSharedPtr<FSource> Due;
+	double WaitSeconds = 0.1;
+
+	{
+		FScopeLock Lock(&Mutex);
+
+		double Earliest = TNumericLimits<double>::Max();
+		for (const TSharedPtr<FSource>& Source : Sources)
+		{
+			if (!Source->bRunning && !Source->bRemoved && Source->NextDeadline < Earliest)
+			{
+				Earliest = Source->NextDeadline;
+				Due = Source;
+			}
+		}
+
+		if (Due)
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (Earliest > Now)
+			{
+				WaitSeconds = Earliest - Now;
+				Due.Reset();
+			}
+			else
+			{
+				const double Lateness = Now - Earliest;
+				Due->bRunning = true;
+				Due->JitterSum += Lateness;
+				Due->JitterMax = FMath::Max(Due->JitterMax, Lateness);
+				++Due->Captures;
+			}
+		}
+	}
+
+	if (!Due)
+	{
+		if (Worker.bStopping) return;
+
+		if (WaitSeconds > CaptureScheduler::SpinThresholdSeconds)
+		{
+			// Wake up a little early, the remainder is covered by yielding for precision
+			WakeEvent->Wait(static_cast<uint32>((WaitSeconds - 0.001) * 1000.0));
+		}
+		else
+		{
+			FPlatformProcess::SleepNoStats(0.0f);
+		}
+		return;
+	}
+
+	const bool bChanged = Due->Work();
+
+	{
+		FScopeLock Lock(&Mutex);
+		Due->bRunning = false;
+
+		if (Due->bAdaptive)
+		{
+			if (bChanged)
+			{
+				Due->Interval = Due->BaseInterval;
+				Due->StaticCaptures = 0;
+			}
+			else if (++Due->StaticCaptures * Due->Interval >= CaptureScheduler::StaticSecondsBeforeSlowdown)
+			{
+				Due->Interval = FMath::Min(Due->Interval * 2.0, Due->MaxInterval);
+				Due->StaticCaptures = 0;
+			}
+		}
+
+		// Advance from the previous deadline, not from now, so capture cost does not accumulate as drift
+		const double Now = FPlatformTime::Seconds();
+		Due->NextDeadline += Due->Interval;
+		if (Due->NextDeadline <= Now)
+		{
+			const int32 Missed = FMath::FloorToInt((Now - Due->NextDeadline) / Due->Interval) + 1;
+			Due->MissedDeadlines += Missed;
+			Due->NextDeadline += Missed * Due->Interval;
+		}
+	}
+
+	WakeEvent->Trigger();
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+
+struct FCaptureSourceStats
+{
+	// Current, possibly lowered, capture rate
+	float FrameRate = 0.0f;
+
+	// How late captures started relative to their deadline
+	float AverageJitterMs = 0.0f;
+	float MaxJitterMs = 0.0f;
+
+	// Deadlines skipped because the previous capture ran past them
+	int32 MissedDeadlines = 0;
+	int32 Captures = 0;
+};
+
+/**
+ * Runs the captures of every UCaptureMachine on a small shared pool of threads.
+ * Deadlines are taken from the monotonic platform clock and advanced by a fixed interval, so
+ * the rate does not drift with capture cost. With AdaptiveFrameRate a source that keeps
+ * reporting static frames is slowed down step by step to its minimum rate and goes back to
+ * its full rate on the first changed frame.
+ */
+class METAVERSE_C_API FCaptureScheduler
+{
+public:
+	static FCaptureScheduler& Get();
+
+	~FCaptureScheduler();
+
+	/**
+	 * Add a capture source.
+	 * @param Work          captures one frame, returns true when the frame changed
+	 * @param FrameRate     target rate
+	 * @param MinFrameRate  lowest rate used for static content, only with bAdaptive
+	 * @return handle for Unregister and GetStats
+	 */
+	uint32 Register(TFunction<bool()> Work, float FrameRate, float MinFrameRate, bool bAdaptive);
+
+	/** Remove a source. Blocks while its Work is running, so the caller can free what Work uses afterwards. */
+	void Unregister(uint32 Handle);
+
+	bool GetStats(uint32 Handle, FCaptureSourceStats& OutStats) const;
+
+private:
+	struct FSource
+	{
+		uint32 Handle = 0;
+		TFunction<bool()> Work;
+		double BaseInterval = 0.0;
+		double MaxInterval = 0.0;
+		double Interval = 0.0;
+		bool bAdaptive = false;
+		double NextDeadline = 0.0;
+		int32 StaticCaptures = 0;
+		bool bRunning = false;
+		bool bRemoved = false;
+
+		double JitterSum = 0.0;
+		double JitterMax = 0.0;
+		int32 MissedDeadlines = 0;
+		int32 Captures = 0;
+	};
+
+	class FWorker : public FRunnable
+	{
+	public:
+		FWorker(FCaptureScheduler& InOwner) : Owner(InOwner) {}
+
+		virtual uint32 Run() override;
+		virtual void Stop() override { bStopping = true; }
+
+		volatile bool bStopping = false;
+
+	private:
+		FCaptureScheduler& Owner;
+	};
+
+	FCaptureScheduler();
+
+	/** One scheduling step of a worker: wait for the earliest deadline or run the due source. */
+	void Step(const FWorker& Worker);
+
+	void StartWorkers();
+	void StopWorkers();
+
+	mutable FCriticalSection Mutex;
+	TArray<TSharedPtr<FSource>> Sources;
+	uint32 NextHandle = 1;
+
+	FEvent* WakeEvent = nullptr;
+	TArray<TUniquePtr<FWorker>> Workers;
+	TArray<TUniquePtr<FRunnableThread>> Threads;
+};
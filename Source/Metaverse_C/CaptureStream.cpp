@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CaptureStream.h"
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
+#include "Modules/ModuleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+FCaptureStreamEncoder::FCaptureStreamEncoder(int32 InQuality)
+	: Quality(FMath::Clamp(InQuality, 1, 100))
+{
+}
+
+void FCaptureStreamEncoder::Reset(const FIntVector2D& Size)
+{
+	Info.Width = Size.X;
+	Info.Height = Size.Y;
+	++Info.Generation;
+
+	TilesX = FMath::DivideAndRoundUp(Size.X, TileSize);
+	TilesY = FMath::DivideAndRoundUp(Size.Y, TileSize);
+
+	Snapshot.SetNumUninitialized(Size.X * Size.Y * 4);
+	DirtyTiles.Init(false, TilesX * TilesY);
+	Tiles.Reset();
+	Tiles.SetNum(TilesX * TilesY);
+}
+
+void FCaptureStreamEncoder::OnFrame(const uint8* Pixels, int32 Pitch, const FIntVector2D& Size, const TArray<FUpdateTextureRegion2D>& Regions)
+{
+	bool bStartEncoding = false;
+	{
+		FScopeLock Lock(&Mutex);
+
+		if (Size.X != Info.Width || Size.Y != Info.Height)
+		{
+			Reset(Size);
+		}
+
+		for (const FUpdateTextureRegion2D& Region : Regions)
+		{
+			for (uint32 Row = 0; Row < Region.Height; ++Row)
+			{
+				const int64 Offset = static_cast<int64>(Region.SrcY + Row) * Pitch + Region.SrcX * 4;
+				FMemory::Memcpy(Snapshot.GetData() + Offset, Pixels + Offset, Region.Width * 4);
+			}
+
+			// Regions come from FCaptureTileDiff and are aligned to the same 64 pixel grid
+			const int32 MinTileX = Region.DestX / TileSize;
+			const int32 MinTileY = Region.DestY / TileSize;
+			const int32 MaxTileX = FMath::DivideAndRoundUp<int32>(Region.DestX + Region.Width, TileSize);
+			const int32 MaxTileY = FMath::DivideAndRoundUp<int32>(Region.DestY + Region.Height, TileSize);
+			for (int32 TileY = MinTileY; TileY < MaxTileY; ++TileY)
+			{
+				for (int32 TileX = MinTileX; TileX < MaxTileX; ++TileX)
+				{
+					DirtyTiles[TileY * TilesX + TileX] = true;
+				}
+			}
+		}
+
+		if (!bEncoding && Regions.Num() > 0)
+		{
+			bEncoding = true;
+			bStartEncoding = true;
+		}
+	}
+
+	if (bStartEncoding)
+	{
+		// One encode task per stream at a time, frames arriving meanwhile only add dirty tiles
+		Async(EAsyncExecution::ThreadPool, [Encoder = AsShared()]()
+			{
+				Encoder->EncodeDirtyTiles();
+			});
+	}
+}
+
+void FCaptureStreamEncoder::EncodeDirtyTiles()
+{
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+
+	TArray<uint8> TilePixels;
+	TilePixels.SetNumUninitialized(TileSize * TileSize * 4);
+
+	for (;;)
+	{
+		int32 TileIndex = INDEX_NONE;
+		int32 Generation = 0;
+		int32 TileWidth = 0;
+		int32 TileHeight = 0;
+		{
+			FScopeLock Lock(&Mutex);
+
+			TileIndex = DirtyTiles.Find(true);
+			if (TileIndex == INDEX_NONE)
+			{
+				bEncoding = false;
+				return;
+			}
+			DirtyTiles[TileIndex] = false;
+
+			const int32 PixelX = (TileIndex % TilesX) * TileSize;
+			const int32 PixelY = (TileIndex / TilesX) * TileSize;
+			TileWidth = FMath::Min(TileSize, Info.Width - PixelX);
+			TileHeight = FMath::Min(TileSize, Info.Height - PixelY);
+			Generation = Info.Generation;
+
+			const int32 Pitch = Info.Width * 4;
+			for (int32 Row = 0; Row < TileHeight; ++Row)
+			{
+				FMemory::Memcpy(TilePixels.GetData() + Row * TileWidth * 4, Snapshot.GetData() + static_cast<int64>(PixelY + Row) * Pitch + PixelX * 4, TileWidth * 4);
+			}
+		}
+
+		if (!ImageWrapper.IsValid() || !ImageWrapper->SetRaw(TilePixels.GetData(), TileWidth * TileHeight * 4, TileWidth, TileHeight, ERGBFormat::BGRA, 8))
+		{
+			continue;
+		}
+
+		TArray64<uint8> Jpeg = ImageWrapper->GetCompressed(Quality);
+
+		FScopeLock Lock(&Mutex);
+		if (Generation == Info.Generation && Tiles.IsValidIndex(TileIndex))
+		{
+			FTile& Tile = Tiles[TileIndex];
+			Tile.Version = NextVersion++;
+			Tile.Jpeg = TArray<uint8>(Jpeg.GetData(), Jpeg.Num());
+		}
+	}
+}
+
+FCaptureStreamInfo FCaptureStreamEncoder::GetInfo() const
+{
+	FScopeLock Lock(&Mutex);
+	return Info;
+}
+
+int32 FCaptureStreamEncoder::GetNumTiles() const
+{
+	FScopeLock Lock(&Mutex);
+	return Tiles.Num();
+}
+
+bool FCaptureStreamEncoder::GetTile(int32 TileIndex, uint32 KnownVersion, FTile& OutTile) const
+{
+	FScopeLock Lock(&Mutex);
+	if (!Tiles.IsValidIndex(TileIndex) || Tiles[TileIndex].Version <= KnownVersion)
+	{
+		return false;
+	}
+
+	OutTile = Tiles[TileIndex];
+	return true;
+}
+
+void FCaptureStreamEncoder::GetTileVersions(TArray<uint32>& OutVersions) const
+{
+	FScopeLock Lock(&Mutex);
+	OutVersions.SetNumUninitialized(Tiles.Num());
+	for (int32 Index = 0; Index < Tiles.Num(); ++Index)
+	{
+		OutVersions[Index] = Tiles[Index].Version;
+	}
+}
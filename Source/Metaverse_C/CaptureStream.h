@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "CaptureMachineProperties.h"
+#include "CaptureStream.generated.h"
+
+/** Size and generation of a capture stream, the generation changes whenever the tile grid is rebuilt. */
+USTRUCT(BlueprintType)
+struct METAVERSE_C_API FCaptureStreamInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	int32 Width = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = WindowCapture2D)
+	int32 Height = 0;
+
+	UPROPERTY()
+	int32 Generation = 0;
+};
+
+/** Part of one JPEG encoded tile, sized to fit a single packet of the connection. */
+USTRUCT()
+struct METAVERSE_C_API FCaptureStreamChunk
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Generation = 0;
+
+	UPROPERTY()
+	uint16 TileIndex = 0;
+
+	UPROPERTY()
+	uint32 Version = 0;
+
+	UPROPERTY()
+	uint8 ChunkIndex = 0;
+
+	UPROPERTY()
+	uint8 ChunkCount = 0;
+
+	UPROPERTY()
+	TArray<uint8> Data;
+};
+
+/** Client confirmation that a tile version was fully received. */
+USTRUCT()
+struct METAVERSE_C_API FCaptureStreamAck
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Generation = 0;
+
+	UPROPERTY()
+	uint16 TileIndex = 0;
+
+	UPROPERTY()
+	uint32 Version = 0;
+};
+
+/**
+ * Server side JPEG tile encoder of a capture stream.
+ * The capture thread feeds changed regions, a single background task encodes the dirty tiles of
+ * the newest frame and keeps the latest encoded bytes of every tile. Senders read that cache, so
+ * a late joiner gets a complete keyframe from the cache without any re-encoding.
+ */
+class METAVERSE_C_API FCaptureStreamEncoder : public TSharedFromThis<FCaptureStreamEncoder, ESPMode::ThreadSafe>
+{
+public:
+	static constexpr int32 TileSize = 64;
+
+	struct FTile
+	{
+		uint32 Version = 0;
+		TArray<uint8> Jpeg;
+	};
+
+	FCaptureStreamEncoder(int32 InQuality);
+
+	/** Capture thread: copy the changed regions of a frame and schedule encoding. */
+	void OnFrame(const uint8* Pixels, int32 Pitch, const FIntVector2D& Size, const TArray<FUpdateTextureRegion2D>& Regions);
+
+	FCaptureStreamInfo GetInfo() const;
+	int32 GetNumTiles() const;
+
+	/** Copies the tile if its version is newer than KnownVersion. */
+	bool GetTile(int32 TileIndex, uint32 KnownVersion, FTile& OutTile) const;
+
+	/** Versions of all tiles, 0 for tiles not encoded yet. */
+	void GetTileVersions(TArray<uint32>& OutVersions) const;
+
+private:
+	void Reset(const FIntVector2D& Size);
+	void EncodeDirtyTiles();
+
+	const int32 Quality;
+
+	mutable FCriticalSection Mutex;
+	FCaptureStreamInfo Info;
+	int32 TilesX = 0;
+	int32 TilesY = 0;
+	TArray<uint8> Snapshot;
+	TBitArray<> DirtyTiles;
+	TArray<FTile> Tiles;
+	uint32 NextVersion = 1;
+	bool bEncoding = false;
+};
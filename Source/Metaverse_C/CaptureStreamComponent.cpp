@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CaptureStreamComponent.h"
+#include "CaptureMachine.h"
+#include "CaptureStreamReceiverComponent.h"
+#include "Async/Async.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Modules/ModuleManager.h"
+#include "Net/UnrealNetwork.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+UCaptureStreamComponent::UCaptureStreamComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	SetIsReplicatedByDefault(true);
+}
+
+void UCaptureStreamComponent::GetLifetimeReplicatedProps(TArray< FLifetimeProperty >& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(UCaptureStreamComponent, StreamInfo);
+}
+
+void UCaptureStreamComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopStreaming();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCaptureStreamComponent::StartStreaming(UCaptureMachine* Machine)
+{
+	StopStreaming();
+
+	if (!Machine || !GetOwner() || !GetOwner()->HasAuthority()) return;
+
+	Encoder = MakeShared<FCaptureStreamEncoder, ESPMode::ThreadSafe>(JpegQuality);
+	StreamedMachine = Machine;
+
+	FrameCapturedHandle = Machine->OnFrameCaptured.AddLambda(
+		[WeakEncoder = TWeakPtr<FCaptureStreamEncoder, ESPMode::ThreadSafe>(Encoder)](const uint8* Pixels, int32 Pitch, const FIntVector2D& Size, const TArray<FUpdateTextureRegion2D>& Regions)
+		{
+			if (TSharedPtr<FCaptureStreamEncoder, ESPMode::ThreadSafe> PinnedEncoder = WeakEncoder.Pin())
+			{
+				PinnedEncoder->OnFrame(Pixels, Pitch, Size, Regions);
+			}
+		});
+}
+
+void UCaptureStreamComponent::StopStreaming()
+{
+	if (StreamedMachine)
+	{
+		StreamedMachine->OnFrameCaptured.Remove(FrameCapturedHandle);
+		StreamedMachine = nullptr;
+	}
+
+	FrameCapturedHandle.Reset();
+	Encoder.Reset();
+}
+
+void UCaptureStreamComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!Encoder || !GetOwner()->HasAuthority()) return;
+
+	const FCaptureStreamInfo EncoderInfo = Encoder->GetInfo();
+	if (EncoderInfo.Generation != StreamInfo.Generation)
+	{
+		StreamInfo = EncoderInfo;
+	}
+
+	if (StreamInfo.Generation == 0) return;
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		APlayerController* PlayerController = Iterator->Get();
+
+		// The listening host already shows the captured texture itself
+		if (!PlayerController || PlayerController->IsLocalController() || !PlayerController->GetNetConnection()) continue;
+
+		UCaptureStreamReceiverComponent::FindOrAdd(PlayerController)->AddStream(this);
+	}
+}
+
+void UCaptureStreamComponent::OnRep_StreamInfo()
+{
+	ReceivedVersions.Reset();
+
+	if (StreamInfo.Width <= 0 || StreamInfo.Height <= 0)
+	{
+		StreamTexture = nullptr;
+		StreamTextureChanged.Broadcast(nullptr);
+		return;
+	}
+
+	ReceivedVersions.SetNumZeroed(FMath::DivideAndRoundUp(StreamInfo.Width, FCaptureStreamEncoder::TileSize) * FMath::DivideAndRoundUp(StreamInfo.Height, FCaptureStreamEncoder::TileSize));
+
+	StreamTexture = UTexture2D::CreateTransient(StreamInfo.Width, StreamInfo.Height, PF_B8G8R8A8);
+	StreamTexture->UpdateResource();
+
+	StreamTextureChanged.Broadcast(StreamTexture);
+}
+
+uint32 UCaptureStreamComponent::GetReceivedVersion(int32 TileIndex) const
+{
+	return ReceivedVersions.IsValidIndex(TileIndex) ? ReceivedVersions[TileIndex] : 0;
+}
+
+bool UCaptureStreamComponent::ReceiveTile(int32 Generation, int32 TileIndex, uint32 Version, TArray<uint8>&& Jpeg)
+{
+	if (Generation != StreamInfo.Generation || !ReceivedVersions.IsValidIndex(TileIndex) || Version <= ReceivedVersions[TileIndex])
+	{
+		return false;
+	}
+
+	ReceivedVersions[TileIndex] = Version;
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis = TWeakObjectPtr<UCaptureStreamComponent>(this), Generation, TileIndex, Version, Jpeg = MoveTemp(Jpeg)]() mutable
+		{
+			IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+			TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+
+			TArray64<uint8> Raw;
+			if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(Jpeg.GetData(), Jpeg.Num()) || !ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, Raw))
+			{
+				return;
+			}
+
+			const int32 Width = ImageWrapper->GetWidth();
+			const int32 Height = ImageWrapper->GetHeight();
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Generation, TileIndex, Version, Pixels = TArray<uint8>(Raw.GetData(), Raw.Num()), Width, Height]() mutable
+				{
+					UCaptureStreamComponent* This = WeakThis.Get();
+
+					// Skip tiles superseded while they were decoding
+					if (This && This->StreamInfo.Generation == Generation && This->GetReceivedVersion(TileIndex) == Version)
+					{
+						This->UploadTile(TileIndex, MoveTemp(Pixels), Width, Height);
+					}
+				});
+		});
+
+	return true;
+}
+
+void UCaptureStreamComponent::UploadTile(int32 TileIndex, TArray<uint8>&& Pixels, int32 Width, int32 Height)
+{
+	if (!StreamTexture) return;
+
+	const int32 TilesX = FMath::DivideAndRoundUp(StreamInfo.Width, FCaptureStreamEncoder::TileSize);
+	const int32 DestX = (TileIndex % TilesX) * FCaptureStreamEncoder::TileSize;
+	const int32 DestY = (TileIndex / TilesX) * FCaptureStreamEncoder::TileSize;
+	if (DestX + Width > StreamInfo.Width || DestY + Height > StreamInfo.Height) return;
+
+	// Ownership of the decoded pixels moves to the render command, the cleanup callback frees them
+	TArray<uint8>* Data = new TArray<uint8>(MoveTemp(Pixels));
+
+	StreamTexture->UpdateTextureRegions(0, 1, new FUpdateTextureRegion2D(DestX, DestY, 0, 0, Width, Height), Width * 4, 4, Data->GetData(),
+		[Data](uint8*, const FUpdateTextureRegion2D* InRegion)
+		{
+			delete Data;
+			delete InRegion;
+		});
+}
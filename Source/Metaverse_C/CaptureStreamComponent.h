@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CaptureStream.h"
+#include "CaptureStreamComponent.generated.h"
+
+class UCaptureMachine;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCaptureStreamTextureChanged, UTexture2D*, NewTexture);
+
+/**
+ * Streams the frames of a UCaptureMachine from the server to every client.
+ * On the server the component encodes changed tiles and hands them to the
+ * UCaptureStreamReceiverComponent of each remote player controller, which sends them within the
+ * connection's bandwidth budget. On clients it decodes received tiles into StreamTexture.
+ */
+UCLASS(ClassGroup = WindowCapture2D, meta = (BlueprintSpawnableComponent))
+class METAVERSE_C_API UCaptureStreamComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCaptureStreamComponent();
+
+	virtual void GetLifetimeReplicatedProps(TArray< FLifetimeProperty >& OutLifetimeProps) const override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Server: start streaming the frames of Machine. Call before Machine->Start(). */
+	void StartStreaming(UCaptureMachine* Machine);
+
+	/** Server: stop streaming. Call after Machine->Stop(). */
+	void StopStreaming();
+
+	/** Client: a tile was fully received. Returns false if it is outdated. */
+	bool ReceiveTile(int32 Generation, int32 TileIndex, uint32 Version, TArray<uint8>&& Jpeg);
+
+	/** Client: latest tile version received. */
+	uint32 GetReceivedVersion(int32 TileIndex) const;
+
+	const TSharedPtr<FCaptureStreamEncoder, ESPMode::ThreadSafe>& GetEncoder() const { return Encoder; }
+	const FCaptureStreamInfo& GetStreamInfo() const { return StreamInfo; }
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	int32 JpegQuality = 70;
+
+	// Upper bound of stream data sent to a single client, shared with the other streams sent to it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	int32 MaxBytesPerSecondPerConnection = 256 * 1024;
+
+	// Tiles that were sent but not acknowledged within this time are sent again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
+	float ResendTimeoutSeconds = 0.5f;
+
+	UPROPERTY(BlueprintReadOnly, Transient, Category = WindowCapture2D)
+	UTexture2D* StreamTexture = nullptr;
+
+	UPROPERTY(BlueprintAssignable, Category = WindowCapture2D)
+	FCaptureStreamTextureChanged StreamTextureChanged;
+
+protected:
+	UFUNCTION()
+	void OnRep_StreamInfo();
+
+	UPROPERTY(ReplicatedUsing = OnRep_StreamInfo)
+	FCaptureStreamInfo StreamInfo;
+
+private:
+	void UploadTile(int32 TileIndex, TArray<uint8>&& Pixels, int32 Width, int32 Height);
+
+	TSharedPtr<FCaptureStreamEncoder, ESPMode::ThreadSafe> Encoder;
+
+	UPROPERTY(Transient)
+	UCaptureMachine* StreamedMachine = nullptr;
+
+	FDelegateHandle FrameCapturedHandle;
+
+	TArray<uint32> ReceivedVersions;
+};
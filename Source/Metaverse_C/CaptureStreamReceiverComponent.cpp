@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CaptureStreamReceiverComponent.h"
+#include "CaptureStreamComponent.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformTime.h"
+
+namespace CaptureStreamReceiver
+{
+	// Room left in a packet for bunch, RPC and chunk headers
+	constexpr int32 ChunkOverheadBytes = 96;
+	constexpr int32 MinChunkPayload = 256;
+
+	// Unused budget is capped so an idle connection cannot burst far above its rate
+	constexpr double MaxBurstSeconds = 0.1;
+
+	constexpr int32 MaxAcksPerRPC = 64;
+}
+
+UCaptureStreamReceiverComponent::UCaptureStreamReceiverComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	SetIsReplicatedByDefault(true);
+}
+
+UCaptureStreamReceiverComponent* UCaptureStreamReceiverComponent::FindOrAdd(APlayerController* PlayerController)
+{
+	UCaptureStreamReceiverComponent* Receiver = PlayerController->FindComponentByClass<UCaptureStreamReceiverComponent>();
+	if (!Receiver)
+	{
+		Receiver = NewObject<UCaptureStreamReceiverComponent>(PlayerController, TEXT("CaptureStreamReceiver"));
+		Receiver->RegisterComponent();
+	}
+
+	return Receiver;
+}
+
+void UCaptureStreamReceiverComponent::AddStream(UCaptureStreamComponent* Stream)
+{
+	SendStates.FindOrAdd(Stream);
+}
+
+bool UCaptureStreamReceiverComponent::PumpStream(UCaptureStreamComponent* Stream, double Now)
+{
+	UNetConnection* Connection = GetOwner()->GetNetConnection();
+	const TSharedPtr<FCaptureStreamEncoder, ESPMode::ThreadSafe>& Encoder = Stream->GetEncoder();
+	if (!Connection || !Encoder) return true;
+	if (Stream->GetStreamInfo().Generation == 0) return true;
+
+	const FCaptureStreamInfo& Info = Stream->GetStreamInfo();
+	FSendState& State = SendStates.FindOrAdd(Stream);
+
+	TArray<uint32> Versions;
+	Encoder->GetTileVersions(Versions);
+
+	if (State.Generation != Info.Generation || State.AckedVersions.Num() != Versions.Num())
+	{
+		State.Generation = Info.Generation;
+		State.AckedVersions.Init(0, Versions.Num());
+		State.SentVersions.Init(0, Versions.Num());
+		State.SentTimes.Init(0.0, Versions.Num());
+		State.Cursor = 0;
+	}
+
+	const int32 ChunkPayload = FMath::Max(Connection->MaxPacket - CaptureStreamReceiver::ChunkOverheadBytes, CaptureStreamReceiver::MinChunkPayload);
+
+	// Walk the tiles from a rotating cursor so a tight budget still reaches every tile eventually
+	for (int32 Step = 0; Step < Versions.Num(); ++Step)
+	{
+		const int32 TileIndex = (State.Cursor + Step) % Versions.Num();
+		const uint32 Version = Versions[TileIndex];
+
+		if (Version == 0 || Version <= State.AckedVersions[TileIndex]) continue;
+		if (State.SentVersions[TileIndex] == Version && Now - State.SentTimes[TileIndex] < Stream->ResendTimeoutSeconds) continue;
+
+		if (Budget <= 0.0 || !Connection->IsNetReady(false))
+		{
+			State.Cursor = TileIndex;
+			return false;
+		}
+
+		FCaptureStreamEncoder::FTile Tile;
+		if (!Encoder->GetTile(TileIndex, State.AckedVersions[TileIndex], Tile)) continue;
+
+		const int32 ChunkCount = FMath::DivideAndRoundUp(Tile.Jpeg.Num(), ChunkPayload);
+		if (ChunkCount > MAX_uint8) continue;
+
+		FCaptureStreamChunk Chunk;
+		Chunk.Generation = Info.Generation;
+		Chunk.TileIndex = static_cast<uint16>(TileIndex);
+		Chunk.Version = Tile.Version;
+		Chunk.ChunkCount = static_cast<uint8>(ChunkCount);
+
+		for (int32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+		{
+			const int32 Offset = ChunkIndex * ChunkPayload;
+			Chunk.ChunkIndex = static_cast<uint8>(ChunkIndex);
+			Chunk.Data = TArray<uint8>(Tile.Jpeg.GetData() + Offset, FMath::Min(ChunkPayload, Tile.Jpeg.Num() - Offset));
+			Client_ReceiveStreamChunk(Stream, Chunk);
+		}
+
+		Budget -= Tile.Jpeg.Num();
+		State.SentVersions[TileIndex] = Tile.Version;
+		State.SentTimes[TileIndex] = Now;
+	}
+
+	return true;
+}
+
+void UCaptureStreamReceiverComponent::Server_AckStreamTiles_Implementation(UCaptureStreamComponent* Stream, const TArray<FCaptureStreamAck>& Acks)
+{
+	FSendState* State = SendStates.Find(Stream);
+	if (!State) return;
+
+	for (const FCaptureStreamAck& Ack : Acks)
+	{
+		if (Ack.Generation == State->Generation && State->AckedVersions.IsValidIndex(Ack.TileIndex))
+		{
+			State->AckedVersions[Ack.TileIndex] = FMath::Max(State->AckedVersions[Ack.TileIndex], Ack.Version);
+		}
+	}
+}
+
+bool UCaptureStreamReceiverComponent::Server_AckStreamTiles_Validate(UCaptureStreamComponent* Stream, const TArray<FCaptureStreamAck>& Acks)
+{
+	return Acks.Num() <= CaptureStreamReceiver::MaxAcksPerRPC;
+}
+
+void UCaptureStreamReceiverComponent::Client_ReceiveStreamChunk_Implementation(UCaptureStreamComponent* Stream, const FCaptureStreamChunk& Chunk)
+{
+	if (!Stream || Chunk.ChunkCount == 0 || Chunk.ChunkIndex >= Chunk.ChunkCount) return;
+
+	FReceiveState& State = ReceiveStates.FindOrAdd(Stream);
+	if (State.Generation != Chunk.Generation)
+	{
+		State.Generation = Chunk.Generation;
+		State.PendingTiles.Reset();
+		State.PendingAcks.Reset();
+	}
+
+	FCaptureStreamAck Ack;
+	Ack.Generation = Chunk.Generation;
+	Ack.TileIndex = Chunk.TileIndex;
+	Ack.Version = Chunk.Version;
+
+	// A resend of a tile we already have means the previous ack was lost
+	const bool bSameGeneration = Stream->GetStreamInfo().Generation == Chunk.Generation;
+	if (bSameGeneration && Chunk.Version <= Stream->GetReceivedVersion(Chunk.TileIndex))
+	{
+		State.PendingAcks.Add(Ack);
+		return;
+	}
+
+	FPendingTile& Pending = State.PendingTiles.FindOrAdd(Chunk.TileIndex);
+	if (Pending.Version != Chunk.Version)
+	{
+		if (Pending.Version > Chunk.Version) return;
+
+		Pending.Version = Chunk.Version;
+		Pending.NumReceived = 0;
+		Pending.Chunks.Reset();
+		Pending.Chunks.SetNum(Chunk.ChunkCount);
+	}
+
+	if (!Pending.Chunks.IsValidIndex(Chunk.ChunkIndex) || Pending.Chunks[Chunk.ChunkIndex].Num() > 0) return;
+
+	Pending.Chunks[Chunk.ChunkIndex] = Chunk.Data;
+	if (++Pending.NumReceived < Pending.Chunks.Num()) return;
+
+	TArray<uint8> Jpeg;
+	for (const TArray<uint8>& Part : Pending.Chunks)
+	{
+		Jpeg.Append(Part);
+	}
+	State.PendingTiles.Remove(Chunk.TileIndex);
+
+	// Tiles arriving before OnRep_StreamInfo, or for another generation, are dropped unacknowledged so the server resends them
+	if (Stream->ReceiveTile(Chunk.Generation, Chunk.TileIndex, Chunk.Version, MoveTemp(Jpeg))
+		|| (Stream->GetStreamInfo().Generation == Chunk.Generation && Chunk.Version <= Stream->GetReceivedVersion(Chunk.TileIndex)))
+	{
+		State.PendingAcks.Add(Ack);
+	}
+}
+
+void UCaptureStreamReceiverComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		TArray<UCaptureStreamComponent*> Streams;
+		int32 BytesPerSecond = MAX_int32;
+		for (auto It = SendStates.CreateIterator(); It; ++It)
+		{
+			UCaptureStreamComponent* Stream = It.Key().Get();
+			if (!Stream)
+			{
+				It.RemoveCurrent();
+				continue;
+			}
+
+			Streams.Add(Stream);
+			// Every stream's limit holds for the total sent to this client
+			BytesPerSecond = FMath::Min(BytesPerSecond, Stream->MaxBytesPerSecondPerConnection);
+		}
+
+		if (Streams.Num() == 0) return;
+
+		BytesPerSecond = FMath::Max(BytesPerSecond, 1);
+		Budget = FMath::Min(Budget + BytesPerSecond * DeltaTime, BytesPerSecond * CaptureStreamReceiver::MaxBurstSeconds);
+
+		const double Now = FPlatformTime::Seconds();
+		StreamCursor = (StreamCursor + 1) % Streams.Num();
+		for (int32 Step = 0; Step < Streams.Num(); ++Step)
+		{
+			if (!PumpStream(Streams[(StreamCursor + Step) % Streams.Num()], Now)) break;
+		}
+		return;
+	}
+
+	// Acks of a tick go out batched, losses are covered by the server resending unacknowledged tiles
+	for (auto It = ReceiveStates.CreateIterator(); It; ++It)
+	{
+		UCaptureStreamComponent* Stream = It.Key().Get();
+		if (!Stream)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		TArray<FCaptureStreamAck>& Acks = It.Value().PendingAcks;
+		for (int32 Offset = 0; Offset < Acks.Num(); Offset += CaptureStreamReceiver::MaxAcksPerRPC)
+		{
+			const int32 Count = FMath::Min(CaptureStreamReceiver::MaxAcksPerRPC, Acks.Num() - Offset);
+			Server_AckStreamTiles(Stream, TArray<FCaptureStreamAck>(Acks.GetData() + Offset, Count));
+		}
+		Acks.Reset();
+	}
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CaptureStream.h"
+#include "CaptureStreamReceiverComponent.generated.h"
+
+class UCaptureStreamComponent;
+
+/**
+ * Per connection end of the capture streams, added by the server to each remote player controller.
+ * Because the player controller only exists on its own connection, the RPCs here reach exactly one
+ * client, which gives every client its own bandwidth budget and its own set of acknowledged tiles.
+ * The budget is shared by all the streams sent to the client.
+ * A late joiner starts with nothing acknowledged and so receives the full set of cached tiles.
+ */
+UCLASS(ClassGroup = WindowCapture2D)
+class METAVERSE_C_API UCaptureStreamReceiverComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCaptureStreamReceiverComponent();
+
+	static UCaptureStreamReceiverComponent* FindOrAdd(APlayerController* PlayerController);
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Server: have the tiles of Stream sent to this client from the next tick on. */
+	void AddStream(UCaptureStreamComponent* Stream);
+
+	UFUNCTION(Client, Unreliable)
+	void Client_ReceiveStreamChunk(UCaptureStreamComponent* Stream, const FCaptureStreamChunk& Chunk);
+	void Client_ReceiveStreamChunk_Implementation(UCaptureStreamComponent* Stream, const FCaptureStreamChunk& Chunk);
+
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void Server_AckStreamTiles(UCaptureStreamComponent* Stream, const TArray<FCaptureStreamAck>& Acks);
+	void Server_AckStreamTiles_Implementation(UCaptureStreamComponent* Stream, const TArray<FCaptureStreamAck>& Acks);
+	bool Server_AckStreamTiles_Validate(UCaptureStreamComponent* Stream, const TArray<FCaptureStreamAck>& Acks);
+
+private:
+	/** Server: send the tiles of Stream this client has not acknowledged yet. Returns false once the budget is spent. */
+	bool PumpStream(UCaptureStreamComponent* Stream, double Now);
+
+	struct FSendState
+	{
+		int32 Generation = 0;
+		TArray<uint32> AckedVersions;
+		TArray<uint32> SentVersions;
+		TArray<double> SentTimes;
+		int32 Cursor = 0;
+	};
+
+	struct FPendingTile
+	{
+		uint32 Version = 0;
+		int32 NumReceived = 0;
+		TArray<TArray<uint8>> Chunks;
+	};
+
+	struct FReceiveState
+	{
+		int32 Generation = 0;
+		TMap<uint16, FPendingTile> PendingTiles;
+		TArray<FCaptureStreamAck> PendingAcks;
+	};
+
+	TMap<TWeakObjectPtr<UCaptureStreamComponent>, FSendState> SendStates;
+	// Bytes the server can still send to this client
+	double Budget = 0.0;
+	// Stream pumped first, rotated every tick so a tight budget is not always spent on the same stream
+	int32 StreamCursor = 0;
+	TMap<TWeakObjectPtr<UCaptureStreamComponent>, FReceiveState> ReceiveStates;
+};
@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CaptureTileDiff.h"
+#include "Math/VectorRegister.h"
+
+namespace CaptureTileDiff
+{
+	// Above this share of dirty tiles a single full frame region is cheaper than many small ones.
+	constexpr float FullFrameDirtyRatio = 0.5f;
+
+	constexpr uint32 HashPrime = 0x9E3779B1u;
+}
+
+void FCaptureTileDiff::Reset(int32 InWidth, int32 InHeight)
+{
+	Width = FMath::Max(InWidth, 0);
+	Height = FMath::Max(InHeight, 0);
+	TilesX = FMath::DivideAndRoundUp(Width, TileSize);
+	TilesY = FMath::DivideAndRoundUp(Height, TileSize);
+
+	TileHashes.SetNumZeroed(TilesX * TilesY);
+	DirtyTiles.Init(false, TilesX * TilesY);
+	bInvalidated = true;
+}
+
+void FCaptureTileDiff::Invalidate()
+{
+	bInvalidated = true;
+}
+
+uint64 FCaptureTileDiff::HashTile(const uint8* Pixels, int32 Pitch, int32 TileWidth, int32 TileHeight)
+{
+	const int32 RowBytes = TileWidth * 4;
+	const int32 VectorBytes = RowBytes & ~15;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	const int32 PrimeLane = static_cast<int32>(CaptureTileDiff::HashPrime);
+	const VectorRegister4Int Prime = MakeVectorRegisterInt(PrimeLane, PrimeLane, PrimeLane, PrimeLane);
+	VectorRegister4Int AccA = MakeVectorRegisterInt(1, 2, 3, 4);
+	VectorRegister4Int AccB = MakeVectorRegisterInt(5, 6, 7, 8);
+#endif
+	uint32 Tail = 0x811C9DC5u;
+
+	for (int32 Y = 0; Y < TileHeight; ++Y)
+	{
+		const uint8* Row = Pixels + static_cast<int64>(Y) * Pitch;
+		int32 Offset = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		// Two independent accumulators keep the multiplies from serializing on each other.
+		for (; Offset + 32 <= VectorBytes; Offset += 32)
+		{
+			AccA = VectorIntMultiply(VectorIntXor(AccA, VectorIntLoad(Row + Offset)), Prime);
+			AccB = VectorIntMultiply(VectorIntXor(AccB, VectorIntLoad(Row + Offset + 16)), Prime);
+		}
+		for (; Offset < VectorBytes; Offset += 16)
+		{
+			AccA = VectorIntMultiply(VectorIntXor(AccA, VectorIntLoad(Row + Offset)), Prime);
+		}
+		AccA = VectorIntXor(AccA, VectorShiftRightImmLogical(AccA, 15));
+		AccB = VectorIntXor(AccB, VectorShiftRightImmLogical(AccB, 15));
+#endif
+
+		for (; Offset < RowBytes; Offset += 4)
+		{
+			uint32 Pixel;
+			FMemory::Memcpy(&Pixel, Row + Offset, 4);
+			Tail = (Tail ^ Pixel) * CaptureTileDiff::HashPrime;
+		}
+	}
+
+	uint64 Hash = Tail;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	alignas(16) uint32 Lanes[8];
+	VectorIntStoreAligned(AccA, Lanes);
+	VectorIntStoreAligned(AccB, Lanes + 4);
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		Hash = (Hash ^ Lanes[Index]) * 0x100000001B3ull;
+		Hash ^= Hash >> 29;
+	}
+#endif
+
+	return Hash;
+}
+
+int32 FCaptureTileDiff::Update(const uint8* Pixels, int32 Pitch, TArray<FUpdateTextureRegion2D>& OutRegions)
+{
+	OutRegions.Reset();
+
+	if (!Pixels || TileHashes.Num() == 0)
+	{
+		return 0;
+	}
+
+	int32 NumDirty = 0;
+	for (int32 TileY = 0; TileY < TilesY; ++TileY)
+	{
+		const int32 PixelY = TileY * TileSize;
+		const int32 TileHeight = FMath::Min(TileSize, Height - PixelY);
+
+		for (int32 TileX = 0; TileX < TilesX; ++TileX)
+		{
+			const int32 PixelX = TileX * TileSize;
+			const int32 TileWidth = FMath::Min(TileSize, Width - PixelX);
+			const int32 TileIndex = TileY * TilesX + TileX;
+
+			const uint64 Hash = HashTile(Pixels + static_cast<int64>(PixelY) * Pitch + PixelX * 4, Pitch, TileWidth, TileHeight);
+			const bool bDirty = bInvalidated || Hash != TileHashes[TileIndex];
+
+			TileHashes[TileIndex] = Hash;
+			DirtyTiles[TileIndex] = bDirty;
+			NumDirty += bDirty ? 1 : 0;
+		}
+	}
+
+	bInvalidated = false;
+
+	if (NumDirty == 0)
+	{
+		return 0;
+	}
+
+	if (NumDirty >= FMath::CeilToInt(TileHashes.Num() * CaptureTileDiff::FullFrameDirtyRatio))
+	{
+		OutRegions.Emplace(0, 0, 0, 0, Width, Height);
+		return NumDirty;
+	}
+
+	// Merge dirty tiles into horizontal runs, then grow a run downward while the row below has the exact same span.
+	int32 OpenBegin = 0;
+	for (int32 TileY = 0; TileY < TilesY; ++TileY)
+	{
+		const int32 PixelY = TileY * TileSize;
+		const int32 TileHeight = FMath::Min(TileSize, Height - PixelY);
+		const int32 RowBegin = OutRegions.Num();
+
+		int32 TileX = 0;
+		while (TileX < TilesX)
+		{
+			if (!DirtyTiles[TileY * TilesX + TileX])
+			{
+				++TileX;
+				continue;
+			}
+
+			const int32 RunStart = TileX;
+			while (TileX < TilesX && DirtyTiles[TileY * TilesX + TileX])
+			{
+				++TileX;
+			}
+
+			const uint32 RegionX = RunStart * TileSize;
+			const uint32 RegionWidth = FMath::Min(TileX * TileSize, Width) - RegionX;
+
+			FUpdateTextureRegion2D* Above = nullptr;
+			for (int32 Index = OpenBegin; Index < RowBegin; ++Index)
+			{
+				FUpdateTextureRegion2D& Candidate = OutRegions[Index];
+				if (Candidate.DestX == RegionX && Candidate.Width == RegionWidth && Candidate.DestY + Candidate.Height == static_cast<uint32>(PixelY))
+				{
+					Above = &Candidate;
+					break;
+				}
+			}
+
+			if (Above)
+			{
+				Above->Height += TileHeight;
+			}
+			else
+			{
+				OutRegions.Emplace(RegionX, PixelY, RegionX, PixelY, RegionWidth, TileHeight);
+			}
+		}
+
+		// Regions that did not grow into this row can never grow again.
+		int32 NewOpenBegin = OutRegions.Num();
+		for (int32 Index = OpenBegin; Index < OutRegions.Num(); ++Index)
+		{
+			const FUpdateTextureRegion2D& Region = OutRegions[Index];
+			if (Region.DestY + Region.Height == static_cast<uint32>(PixelY + TileHeight))
+			{
+				NewOpenBegin = FMath::Min(NewOpenBegin, Index);
+			}
+		}
+		OpenBegin = NewOpenBegin;
+	}
+
+	return NumDirty;
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+
+/**
+ * Tile based change detector for captured BGRA frames.
+ * The frame is split into TileSize x TileSize tiles, each tile is hashed and compared
+ * with the hash of the previous frame. Changed tiles are merged into horizontal runs
+ * so they can be uploaded as a small batch of FUpdateTextureRegion2D.
+ */
+class METAVERSE_C_API FCaptureTileDiff
+{
+public:
+	static constexpr int32 TileSize = 64;
+
+	/** Resize the tile grid. The next call to Update reports the whole frame as dirty. */
+	void Reset(int32 InWidth, int32 InHeight);
+
+	/** Force the next call to Update to report the whole frame as dirty. */
+	void Invalidate();
+
+	/**
+	 * Hash the frame and collect the regions that changed since the previous call.
+	 * @param Pixels      BGRA8 pixels of the frame
+	 * @param Pitch       bytes per row of Pixels
+	 * @param OutRegions  receives the changed regions, empty when the frame is static
+	 * @return number of changed tiles
+	 */
+	int32 Update(const uint8* Pixels, int32 Pitch, TArray<FUpdateTextureRegion2D>& OutRegions);
+
+	int32 GetNumTiles() const { return TileHashes.Num(); }
+
+private:
+	static uint64 HashTile(const uint8* Pixels, int32 Pitch, int32 TileWidth, int32 TileHeight);
+
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 TilesX = 0;
+	int32 TilesY = 0;
+	bool bInvalidated = true;
+
+	TArray<uint64> TileHashes;
+	TBitArray<> DirtyTiles;
+};
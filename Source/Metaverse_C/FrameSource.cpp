@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FrameSource.h"
+#include "Internationalization/Regex.h"
+#include "FrameSourceGDI.h"
+#include "FrameSourceFile.h"
+#include "FrameSourceX11.h"
+
+TUniquePtr<IFrameSource> IFrameSource::Create(const FCaptureMachineProperties& Properties)
+{
+	switch (Properties.FrameSource)
+	{
+	case ECaptureFrameSource::Window:
+#if PLATFORM_WINDOWS
+		return MakeUnique<FFrameSourceGDI>(Properties);
+#elif PLATFORM_LINUX
+		return MakeUnique<FFrameSourceX11>(Properties);
+#else
+		return nullptr;
+#endif
+
+	case ECaptureFrameSource::ImageSequence:
+		return MakeUnique<FFrameSourceFile>(Properties);
+
+	case ECaptureFrameSource::Synthetic:
+		return MakeUnique<FFrameSourceSynthetic>(Properties);
+	}
+
+	return nullptr;
+}
+
+bool IFrameSource::MatchesTitle(const FString& Title, const FCaptureMachineProperties& Properties)
+{
+	if (Title.IsEmpty()) return false;
+
+	switch (Properties.TitleMatchingWindowSearch)
+	{
+	case ETitleMatchingWindowSearch::PerfectMatch:
+		return Title.Equals(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
+
+	case ETitleMatchingWindowSearch::ForwardMatch:
+		return Title.StartsWith(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
+
+	case ETitleMatchingWindowSearch::PartialMatch:
+		return Title.Contains(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
+
+	case ETitleMatchingWindowSearch::BackwardMatch:
+		return Title.EndsWith(Properties.CaptureTargetTitle, ESearchCase::IgnoreCase);
+
+	case ETitleMatchingWindowSearch::RegularExpression:
+	{
+		const FRegexPattern pattern = FRegexPattern(Properties.CaptureTargetTitle);
+		FRegexMatcher matcher(pattern, Title);
+
+		return matcher.FindNext();
+	}
+	}
+
+	return false;
+}
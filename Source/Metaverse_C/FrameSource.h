@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CaptureMachineProperties.h"
+
+/**
+ * Produces the frames consumed by UCaptureMachine.
+ * Frames are BGRA8 with rows stored bottom-up, the same layout as a GDI DIB section,
+ * so every backend can feed the same texture and material setup.
+ * All methods except Open/Close are called from the capture thread.
+ */
+class METAVERSE_C_API IFrameSource
+{
+public:
+	virtual ~IFrameSource() {}
+
+	/** Create the backend selected by Properties.FrameSource for the current platform, nullptr if unsupported. */
+	static TUniquePtr<IFrameSource> Create(const FCaptureMachineProperties& Properties);
+
+	/** Checks a window title against CaptureTargetTitle using TitleMatchingWindowSearch. */
+	static bool MatchesTitle(const FString& Title, const FCaptureMachineProperties& Properties);
+
+	virtual bool Open() = 0;
+	virtual void Close() = 0;
+
+	/** Re-query the source size. Returns true when it changed, the pixel buffer is then reallocated. */
+	virtual bool RefreshFrameSize() = 0;
+
+	/** Fill the pixel buffer with the next frame. Returns false when no frame could be produced. */
+	virtual bool CaptureFrame() = 0;
+
+	virtual FIntVector2D GetFrameSize() const = 0;
+	virtual const uint8* GetPixels() const = 0;
+
+	int32 GetPitch() const { return GetFrameSize().X * 4; }
+};
@@ -0,0 +1,259 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FrameSourceFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+namespace FrameSourceFile
+{
+	// Copies top-down rows into the bottom-up layout expected by IFrameSource consumers
+	void CopyFlipped(const uint8* Src, uint8* Dst, int32 Width, int32 Height)
+	{
+		const int32 Pitch = Width * 4;
+		for (int32 Y = 0; Y < Height; ++Y)
+		{
+			FMemory::Memcpy(Dst + static_cast<int64>(Height - 1 - Y) * Pitch, Src + static_cast<int64>(Y) * Pitch, Pitch);
+		}
+	}
+}
+
+FFrameSourceFile::FFrameSourceFile(const FCaptureMachineProperties& InProperties)
+	: Properties(InProperties)
+{
+}
+
+FFrameSourceFile::~FFrameSourceFile()
+{
+	Close();
+}
+
+bool FFrameSourceFile::Open()
+{
+	Close();
+
+	const FString& Path = Properties.ImageSequencePath;
+	if (FPaths::DirectoryExists(Path))
+	{
+		return OpenImageSequence(Path);
+	}
+
+	if (FPaths::FileExists(Path))
+	{
+		return OpenRawFile(Path);
+	}
+
+	UE_LOG(LogTemp, Error, TEXT("Frame source path %s does not exist"), *Path);
+	return false;
+}
+
+void FFrameSourceFile::Close()
+{
+	RawFile.Reset();
+	RawFrameCount = 0;
+	DecodedFrames.Empty();
+	Pixels.Empty();
+	FrameIndex = 0;
+	FrameSize = FIntVector2D();
+}
+
+bool FFrameSourceFile::OpenImageSequence(const FString& Directory)
+{
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *Directory, TEXT("*"));
+	Files.Sort();
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+	for (const FString& File : Files)
+	{
+		TArray<uint8> Compressed;
+		if (!FFileHelper::LoadFileToArray(Compressed, *FPaths::Combine(Directory, File)))
+		{
+			continue;
+		}
+
+		const EImageFormat Format = ImageWrapperModule.DetectImageFormat(Compressed.GetData(), Compressed.Num());
+		if (Format == EImageFormat::Invalid)
+		{
+			continue;
+		}
+
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(Format);
+		TArray64<uint8> Raw;
+		if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(Compressed.GetData(), Compressed.Num()) || !ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, Raw))
+		{
+			continue;
+		}
+
+		const FIntVector2D ImageSize(ImageWrapper->GetWidth(), ImageWrapper->GetHeight());
+		if (DecodedFrames.Num() == 0)
+		{
+			FrameSize = ImageSize;
+		}
+		else if (ImageSize != FrameSize)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Skipping %s, its size differs from the first frame of the sequence"), *File);
+			continue;
+		}
+
+		TArray<uint8>& Frame = DecodedFrames.AddDefaulted_GetRef();
+		Frame.SetNumUninitialized(FrameSize.X * FrameSize.Y * 4);
+		FrameSourceFile::CopyFlipped(Raw.GetData(), Frame.GetData(), FrameSize.X, FrameSize.Y);
+	}
+
+	if (DecodedFrames.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("No readable images in %s"), *Directory);
+		return false;
+	}
+
+	Pixels.SetNumUninitialized(FrameSize.X * FrameSize.Y * 4);
+	return true;
+}
+
+bool FFrameSourceFile::OpenRawFile(const FString& Filename)
+{
+	FrameSize = FIntVector2D(Properties.SyntheticFrameSize.X, Properties.SyntheticFrameSize.Y);
+	const int64 FrameBytes = static_cast<int64>(FrameSize.X) * FrameSize.Y * 4;
+	if (FrameBytes <= 0)
+	{
+		return false;
+	}
+
+	RawFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+	if (!RawFile)
+	{
+		return false;
+	}
+
+	RawFrameCount = RawFile->Size() / FrameBytes;
+	if (RawFrameCount == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s is smaller than one %dx%d frame"), *Filename, FrameSize.X, FrameSize.Y);
+		RawFile.Reset();
+		return false;
+	}
+
+	Pixels.SetNumUninitialized(FrameBytes);
+	return true;
+}
+
+bool FFrameSourceFile::CaptureFrame()
+{
+	if (DecodedFrames.Num() > 0)
+	{
+		FMemory::Memcpy(Pixels.GetData(), DecodedFrames[FrameIndex].GetData(), Pixels.Num());
+		FrameIndex = (FrameIndex + 1) % DecodedFrames.Num();
+		return true;
+	}
+
+	if (RawFile)
+	{
+		const int32 Pitch = FrameSize.X * 4;
+		RawFile->Seek(static_cast<int64>(FrameIndex) * Pixels.Num());
+
+		// Raw frames are top-down, read each row straight into its flipped slot
+		for (int32 Y = 0; Y < FrameSize.Y; ++Y)
+		{
+			if (!RawFile->Read(Pixels.GetData() + static_cast<int64>(FrameSize.Y - 1 - Y) * Pitch, Pitch))
+			{
+				return false;
+			}
+		}
+
+		FrameIndex = (FrameIndex + 1) % RawFrameCount;
+		return true;
+	}
+
+	return false;
+}
+
+
+FFrameSourceSynthetic::FFrameSourceSynthetic(const FCaptureMachineProperties& InProperties)
+	: Properties(InProperties)
+{
+}
+
+bool FFrameSourceSynthetic::Open()
+{
+	FrameSize = FIntVector2D(Properties.SyntheticFrameSize.X, Properties.SyntheticFrameSize.Y);
+	if (FrameSize.X <= 0 || FrameSize.Y <= 0)
+	{
+		return false;
+	}
+
+	Pixels.SetNumUninitialized(FrameSize.X * FrameSize.Y * 4);
+	FillBackground(0, 0, FrameSize.X, FrameSize.Y);
+
+	FrameNumber = 0;
+	BlockPosition = FIntVector2D(0, FrameSize.Y / 2);
+	return true;
+}
+
+void FFrameSourceSynthetic::Close()
+{
+	Pixels.Empty();
+	FrameSize = FIntVector2D();
+}
+
+bool FFrameSourceSynthetic::CaptureFrame()
+{
+	if (Pixels.Num() == 0) return false;
+
+	constexpr int32 BlockSize = 48;
+	constexpr int32 BlockStep = 8;
+	constexpr int32 CaretWidth = 2;
+	constexpr int32 CaretHeight = 20;
+
+	// Restore what the block covered last frame, then draw it at its next position
+	FillBackground(BlockPosition.X, BlockPosition.Y, BlockSize, BlockSize);
+	BlockPosition.X = (BlockPosition.X + BlockStep) % FMath::Max(1, FrameSize.X - BlockSize);
+	FillRect(BlockPosition.X, BlockPosition.Y, BlockSize, BlockSize, FColor(255, 96, 0));
+
+	// The caret toggles every half second at 30 fps
+	const bool bCaretVisible = (FrameNumber / 15) % 2 == 0;
+	FillRect(FrameSize.X / 4, FrameSize.Y / 4, CaretWidth, CaretHeight, bCaretVisible ? FColor::Black : FColor::White);
+
+	++FrameNumber;
+	return true;
+}
+
+void FFrameSourceSynthetic::FillRect(int32 X, int32 Y, int32 Width, int32 Height, FColor Color)
+{
+	const int32 MinX = FMath::Clamp(X, 0, FrameSize.X);
+	const int32 MaxX = FMath::Clamp(X + Width, 0, FrameSize.X);
+	const int32 MinY = FMath::Clamp(Y, 0, FrameSize.Y);
+	const int32 MaxY = FMath::Clamp(Y + Height, 0, FrameSize.Y);
+
+	for (int32 Row = MinY; Row < MaxY; ++Row)
+	{
+		FColor* Dst = reinterpret_cast<FColor*>(Pixels.GetData()) + static_cast<int64>(Row) * FrameSize.X;
+		for (int32 Column = MinX; Column < MaxX; ++Column)
+		{
+			Dst[Column] = Color;
+		}
+	}
+}
+
+void FFrameSourceSynthetic::FillBackground(int32 X, int32 Y, int32 Width, int32 Height)
+{
+	const int32 MinX = FMath::Clamp(X, 0, FrameSize.X);
+	const int32 MaxX = FMath::Clamp(X + Width, 0, FrameSize.X);
+	const int32 MinY = FMath::Clamp(Y, 0, FrameSize.Y);
+	const int32 MaxY = FMath::Clamp(Y + Height, 0, FrameSize.Y);
+
+	for (int32 Row = MinY; Row < MaxY; ++Row)
+	{
+		FColor* Dst = reinterpret_cast<FColor*>(Pixels.GetData()) + static_cast<int64>(Row) * FrameSize.X;
+		for (int32 Column = MinX; Column < MaxX; ++Column)
+		{
+			Dst[Column] = FColor(Column * 255 / FrameSize.X, Row * 255 / FrameSize.Y, 128);
+		}
+	}
+}
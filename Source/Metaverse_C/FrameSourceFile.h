@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FrameSource.h"
+
+class IFileHandle;
+
+/**
+ * Plays back frames from disk so the capture pipeline can run headless.
+ * ImageSequencePath is either a directory of png/jpg/bmp images, decoded once on Open and
+ * played in file name order, or a raw file of consecutive BGRA8 top-down frames of
+ * SyntheticFrameSize that is streamed one frame per capture.
+ */
+class METAVERSE_C_API FFrameSourceFile : public IFrameSource
+{
+public:
+	FFrameSourceFile(const FCaptureMachineProperties& InProperties);
+	virtual ~FFrameSourceFile();
+
+	virtual bool Open() override;
+	virtual void Close() override;
+	virtual bool RefreshFrameSize() override { return false; }
+	virtual bool CaptureFrame() override;
+
+	virtual FIntVector2D GetFrameSize() const override { return FrameSize; }
+	virtual const uint8* GetPixels() const override { return Pixels.GetData(); }
+
+private:
+	bool OpenImageSequence(const FString& Directory);
+	bool OpenRawFile(const FString& Filename);
+
+	FCaptureMachineProperties Properties;
+
+	FIntVector2D FrameSize;
+	TArray<uint8> Pixels;
+
+	TArray<TArray<uint8>> DecodedFrames;
+	int32 FrameIndex = 0;
+
+	TUniquePtr<IFileHandle> RawFile;
+	int64 RawFrameCount = 0;
+};
+
+/**
+ * Generates a test pattern with a moving block and a blinking caret.
+ * Only a few tiles change per frame, which mirrors a mostly static shared screen.
+ */
+class METAVERSE_C_API FFrameSourceSynthetic : public IFrameSource
+{
+public:
+	FFrameSourceSynthetic(const FCaptureMachineProperties& InProperties);
+
+	virtual bool Open() override;
+	virtual void Close() override;
+	virtual bool RefreshFrameSize() override { return false; }
+	virtual bool CaptureFrame() override;
+
+	virtual FIntVector2D GetFrameSize() const override { return FrameSize; }
+	virtual const uint8* GetPixels() const override { return Pixels.GetData(); }
+
+private:
+	void FillRect(int32 X, int32 Y, int32 Width, int32 Height, FColor Color);
+	void FillBackground(int32 X, int32 Y, int32 Width, int32 Height);
+
+	FCaptureMachineProperties Properties;
+
+	FIntVector2D FrameSize;
+	TArray<uint8> Pixels;
+	uint32 FrameNumber = 0;
+	FIntVector2D BlockPosition;
+};
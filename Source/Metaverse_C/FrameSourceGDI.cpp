@@ -0,0 +1,186 @@
+// Copyright 2019 ayumax. All Rights Reserved.
+
+#include "FrameSourceGDI.h"
+
+#if PLATFORM_WINDOWS
+#include <dwmapi.h>
+
+FFrameSourceGDI::FFrameSourceGDI(const FCaptureMachineProperties& InProperties)
+	: Properties(InProperties)
+{
+}
+
+FFrameSourceGDI::~FFrameSourceGDI()
+{
+	Close();
+}
+
+bool FFrameSourceGDI::Open()
+{
+	m_TargetWindow = nullptr;
+
+	::EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL
+		{
+			FFrameSourceGDI* my = (FFrameSourceGDI*)lParam;
+			return my->FindTargetWindow(hwnd);
+		}, (LPARAM)this);
+
+	if (!m_TargetWindow) return false;
+
+	GetWindowSize(m_TargetWindow);
+
+	HDC foundDC = ::GetDC(m_TargetWindow);
+	m_MemDC = ::CreateCompatibleDC(foundDC);
+	if (Properties.CutShadow)
+	{
+		m_OriginalMemDC = ::CreateCompatibleDC(foundDC);
+	}
+
+	ReleaseDC(m_TargetWindow, foundDC);
+
+	ReCreateBitmap();
+
+	return m_BitmapBuffer != nullptr;
+}
+
+void FFrameSourceGDI::Close()
+{
+	ReleaseBitmap();
+
+	if (m_MemDC)
+	{
+		::DeleteDC(m_MemDC);
+		m_MemDC = nullptr;
+	}
+
+	if (m_OriginalMemDC)
+	{
+		::DeleteDC(m_OriginalMemDC);
+		m_OriginalMemDC = nullptr;
+	}
+
+	m_TargetWindow = nullptr;
+}
+
+bool FFrameSourceGDI::RefreshFrameSize()
+{
+	if (!m_TargetWindow) return false;
+
+	const FIntVector2D oldWindowSize = m_WindowSize;
+	GetWindowSize(m_TargetWindow);
+	if (m_WindowSize != oldWindowSize)
+	{
+		ReCreateBitmap();
+		return true;
+	}
+
+	return false;
+}
+
+bool FFrameSourceGDI::CaptureFrame()
+{
+	if (!m_TargetWindow || !m_BitmapBuffer) return false;
+
+	if (Properties.CutShadow)
+	{
+		::PrintWindow(m_TargetWindow, m_OriginalMemDC, 2);
+		::BitBlt(m_MemDC, 0, 0, m_WindowSize.X, m_WindowSize.Y, m_OriginalMemDC, m_WindowOffset.X, m_WindowOffset.Y, SRCCOPY);
+	}
+	else
+	{
+		::PrintWindow(m_TargetWindow, m_MemDC, 2);
+	}
+
+	return true;
+}
+
+bool FFrameSourceGDI::FindTargetWindow(HWND hWnd)
+{
+	__wchar_t windowTitle[1024];
+	GetWindowText(hWnd, windowTitle, 1024);
+	FString title(windowTitle);
+
+	if (MatchesTitle(title, Properties))
+	{
+		m_TargetWindow = hWnd;
+		return false;
+	}
+
+	return true;
+}
+
+void FFrameSourceGDI::GetWindowSize(HWND hWnd)
+{
+	if (!::IsWindow(hWnd))
+	{
+		m_OriginalWindowSize = FIntVector2D(0, 0);
+		m_WindowSize = m_OriginalWindowSize;
+		m_WindowOffset = FIntVector2D(0, 0);
+		return;
+	}
+
+	RECT rect;
+	::GetWindowRect(hWnd, &rect);
+
+	if (Properties.CutShadow)
+	{
+		RECT dwmWindowRect;
+		::DwmGetWindowAttribute(hWnd, DWMWA_EXTENDED_FRAME_BOUNDS, &dwmWindowRect, sizeof(RECT));
+
+		m_OriginalWindowSize = FIntVector2D(rect.right - rect.left, rect.bottom - rect.top);
+		m_WindowSize = FIntVector2D(dwmWindowRect.right - dwmWindowRect.left, dwmWindowRect.bottom - dwmWindowRect.top);
+		m_WindowOffset = FIntVector2D(dwmWindowRect.left - rect.left, dwmWindowRect.top - rect.top);
+	}
+	else
+	{
+		m_OriginalWindowSize = FIntVector2D(rect.right - rect.left, rect.bottom - rect.top);
+		m_WindowSize = m_OriginalWindowSize;
+		m_WindowOffset = FIntVector2D(0, 0);
+	}
+}
+
+void FFrameSourceGDI::ReCreateBitmap()
+{
+	ReleaseBitmap();
+
+	if (m_WindowSize.X == 0 || m_WindowSize.Y == 0)
+	{
+		return;
+	}
+
+	BITMAPINFO bmpInfo;
+	bmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmpInfo.bmiHeader.biWidth = m_WindowSize.X;
+	bmpInfo.bmiHeader.biHeight = m_WindowSize.Y;
+	bmpInfo.bmiHeader.biPlanes = 1;
+	bmpInfo.bmiHeader.biBitCount = 32;
+	bmpInfo.bmiHeader.biCompression = BI_RGB;
+
+	// The DIB section owns the pixel memory, m_BitmapBuffer only points into it
+	m_hBmp = ::CreateDIBSection(NULL, &bmpInfo, DIB_RGB_COLORS, (void**)&m_BitmapBuffer, NULL, 0);
+
+	::SelectObject(m_MemDC, m_hBmp);
+
+	if (Properties.CutShadow)
+	{
+		m_hOriginalBmp = ::CreateCompatibleBitmap(m_MemDC, m_OriginalWindowSize.X, m_OriginalWindowSize.Y);
+		::SelectObject(m_OriginalMemDC, m_hOriginalBmp);
+	}
+}
+
+void FFrameSourceGDI::ReleaseBitmap()
+{
+	if (m_hBmp)
+	{
+		::DeleteObject(m_hBmp);
+		m_hBmp = nullptr;
+		m_BitmapBuffer = nullptr;
+	}
+
+	if (m_hOriginalBmp)
+	{
+		::DeleteObject(m_hOriginalBmp);
+		m_hOriginalBmp = nullptr;
+	}
+}
+#endif
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FrameSource.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include <WinUser.h>
+
+/**
+ * Captures a desktop window with PrintWindow into a DIB section.
+ */
+class METAVERSE_C_API FFrameSourceGDI : public IFrameSource
+{
+public:
+	FFrameSourceGDI(const FCaptureMachineProperties& InProperties);
+	virtual ~FFrameSourceGDI();
+
+	virtual bool Open() override;
+	virtual void Close() override;
+	virtual bool RefreshFrameSize() override;
+	virtual bool CaptureFrame() override;
+
+	virtual FIntVector2D GetFrameSize() const override { return m_WindowSize; }
+	virtual const uint8* GetPixels() const override { return reinterpret_cast<const uint8*>(m_BitmapBuffer); }
+
+private:
+	bool FindTargetWindow(HWND hWnd);
+	void GetWindowSize(HWND hWnd);
+	void ReCreateBitmap();
+	void ReleaseBitmap();
+
+	FCaptureMachineProperties Properties;
+
+	char* m_BitmapBuffer = nullptr;
+
+	HBITMAP m_hBmp = nullptr;
+	HDC m_MemDC = nullptr;
+	HBITMAP m_hOriginalBmp = nullptr;
+	HDC m_OriginalMemDC = nullptr;
+	HWND m_TargetWindow = nullptr;
+
+	FIntVector2D m_WindowSize;
+	FIntVector2D m_OriginalWindowSize;
+	FIntVector2D m_WindowOffset;
+};
+#endif
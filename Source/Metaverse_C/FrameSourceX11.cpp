@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FrameSourceX11.h"
+
+#if PLATFORM_LINUX
+#include "HAL/PlatformProcess.h"
+
+// Minimal libX11 ABI, declared here so the module builds without X11 development headers
+struct FX11Image
+{
+	int width, height;
+	int xoffset;
+	int format;
+	char* data;
+	int byte_order;
+	int bitmap_unit;
+	int bitmap_bit_order;
+	int bitmap_pad;
+	int depth;
+	int bytes_per_line;
+	int bits_per_pixel;
+	unsigned long red_mask, green_mask, blue_mask;
+	char* obdata;
+	struct
+	{
+		FX11Image* (*create_image)(void*, void*, unsigned int, int, int, char*, unsigned int, unsigned int, int, int);
+		int (*destroy_image)(FX11Image*);
+		unsigned long (*get_pixel)(FX11Image*, int, int);
+		int (*put_pixel)(FX11Image*, int, int, unsigned long);
+		FX11Image* (*sub_image)(FX11Image*, int, int, unsigned int, unsigned int);
+		int (*add_pixel)(FX11Image*, long);
+	} f;
+};
+
+struct FX11Api
+{
+	_XDisplay* (*XOpenDisplay)(const char*);
+	int (*XCloseDisplay)(_XDisplay*);
+	unsigned long (*XDefaultRootWindow)(_XDisplay*);
+	int (*XQueryTree)(_XDisplay*, unsigned long, unsigned long*, unsigned long*, unsigned long**, unsigned int*);
+	int (*XFetchName)(_XDisplay*, unsigned long, char**);
+	int (*XFree)(void*);
+	int (*XGetGeometry)(_XDisplay*, unsigned long, unsigned long*, int*, int*, unsigned int*, unsigned int*, unsigned int*, unsigned int*);
+	FX11Image* (*XGetImage)(_XDisplay*, unsigned long, int, int, unsigned int, unsigned int, unsigned long, int);
+	FX11Image* (*XGetSubImage)(_XDisplay*, unsigned long, int, int, unsigned int, unsigned int, unsigned long, int, FX11Image*, int, int);
+};
+
+namespace FrameSourceX11
+{
+	constexpr int ZPixmap = 2;
+	constexpr unsigned long AllPlanes = ~0ul;
+}
+
+FFrameSourceX11::FFrameSourceX11(const FCaptureMachineProperties& InProperties)
+	: Properties(InProperties)
+{
+}
+
+FFrameSourceX11::~FFrameSourceX11()
+{
+	Close();
+
+	delete Api;
+	if (LibraryHandle)
+	{
+		FPlatformProcess::FreeDllHandle(LibraryHandle);
+	}
+}
+
+bool FFrameSourceX11::LoadX11Library()
+{
+	if (Api) return true;
+
+	LibraryHandle = FPlatformProcess::GetDllHandle(TEXT("libX11.so.6"));
+	if (!LibraryHandle)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("libX11 is not available, X11 window capture disabled"));
+		return false;
+	}
+
+	FX11Api* Loaded = new FX11Api();
+	bool bComplete = true;
+	auto Resolve = [this, &bComplete](auto& Function, const TCHAR* Name)
+	{
+		Function = reinterpret_cast<typename TRemoveReference<decltype(Function)>::Type>(FPlatformProcess::GetDllExport(LibraryHandle, Name));
+		bComplete &= Function != nullptr;
+	};
+
+	Resolve(Loaded->XOpenDisplay, TEXT("XOpenDisplay"));
+	Resolve(Loaded->XCloseDisplay, TEXT("XCloseDisplay"));
+	Resolve(Loaded->XDefaultRootWindow, TEXT("XDefaultRootWindow"));
+	Resolve(Loaded->XQueryTree, TEXT("XQueryTree"));
+	Resolve(Loaded->XFetchName, TEXT("XFetchName"));
+	Resolve(Loaded->XFree, TEXT("XFree"));
+	Resolve(Loaded->XGetGeometry, TEXT("XGetGeometry"));
+	Resolve(Loaded->XGetImage, TEXT("XGetImage"));
+	Resolve(Loaded->XGetSubImage, TEXT("XGetSubImage"));
+
+	if (!bComplete)
+	{
+		delete Loaded;
+		return false;
+	}
+
+	Api = Loaded;
+	return true;
+}
+
+bool FFrameSourceX11::Open()
+{
+	if (!LoadX11Library()) return false;
+
+	Display = Api->XOpenDisplay(nullptr);
+	if (!Display)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot open X display, set DISPLAY or start an Xvfb server"));
+		return false;
+	}
+
+	const unsigned long Root = Api->XDefaultRootWindow(Display);
+	TargetWindow = Properties.CaptureTargetTitle.IsEmpty() ? Root : FindTargetWindow(Root);
+	if (!TargetWindow)
+	{
+		Close();
+		return false;
+	}
+
+	FrameSize = QueryWindowSize();
+	Pixels.SetNumZeroed(FrameSize.X * FrameSize.Y * 4);
+	return FrameSize.X > 0 && FrameSize.Y > 0;
+}
+
+void FFrameSourceX11::Close()
+{
+	ReleaseImage();
+
+	if (Display)
+	{
+		Api->XCloseDisplay(Display);
+		Display = nullptr;
+	}
+
+	TargetWindow = 0;
+	FrameSize = FIntVector2D();
+	Pixels.Empty();
+}
+
+unsigned long FFrameSourceX11::FindTargetWindow(unsigned long Window)
+{
+	char* Name = nullptr;
+	if (Api->XFetchName(Display, Window, &Name) && Name)
+	{
+		const bool bMatch = MatchesTitle(UTF8_TO_TCHAR(Name), Properties);
+		Api->XFree(Name);
+		if (bMatch)
+		{
+			return Window;
+		}
+	}
+
+	unsigned long Root = 0;
+	unsigned long Parent = 0;
+	unsigned long* Children = nullptr;
+	unsigned int NumChildren = 0;
+	if (!Api->XQueryTree(Display, Window, &Root, &Parent, &Children, &NumChildren))
+	{
+		return 0;
+	}
+
+	unsigned long Found = 0;
+	for (unsigned int Index = 0; Index < NumChildren && !Found; ++Index)
+	{
+		Found = FindTargetWindow(Children[Index]);
+	}
+
+	if (Children)
+	{
+		Api->XFree(Children);
+	}
+
+	return Found;
+}
+
+FIntVector2D FFrameSourceX11::QueryWindowSize() const
+{
+	unsigned long Root = 0;
+	int X = 0, Y = 0;
+	unsigned int Width = 0, Height = 0, Border = 0, Depth = 0;
+	if (!Display || !Api->XGetGeometry(Display, TargetWindow, &Root, &X, &Y, &Width, &Height, &Border, &Depth))
+	{
+		return FIntVector2D(0, 0);
+	}
+
+	return FIntVector2D(Width, Height);
+}
+
+void FFrameSourceX11::ReleaseImage()
+{
+	if (Image)
+	{
+		Image->f.destroy_image(Image);
+		Image = nullptr;
+	}
+}
+
+bool FFrameSourceX11::RefreshFrameSize()
+{
+	const FIntVector2D NewSize = QueryWindowSize();
+	if (NewSize != FrameSize)
+	{
+		ReleaseImage();
+		FrameSize = NewSize;
+		Pixels.SetNumZeroed(FrameSize.X * FrameSize.Y * 4);
+		return true;
+	}
+
+	return false;
+}
+
+bool FFrameSourceX11::CaptureFrame()
+{
+	if (!Display || FrameSize.X <= 0 || FrameSize.Y <= 0) return false;
+
+	// The first grab allocates the XImage, later grabs refill it in place
+	if (!Image)
+	{
+		Image = Api->XGetImage(Display, TargetWindow, 0, 0, FrameSize.X, FrameSize.Y, FrameSourceX11::AllPlanes, FrameSourceX11::ZPixmap);
+	}
+	else if (!Api->XGetSubImage(Display, TargetWindow, 0, 0, FrameSize.X, FrameSize.Y, FrameSourceX11::AllPlanes, FrameSourceX11::ZPixmap, Image, 0, 0))
+	{
+		return false;
+	}
+
+	if (!Image || Image->bits_per_pixel != 32)
+	{
+		ReleaseImage();
+		return false;
+	}
+
+	// 24 bit visuals leave the padding byte undefined, force it opaque while flipping to bottom-up
+	const int32 Pitch = FrameSize.X * 4;
+	for (int32 Row = 0; Row < FrameSize.Y; ++Row)
+	{
+		const uint32* Src = reinterpret_cast<const uint32*>(Image->data + static_cast<int64>(Row) * Image->bytes_per_line);
+		uint32* Dst = reinterpret_cast<uint32*>(Pixels.GetData() + static_cast<int64>(FrameSize.Y - 1 - Row) * Pitch);
+		for (int32 Column = 0; Column < FrameSize.X; ++Column)
+		{
+			Dst[Column] = Src[Column] | 0xFF000000u;
+		}
+	}
+
+	return true;
+}
+#endif
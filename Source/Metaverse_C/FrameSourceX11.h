@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FrameSource.h"
+
+#if PLATFORM_LINUX
+
+/**
+ * Captures an X11 window, or the whole root window when CaptureTargetTitle is empty.
+ * libX11 is loaded at runtime so dedicated servers without X still start; pointing DISPLAY
+ * at an Xvfb offscreen buffer lets CI run the capture path without a desktop.
+ */
+class METAVERSE_C_API FFrameSourceX11 : public IFrameSource
+{
+public:
+	FFrameSourceX11(const FCaptureMachineProperties& InProperties);
+	virtual ~FFrameSourceX11();
+
+	virtual bool Open() override;
+	virtual void Close() override;
+	virtual bool RefreshFrameSize() override;
+	virtual bool CaptureFrame() override;
+
+	virtual FIntVector2D GetFrameSize() const override { return FrameSize; }
+	virtual const uint8* GetPixels() const override { return Pixels.GetData(); }
+
+private:
+	bool LoadX11Library();
+	unsigned long FindTargetWindow(unsigned long Window);
+	FIntVector2D QueryWindowSize() const;
+	void ReleaseImage();
+
+	FCaptureMachineProperties Properties;
+
+	void* LibraryHandle = nullptr;
+	struct FX11Api* Api = nullptr;
+	struct _XDisplay* Display = nullptr;
+	struct FX11Image* Image = nullptr;
+	unsigned long TargetWindow = 0;
+
+	FIntVector2D FrameSize;
+	TArray<uint8> Pixels;
+};
+#endif
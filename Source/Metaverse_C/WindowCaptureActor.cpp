@@ -4,9 +4,11 @@
 #include "Engine/Texture2D.h"
 #include "Net/UnrealNetwork.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#if PLATFORM_WINDOWS
 #include <Windows.h>
 #define TRUE 1
 #define FALSE 0
+#endif
 
 AWindowCaptureActor::AWindowCaptureActor()
 {
@@ -18,6 +20,9 @@ AWindowCaptureActor::AWindowCaptureActor()
 
 	MeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComponent"));
 	MeshComponent->SetupAttachment(RootComponent);
+
+	StreamComponent = CreateDefaultSubobject<UCaptureStreamComponent>(TEXT("StreamComponent"));
+	StreamComponent->StreamTextureChanged.AddDynamic(this, &AWindowCaptureActor::OnStreamTexture);
 }
 
 void AWindowCaptureActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -27,6 +32,8 @@ void AWindowCaptureActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 		CaptureMachine->Stop();
 	}
 
+	StreamComponent->StopStreaming();
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -46,6 +53,7 @@ UTexture2D* AWindowCaptureActor::Start()
 	if (CaptureMachine)
 	{
 		CaptureMachine->Stop();
+		StreamComponent->StopStreaming();
 		CaptureMachine->Dispose();
 	}
 
@@ -54,6 +62,10 @@ UTexture2D* AWindowCaptureActor::Start()
 	CaptureMachine->Properties = Properties;
 
 	CaptureMachine->ChangeTexture.AddDynamic(this, &AWindowCaptureActor::OnChangeTexture);
+	if (HasAuthority())
+	{
+		StreamComponent->StartStreaming(CaptureMachine);
+	}
 	CaptureMachine->Start();
 
 	return CaptureMachine->CreateTexture();
@@ -64,6 +76,7 @@ void AWindowCaptureActor::Stop()
 	if (CaptureMachine)
 	{
 		CaptureMachine->Stop();
+		StreamComponent->StopStreaming();
 		CaptureMachine->Dispose();
 	}
 }
@@ -73,21 +86,26 @@ void AWindowCaptureActor::OnChangeTexture(UTexture2D* _NewTexture)
 {
 	ChangeTexture.Broadcast(_NewTexture);
 
-	if (HasAuthority()) // Only on the server
+	if (HasAuthority()) // Only on the server, clients get their texture from the capture stream
 	{
 		TextureTarget = _NewTexture;
-		TextureTarget->SetFlags(RF_Public); // Ensure the texture is marked as public
-
-		// Replicate the change to clients
 		OnRep_TextureTarget();
 	}
 }
 
+void AWindowCaptureActor::OnStreamTexture(UTexture2D* _NewTexture)
+{
+	if (HasAuthority()) return;
+
+	TextureTarget = _NewTexture;
+	ChangeTexture.Broadcast(_NewTexture);
+	OnRep_TextureTarget();
+}
+
 void AWindowCaptureActor::GetLifetimeReplicatedProps(TArray< FLifetimeProperty >& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 	DOREPLIFETIME(AWindowCaptureActor, Properties);
-	DOREPLIFETIME(AWindowCaptureActor, TextureTarget);
 }
 
 void AWindowCaptureActor::OnRep_TextureTarget()
@@ -115,6 +133,7 @@ TArray<FString> AWindowCaptureActor::GetAvailableWindows()
 {
 	AvailableWindows.Empty(); // Clear the existing window list
 
+#if PLATFORM_WINDOWS
 	// Callback function to receive window titles
 	auto EnumWindowsProc = [](HWND hwnd, LPARAM lParam) -> BOOL {
 		TCHAR title[256];
@@ -131,6 +150,7 @@ TArray<FString> AWindowCaptureActor::GetAvailableWindows()
 	if (EnumWindows(EnumWindowsProc, (LPARAM)&AvailableWindows)) {
 		return AvailableWindows;
 	}
+#endif
 
 	return AvailableWindows; // Return the list of window titles
 
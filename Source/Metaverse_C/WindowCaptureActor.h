@@ -6,6 +6,7 @@
 #include "GameFramework/Actor.h"
 #include "CaptureMachineProperties.h"
 #include "CaptureMachine.h"
+#include "CaptureStreamComponent.h"
 #include "WindowCaptureActor.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWindowCaptureActorChangeTexture, UTexture2D*, NewTexture);
@@ -37,6 +38,9 @@ protected:
 	UFUNCTION()
 	void OnChangeTexture(UTexture2D* NewTexture);
 
+	UFUNCTION()
+	void OnStreamTexture(UTexture2D* NewTexture);
+
 public:
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void BeginDestroy() override;
@@ -44,7 +48,8 @@ public:
 	UPROPERTY(Replicated, EditAnywhere, BlueprintReadWrite, Category = WindowCapture2D)
 	FCaptureMachineProperties Properties;
 
-	UPROPERTY(Replicated, BlueprintReadWrite, Category = SceneCapture)
+	// Captured texture on the server, texture decoded from the capture stream on clients
+	UPROPERTY(BlueprintReadWrite, Category = SceneCapture)
 	class UTexture2D* TextureTarget;
 
 	UPROPERTY(BlueprintAssignable, Category = SceneCapture)
@@ -59,6 +64,9 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	USceneComponent* SceneComponent;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = WindowCapture2D)
+	UCaptureStreamComponent* StreamComponent;
+
 protected:
 	UPROPERTY(Transient)
 	UCaptureMachine* CaptureMachine = nullptr;
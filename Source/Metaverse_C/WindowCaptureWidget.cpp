@@ -4,11 +4,13 @@
 #include "Engine/Texture2D.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/NetDriver.h"
+#if PLATFORM_WINDOWS
 #include <Windows.h>
 #define TRUE 1
 #define FALSE 0
 #include <Psapi.h>
 #pragma comment(lib, "Psapi.lib")
+#endif
 
 UWindowCaptureWidget::UWindowCaptureWidget(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -199,6 +201,7 @@ TArray<FString> UWindowCaptureWidget::GetAvailableWindows()
 {
 	AvailableWindows.Empty(); // Clear the existing window list
 
+#if PLATFORM_WINDOWS
 	// Callback function to receive window titles
 	auto EnumWindowsProc = [](HWND hwnd, LPARAM lParam) -> BOOL {
 		if (IsWindowVisible(hwnd) && GetAncestor(hwnd, GA_ROOT) == hwnd) {
@@ -215,6 +218,7 @@ TArray<FString> UWindowCaptureWidget::GetAvailableWindows()
 
 	// Enumerate all open windows and collect their titles
 	EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(&AvailableWindows));
+#endif
 
 	return AvailableWindows; // Return the list of window titles
 }